@@ -14,6 +14,8 @@
 // Author: Douglas P. Bogia
 
 #include "BaseAlgorithm.hpp"
+#include "HugePageAllocator.hpp"
+#include "TimingStats.hpp"
 #include <iostream>
 
 BaseAlgorithm::BaseAlgorithm(SParameters& parameters)
@@ -32,6 +34,66 @@ void BaseAlgorithm::FrameCalculations(bool bParametersChanged)
 	m_bFrameCalcRequired = false;
 }
 
+std::future<cv::Mat> BaseAlgorithm::ExtractFrameImageAsync()
+{
+	std::promise<cv::Mat> frame;
+
+	frame.set_value(ExtractFrameImage());
+
+	return frame.get_future();
+}
+
+bool BaseAlgorithm::SupportsAsyncFrames()
+{
+	return false;
+}
+
+void BaseAlgorithm::GetOutputAlignment(int& widthAlignment, int& heightAlignment)
+{
+	widthAlignment = 1;
+	heightAlignment = 1;
+}
+
+void BaseAlgorithm::ExtractFrameImage(cv::Mat& output)
+{
+	cv::Mat frame = ExtractFrameImage();
+	std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+
+	frame.copyTo(output);
+	TimingStats::GetTimingStats()->AddIterationResults(ETimingType::TIMING_OUTPUT_COPY, startTime, std::chrono::high_resolution_clock::now());
+}
+
+cv::Mat BaseAlgorithm::AllocateOutputImage()
+{
+	cv::Mat output;
+
+	// With --hugePages the output comes from huge pages (a NULL allocator keeps the OpenCV default)
+	output.allocator = HugePageAllocator::GetHugePageAllocator();
+	output.create(m_parameters->m_heightOutput, m_parameters->m_widthOutput, CV_8UC3);
+
+	return output;
+}
+
+void BaseAlgorithm::FreeOutputImage(cv::Mat& output)
+{
+	output.release();
+}
+
+std::string BaseAlgorithm::GetAlgorithmStats()
+{
+	return "";
+}
+
+std::string BaseAlgorithm::GetDeviceName()
+{
+	return "host CPU";
+}
+
+std::string BaseAlgorithm::GetDriverVersion()
+{
+	return "";
+}
+
 bool BaseAlgorithm::StartVariant()
 {
 	bool bRetVal = true;
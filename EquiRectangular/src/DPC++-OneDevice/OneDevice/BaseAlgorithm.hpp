@@ -16,6 +16,7 @@
 #pragma once
 
 #include "ParseArgs.hpp"
+#include <future>
 #include <string>
 #include <string.h>
 
@@ -27,6 +28,10 @@ const int STORE_COL_ROW = 1;
 
 const int STORE_MAX = 2;
 
+// The multiples main rounds the output width and height up to so the parallel algorithms need not handle odd sizes
+const int OUTPUT_WIDTH_ALIGNMENT = 16;
+const int OUTPUT_HEIGHT_ALIGNMENT = 8;
+
 class BaseAlgorithm {
 protected:
 	SParameters* m_parameters;
@@ -39,10 +44,41 @@ public:
 
 	virtual void FrameCalculations(bool bParametersChanged);
 	virtual cv::Mat ExtractFrameImage() = 0;
+	// ExtractFrameImageAsync submits the work for the frame and returns a future for the flattened image.  The
+	// default runs ExtractFrameImage synchronously so only algorithms that can avoid waiting need to override it.
+	virtual std::future<cv::Mat> ExtractFrameImageAsync();
+	// SupportsAsyncFrames is true when a frame returned by ExtractFrameImageAsync stays intact while the next frame
+	// is submitted (i.e., the frames are rendered into separate buffers), so --asyncFrames can keep one in flight.
+	// The default ExtractFrameImageAsync returns the algorithm's own buffer, which the next frame overwrites.
+	virtual bool SupportsAsyncFrames();
+	// ExtractFrameImage(output) renders into a caller owned image.  If output is empty or the wrong size it is
+	// (re)allocated.  The default copies the result of ExtractFrameImage() so algorithms that can write straight
+	// into the caller's memory should override it.
+	virtual void ExtractFrameImage(cv::Mat& output);
+	// AllocateOutputImage returns an output image suited to ExtractFrameImage(output) for the current variant
+	// (e.g., USM memory for DPC++ algorithms).  Release it with FreeOutputImage before StopVariant.
+	virtual cv::Mat AllocateOutputImage();
+	virtual void FreeOutputImage(cv::Mat& output);
 	virtual cv::Mat GetDebugImage() = 0;
+	// GetOutputAlignment returns the multiples the output width and height have to be for the algorithm's kernels
+	// to cover every pixel.  main pads the requested size up to OUTPUT_WIDTH_ALIGNMENT by OUTPUT_HEIGHT_ALIGNMENT;
+	// the batch runner and render service render exactly the requested size and reject sizes that do not fit.
+	// The default accepts any size.
+	virtual void GetOutputAlignment(int& widthAlignment, int& heightAlignment);
 
 	virtual std::string GetDescription() = 0;
+	// GetAlgorithmStats returns any statistics the algorithm keeps beyond the timing statistics (e.g., cache hit
+	// rates) as one or more lines.  The default has none.
+	virtual std::string GetAlgorithmStats();
+	// GetDeviceName and GetDriverVersion identify the device the current variant runs on (e.g., for the results
+	// file).  The defaults are for the algorithms that run on the host CPU.
+	virtual std::string GetDeviceName();
+	virtual std::string GetDriverVersion();
 
 	virtual bool StartVariant();
 	virtual void StopVariant() = 0;
-};
\ No newline at end of file
+};
+
+// CreateAlgorithmFunc creates the algorithm with the given number (see --algorithm) or returns NULL.  Used by the
+// modes that create their own algorithm instances (e.g., BatchRunner and RenderService).
+typedef BaseAlgorithm* (*CreateAlgorithmFunc)(int algorithm, SParameters& parameters);
\ No newline at end of file
@@ -0,0 +1,383 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "BatchRunner.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include "opencv2/imgcodecs.hpp"
+#include "TimingStats.hpp"
+
+const int BATCH_JOB_FIELDS = 8;
+
+static std::string TrimField(const std::string& field)
+{
+	size_t start = field.find_first_not_of(" \t\r\n");
+	size_t end = field.find_last_not_of(" \t\r\n");
+
+	if (start == std::string::npos)
+	{
+		return "";
+	}
+
+	return field.substr(start, end - start + 1);
+}
+
+BatchRunner::BatchRunner(SParameters& parameters, CreateAlgorithmFunc pCreateAlgorithm)
+{
+	m_baseParameters = parameters;
+	m_pCreateAlgorithm = pCreateAlgorithm;
+	m_algorithm = (parameters.m_algorithm > -1) ? parameters.m_algorithm : DEFAULT_BATCH_ALGORITHM;
+	m_widthAlignment = 1;
+	m_heightAlignment = 1;
+
+	// Constructing an algorithm does not touch a device, so a throwaway instance can report the alignment
+	BaseAlgorithm* pAlg = m_pCreateAlgorithm(m_algorithm, m_baseParameters);
+
+	if (pAlg != NULL)
+	{
+		pAlg->GetOutputAlignment(m_widthAlignment, m_heightAlignment);
+		delete pAlg;
+	}
+	m_numWorkers = parameters.m_batchWorkers;
+	if (m_numWorkers < 1)
+	{
+		m_numWorkers = std::max(1, (int)std::thread::hardware_concurrency());
+	}
+	m_nextJob = 0;
+	m_statJobsDone = 0;
+	m_statJobsFailed = 0;
+	m_statSourcesDecoded = 0;
+	m_statSetups = 0;
+	for (int i = 0; i < BATCH_STAGE_MAX; i++)
+	{
+		m_statStageSum[i] = std::chrono::duration<double>::zero();
+	}
+	m_statWallTime = std::chrono::duration<double>::zero();
+}
+
+bool BatchRunner::LoadJobs(const char* pFilename, char* pErrorMessage)
+{
+	std::ifstream jobFile(pFilename);
+	std::string line;
+	int lineNumber = 0;
+
+	if (!jobFile.is_open())
+	{
+		snprintf(pErrorMessage, MAX_ERROR_MESSAGE, "Error: Could not open the batch job file %s", pFilename);
+		return false;
+	}
+	m_jobs.clear();
+	m_sources.clear();
+	while (std::getline(jobFile, line))
+	{
+		std::vector<std::string> fields;
+		size_t start = 0;
+		size_t comma;
+
+		lineNumber++;
+		line = TrimField(line);
+		if (line.empty() || line[0] == '#')
+		{
+			continue;
+		}
+		do
+		{
+			comma = line.find(',', start);
+			fields.push_back(TrimField(line.substr(start, (comma == std::string::npos) ? std::string::npos : comma - start)));
+			start = comma + 1;
+		} while (comma != std::string::npos);
+		if (fields.size() != BATCH_JOB_FIELDS)
+		{
+			snprintf(pErrorMessage, MAX_ERROR_MESSAGE, "Error: Line %d of %s has %d fields.  Expected source, yaw, pitch, roll, fov, width, height, output.",
+				lineNumber, pFilename, (int)fields.size());
+			return false;
+		}
+
+		SBatchJob job;
+
+		job.m_source = fields[0];
+		job.m_yaw = atoi(fields[1].c_str());
+		job.m_pitch = atoi(fields[2].c_str());
+		job.m_roll = atoi(fields[3].c_str());
+		job.m_fov = atoi(fields[4].c_str());
+		job.m_widthOutput = atoi(fields[5].c_str());
+		job.m_heightOutput = atoi(fields[6].c_str());
+		job.m_output = fields[7];
+		job.m_lineNumber = lineNumber;
+		// Use the same limits ParseArgs applies to the command line values
+		if (job.m_source.empty() || job.m_output.empty() || job.m_yaw < -180 || job.m_yaw > 180 || job.m_pitch < -90 || job.m_pitch > 90 ||
+			job.m_roll < 0 || job.m_roll > 360 || job.m_fov < 1 || job.m_fov > 120 || job.m_widthOutput <= 0 || job.m_heightOutput <= 0)
+		{
+			snprintf(pErrorMessage, MAX_ERROR_MESSAGE, "Error: Line %d of %s has an illegal value.", lineNumber, pFilename);
+			return false;
+		}
+		if (job.m_widthOutput % m_widthAlignment != 0 || job.m_heightOutput % m_heightAlignment != 0)
+		{
+			snprintf(pErrorMessage, MAX_ERROR_MESSAGE, "Error: Line %d of %s asks for %dx%d but algorithm %d needs the width to be a multiple of %d and the height of %d.",
+				lineNumber, pFilename, job.m_widthOutput, job.m_heightOutput, m_algorithm, m_widthAlignment, m_heightAlignment);
+			return false;
+		}
+		m_jobs.push_back(job);
+	}
+
+	// Keep the jobs for one source together (and within that the jobs with the same output size) so each worker
+	// switches source and rebuilds its algorithm as rarely as possible
+	std::stable_sort(m_jobs.begin(), m_jobs.end(), [](const SBatchJob& a, const SBatchJob& b) {
+		if (a.m_source != b.m_source)
+		{
+			return a.m_source < b.m_source;
+		}
+		if (a.m_widthOutput != b.m_widthOutput)
+		{
+			return a.m_widthOutput < b.m_widthOutput;
+		}
+		return a.m_heightOutput < b.m_heightOutput;
+	});
+	for (auto& job : m_jobs)
+	{
+		m_sources[job.m_source].m_jobsRemaining++;
+	}
+
+	return true;
+}
+
+void BatchRunner::Run()
+{
+	std::vector<std::thread*> threads;
+	std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+
+	m_nextJob = 0;
+	for (int i = 0; i < m_numWorkers; i++)
+	{
+		threads.push_back(new std::thread([this] { threadFunc(); }));
+	}
+	for (auto pThread : threads)
+	{
+		pThread->join();
+		delete pThread;
+	}
+	m_statWallTime = std::chrono::high_resolution_clock::now() - startTime;
+}
+
+bool BatchRunner::GetNextJob(SBatchJob& job)
+{
+	std::lock_guard<std::mutex> jobLock(m_jobMutex);
+
+	if (m_nextJob >= m_jobs.size())
+	{
+		return false;
+	}
+	job = m_jobs[m_nextJob++];
+
+	return true;
+}
+
+cv::Mat BatchRunner::AcquireSource(const std::string& source)
+{
+	std::shared_future<cv::Mat> image;
+	std::promise<cv::Mat> decodePromise;
+	bool bDecode = false;
+
+	{
+		std::lock_guard<std::mutex> jobLock(m_jobMutex);
+		SSourceEntry& entry = m_sources[source];
+
+		if (!entry.m_image.valid())
+		{
+			// First request for this source, so this worker decodes it and any other worker that needs it waits
+			entry.m_image = decodePromise.get_future().share();
+			bDecode = true;
+		}
+		image = entry.m_image;
+	}
+	if (bDecode)
+	{
+		std::chrono::high_resolution_clock::time_point decodeStartTime = std::chrono::high_resolution_clock::now();
+
+		decodePromise.set_value(cv::imread(source, cv::IMREAD_COLOR));
+		AddStageTime(BATCH_STAGE_DECODE, decodeStartTime, std::chrono::high_resolution_clock::now());
+		std::lock_guard<std::mutex> statsLock(m_statsMutex);
+		m_statSourcesDecoded++;
+	}
+
+	return image.get();
+}
+
+void BatchRunner::JobFinished(const SBatchJob& job, bool bSucceeded)
+{
+	{
+		std::lock_guard<std::mutex> jobLock(m_jobMutex);
+		auto entry = m_sources.find(job.m_source);
+
+		// Drop the shared copy of the decoded source once no job needs it
+		if (entry != m_sources.end() && --entry->second.m_jobsRemaining == 0)
+		{
+			m_sources.erase(entry);
+		}
+	}
+
+	std::lock_guard<std::mutex> statsLock(m_statsMutex);
+	if (bSucceeded)
+	{
+		m_statJobsDone++;
+	}
+	else
+	{
+		m_statJobsFailed++;
+	}
+}
+
+void BatchRunner::AddStageTime(EBatchStage stage, std::chrono::high_resolution_clock::time_point startTime, std::chrono::high_resolution_clock::time_point endTime)
+{
+	std::lock_guard<std::mutex> statsLock(m_statsMutex);
+
+	m_statStageSum[stage] += endTime - startTime;
+}
+
+void BatchRunner::threadFunc()
+{
+	SParameters parameters = m_baseParameters;
+	SParameters prevParameters;
+	BaseAlgorithm* pAlg = NULL;
+	std::string currentSource = "";
+	SBatchJob job;
+
+	parameters.m_imageIndex = 0;
+	while (GetNextJob(job))
+	{
+		std::chrono::high_resolution_clock::time_point stageStartTime;
+		// Render at exactly the requested size since the focal length and principal point follow from it (LoadJobs
+		// only accepts sizes the algorithm can render)
+		int widthOutput = job.m_widthOutput;
+		int heightOutput = job.m_heightOutput;
+
+		if (job.m_source != currentSource)
+		{
+			cv::Mat image = AcquireSource(job.m_source);
+
+			if (image.empty())
+			{
+				printf("Batch: line %d could not load %s\n", job.m_lineNumber, job.m_source.c_str());
+				JobFinished(job, false);
+				continue;
+			}
+			// Place the image in the entry that is not current so algorithms caching the source by m_imageIndex
+			// upload the new source
+			parameters.m_imageIndex = (parameters.m_imageIndex + 1) % 2;
+			parameters.m_image[parameters.m_imageIndex] = image;
+			currentSource = job.m_source;
+		}
+		parameters.m_yaw = job.m_yaw;
+		parameters.m_pitch = job.m_pitch;
+		parameters.m_roll = job.m_roll;
+		parameters.m_fov = job.m_fov;
+		if (pAlg == NULL || widthOutput != parameters.m_widthOutput || heightOutput != parameters.m_heightOutput)
+		{
+			// The algorithms size their buffers for the output in StartVariant so a new size needs a new instance
+			std::lock_guard<std::mutex> setupLock(m_setupMutex);
+
+			stageStartTime = std::chrono::high_resolution_clock::now();
+			if (pAlg != NULL)
+			{
+				pAlg->StopVariant();
+				delete pAlg;
+				pAlg = NULL;
+			}
+			parameters.m_widthOutput = widthOutput;
+			parameters.m_heightOutput = heightOutput;
+			pAlg = m_pCreateAlgorithm(m_algorithm, parameters);
+			if (pAlg != NULL && !pAlg->StartVariant())
+			{
+				delete pAlg;
+				pAlg = NULL;
+			}
+			AddStageTime(BATCH_STAGE_SETUP, stageStartTime, std::chrono::high_resolution_clock::now());
+			std::lock_guard<std::mutex> statsLock(m_statsMutex);
+			m_statSetups++;
+		}
+		if (pAlg == NULL)
+		{
+			printf("Batch: line %d could not start algorithm %d\n", job.m_lineNumber, m_algorithm);
+			JobFinished(job, false);
+			continue;
+		}
+
+		bool bParametersChanged = prevParameters != parameters;
+
+		stageStartTime = std::chrono::high_resolution_clock::now();
+		pAlg->FrameCalculations(bParametersChanged);
+		AddStageTime(BATCH_STAGE_FRAME_CALCULATIONS, stageStartTime, std::chrono::high_resolution_clock::now());
+		prevParameters = parameters;
+
+		stageStartTime = std::chrono::high_resolution_clock::now();
+		cv::Mat flatImg = pAlg->ExtractFrameImage();
+		AddStageTime(BATCH_STAGE_EXTRACTION, stageStartTime, std::chrono::high_resolution_clock::now());
+
+		stageStartTime = std::chrono::high_resolution_clock::now();
+		bool bWritten = cv::imwrite(job.m_output, flatImg);
+		AddStageTime(BATCH_STAGE_WRITE, stageStartTime, std::chrono::high_resolution_clock::now());
+		if (!bWritten)
+		{
+			printf("Batch: line %d could not write %s\n", job.m_lineNumber, job.m_output.c_str());
+		}
+		JobFinished(job, bWritten);
+	}
+
+	if (pAlg != NULL)
+	{
+		std::lock_guard<std::mutex> setupLock(m_setupMutex);
+
+		pAlg->StopVariant();
+		delete pAlg;
+	}
+	TimingStats::ReleaseTimingStats();
+}
+
+int BatchRunner::GetNumWorkers()
+{
+	return m_numWorkers;
+}
+
+std::string BatchRunner::GetStatsString()
+{
+	char line[1024];
+	std::string retVal;
+	std::lock_guard<std::mutex> statsLock(m_statsMutex);
+	char const* stageNames[BATCH_STAGE_MAX] = { "Source decode", "Algorithm setup", "Frame calculations", "Image extraction", "Output write" };
+	long long jobs = m_statJobsDone + m_statJobsFailed;
+	double jobsPerSecond = 0.0;
+
+	if (m_statWallTime.count() > 0.0)
+	{
+		jobsPerSecond = (double)m_statJobsDone / m_statWallTime.count();
+	}
+	sprintf(line, "Batch,%lld,jobs done,%lld,failed,%lld,sources decoded,%lld,algorithm setups,%d,workers,%12.7f,seconds,%12.5f,jobs/second\n",
+		m_statJobsDone, m_statJobsFailed, m_statSourcesDecoded, m_statSetups, m_numWorkers, m_statWallTime.count(), jobsPerSecond);
+	retVal = line;
+	for (int i = 0; i < BATCH_STAGE_MAX; i++)
+	{
+		// Decode and setup happen once per source or size, the rest once per job.  The times are summed across
+		// the workers so they show where the CPU time goes rather than the wall time.
+		long long count = (i == BATCH_STAGE_DECODE) ? m_statSourcesDecoded : (i == BATCH_STAGE_SETUP) ? m_statSetups : jobs;
+		double average = (count > 0) ? m_statStageSum[i].count() / (double)count : 0.0;
+
+		sprintf(line, "Batch stage,%s,%12.7f,total seconds,%12.7f,average seconds,%lld,times\n", stageNames[i], m_statStageSum[i].count(), average, count);
+		retVal += line;
+	}
+
+	return retVal;
+}
@@ -0,0 +1,116 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// BatchRunner renders a list of jobs read from a job file without any highgui windows so it can run on a
+// headless server.  Each non-comment line of the job file is:
+//
+//     sourcePath, yaw, pitch, roll, fov, widthOutput, heightOutput, outputPath
+//
+// The jobs are sorted by source (and then by output size) and handed out in that order to a pool of worker
+// threads.  Each worker owns its own algorithm instance (and therefore its own DPC++ queue) and each source
+// is decoded only once no matter how many workers use it.  A worker only switches the image the algorithm
+// sees when its next job has a different source, so algorithms that cache the uploaded source by
+// m_imageIndex upload each panorama once per worker.
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <future>
+#include <vector>
+#include "opencv2/core/core.hpp"
+#include "BaseAlgorithm.hpp"
+#include "ParseArgs.hpp"
+
+// The algorithm used when --algorithm is not given along with --batch (SerialRemappingV2)
+const int DEFAULT_BATCH_ALGORITHM = 4;
+
+struct SBatchJob {
+	std::string	m_source;
+	int			m_yaw;
+	int			m_pitch;
+	int			m_roll;
+	int			m_fov;
+	int			m_widthOutput;
+	int			m_heightOutput;
+	std::string	m_output;
+	// m_lineNumber is the line of the job file the job came from (used for error messages)
+	int			m_lineNumber;
+};
+
+class BatchRunner {
+private:
+	enum EBatchStage {
+		BATCH_STAGE_DECODE = 0,
+		BATCH_STAGE_SETUP,
+		BATCH_STAGE_FRAME_CALCULATIONS,
+		BATCH_STAGE_EXTRACTION,
+		BATCH_STAGE_WRITE,
+		BATCH_STAGE_MAX
+	};
+
+	struct SSourceEntry {
+		std::shared_future<cv::Mat>	m_image;
+		// m_jobsRemaining counts the jobs that still need the image so it can be freed after the last one
+		int							m_jobsRemaining;
+	};
+
+	SParameters m_baseParameters;
+	CreateAlgorithmFunc m_pCreateAlgorithm;
+	int m_algorithm;
+	// The jobs are rendered at exactly their size, so it has to be a multiple of the algorithm's output alignment
+	int m_widthAlignment;
+	int m_heightAlignment;
+	int m_numWorkers;
+	std::vector<SBatchJob> m_jobs;
+	size_t m_nextJob;
+	std::map<std::string, SSourceEntry> m_sources;
+	std::mutex m_jobMutex;
+	// Algorithm creation and StartVariant go through the static ConfigurableDeviceSelector search state so only
+	// one worker sets up an algorithm at a time
+	std::mutex m_setupMutex;
+	std::mutex m_statsMutex;
+
+	// Statistics for the last Run
+	long long m_statJobsDone;
+	long long m_statJobsFailed;
+	long long m_statSourcesDecoded;
+	long long m_statSetups;
+	std::chrono::duration<double> m_statStageSum[BATCH_STAGE_MAX];
+	std::chrono::duration<double> m_statWallTime;
+
+private:
+	// Function to run in each worker thread
+	void threadFunc();
+	bool GetNextJob(SBatchJob& job);
+	// AcquireSource returns the decoded source image, decoding it if this is the first request for it
+	cv::Mat AcquireSource(const std::string& source);
+	void JobFinished(const SBatchJob& job, bool bSucceeded);
+	void AddStageTime(EBatchStage stage, std::chrono::high_resolution_clock::time_point startTime, std::chrono::high_resolution_clock::time_point endTime);
+
+public:
+	BatchRunner(SParameters& parameters, CreateAlgorithmFunc pCreateAlgorithm);
+
+	// LoadJobs reads the job file.  Returns false and fills in pErrorMessage (at least MAX_ERROR_MESSAGE
+	// characters) if the file cannot be read or a line is malformed.
+	bool LoadJobs(const char* pFilename, char* pErrorMessage);
+	// Run blocks until every job has been rendered and written
+	void Run();
+
+	int GetNumWorkers();
+	std::string GetStatsString();
+};
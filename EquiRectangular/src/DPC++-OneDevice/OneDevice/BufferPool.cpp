@@ -0,0 +1,260 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "BufferPool.hpp"
+#include <new>
+#include <stdio.h>
+#include "HugePageAllocator.hpp"
+
+BufferPool* BufferPool::c_pBufferPool = NULL;
+
+BufferPool::BufferPool()
+{
+	m_bPooling = false;
+	m_idleLimit = DEFAULT_BUFFER_POOL_IDLE_LIMIT;
+	m_idleBytes = 0;
+	m_useCounter = 0;
+	ResetStats();
+}
+
+BufferPool* BufferPool::GetBufferPool()
+{
+	if (c_pBufferPool == NULL)
+	{
+		c_pBufferPool = new BufferPool();
+	}
+
+	return c_pBufferPool;
+}
+
+void BufferPool::Terminate()
+{
+	if (c_pBufferPool != NULL)
+	{
+		{
+			std::lock_guard<std::mutex> poolLock(c_pBufferPool->m_poolMutex);
+
+			for (auto& buffer : c_pBufferPool->m_buffers)
+			{
+				c_pBufferPool->FreeBuffer(buffer);
+			}
+			c_pBufferPool->m_buffers.clear();
+		}
+		delete c_pBufferPool;
+		c_pBufferPool = NULL;
+	}
+}
+
+void BufferPool::SetPooling(bool bPooling)
+{
+	std::lock_guard<std::mutex> poolLock(m_poolMutex);
+
+	m_bPooling = bPooling;
+	if (!m_bPooling)
+	{
+		TrimIdle(0);
+	}
+}
+
+void BufferPool::ResetStats()
+{
+	m_statAcquires = 0;
+	m_statReused = 0;
+	m_statAllocations = 0;
+	m_statAllocatedBytes = 0;
+	m_statFrees = 0;
+}
+
+void* BufferPool::Acquire(size_t bytes)
+{
+	return AcquireBuffer(bytes, BUFFER_HOST, NULL, NULL);
+}
+
+void* BufferPool::Acquire(size_t bytes, EBufferKind kind, const sycl::device& device, const sycl::context& context)
+{
+	return AcquireBuffer(bytes, kind, &device, &context);
+}
+
+void* BufferPool::AcquireBuffer(size_t bytes, EBufferKind kind, const sycl::device* pDevice, const sycl::context* pContext)
+{
+	std::lock_guard<std::mutex> poolLock(m_poolMutex);
+	SPooledBuffer* pBest = NULL;
+
+	m_statAcquires++;
+	if (m_bPooling)
+	{
+		// Best fit among the idle buffers of the same kind, device, and context
+		for (auto& buffer : m_buffers)
+		{
+			if (!buffer.m_bInUse && buffer.m_kind == kind && buffer.m_bytes >= bytes && buffer.m_bytes / 2 <= bytes &&
+				(kind == BUFFER_HOST || (*buffer.m_context == *pContext && *buffer.m_device == *pDevice)) &&
+				(pBest == NULL || buffer.m_bytes < pBest->m_bytes))
+			{
+				pBest = &buffer;
+			}
+		}
+	}
+	if (pBest != NULL)
+	{
+		pBest->m_bInUse = true;
+		pBest->m_lastUse = ++m_useCounter;
+		m_idleBytes -= pBest->m_bytes;
+		m_statReused++;
+
+		return pBest->m_pMemory;
+	}
+
+	SPooledBuffer buffer;
+
+	buffer.m_bytes = (bytes + BUFFER_POOL_ALIGNMENT - 1) / BUFFER_POOL_ALIGNMENT * BUFFER_POOL_ALIGNMENT;
+	buffer.m_kind = kind;
+	buffer.m_bInUse = true;
+	buffer.m_bHugePages = false;
+	buffer.m_lastUse = ++m_useCounter;
+	switch (kind)
+	{
+	case BUFFER_HOST:
+		if (HugePageAllocator::GetHugePageAllocator() != NULL && buffer.m_bytes >= HUGE_PAGE_SIZE)
+		{
+			buffer.m_pMemory = HugePageAllocator::Allocate(buffer.m_bytes);
+			buffer.m_bHugePages = true;
+		}
+		else
+		{
+			buffer.m_pMemory = ::operator new(buffer.m_bytes, std::align_val_t(BUFFER_POOL_ALIGNMENT));
+		}
+		break;
+	case BUFFER_USM_HOST:
+		buffer.m_pMemory = sycl::aligned_alloc_host(BUFFER_POOL_ALIGNMENT, buffer.m_bytes, *pContext);
+		break;
+	case BUFFER_USM_SHARED:
+		buffer.m_pMemory = sycl::aligned_alloc_shared(BUFFER_POOL_ALIGNMENT, buffer.m_bytes, *pDevice, *pContext);
+		break;
+	case BUFFER_USM_DEVICE:
+		buffer.m_pMemory = sycl::aligned_alloc_device(BUFFER_POOL_ALIGNMENT, buffer.m_bytes, *pDevice, *pContext);
+		break;
+	default:
+		buffer.m_pMemory = NULL;
+		break;
+	}
+	if (buffer.m_pMemory == NULL)
+	{
+		printf("BufferPool: allocation of %zu bytes failed\n", buffer.m_bytes);
+		throw std::bad_alloc();
+	}
+	if (kind != BUFFER_HOST)
+	{
+		buffer.m_context = *pContext;
+		buffer.m_device = *pDevice;
+	}
+	m_statAllocations++;
+	m_statAllocatedBytes += buffer.m_bytes;
+	m_buffers.push_back(buffer);
+
+	return buffer.m_pMemory;
+}
+
+void BufferPool::FreeBuffer(SPooledBuffer& buffer)
+{
+	switch (buffer.m_kind)
+	{
+	case BUFFER_HOST:
+		if (buffer.m_bHugePages)
+		{
+			HugePageAllocator::Free(buffer.m_pMemory);
+		}
+		else
+		{
+			::operator delete(buffer.m_pMemory, std::align_val_t(BUFFER_POOL_ALIGNMENT));
+		}
+		break;
+	default:
+		sycl::free(buffer.m_pMemory, *buffer.m_context);
+		break;
+	}
+	buffer.m_pMemory = NULL;
+	m_statFrees++;
+}
+
+void BufferPool::TrimIdle(size_t limit)
+{
+	while (m_idleBytes > limit)
+	{
+		auto oldest = m_buffers.end();
+
+		for (auto buffer = m_buffers.begin(); buffer != m_buffers.end(); buffer++)
+		{
+			if (!buffer->m_bInUse && (oldest == m_buffers.end() || buffer->m_lastUse < oldest->m_lastUse))
+			{
+				oldest = buffer;
+			}
+		}
+		if (oldest == m_buffers.end())
+		{
+			break;
+		}
+		m_idleBytes -= oldest->m_bytes;
+		FreeBuffer(*oldest);
+		m_buffers.erase(oldest);
+	}
+}
+
+void BufferPool::Release(void* pMemory)
+{
+	if (pMemory == NULL)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> poolLock(m_poolMutex);
+
+	for (auto buffer = m_buffers.begin(); buffer != m_buffers.end(); buffer++)
+	{
+		if (buffer->m_pMemory == pMemory && buffer->m_bInUse)
+		{
+			if (m_bPooling)
+			{
+				buffer->m_bInUse = false;
+				m_idleBytes += buffer->m_bytes;
+				TrimIdle(m_idleLimit);
+			}
+			else
+			{
+				FreeBuffer(*buffer);
+				m_buffers.erase(buffer);
+			}
+
+			return;
+		}
+	}
+}
+
+std::string BufferPool::GetStatsString(long long frames)
+{
+	char line[1024];
+	std::lock_guard<std::mutex> poolLock(m_poolMutex);
+	double perFrame = frames > 0 ? 1.0 / (double)frames : 0.0;
+	size_t pooledBytes = 0;
+
+	for (auto& buffer : m_buffers)
+	{
+		pooledBytes += buffer.m_bytes;
+	}
+	sprintf(line, "Buffer pool,%s,pooling,%lld,requests,%lld,reused,%lld,allocations,%10.1f,MB allocated,%lld,frees,%8.3f,allocations per frame,%10.1f,KB allocated per frame,%10.1f,MB held\n",
+		m_bPooling ? "on" : "off", m_statAcquires, m_statReused, m_statAllocations, m_statAllocatedBytes / (1024.0 * 1024.0), m_statFrees,
+		m_statAllocations * perFrame, m_statAllocatedBytes * perFrame / 1024.0, pooledBytes / (1024.0 * 1024.0));
+
+	return line;
+}
@@ -0,0 +1,103 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// BufferPool hands out the large per-variant and per-frame working buffers (maps, coordinate arrays, USM images)
+// so they can be reused rather than allocated and freed by every StartVariant/StopVariant and every frame.  Every
+// buffer is aligned to BUFFER_POOL_ALIGNMENT.  With pooling on (--bufferPool) a released buffer stays allocated
+// and the next request of the same kind, device and context that it can hold (without wasting more than half of
+// it) gets it back.  Idle buffers beyond the idle limit are freed oldest first.  With pooling off every buffer is
+// freed on release, as before, but the requests are still counted so both runs can be compared in the summary.
+//
+// Host buffers use huge pages (see HugePageAllocator) when --hugePages is given and the buffer is at least one
+// huge page.
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include <sycl/sycl.hpp>
+
+enum EBufferKind {
+	BUFFER_HOST = 0,
+	BUFFER_USM_HOST,
+	BUFFER_USM_SHARED,
+	BUFFER_USM_DEVICE,
+	BUFFER_KIND_MAX
+};
+
+const size_t BUFFER_POOL_ALIGNMENT = 64;
+// Idle buffers kept for reuse are capped at this many bytes
+const size_t DEFAULT_BUFFER_POOL_IDLE_LIMIT = (size_t)1024 * 1024 * 1024;
+
+class BufferPool {
+private:
+	struct SPooledBuffer {
+		void*			m_pMemory;
+		size_t			m_bytes;
+		EBufferKind		m_kind;
+		// m_context and m_device are only set for the USM kinds; default constructing them would select a
+		// device and create a new context on every host allocation
+		std::optional<sycl::context>	m_context;
+		std::optional<sycl::device>		m_device;
+		bool			m_bInUse;
+		bool			m_bHugePages;
+		long long		m_lastUse;
+	};
+
+	static BufferPool* c_pBufferPool;
+
+	bool m_bPooling;
+	size_t m_idleLimit;
+	size_t m_idleBytes;
+	long long m_useCounter;
+	std::vector<SPooledBuffer> m_buffers;
+	std::mutex m_poolMutex;
+
+	// Statistics since the last ResetStats
+	long long m_statAcquires;
+	long long m_statReused;
+	long long m_statAllocations;
+	size_t m_statAllocatedBytes;
+	long long m_statFrees;
+
+private:
+	BufferPool();
+	void* AcquireBuffer(size_t bytes, EBufferKind kind, const sycl::device* pDevice, const sycl::context* pContext);
+	// FreeBuffer returns the memory to the system.  Call with m_poolMutex held.
+	void FreeBuffer(SPooledBuffer& buffer);
+	// TrimIdle frees the oldest idle buffers until the idle bytes fit in limit.  Call with m_poolMutex held.
+	void TrimIdle(size_t limit);
+
+public:
+	static BufferPool* GetBufferPool();
+	// Terminate frees every buffer (released or not) so it must be called after all algorithms are stopped
+	static void Terminate();
+
+	void SetPooling(bool bPooling);
+
+	// Acquire returns a host buffer of at least bytes
+	void* Acquire(size_t bytes);
+	// Acquire returns a USM buffer (kind is BUFFER_USM_HOST, BUFFER_USM_SHARED, or BUFFER_USM_DEVICE) of at least
+	// bytes for the device and context
+	void* Acquire(size_t bytes, EBufferKind kind, const sycl::device& device, const sycl::context& context);
+	// Release gives back a buffer from Acquire.  NULL is ignored.
+	void Release(void* pMemory);
+
+	void ResetStats();
+	// GetStatsString reports the requests and system allocations since ResetStats in total and per frame
+	std::string GetStatsString(long long frames);
+};
@@ -22,6 +22,11 @@ std::string ConfigurableDeviceSelector::c_device_name = "";
 std::string ConfigurableDeviceSelector::c_driver_version = "";
 std::map<std::string, int> ConfigurableDeviceSelector::c_type_preference = std::map<std::string, int>();
 std::vector<SDeviceInfo> ConfigurableDeviceSelector::c_prev_devices = std::vector<SDeviceInfo>();
+std::map<std::string, double> ConfigurableDeviceSelector::c_measured_fps = std::map<std::string, double>();
+double ConfigurableDeviceSelector::c_best_measured_fps = 0.0;
+
+// The measured ranking must stay below the 10000 steps between type preferences
+const int MAX_MEASURED_RANK = 9999;
 
 void ConfigurableDeviceSelector::set_search(std::string type_preference, std::string platform, std::string device_name, std::string driver_version)
 {
@@ -48,6 +53,16 @@ void ConfigurableDeviceSelector::set_search(std::string type_preference, std::st
 	std::cout << "Device search set to type = " << type_preference << " platform = " << c_platform << " device name = " << c_device_name << " driver_version = " << c_driver_version << std::endl;
 }
 
+void ConfigurableDeviceSelector::set_measured_fps(const std::map<std::string, double>& measured_fps)
+{
+	c_measured_fps = measured_fps;
+	c_best_measured_fps = 0.0;
+	for (auto& measured : c_measured_fps)
+	{
+		c_best_measured_fps = std::max(c_best_measured_fps, measured.second);
+	}
+}
+
 // Pass the following function to the sycl::queue to use the criteria that were
 // set by set_search to locate the best device to use.
 int ConfigurableDeviceSelector::device_selector(const sycl::device& device)
@@ -97,8 +112,23 @@ int ConfigurableDeviceSelector::device_selector(const sycl::device& device)
 
 	if (retVal >= 0)
 	{
-		// Select higher compute units over lower ones
-		retVal += device.get_info<sycl::info::device::max_compute_units>();
+		if (c_measured_fps.empty())
+		{
+			// Select higher compute units over lower ones
+			retVal += device.get_info<sycl::info::device::max_compute_units>();
+		}
+		else
+		{
+			// Select the device that remapped the most frames per second (unmeasured devices rank last)
+			auto measured = c_measured_fps.find(get_device_description(device));
+
+			if (measured != c_measured_fps.end() && c_best_measured_fps > 0.0)
+			{
+				// Scale by the fastest device so the whole rank range is used rather than truncating to whole
+				// frames per second (which ties slow devices) or clamping (which ties fast ones)
+				retVal += 1 + (int)(measured->second / c_best_measured_fps * (MAX_MEASURED_RANK - 1) + 0.5);
+			}
+		}
 		// Give preference to newer drivers (this assumes that driver_versions
 		// can be compared with strcmp and newer versions will be >).
 		std::string key = platform_name + device_name;
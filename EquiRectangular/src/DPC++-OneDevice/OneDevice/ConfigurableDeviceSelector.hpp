@@ -38,6 +38,11 @@ private:
 	static std::string c_platform;
 	static std::string c_device_name;
 	static std::string c_driver_version;
+	// c_measured_fps holds the DeviceBenchmark frames per second by device description.  When it is not empty the
+	// devices are ranked by it instead of by max_compute_units.
+	static std::map<std::string, double> c_measured_fps;
+	// c_best_measured_fps is the highest of c_measured_fps, which the ranking is scaled by
+	static double c_best_measured_fps;
 
 public:
 	// type_preference is a list of preferences in priority order.  The type values can be:
@@ -61,6 +66,11 @@ public:
 	//   see https://intel.github.io/llvm-docs/EnvironmentVariables.html
 	static void set_search(std::string type_preference, std::string platform, std::string device_name, std::string driver_version);
 
+	// set_measured_fps switches the ranking among the matching devices from max_compute_units to the measured frames
+	// per second (see DeviceBenchmark).  The type preference and the platform / device / driver filters still apply
+	// first.
+	static void set_measured_fps(const std::map<std::string, double>& measured_fps);
+
 	// Pass the following function to the sycl::queue to use the criteria that were
 	// set by set_search to locate the best device to use.
 	static int device_selector(const sycl::device& device);
@@ -0,0 +1,181 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "DeviceBenchmark.hpp"
+#include "ConfigurableDeviceSelector.hpp"
+#include <chrono>
+#include <iostream>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI (3.14159265358979323846f)
+#endif
+
+double DeviceBenchmark::MeasureFramesPerSecond(const sycl::device& device, int widthOutput, int heightOutput)
+{
+	double retVal = 0.0;
+
+	try {
+		sycl::queue q(device);
+		size_t sourceBytes = (size_t)BENCHMARK_SOURCE_WIDTH * BENCHMARK_SOURCE_HEIGHT * 3;
+		size_t outputBytes = (size_t)widthOutput * heightOutput * 3;
+		unsigned char* pSource = sycl::malloc_device<unsigned char>(sourceBytes, q);
+		unsigned char* pOutput = sycl::malloc_device<unsigned char>(outputBytes, q);
+		const int width = widthOutput;
+		const int height = heightOutput;
+		const int sourceWidth = BENCHMARK_SOURCE_WIDTH;
+		// Same camera set up as the algorithms with a 90 degree field of view
+		const float f = 0.5f * width;
+		const float invf = 1.0f / f;
+		const float translatecx = -(width / 2.0f) * invf;
+		const float translatecy = -(height / 2.0f) * invf;
+		const float imageWidth = BENCHMARK_SOURCE_WIDTH - 1;
+		const float imageHeight = BENCHMARK_SOURCE_HEIGHT - 1;
+		const float xDiv = 2 * M_PI;
+		int frames = 0;
+		std::chrono::high_resolution_clock::time_point startTime;
+		double seconds = 0.0;
+
+		if (pSource == NULL || pOutput == NULL)
+		{
+			throw std::bad_alloc();
+		}
+		q.memset(pSource, 0x80, sourceBytes).wait();
+		// Frame -1 compiles the kernel and is not timed
+		for (int frame = -1; frame < BENCHMARK_MIN_FRAMES || seconds < BENCHMARK_MIN_SECONDS; frame++)
+		{
+			// Turn a little each frame like --deltaYaw so nothing can be reused between frames
+			const float yaw = frame * 5.0f * M_PI / 180.0f;
+			const float m00 = cos(yaw);
+			const float m02 = sin(yaw);
+			const float m20 = -sin(yaw);
+			const float m22 = cos(yaw);
+
+			if (frame == 0)
+			{
+				startTime = std::chrono::high_resolution_clock::now();
+			}
+			q.submit([&](sycl::handler& cgh) {
+				cgh.parallel_for(sycl::range<2>(height, width),
+				[=](sycl::id<2> item) {
+					float eX = item[1] * invf + translatecx;
+					float eY = item[0] * invf + translatecy;
+					float eZ = 1.0f;
+					float x = eX * m00 + eZ * m02;
+					float y = eY;
+					float z = eX * m20 + eZ * m22;
+					float norm = sqrt(x * x + y * y + z * z);
+					int srcX;
+					int srcY;
+					size_t src;
+					size_t dst = ((size_t)item[0] * width + item[1]) * 3;
+
+					x = atan2(x / norm, z / norm);
+					y = asin(y / norm);
+					srcX = (int)((x / xDiv + 0.5f) * imageWidth);
+					srcY = (int)((y / M_PI + 0.5f) * imageHeight);
+					src = ((size_t)srcY * sourceWidth + srcX) * 3;
+					pOutput[dst] = pSource[src];
+					pOutput[dst + 1] = pSource[src + 1];
+					pOutput[dst + 2] = pSource[src + 2];
+				});
+			}).wait();
+			if (frame >= 0)
+			{
+				frames++;
+				seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+			}
+		}
+		sycl::free(pSource, q);
+		sycl::free(pOutput, q);
+		retVal = frames / seconds;
+	}
+	catch (std::exception const& e) {
+		std::cout << "Could not benchmark " << ConfigurableDeviceSelector::get_device_description(device) << ": " << e.what() << std::endl;
+	}
+
+	return retVal;
+}
+
+void DeviceBenchmark::LoadCache(const char* pCachePath, int widthOutput, int heightOutput, std::map<std::string, double>& framesPerSecond)
+{
+	FILE* pFile = fopen(pCachePath, "r");
+	char line[2048];
+
+	if (pFile == NULL)
+	{
+		return;
+	}
+	while (fgets(line, sizeof(line), pFile) != NULL)
+	{
+		int width;
+		int height;
+		double fps;
+		int descriptionStart = 0;
+
+		line[strcspn(line, "\r\n")] = '\0';
+		if (sscanf(line, "%d,%d,%lf,%n", &width, &height, &fps, &descriptionStart) == 3 && descriptionStart > 0 &&
+			width == widthOutput && height == heightOutput)
+		{
+			framesPerSecond.insert_or_assign(std::string(line + descriptionStart), fps);
+		}
+	}
+	fclose(pFile);
+}
+
+void DeviceBenchmark::AppendCache(const char* pCachePath, int widthOutput, int heightOutput, const std::string& description, double framesPerSecond)
+{
+	FILE* pFile = fopen(pCachePath, "a");
+
+	if (pFile == NULL)
+	{
+		printf("Warning: Could not write the device ranking cache %s\n", pCachePath);
+		return;
+	}
+	fprintf(pFile, "%d,%d,%.3f,%s\n", widthOutput, heightOutput, framesPerSecond, description.c_str());
+	fclose(pFile);
+}
+
+void DeviceBenchmark::RankDevices(int widthOutput, int heightOutput, const char* pCachePath)
+{
+	std::map<std::string, double> framesPerSecond;
+
+	LoadCache(pCachePath, widthOutput, heightOutput, framesPerSecond);
+	printf("Ranking devices by measured frames per second at %d x %d\n", widthOutput, heightOutput);
+	for (auto& device : sycl::device::get_devices())
+	{
+		std::string description = ConfigurableDeviceSelector::get_device_description(device);
+		auto cached = framesPerSecond.find(description);
+		double fps;
+
+		if (cached != framesPerSecond.end())
+		{
+			fps = cached->second;
+			printf("  %12.1f FPS (cached)   %s\n", fps, description.c_str());
+		}
+		else
+		{
+			fps = MeasureFramesPerSecond(device, widthOutput, heightOutput);
+			framesPerSecond.insert_or_assign(description, fps);
+			if (fps > 0.0)
+			{
+				AppendCache(pCachePath, widthOutput, heightOutput, description, fps);
+			}
+			printf("  %12.1f FPS (measured) %s\n", fps, description.c_str());
+		}
+	}
+	ConfigurableDeviceSelector::set_measured_fps(framesPerSecond);
+}
@@ -0,0 +1,50 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// DeviceBenchmark measures how fast each device can remap a frame so ConfigurableDeviceSelector can rank devices by
+// measured frames per second instead of max_compute_units.  The microbenchmark is the core of the DPC++ algorithms
+// at the requested output size: per output pixel a rotated camera ray, atan2 / asin to find the source pixel, and a
+// gather of its BGR bytes from a synthetic equirectangular source.  The kernel runs once to compile and is then
+// repeated until at least BENCHMARK_MIN_SECONDS have passed, so fast and slow devices are both timed accurately.
+//
+// Results are cached in a text file, one line per device, driver version, and output size:
+//     widthOutput,heightOutput,framesPerSecond,platform device driver_version
+// so only new devices, drivers, or sizes are measured.  Delete the file to measure everything again.
+
+#include <CL/sycl.hpp>
+#include <map>
+#include <string>
+
+const double BENCHMARK_MIN_SECONDS = 0.2;
+const int BENCHMARK_MIN_FRAMES = 3;
+const int BENCHMARK_SOURCE_WIDTH = 4096;
+const int BENCHMARK_SOURCE_HEIGHT = 2048;
+const char DEFAULT_RANKING_CACHE[] = "DeviceRanking.txt";
+
+class DeviceBenchmark {
+private:
+	// LoadCache adds the cached results for the output size to framesPerSecond (keyed by device description)
+	static void LoadCache(const char* pCachePath, int widthOutput, int heightOutput, std::map<std::string, double>& framesPerSecond);
+	static void AppendCache(const char* pCachePath, int widthOutput, int heightOutput, const std::string& description, double framesPerSecond);
+
+public:
+	// MeasureFramesPerSecond runs the microbenchmark on the device.  Returns 0 if the device cannot run it.
+	static double MeasureFramesPerSecond(const sycl::device& device, int widthOutput, int heightOutput);
+	// RankDevices measures (or loads from the cache) every device and hands the results to
+	// ConfigurableDeviceSelector::set_measured_fps
+	static void RankDevices(int widthOutput, int heightOutput, const char* pCachePath);
+};
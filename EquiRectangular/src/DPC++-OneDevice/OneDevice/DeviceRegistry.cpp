@@ -0,0 +1,182 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "DeviceRegistry.hpp"
+#include "ConfigurableDeviceSelector.hpp"
+#include "PinnedMatAllocator.hpp"
+#include <iostream>
+#include <stdio.h>
+
+std::mutex DeviceRegistry::c_registryMutex;
+std::vector<DeviceRegistry::SDeviceEntry*> DeviceRegistry::c_entries;
+std::map<std::string, sycl::device> DeviceRegistry::c_selections;
+long long DeviceRegistry::c_statSelections = 0;
+long long DeviceRegistry::c_statEnumerations = 0;
+
+void DeviceRegistry::AsyncHandler(sycl::exception_list exceptionList)
+{
+	// Fail more gracefully on asynchronous errors
+	for (std::exception_ptr const& e : exceptionList) {
+		try {
+			std::cout << "Exception caught in ehandler, rethrowing " << std::endl;
+			std::rethrow_exception(e);
+		}
+		catch (cl::sycl::exception const& e) {
+			std::cout << "Caught an asynchronous DPC++ exception, terminating the "
+				"program."
+				<< std::endl;
+			std::terminate();
+		}
+	}
+}
+
+sycl::device DeviceRegistry::SelectDevice(const std::string& typePreference, const std::string& platformName, const std::string& deviceName, const std::string& driverVersion)
+{
+	std::lock_guard<std::mutex> registryLock(c_registryMutex);
+	std::string key = typePreference + "|" + platformName + "|" + deviceName + "|" + driverVersion;
+	auto selection = c_selections.find(key);
+
+	c_statSelections++;
+	if (selection != c_selections.end())
+	{
+		return selection->second;
+	}
+
+	// ConfigurableDeviceSelector keeps the search in static members, so this also has to be under the lock
+	c_statEnumerations++;
+	ConfigurableDeviceSelector::set_search(typePreference, platformName, deviceName, driverVersion);
+	sycl::device device(ConfigurableDeviceSelector::device_selector);
+
+	c_selections.insert_or_assign(key, device);
+
+	return device;
+}
+
+DeviceRegistry::SDeviceEntry* DeviceRegistry::GetEntry(const sycl::device& device)
+{
+	std::lock_guard<std::mutex> registryLock(c_registryMutex);
+
+	for (auto pEntry : c_entries)
+	{
+		if (pEntry->m_device == device)
+		{
+			return pEntry;
+		}
+	}
+
+	SDeviceEntry* pEntry = new SDeviceEntry(device);
+
+	c_entries.push_back(pEntry);
+
+	return pEntry;
+}
+
+sycl::context& DeviceRegistry::GetContext(SDeviceEntry* pEntry)
+{
+	if (pEntry->m_pContext == NULL)
+	{
+		// Use the pinned allocator's context when it covers the device so the queues can see the pinned images
+		pEntry->m_pContext = new sycl::context(PinnedMatAllocator::GetContext(pEntry->m_device));
+	}
+
+	return *pEntry->m_pContext;
+}
+
+void DeviceRegistry::BuildKernels(const sycl::device& device)
+{
+	SDeviceEntry* pEntry = GetEntry(device);
+	std::lock_guard<std::mutex> entryLock(pEntry->m_entryMutex);
+
+	if (pEntry->m_bundles.empty())
+	{
+		pEntry->m_bundles.push_back(sycl::get_kernel_bundle<sycl::bundle_state::executable>(GetContext(pEntry), { device }));
+	}
+}
+
+sycl::queue* DeviceRegistry::AcquireQueue(const sycl::device& device)
+{
+	SDeviceEntry* pEntry = GetEntry(device);
+	std::lock_guard<std::mutex> entryLock(pEntry->m_entryMutex);
+	sycl::queue* pQ;
+
+	pEntry->m_statBorrows++;
+	if (pEntry->m_idleQueues.empty())
+	{
+		pQ = new sycl::queue(GetContext(pEntry), device, AsyncHandler);
+		pEntry->m_statQueuesCreated++;
+	}
+	else
+	{
+		pQ = pEntry->m_idleQueues.back();
+		pEntry->m_idleQueues.pop_back();
+	}
+
+	return pQ;
+}
+
+void DeviceRegistry::ReleaseQueue(sycl::queue* pQ)
+{
+	if (pQ != NULL)
+	{
+		SDeviceEntry* pEntry = GetEntry(pQ->get_device());
+
+		// The next borrower should not wait on (or see errors from) this variant's work
+		pQ->wait();
+		std::lock_guard<std::mutex> entryLock(pEntry->m_entryMutex);
+		pEntry->m_idleQueues.push_back(pQ);
+	}
+}
+
+void DeviceRegistry::Terminate()
+{
+	std::lock_guard<std::mutex> registryLock(c_registryMutex);
+
+	for (auto pEntry : c_entries)
+	{
+		for (auto pQ : pEntry->m_idleQueues)
+		{
+			delete pQ;
+		}
+		pEntry->m_bundles.clear();
+		if (pEntry->m_pContext != NULL)
+		{
+			delete pEntry->m_pContext;
+		}
+		delete pEntry;
+	}
+	c_entries.clear();
+	c_selections.clear();
+}
+
+std::string DeviceRegistry::GetStatsString()
+{
+	std::lock_guard<std::mutex> registryLock(c_registryMutex);
+	std::string retVal;
+	char line[1024];
+
+	sprintf(line, "Device registry, %lld,device selections, %lld,platform enumerations\n", c_statSelections, c_statEnumerations);
+	retVal = line;
+	for (auto pEntry : c_entries)
+	{
+		std::lock_guard<std::mutex> entryLock(pEntry->m_entryMutex);
+
+		sprintf(line, "Device registry, %lld,queue borrows, %lld,queues created, %s\n", pEntry->m_statBorrows, pEntry->m_statQueuesCreated,
+			pEntry->m_bundles.empty() ? "kernels built on first use" : "kernels prebuilt");
+		retVal += line;
+		retVal += "    " + ConfigurableDeviceSelector::get_device_description(pEntry->m_device) + "\n";
+	}
+
+	return retVal;
+}
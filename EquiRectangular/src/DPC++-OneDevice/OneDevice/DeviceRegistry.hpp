@@ -0,0 +1,84 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// DeviceRegistry keeps the DPC++ devices, contexts, compiled kernel bundles, and queues for the whole process so
+// switching variants or algorithms (the 'a' key or a --startAlgorithm range) does not set the device up again.
+// Variants borrow a queue with AcquireQueue and hand it back with ReleaseQueue; the queue goes on the device's idle
+// list for the next variant.  All the queues of a device share one context, and DPC++ caches the kernels it builds
+// per context, so a kernel is JIT compiled once per process instead of once per variant.  The device a search
+// (type preference, platform, device name, driver version) selects is also remembered so the platforms are not
+// enumerated again for the same search.
+//
+// The registry is thread safe.  Each device has its own lock so one device building its kernels (see KernelWarmup)
+// does not hold up the others; a queue requested while its device is still building waits for the build.
+
+#include <CL/sycl.hpp>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class DeviceRegistry {
+private:
+	struct SDeviceEntry {
+		sycl::device	m_device;
+		// m_entryMutex protects the rest of the entry
+		std::mutex		m_entryMutex;
+		// m_pContext is a pointer since a default constructed sycl::context would create a context of its own
+		sycl::context*	m_pContext;
+		std::vector<sycl::kernel_bundle<sycl::bundle_state::executable>>	m_bundles;
+		std::vector<sycl::queue*>	m_idleQueues;
+		long long		m_statQueuesCreated;
+		long long		m_statBorrows;
+
+		SDeviceEntry(const sycl::device& device) : m_device(device)
+		{
+			m_pContext = NULL;
+			m_statQueuesCreated = 0;
+			m_statBorrows = 0;
+		}
+	};
+
+	static std::mutex c_registryMutex;
+	static std::vector<SDeviceEntry*> c_entries;
+	// c_selections maps each search to the device it selected
+	static std::map<std::string, sycl::device> c_selections;
+	static long long c_statSelections;
+	static long long c_statEnumerations;
+
+private:
+	// GetEntry returns the device's entry, adding it if needed
+	static SDeviceEntry* GetEntry(const sycl::device& device);
+	// GetContext returns the device's context, creating it if needed.  Must be called with the entry's lock held.
+	static sycl::context& GetContext(SDeviceEntry* pEntry);
+	static void AsyncHandler(sycl::exception_list exceptionList);
+
+public:
+	// SelectDevice returns the device ConfigurableDeviceSelector picks for the search.  Throws sycl::exception if
+	// no device matches.
+	static sycl::device SelectDevice(const std::string& typePreference, const std::string& platformName, const std::string& deviceName, const std::string& driverVersion);
+	// BuildKernels builds the executable kernel bundle (every kernel in the program) for the device in its context
+	static void BuildKernels(const sycl::device& device);
+	// AcquireQueue returns an idle queue for the device (creating one if none are idle)
+	static sycl::queue* AcquireQueue(const sycl::device& device);
+	// ReleaseQueue waits for the queue's work and puts the queue back on its device's idle list
+	static void ReleaseQueue(sycl::queue* pQ);
+	// Terminate frees every queue, bundle, and context.  All the borrowed queues must have been released.
+	static void Terminate();
+
+	static std::string GetStatsString();
+};
@@ -15,6 +15,9 @@
 
 #include "DpcppBaseAlgorithm.hpp"
 #include "ConfigurableDeviceSelector.hpp"
+#include "DeviceRegistry.hpp"
+#include "KernelWarmup.hpp"
+#include "PinnedMatAllocator.hpp"
 
 DpcppBaseAlgorithm::DpcppBaseAlgorithm(SParameters& parameters) : BaseAlgorithm(parameters)
 {
@@ -27,32 +30,26 @@ DpcppBaseAlgorithm::~DpcppBaseAlgorithm()
     StopVariant();
 }
 
-sycl::queue* DpcppBaseAlgorithm::GetDeviceQ()
+void DpcppBaseAlgorithm::ReleaseDeviceQ()
 {
-    // create an async exception handler so the program fails more gracefully.
-    auto ehandler = [](cl::sycl::exception_list exceptionList) {
-        for (std::exception_ptr const& e : exceptionList) {
-            try {
-                std::cout << "Exception caught in ehandler, rethrowing " << std::endl;
-                std::rethrow_exception(e);
-            }
-            catch (cl::sycl::exception const& e) {
-                std::cout << "Caught an asynchronous DPC++ exception, terminating the "
-                    "program."
-                    << std::endl;
-                std::terminate();
-            }
-        }
-    };
+    if (m_pQ != NULL)
+    {
+        DeviceRegistry::ReleaseQueue(m_pQ);
+        m_pQ = NULL;
+    }
+}
 
+sycl::queue* DpcppBaseAlgorithm::GetDeviceQ()
+{
     try {
-        if (m_pQ != NULL)
-        {
-            delete m_pQ;
-            m_pQ = NULL;
-        }
-        ConfigurableDeviceSelector::set_search(m_typePreference, m_platformName, m_deviceName, m_driverVersion);
-        m_pQ = new sycl::queue(ConfigurableDeviceSelector::device_selector, ehandler);
+        ReleaseDeviceQ();
+        // The registry remembers the device for each search and keeps the queues (and the kernels built in their
+        // context) between variants and algorithms
+        sycl::device device = DeviceRegistry::SelectDevice(m_typePreference, m_platformName, m_deviceName, m_driverVersion);
+
+        // If --warmupKernels is still building the device's kernels, wait for it rather than building them again
+        KernelWarmup::WaitForDevice(device);
+        m_pQ = DeviceRegistry::AcquireQueue(device);
 #define SHOW_RESULTS
 #ifdef SHOW_RESULTS
         if (m_pQ)
@@ -103,21 +100,48 @@ sycl::queue* DpcppBaseAlgorithm::GetNextDeviceQ()
         else
         {
             bDone = true;
-            delete m_pQ;
-            m_pQ = NULL;
+            ReleaseDeviceQ();
         }
     } while (m_pQ == NULL && !bDone);
 
     return m_pQ;
 }
 
-std::string DpcppBaseAlgorithm::GetDeviceDescription()
+std::string DpcppBaseAlgorithm::GetDeviceDescription(bool bPinnedTransfers /* = false */)
 {
     std::string retVal = "";
 
     if (m_pQ != NULL)
     {
         retVal = ConfigurableDeviceSelector::get_device_description(m_pQ->get_device());
+        if (bPinnedTransfers && PinnedMatAllocator::GetPinnedAllocator() != NULL)
+        {
+            retVal += " with pinned host memory";
+        }
+    }
+
+    return retVal;
+}
+
+std::string DpcppBaseAlgorithm::GetDeviceName()
+{
+    std::string retVal = "";
+
+    if (m_pQ != NULL)
+    {
+        retVal = m_pQ->get_device().get_info<sycl::info::device::name>();
+    }
+
+    return retVal;
+}
+
+std::string DpcppBaseAlgorithm::GetDriverVersion()
+{
+    std::string retVal = "";
+
+    if (m_pQ != NULL)
+    {
+        retVal = m_pQ->get_device().get_info<sycl::info::device::driver_version>();
     }
 
     return retVal;
@@ -174,8 +198,7 @@ bool DpcppBaseAlgorithm::StartVariant()
         }
         else
         {
-            delete m_pQ;
-            m_pQ = NULL;
+            ReleaseDeviceQ();
         }
     }
     m_bFrameCalcRequired = true;
@@ -186,8 +209,40 @@ bool DpcppBaseAlgorithm::StartVariant()
 
 void DpcppBaseAlgorithm::StopVariant()
 {
-    delete m_pQ;
-    m_pQ = NULL;
+    ReleaseDeviceQ();
+}
+
+cv::Mat DpcppBaseAlgorithm::AllocateOutputImage()
+{
+    cv::Mat retVal;
+
+    if (m_pQ != NULL)
+    {
+        // Shared USM so the kernels can write the flattened image directly into the caller's buffer
+        void* pOutput = sycl::malloc_shared(m_parameters->m_heightOutput * m_parameters->m_widthOutput * 3 * sizeof(unsigned char), *m_pQ);
+        retVal = cv::Mat(m_parameters->m_heightOutput, m_parameters->m_widthOutput, CV_8UC3, pOutput);
+    }
+    else
+    {
+        retVal = BaseAlgorithm::AllocateOutputImage();
+    }
+
+    return retVal;
+}
+
+void DpcppBaseAlgorithm::FreeOutputImage(cv::Mat& output)
+{
+    if (IsUsmImage(output))
+    {
+        sycl::free(output.data, *m_pQ);
+    }
+    output.release();
+}
+
+bool DpcppBaseAlgorithm::IsUsmImage(const cv::Mat& image)
+{
+    return m_pQ != NULL && !image.empty() && image.isContinuous() &&
+        sycl::get_pointer_type(image.data, m_pQ->get_context()) != sycl::usm::alloc::unknown;
 }
 
 cv::Mat DpcppBaseAlgorithm::GetDebugImage()
@@ -41,6 +41,8 @@ private:
 private:
 	sycl::queue* GetNextDeviceQ();
 	sycl::queue* GetDeviceQ();
+	// ReleaseDeviceQ hands m_pQ back to the DeviceRegistry for the next variant
+	void ReleaseDeviceQ();
 
 protected:
 	sycl::queue* m_pQ;
@@ -49,9 +51,18 @@ protected:
 public:
 	DpcppBaseAlgorithm(SParameters& parameters);
 	virtual ~DpcppBaseAlgorithm();
-	std::string GetDeviceDescription();
+	// GetDeviceDescription describes the device.  bPinnedTransfers is true for variants that upload and read back
+	// through host memory, which then say whether --pinnedMemory page locks it.
+	std::string GetDeviceDescription(bool bPinnedTransfers = false);
+	virtual std::string GetDeviceName();
+	virtual std::string GetDriverVersion();
 
 	virtual cv::Mat GetDebugImage();
+	virtual cv::Mat AllocateOutputImage();
+	virtual void FreeOutputImage(cv::Mat& output);
+	// IsUsmImage returns true if the image memory was allocated as USM on the current queue's context
+	// so kernels can write into it directly
+	bool IsUsmImage(const cv::Mat& image);
 
 	virtual bool StartVariant();
 	virtual void StopVariant();
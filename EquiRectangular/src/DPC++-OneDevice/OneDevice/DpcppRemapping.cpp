@@ -18,6 +18,7 @@
 // to test out parallel computations.
 
 #include "DpcppRemapping.hpp"
+#include "BufferPool.hpp"
 #include "ConfigurableDeviceSelector.hpp"
 #include "TimingStats.hpp"
 #include <opencv2/calib3d.hpp>
@@ -309,9 +310,9 @@ bool DpcppRemapping::StartVariant()
 			auto ctxt = m_pQ->get_context();
 			int size = m_parameters->m_widthOutput * m_parameters->m_heightOutput;
 
-			m_pXYZPoints = (Point3D *)malloc_shared(size * sizeof(Point3D), dev, ctxt);
-			m_pXYPoints = (Point2D *)malloc_shared(size * sizeof(Point2D), dev, ctxt);
-			m_pLonLatPoints = (Point2D *)malloc_shared(size * sizeof(Point2D), dev, ctxt);
+			m_pXYZPoints = (Point3D *)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point3D), BUFFER_USM_SHARED, dev, ctxt);
+			m_pXYPoints = (Point2D *)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D), BUFFER_USM_SHARED, dev, ctxt);
+			m_pLonLatPoints = (Point2D *)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D), BUFFER_USM_SHARED, dev, ctxt);
 
 			printf("DpcppRemapping::StartVariant STORAGE_TYPE_USM\n");
 			break;
@@ -323,13 +324,11 @@ bool DpcppRemapping::StartVariant()
 
 void DpcppRemapping::StopVariant()
 {
-	auto ctxt = m_pQ->get_context();
-
-	free(m_pXYZPoints, ctxt);
+	BufferPool::GetBufferPool()->Release(m_pXYZPoints);
 	m_pXYZPoints = NULL;
-	free(m_pXYPoints, ctxt);
+	BufferPool::GetBufferPool()->Release(m_pXYPoints);
 	m_pXYPoints = NULL;
-	free(m_pLonLatPoints, ctxt);
+	BufferPool::GetBufferPool()->Release(m_pLonLatPoints);
 	m_pLonLatPoints = NULL;
 
 	DpcppBaseAlgorithm::StopVariant();
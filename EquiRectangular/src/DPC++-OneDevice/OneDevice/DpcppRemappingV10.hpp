@@ -40,6 +40,8 @@ public:
 
 	virtual void FrameCalculations(bool bParametersChanged);
 	virtual cv::Mat ExtractFrameImage();
+	// The work groups cover each row in blocks of 16 pixels
+	virtual void GetOutputAlignment(int& widthAlignment, int& heightAlignment);
 
 	virtual std::string GetDescription();
 
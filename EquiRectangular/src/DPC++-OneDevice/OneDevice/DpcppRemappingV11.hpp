@@ -40,6 +40,8 @@ public:
 
 	virtual void FrameCalculations(bool bParametersChanged);
 	virtual cv::Mat ExtractFrameImage();
+	// The work items stride through the image by sub-group, so the pixel count has to fill whole blocks
+	virtual void GetOutputAlignment(int& widthAlignment, int& heightAlignment);
 
 	virtual std::string GetDescription();
 
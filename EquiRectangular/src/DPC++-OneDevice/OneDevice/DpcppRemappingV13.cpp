@@ -16,7 +16,9 @@
 // This code starts from V2 and attempts to see if there are speed ups availabe in the ExtractFrame area
 
 #include "DpcppRemappingV13.hpp"
+#include "BufferPool.hpp"
 #include "ConfigurableDeviceSelector.hpp"
+#include "PinnedMatAllocator.hpp"
 #include "TimingStats.hpp"
 #include <opencv2/calib3d.hpp>
 
@@ -42,7 +44,7 @@ DpcppRemappingV13::DpcppRemappingV13(SParameters& parameters) : DpcppBaseAlgorit
 
 std::string DpcppRemappingV13::GetDescription()
 {
-    std::string strDesc = GetDeviceDescription();
+    std::string strDesc = GetDeviceDescription(m_storageType == STORAGE_TYPE_DEVICE);
 
 	switch (m_storageType)
 	{
@@ -187,20 +189,47 @@ void DpcppRemappingV13::FrameCalculations(bool bParametersChanged)
 
 cv::Mat DpcppRemappingV13::ExtractFrameImage()
 {
-	std::chrono::high_resolution_clock::time_point startTime	= std::chrono::high_resolution_clock::now();
 	cv::Mat retVal;
 
 	switch (m_storageType)
 	{
 	case STORAGE_TYPE_USM:
+		// Render straight into the USM flat image and hand it back without a copy
+		retVal = cv::Mat(m_parameters->m_heightOutput, m_parameters->m_widthOutput, CV_8UC3, m_pFlatImage);
+		break;
+	case STORAGE_TYPE_DEVICE:
+		// With --pinnedMemory the frame is read back into page locked memory
+		retVal.allocator = PinnedMatAllocator::GetPinnedAllocator();
+		retVal.create(m_parameters->m_heightOutput, m_parameters->m_widthOutput, CV_8UC3);
+		break;
+	}
+	ExtractFrameImage(retVal);
+
+	return retVal;
+}
+
+void DpcppRemappingV13::ExtractFrameImage(cv::Mat& output)
+{
+	std::chrono::high_resolution_clock::time_point startTime	= std::chrono::high_resolution_clock::now();
+	int height = m_parameters->m_heightOutput;
+	int width = m_parameters->m_widthOutput;
+	int imageHeight = m_parameters->m_image[m_parameters->m_imageIndex].rows;
+	int imageWidth = m_parameters->m_image[m_parameters->m_imageIndex].cols;
+	Point2D *pPoints = NULL;
+	unsigned char *pFullImage = NULL;
+	unsigned char *pStagingFlatImage = NULL;
+	size_t imageBytes = imageHeight * imageWidth * sizeof(unsigned char) * pixelBytes;
+	size_t outputBytes = height * width * sizeof(unsigned char) * pixelBytes;
+
+	if (output.rows != height || output.cols != width || output.type() != CV_8UC3)
 	{
-		int height = m_parameters->m_heightOutput;
-		int width = m_parameters->m_widthOutput;
-		int imageHeight = m_parameters->m_image[m_parameters->m_imageIndex].rows;
-		int imageWidth = m_parameters->m_image[m_parameters->m_imageIndex].cols;
-		Point2D *pPoints = m_pXYPoints;
-		unsigned char *pFlatImage = m_pFlatImage;
+		output.create(height, width, CV_8UC3);
+	}
 
+	switch (m_storageType)
+	{
+	case STORAGE_TYPE_USM:
+	{
 		if (m_currentIndex != m_parameters->m_imageIndex)
 		{
 #ifdef VTUNE_API
@@ -208,57 +237,21 @@ cv::Mat DpcppRemappingV13::ExtractFrameImage()
 #endif
 			// TODO: This assumes that both images are the exact same size.  Perhaps should put an
 			// ASSERT here to check that assumption
-			memcpy(m_pFullImage, m_parameters->m_image[m_parameters->m_imageIndex].data, imageHeight * imageWidth * sizeof(unsigned char) * pixelBytes);
+			std::chrono::high_resolution_clock::time_point uploadStartTime = std::chrono::high_resolution_clock::now();
+			memcpy(m_pFullImage, m_parameters->m_image[m_parameters->m_imageIndex].data, imageBytes);
+			TimingStats::GetTimingStats()->AddTransferResults(ETimingType::TIMING_UPLOAD, uploadStartTime, std::chrono::high_resolution_clock::now(), imageBytes);
 			m_currentIndex = m_parameters->m_imageIndex;
 #ifdef VTUNE_API
 			__itt_task_end(pittTests_domain);
 #endif
 		}
-
-		unsigned char *pFullImage = m_pFullImage;
-
-#ifdef VTUNE_API
-		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV13_extract_kernel);
-#endif
-		m_pQ->submit([&](sycl::handler &cgh) {
-			cgh.parallel_for(sycl::range<2>(height, width),
-			[=](sycl::id<2> item) {
-				int offset = item[0] * width + item[1];
-				Point2D *pElement = &pPoints[offset];
-				unsigned char *pFlatPixel = &pFlatImage[offset * pixelBytes];
-				// determine the nearest top left pixel 
-				int top_left_x = static_cast<int>(pElement->m_x); // convert the subpixel value to an integer pixel value (top left pixel due to int() operator)
-				int top_left_y = static_cast<int>(pElement->m_y);
-				// Starting bytes for the four points to use for the calculation of the color for the flat image pixel.
-				unsigned char *tl = pFullImage + (top_left_y * imageWidth + top_left_x) * pixelBytes;
-
-				// There is an assumption here that the image has 3 consecutive bytes for
-				// blue, green, and red (i.e., no alpha channel)
-				for (int i = 0; i < pixelBytes; i++)
-				{
-					pFlatPixel[i] = tl[i];
-				}
-			});
-		}).wait();
-
-		retVal = cv::Mat(m_parameters->m_heightOutput, m_parameters->m_widthOutput, CV_8UC3, m_pFlatImage);
-		TimingStats::GetTimingStats()->AddIterationResults(ETimingType::TIMING_REMAP, startTime, std::chrono::high_resolution_clock::now());
-#ifdef VTUNE_API
-		__itt_task_end(pittTests_domain);
-#endif
-
+		pPoints = m_pXYPoints;
+		pFullImage = m_pFullImage;
+		pStagingFlatImage = m_pFlatImage;
 		break;
 	}
 	case STORAGE_TYPE_DEVICE:
 	{
-		int height = m_parameters->m_heightOutput;
-		int width = m_parameters->m_widthOutput;
-		int imageHeight = m_parameters->m_image[m_parameters->m_imageIndex].rows;
-		int imageWidth = m_parameters->m_image[m_parameters->m_imageIndex].cols;
-		unsigned char *pFlatImage = m_pDevFlatImage;
-		unsigned char *pDevFullImage = m_pDevFullImage;
-		Point2D *pDevXYPoints = m_pDevXYPoints;
-
 		if (m_currentIndex != m_parameters->m_imageIndex)
 		{
 #ifdef VTUNE_API
@@ -266,49 +259,66 @@ cv::Mat DpcppRemappingV13::ExtractFrameImage()
 #endif
 			// TODO: This assumes that both images are the exact same size.  Perhaps should put an
 			// ASSERT here to check that assumption
-			m_pQ->memcpy(m_pDevFullImage, m_parameters->m_image[m_parameters->m_imageIndex].data, imageHeight * imageWidth * sizeof(unsigned char) * pixelBytes);
+			std::chrono::high_resolution_clock::time_point uploadStartTime = std::chrono::high_resolution_clock::now();
+			m_pQ->memcpy(m_pDevFullImage, m_parameters->m_image[m_parameters->m_imageIndex].data, imageBytes);
 			m_pQ->wait();
+			TimingStats::GetTimingStats()->AddTransferResults(ETimingType::TIMING_UPLOAD, uploadStartTime, std::chrono::high_resolution_clock::now(), imageBytes);
 			m_currentIndex = m_parameters->m_imageIndex;
 #ifdef VTUNE_API
 			__itt_task_end(pittTests_domain);
 #endif
 		}
+		pPoints = m_pDevXYPoints;
+		pFullImage = m_pDevFullImage;
+		pStagingFlatImage = m_pDevFlatImage;
+		break;
+	}
+	}
+
+	// If the caller's buffer is shared USM the kernel writes the pixels straight into it, otherwise the kernel
+	// writes into this variant's flat image and the result is copied out afterwards.  Pinned (host USM) output
+	// is copied as well so the readback runs as one DMA transfer rather than as scattered kernel writes.
+	bool bDirectOutput = IsUsmImage(output) && sycl::get_pointer_type(output.data, m_pQ->get_context()) == sycl::usm::alloc::shared;
+	unsigned char *pFlatImage = bDirectOutput ? output.data : pStagingFlatImage;
 
 #ifdef VTUNE_API
-		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV13_extract_kernel);
+	__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV13_extract_kernel);
 #endif
-		m_pQ->submit([&](sycl::handler &cgh) {
-			cgh.parallel_for(sycl::range<2>(height, width),
-			[=](sycl::id<2> item) {
-				int offset = item[0] * width + item[1];
-				Point2D *pElement = &pDevXYPoints[offset];
-				unsigned char *pFlatPixel = &pFlatImage[offset * pixelBytes];
-				// determine the nearest top left pixel for bilinear interpolation
-				int top_left_x = static_cast<int>(pElement->m_x); // convert the subpixel value to an integer pixel value (top left pixel due to int() operator)
-				int top_left_y = static_cast<int>(pElement->m_y);
-				// Starting bytes for the four points to use for the calculation of the color for the flat image pixel.
-				unsigned char *tl = pDevFullImage + (top_left_y * imageWidth + top_left_x) * pixelBytes;
-
-				// There is an assumption here that the image has 3 consecutive bytes for
-				// blue, green, and red (i.e., no alpha channel)
-				for (int i = 0; i < pixelBytes; i++)
-				{
-					pFlatPixel[i] = tl[i];
-				}
-			});
-		}).wait();
-		retVal = cv::Mat(m_parameters->m_heightOutput, m_parameters->m_widthOutput, CV_8UC3);
-		m_pQ->memcpy(retVal.data, m_pDevFlatImage, m_parameters->m_heightOutput * m_parameters->m_widthOutput * sizeof(unsigned char) * pixelBytes);
+	m_pQ->submit([&](sycl::handler &cgh) {
+		cgh.parallel_for(sycl::range<2>(height, width),
+		[=](sycl::id<2> item) {
+			int offset = item[0] * width + item[1];
+			Point2D *pElement = &pPoints[offset];
+			unsigned char *pFlatPixel = &pFlatImage[offset * pixelBytes];
+			// determine the nearest top left pixel 
+			int top_left_x = static_cast<int>(pElement->m_x); // convert the subpixel value to an integer pixel value (top left pixel due to int() operator)
+			int top_left_y = static_cast<int>(pElement->m_y);
+			// Starting bytes for the four points to use for the calculation of the color for the flat image pixel.
+			unsigned char *tl = pFullImage + (top_left_y * imageWidth + top_left_x) * pixelBytes;
+
+			// There is an assumption here that the image has 3 consecutive bytes for
+			// blue, green, and red (i.e., no alpha channel)
+			for (int i = 0; i < pixelBytes; i++)
+			{
+				pFlatPixel[i] = tl[i];
+			}
+		});
+	}).wait();
+
+	if (!bDirectOutput)
+	{
+		std::chrono::high_resolution_clock::time_point copyStartTime = std::chrono::high_resolution_clock::now();
+
+		m_pQ->memcpy(output.data, pStagingFlatImage, outputBytes);
 		m_pQ->wait();
-		TimingStats::GetTimingStats()->AddIterationResults(ETimingType::TIMING_REMAP, startTime, std::chrono::high_resolution_clock::now());
+		// Copying out of device memory is the readback; copying out of the shared flat image is only a host copy
+		TimingStats::GetTimingStats()->AddTransferResults((m_storageType == STORAGE_TYPE_DEVICE) ? ETimingType::TIMING_READBACK : ETimingType::TIMING_OUTPUT_COPY,
+			copyStartTime, std::chrono::high_resolution_clock::now(), outputBytes);
+	}
+	TimingStats::GetTimingStats()->AddIterationResults(ETimingType::TIMING_REMAP, startTime, std::chrono::high_resolution_clock::now());
 #ifdef VTUNE_API
-		__itt_task_end(pittTests_domain);
+	__itt_task_end(pittTests_domain);
 #endif
-		break;
-	}
-	}
-
-	return retVal;
 }
 
 // Pass in theta, phi, and psi in radians, not degrees
@@ -358,17 +368,17 @@ bool DpcppRemappingV13::StartVariant()
 		{
 		case STORAGE_TYPE_USM:
 		{
-			m_pXYPoints = (Point2D*)malloc_shared(size * sizeof(Point2D), dev, ctxt);
-			m_pFlatImage = (unsigned char *)malloc_shared(size * pixelBytes * sizeof(unsigned char), dev, ctxt);
-			m_pFullImage = (unsigned char *)malloc_shared(m_parameters->m_image[m_parameters->m_imageIndex].cols * m_parameters->m_image[m_parameters->m_imageIndex].rows * pixelBytes * sizeof(unsigned char), dev, ctxt);
+			m_pXYPoints = (Point2D*)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D), BUFFER_USM_SHARED, dev, ctxt);
+			m_pFlatImage = (unsigned char *)BufferPool::GetBufferPool()->Acquire(size * pixelBytes * sizeof(unsigned char), BUFFER_USM_SHARED, dev, ctxt);
+			m_pFullImage = (unsigned char *)BufferPool::GetBufferPool()->Acquire(m_parameters->m_image[m_parameters->m_imageIndex].cols * m_parameters->m_image[m_parameters->m_imageIndex].rows * pixelBytes * sizeof(unsigned char), BUFFER_USM_SHARED, dev, ctxt);
 
 			printf("DpcppRemappingV13::StartVariant STORAGE_TYPE_USM\n");
 			break;
 		}
 		case STORAGE_TYPE_DEVICE:
-			m_pDevXYPoints = (Point2D*)malloc_device(size * sizeof(Point2D), dev, ctxt);
-			m_pDevFlatImage = (unsigned char *)malloc_device(size * pixelBytes * sizeof(unsigned char), dev, ctxt);
-			m_pDevFullImage = (unsigned char *)malloc_device(m_parameters->m_image[m_parameters->m_imageIndex].cols * m_parameters->m_image[m_parameters->m_imageIndex].rows * pixelBytes * sizeof(unsigned char), dev, ctxt);
+			m_pDevXYPoints = (Point2D*)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D), BUFFER_USM_DEVICE, dev, ctxt);
+			m_pDevFlatImage = (unsigned char *)BufferPool::GetBufferPool()->Acquire(size * pixelBytes * sizeof(unsigned char), BUFFER_USM_DEVICE, dev, ctxt);
+			m_pDevFullImage = (unsigned char *)BufferPool::GetBufferPool()->Acquire(m_parameters->m_image[m_parameters->m_imageIndex].cols * m_parameters->m_image[m_parameters->m_imageIndex].rows * pixelBytes * sizeof(unsigned char), BUFFER_USM_DEVICE, dev, ctxt);
 
 			printf("DpcppRemappingV13::StartVariant STORAGE_TYPE_DEVICE\n");
 			break;
@@ -386,23 +396,21 @@ void DpcppRemappingV13::StopVariant()
 	{
 	case STORAGE_TYPE_USM:
 	{
-		auto ctxt = m_pQ->get_context();
-
-		free(m_pXYPoints, ctxt);
+		BufferPool::GetBufferPool()->Release(m_pXYPoints);
 		m_pXYPoints = NULL;
-		free(m_pFlatImage, ctxt);
+		BufferPool::GetBufferPool()->Release(m_pFlatImage);
 		m_pFlatImage = NULL;
-		free(m_pFullImage, ctxt);
+		BufferPool::GetBufferPool()->Release(m_pFullImage);
 		m_pFullImage = NULL;
 
 		break;
 	}
 	case STORAGE_TYPE_DEVICE:
-		free(m_pDevXYPoints, m_pQ->get_context());
+		BufferPool::GetBufferPool()->Release(m_pDevXYPoints);
 		m_pDevXYPoints = NULL;
-		free(m_pDevFlatImage, m_pQ->get_context());
+		BufferPool::GetBufferPool()->Release(m_pDevFlatImage);
 		m_pDevFlatImage = NULL;
-		free(m_pDevFullImage, m_pQ->get_context());
+		BufferPool::GetBufferPool()->Release(m_pDevFullImage);
 		m_pDevFullImage = NULL;
 		break;
 	}
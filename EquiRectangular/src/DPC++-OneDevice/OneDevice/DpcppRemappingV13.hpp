@@ -51,6 +51,7 @@ public:
 
 	virtual void FrameCalculations(bool bParametersChanged);
 	virtual cv::Mat ExtractFrameImage();
+	virtual void ExtractFrameImage(cv::Mat& output);
 
 	virtual std::string GetDescription();
 
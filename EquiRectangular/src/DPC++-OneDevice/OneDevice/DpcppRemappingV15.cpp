@@ -16,7 +16,9 @@
 // This code starts from V2 and attempts to see if there are speed ups available in the ExtractFrame area
 
 #include "DpcppRemappingV15.hpp"
+#include "BufferPool.hpp"
 #include "ConfigurableDeviceSelector.hpp"
+#include "PinnedMatAllocator.hpp"
 #include "TimingStats.hpp"
 #include <opencv2/calib3d.hpp>
 
@@ -42,7 +44,7 @@ DpcppRemappingV15::DpcppRemappingV15(SParameters& parameters) : DpcppBaseAlgorit
 
 std::string DpcppRemappingV15::GetDescription()
 {
-    std::string strDesc = GetDeviceDescription();
+    std::string strDesc = GetDeviceDescription(m_storageType == STORAGE_TYPE_DEVICE);
 
 	switch (m_storageType)
 	{
@@ -276,8 +278,12 @@ cv::Mat DpcppRemappingV15::ExtractFrameImage()
 
 			// TODO: This assumes that both images are the exact same size.  Perhaps should put an
 			// ASSERT here to check that assumption
-			m_pQ->memcpy(m_pDevFullImage, m_parameters->m_image[m_parameters->m_imageIndex].data, imageHeight * imageWidth * sizeof(unsigned char) * pixelBytes);
+			size_t imageBytes = imageHeight * imageWidth * sizeof(unsigned char) * pixelBytes;
+			std::chrono::high_resolution_clock::time_point uploadStartTime = std::chrono::high_resolution_clock::now();
+
+			m_pQ->memcpy(m_pDevFullImage, m_parameters->m_image[m_parameters->m_imageIndex].data, imageBytes);
 			m_pQ->wait();
+			TimingStats::GetTimingStats()->AddTransferResults(ETimingType::TIMING_UPLOAD, uploadStartTime, std::chrono::high_resolution_clock::now(), imageBytes);
 			m_currentIndex = m_parameters->m_imageIndex;
 #ifdef VTUNE_API
 			__itt_task_end(pittTests_domain);
@@ -309,9 +315,16 @@ cv::Mat DpcppRemappingV15::ExtractFrameImage()
 				}
 			});
 		}).wait();
-		retVal = cv::Mat(m_parameters->m_heightOutput, m_parameters->m_widthOutput, CV_8UC3);
-		m_pQ->memcpy(retVal.data, m_pDevFlatImage, m_parameters->m_heightOutput * m_parameters->m_widthOutput * sizeof(unsigned char) * pixelBytes);
+		// With --pinnedMemory the frame is read back into page locked memory
+		retVal.allocator = PinnedMatAllocator::GetPinnedAllocator();
+		retVal.create(m_parameters->m_heightOutput, m_parameters->m_widthOutput, CV_8UC3);
+
+		size_t outputBytes = m_parameters->m_heightOutput * m_parameters->m_widthOutput * sizeof(unsigned char) * pixelBytes;
+		std::chrono::high_resolution_clock::time_point readbackStartTime = std::chrono::high_resolution_clock::now();
+
+		m_pQ->memcpy(retVal.data, m_pDevFlatImage, outputBytes);
 		m_pQ->wait();
+		TimingStats::GetTimingStats()->AddTransferResults(ETimingType::TIMING_READBACK, readbackStartTime, std::chrono::high_resolution_clock::now(), outputBytes);
 		TimingStats::GetTimingStats()->AddIterationResults(ETimingType::TIMING_REMAP, startTime, std::chrono::high_resolution_clock::now());
 #ifdef VTUNE_API
 		__itt_task_end(pittTests_domain);
@@ -370,18 +383,18 @@ bool DpcppRemappingV15::StartVariant()
 		{
 		case STORAGE_TYPE_USM:
 		{
-			m_pXYPoints = (Point2D*)malloc_shared(size * sizeof(Point2D), dev, ctxt);
-			m_pFlatImage = (unsigned char *)malloc_shared(size * pixelBytes * sizeof(unsigned char), dev, ctxt);
-			m_pFullImage = (unsigned char *)malloc_shared(m_parameters->m_image[m_parameters->m_imageIndex].cols * m_parameters->m_image[m_parameters->m_imageIndex].rows * pixelBytes * sizeof(unsigned char), dev, ctxt);
+			m_pXYPoints = (Point2D*)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D), BUFFER_USM_SHARED, dev, ctxt);
+			m_pFlatImage = (unsigned char *)BufferPool::GetBufferPool()->Acquire(size * pixelBytes * sizeof(unsigned char), BUFFER_USM_SHARED, dev, ctxt);
+			m_pFullImage = (unsigned char *)BufferPool::GetBufferPool()->Acquire(m_parameters->m_image[m_parameters->m_imageIndex].cols * m_parameters->m_image[m_parameters->m_imageIndex].rows * pixelBytes * sizeof(unsigned char), BUFFER_USM_SHARED, dev, ctxt);
 
 			printf("DpcppRemappingV15::StartVariant STORAGE_TYPE_USM\n");
 
 			break;
 		}
 		case STORAGE_TYPE_DEVICE:
-			m_pDevXYPoints = (Point2D*)malloc_device(size * sizeof(Point2D), dev, ctxt);
-			m_pDevFlatImage = (unsigned char *)malloc_device(size * pixelBytes * sizeof(unsigned char), dev, ctxt);
-			m_pDevFullImage = (unsigned char *)malloc_device(m_parameters->m_image[m_parameters->m_imageIndex].cols * m_parameters->m_image[m_parameters->m_imageIndex].rows * pixelBytes * sizeof(unsigned char), dev, ctxt);
+			m_pDevXYPoints = (Point2D*)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D), BUFFER_USM_DEVICE, dev, ctxt);
+			m_pDevFlatImage = (unsigned char *)BufferPool::GetBufferPool()->Acquire(size * pixelBytes * sizeof(unsigned char), BUFFER_USM_DEVICE, dev, ctxt);
+			m_pDevFullImage = (unsigned char *)BufferPool::GetBufferPool()->Acquire(m_parameters->m_image[m_parameters->m_imageIndex].cols * m_parameters->m_image[m_parameters->m_imageIndex].rows * pixelBytes * sizeof(unsigned char), BUFFER_USM_DEVICE, dev, ctxt);
 
 			printf("DpcppRemappingV15::StartVariant STORAGE_TYPE_DEVICE\n");
 
@@ -400,23 +413,21 @@ void DpcppRemappingV15::StopVariant()
 	{
 	case STORAGE_TYPE_USM:
 	{
-		auto ctxt = m_pQ->get_context();
-
-		free(m_pXYPoints, ctxt);
+		BufferPool::GetBufferPool()->Release(m_pXYPoints);
 		m_pXYPoints = NULL;
-		free(m_pFlatImage, ctxt);
+		BufferPool::GetBufferPool()->Release(m_pFlatImage);
 		m_pFlatImage = NULL;
-		free(m_pFullImage, ctxt);
+		BufferPool::GetBufferPool()->Release(m_pFullImage);
 		m_pFullImage = NULL;
 
 		break;
 	}
 	case STORAGE_TYPE_DEVICE:
-		free(m_pDevXYPoints, m_pQ->get_context());
+		BufferPool::GetBufferPool()->Release(m_pDevXYPoints);
 		m_pDevXYPoints = NULL;
-		free(m_pDevFlatImage, m_pQ->get_context());
+		BufferPool::GetBufferPool()->Release(m_pDevFlatImage);
 		m_pDevFlatImage = NULL;
-		free(m_pDevFullImage, m_pQ->get_context());
+		BufferPool::GetBufferPool()->Release(m_pDevFullImage);
 		m_pDevFullImage = NULL;
 		break;
 	}
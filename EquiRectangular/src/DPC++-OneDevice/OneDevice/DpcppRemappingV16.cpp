@@ -0,0 +1,350 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+// This code starts from V13 (device memory) and pipelines the frames across multiple sets of device buffers
+
+#include "DpcppRemappingV16.hpp"
+#include "BufferPool.hpp"
+#include "ConfigurableDeviceSelector.hpp"
+#include "TimingStats.hpp"
+#include <opencv2/calib3d.hpp>
+
+#ifdef VTUNE_API
+#include "ittnotify.h"
+#pragma comment(lib, "libittnotify.lib")
+extern __itt_domain* pittTests_domain;
+// Create string handle for denoting when the kernel is running
+wchar_t const* pDpcppRemappingV16Submit = _T("DpcppRemappingV16 Submit Frame");
+__itt_string_handle* handle_DpcppRemappingV16_submit_frame = __itt_string_handle_create(pDpcppRemappingV16Submit);
+wchar_t const* pDpcppRemappingV16Wait = _T("DpcppRemappingV16 Wait Frame");
+__itt_string_handle* handle_DpcppRemappingV16_wait_frame = __itt_string_handle_create(pDpcppRemappingV16Wait);
+#endif
+
+const int pixelBytes = 3;
+
+DpcppRemappingV16::DpcppRemappingV16(SParameters& parameters) : DpcppBaseAlgorithm(parameters)
+{
+	m_slotCount = FRAME_SLOTS_INIT;
+	m_mapGeneration = 0;
+	m_imageGeneration = 0;
+}
+
+std::string DpcppRemappingV16::GetDescription()
+{
+	std::string strDesc = GetDeviceDescription();
+
+	switch (m_slotCount)
+	{
+	case 1:
+		return "DpcppRemappingV16: V13 device memory with 1 frame slot (serialized) " + strDesc;
+		break;
+	case 2:
+		return "DpcppRemappingV16: V13 device memory with 2 frame slots overlapping upload, compute and readback " + strDesc;
+		break;
+	case 3:
+		return "DpcppRemappingV16: V13 device memory with 3 frame slots overlapping upload, compute and readback " + strDesc;
+		break;
+	}
+
+	return "Unknown";
+}
+
+void DpcppRemappingV16::FrameCalculations(bool bParametersChanged)
+{
+	if (bParametersChanged || m_bFrameCalcRequired)
+	{
+		BaseAlgorithm::FrameCalculations(bParametersChanged);
+
+		ComputeRotationMatrix((float)m_parameters->m_yaw * DEGREE_CONVERSION_FACTOR, (float)m_parameters->m_pitch * DEGREE_CONVERSION_FACTOR, (float)m_parameters->m_roll * DEGREE_CONVERSION_FACTOR);
+
+		float f;
+		float cx;
+		float cy;
+
+		f = 0.5 * m_parameters->m_widthOutput * 1 / tan(0.5 * m_parameters->m_fov / 180.0 * M_PI);
+		cx = ((float)m_parameters->m_widthOutput - 1.0f) / 2.0f;
+		cy = ((float)m_parameters->m_heightOutput - 1.0f) / 2.0f;
+
+		// Only the host side values are computed here.  The map kernel itself is submitted into a frame slot
+		// by ExtractFrameImage so it can run after the previous frame in that slot has finished with the map.
+		m_mapParams.m_invf = 1.0f / f;
+		m_mapParams.m_translatecx = -cx * m_mapParams.m_invf;
+		m_mapParams.m_translatecy = -cy * m_mapParams.m_invf;
+		m_mapParams.m_m00 = m_rotationMatrix.at<float>(0, 0);
+		m_mapParams.m_m01 = m_rotationMatrix.at<float>(0, 1);
+		m_mapParams.m_m02 = m_rotationMatrix.at<float>(0, 2);
+		m_mapParams.m_m10 = m_rotationMatrix.at<float>(1, 0);
+		m_mapParams.m_m11 = m_rotationMatrix.at<float>(1, 1);
+		m_mapParams.m_m12 = m_rotationMatrix.at<float>(1, 2);
+		m_mapParams.m_m20 = m_rotationMatrix.at<float>(2, 0);
+		m_mapParams.m_m21 = m_rotationMatrix.at<float>(2, 1);
+		m_mapParams.m_m22 = m_rotationMatrix.at<float>(2, 2);
+		m_mapParams.m_imageWidth = m_parameters->m_image[m_parameters->m_imageIndex].cols - 1;
+		m_mapParams.m_imageHeight = m_parameters->m_image[m_parameters->m_imageIndex].rows - 1;
+		m_mapGeneration++;
+
+		m_bFrameCalcRequired = false;
+	}
+}
+
+// SubmitFrame queues the upload (if the image changed), map kernel (if the parameters changed), extract kernel,
+// and readback for the current frame into the slot without waiting on any of them.
+void DpcppRemappingV16::SubmitFrame(SFrameSlot& slot)
+{
+	int height = m_parameters->m_heightOutput;
+	int width = m_parameters->m_widthOutput;
+	int imageHeight = m_parameters->m_image[m_parameters->m_imageIndex].rows;
+	int imageWidth = m_parameters->m_image[m_parameters->m_imageIndex].cols;
+	unsigned char* pDevFullImage = slot.m_pDevFullImage;
+	unsigned char* pDevFlatImage = slot.m_pDevFlatImage;
+	Point2D* pDevXYPoints = slot.m_pDevXYPoints;
+	std::vector<sycl::event> extractDeps;
+
+	slot.m_submitTime = std::chrono::high_resolution_clock::now();
+	if (slot.m_imageGeneration != m_imageGeneration)
+	{
+		// TODO: This assumes that both images are the exact same size.  Perhaps should put an
+		// ASSERT here to check that assumption
+		size_t imageBytes = imageHeight * imageWidth * sizeof(unsigned char) * pixelBytes;
+
+		memcpy(slot.m_pHostFullImage, m_parameters->m_image[m_parameters->m_imageIndex].data, imageBytes);
+		extractDeps.push_back(m_pQ->memcpy(slot.m_pDevFullImage, slot.m_pHostFullImage, imageBytes));
+		slot.m_imageGeneration = m_imageGeneration;
+	}
+	if (slot.m_mapGeneration != m_mapGeneration)
+	{
+		SMapParams mp = m_mapParams;
+		float xDiv = 2 * M_PI;
+
+		extractDeps.push_back(m_pQ->submit([&](sycl::handler& cgh) {
+			cgh.parallel_for(sycl::range<2>(height, width),
+			[=](sycl::id<2> item) {
+				Point2D* pElement = &pDevXYPoints[item[0] * width + item[1]];
+				float x = item[1] * mp.m_invf + mp.m_translatecx;
+				float y = item[0] * mp.m_invf + mp.m_translatecy;
+				float z = 1.0f;
+				float norm;
+
+				// Calculate xyz * R, save the initial x, y, and z values for the computation
+				float eX = x;
+				float eY = y;
+				float eZ = z;
+
+				x = eX * mp.m_m00 + eY * mp.m_m01 + eZ * mp.m_m02;
+				y = eX * mp.m_m10 + eY * mp.m_m11 + eZ * mp.m_m12;
+				z = eX * mp.m_m20 + eY * mp.m_m21 + eZ * mp.m_m22;
+
+				norm = sqrt(x * x + y * y + z * z);
+
+				x = atan2(x / norm, z / norm);
+				y = asin(y / norm);
+
+				pElement->m_x = (x / xDiv + 0.5f) * mp.m_imageWidth;
+				pElement->m_y = (y / M_PI + 0.5f) * mp.m_imageHeight;
+			});
+		}));
+		slot.m_mapGeneration = m_mapGeneration;
+	}
+
+	sycl::event extractEvent = m_pQ->submit([&](sycl::handler& cgh) {
+		cgh.depends_on(extractDeps);
+		cgh.parallel_for(sycl::range<2>(height, width),
+		[=](sycl::id<2> item) {
+			int offset = item[0] * width + item[1];
+			Point2D* pElement = &pDevXYPoints[offset];
+			unsigned char* pFlatPixel = &pDevFlatImage[offset * pixelBytes];
+			int top_left_x = static_cast<int>(pElement->m_x); // convert the subpixel value to an integer pixel value (top left pixel due to int() operator)
+			int top_left_y = static_cast<int>(pElement->m_y);
+			unsigned char* tl = pDevFullImage + (top_left_y * imageWidth + top_left_x) * pixelBytes;
+
+			// There is an assumption here that the image has 3 consecutive bytes for
+			// blue, green, and red (i.e., no alpha channel)
+			for (int i = 0; i < pixelBytes; i++)
+			{
+				pFlatPixel[i] = tl[i];
+			}
+		});
+	});
+
+	slot.m_readbackEvent = m_pQ->submit([&](sycl::handler& cgh) {
+		cgh.depends_on(extractEvent);
+		cgh.memcpy(slot.m_pHostFlatImage, pDevFlatImage, height * width * sizeof(unsigned char) * pixelBytes);
+	});
+	slot.m_bInFlight = true;
+}
+
+void DpcppRemappingV16::WaitForSlot(SFrameSlot& slot)
+{
+	if (slot.m_bInFlight)
+	{
+		slot.m_readbackEvent.wait();
+		slot.m_bInFlight = false;
+		TimingStats::GetTimingStats()->AddIterationResults(ETimingType::TIMING_FRAME_LATENCY, slot.m_submitTime, std::chrono::high_resolution_clock::now());
+	}
+}
+
+cv::Mat DpcppRemappingV16::ExtractFrameImage()
+{
+	std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+	cv::Mat retVal;
+
+	if (m_currentIndex != m_parameters->m_imageIndex)
+	{
+		m_currentIndex = m_parameters->m_imageIndex;
+		m_imageGeneration++;
+	}
+
+#ifdef VTUNE_API
+	__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV16_submit_frame);
+#endif
+	// The slot being reused held frame N - m_slotCount which was handed back on the previous call, so it has
+	// already finished.  The wait is a no-op in the steady state.
+	SFrameSlot& submitSlot = m_slots[m_nextSlot];
+	WaitForSlot(submitSlot);
+	SubmitFrame(submitSlot);
+	m_framesSubmitted++;
+	m_nextSlot = (m_nextSlot + 1) % m_slotCount;
+#ifdef VTUNE_API
+	__itt_task_end(pittTests_domain);
+#endif
+
+	// Hand back the oldest frame still in the pipeline.  Until the pipeline fills, keep returning frame 0.
+	long long returnFrame = m_framesSubmitted - m_slotCount;
+	if (returnFrame < 0)
+	{
+		returnFrame = 0;
+	}
+	SFrameSlot& returnSlot = m_slots[returnFrame % m_slotCount];
+
+#ifdef VTUNE_API
+	__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV16_wait_frame);
+#endif
+	WaitForSlot(returnSlot);
+#ifdef VTUNE_API
+	__itt_task_end(pittTests_domain);
+#endif
+	retVal = cv::Mat(m_parameters->m_heightOutput, m_parameters->m_widthOutput, CV_8UC3, returnSlot.m_pHostFlatImage);
+	TimingStats::GetTimingStats()->AddIterationResults(ETimingType::TIMING_REMAP, startTime, std::chrono::high_resolution_clock::now());
+
+	return retVal;
+}
+
+cv::Mat DpcppRemappingV16::GetDebugImage()
+{
+	// The map only lives in device memory so copy the one from the most recently submitted frame
+	// back to the host for the base class to draw
+	SFrameSlot& slot = m_slots[(m_nextSlot + m_slotCount - 1) % m_slotCount];
+
+	m_pQ->wait();
+	m_pQ->memcpy(m_pXYPoints, slot.m_pDevXYPoints, m_parameters->m_widthOutput * m_parameters->m_heightOutput * sizeof(Point2D)).wait();
+
+	return DpcppBaseAlgorithm::GetDebugImage();
+}
+
+// Pass in theta, phi, and psi in radians, not degrees
+void DpcppRemappingV16::ComputeRotationMatrix(float radTheta, float radPhi, float radPsi)
+{
+	// Python code snippet that this is attempting to match
+	//# Compute a matrix representing the three rotations THETA, PHI, and PSI
+	//x_axis = np.array([1.0, 0.0, 0.0], np.float32)
+	//y_axis = np.array([0.0, 1.0, 0.0], np.float32)
+	//z_axis = np.array([0.0, 0.0, 1.0], np.float32)
+	//Ry, _ = cv2.Rodrigues(y_axis * np.radians(THETA))
+	//Rx, _ = cv2.Rodrigues(np.dot(Ry, x_axis) * np.radians(PHI))
+	//Rz, _ = cv2.Rodrigues(np.dot(Rx, np.dot(Ry, z_axis)) * np.radians(PSI))
+	//R = Rz @ Rx @ Ry
+	cv::Mat x_axis = (cv::Mat_<float>(3, 1) << 1, 0, 0);
+	cv::Mat y_axis = (cv::Mat_<float>(3, 1) << 0, 1, 0);
+	cv::Mat z_axis = (cv::Mat_<float>(3, 1) << 0, 0, 1);
+	cv::Mat Rx;
+	cv::Mat Ry;
+	cv::Mat Rz;
+	cv::Mat R;
+
+	cv::Rodrigues(y_axis * radTheta, Ry);
+	cv::Rodrigues(Ry * x_axis * radPhi, Rx);
+	cv::Rodrigues(Rx * Ry * z_axis * radPsi, Rz);
+
+	m_rotationMatrix = Rz * Rx * Ry;
+}
+
+bool DpcppRemappingV16::StartVariant()
+{
+	bool bRetVal = false;
+
+	m_currentIndex = -1;
+	if (m_slotCount == FRAME_SLOTS_INIT)
+	{
+		DpcppBaseAlgorithm::StartVariant();
+	}
+	m_slotCount++;
+	if (m_pQ && m_slotCount <= FRAME_SLOTS_MAX)
+	{
+		int size = m_parameters->m_widthOutput * m_parameters->m_heightOutput;
+		int imageSize = m_parameters->m_image[m_parameters->m_imageIndex].cols * m_parameters->m_image[m_parameters->m_imageIndex].rows;
+		auto dev = m_pQ->get_device();
+		auto ctxt = m_pQ->get_context();
+
+		m_slots.resize(m_slotCount);
+		for (auto& slot : m_slots)
+		{
+			slot.m_pHostFullImage = (unsigned char*)BufferPool::GetBufferPool()->Acquire(imageSize * pixelBytes * sizeof(unsigned char), BUFFER_USM_HOST, dev, ctxt);
+			slot.m_pDevFullImage = (unsigned char*)BufferPool::GetBufferPool()->Acquire(imageSize * pixelBytes * sizeof(unsigned char), BUFFER_USM_DEVICE, dev, ctxt);
+			slot.m_pDevXYPoints = (Point2D*)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D), BUFFER_USM_DEVICE, dev, ctxt);
+			slot.m_pDevFlatImage = (unsigned char*)BufferPool::GetBufferPool()->Acquire(size * pixelBytes * sizeof(unsigned char), BUFFER_USM_DEVICE, dev, ctxt);
+			slot.m_pHostFlatImage = (unsigned char*)BufferPool::GetBufferPool()->Acquire(size * pixelBytes * sizeof(unsigned char), BUFFER_USM_HOST, dev, ctxt);
+			slot.m_imageGeneration = -1;
+			slot.m_mapGeneration = -1;
+			slot.m_bInFlight = false;
+		}
+		m_pXYPoints = (Point2D*)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D), BUFFER_USM_HOST, dev, ctxt);
+		m_nextSlot = 0;
+		m_framesSubmitted = 0;
+
+		printf("DpcppRemappingV16::StartVariant %d frame slot(s)\n", m_slotCount);
+
+		m_bFrameCalcRequired = true;
+		bRetVal = true;
+	}
+
+	return bRetVal;
+}
+
+void DpcppRemappingV16::StopVariant()
+{
+	if (m_pQ != NULL)
+	{
+		m_pQ->wait();
+		for (auto& slot : m_slots)
+		{
+			BufferPool::GetBufferPool()->Release(slot.m_pHostFullImage);
+			BufferPool::GetBufferPool()->Release(slot.m_pDevFullImage);
+			BufferPool::GetBufferPool()->Release(slot.m_pDevXYPoints);
+			BufferPool::GetBufferPool()->Release(slot.m_pDevFlatImage);
+			BufferPool::GetBufferPool()->Release(slot.m_pHostFlatImage);
+		}
+		BufferPool::GetBufferPool()->Release(m_pXYPoints);
+		m_pXYPoints = NULL;
+	}
+	m_slots.clear();
+
+	// Keep the queue for the remaining slot counts and only release it after the last one so the next
+	// StartVariant moves on to the next device
+	if (m_slotCount >= FRAME_SLOTS_MAX)
+	{
+		DpcppBaseAlgorithm::StopVariant();
+		m_slotCount = FRAME_SLOTS_INIT;
+	}
+}
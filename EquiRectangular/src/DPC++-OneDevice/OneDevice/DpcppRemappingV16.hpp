@@ -0,0 +1,95 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// The primary difference between this implementation and DpcppRemappingV13 (device memory) is that this one
+// keeps several frame slots, each with its own set of device buffers.  The upload, map kernel, extract kernel,
+// and readback for a frame are chained with events instead of waiting on the queue between each step, so the
+// upload of the next frame and the readback of the previous frame can overlap the extraction of the current
+// frame.  The price is latency: with N slots the image returned from ExtractFrameImage is N - 1 frames old.
+
+#include <chrono>
+#include <vector>
+#include <sycl/sycl.hpp>
+#include "DpcppBaseAlgorithm.hpp"
+#include "Point2D.hpp"
+#include "Point3D.hpp"
+
+const int FRAME_SLOTS_INIT = 0;
+const int FRAME_SLOTS_MAX = 3;
+
+class DpcppRemappingV16 : public DpcppBaseAlgorithm {
+private:
+	// SMapParams holds the values computed on the host in FrameCalculations that the map kernel needs
+	struct SMapParams {
+		float m_invf;
+		float m_translatecx;
+		float m_translatecy;
+		float m_m00, m_m01, m_m02;
+		float m_m10, m_m11, m_m12;
+		float m_m20, m_m21, m_m22;
+		float m_imageWidth;
+		float m_imageHeight;
+	};
+
+	struct SFrameSlot {
+		// m_pHostFullImage is pinned host memory used to stage the source image so the upload can run
+		// asynchronously without the source cv::Mat having to stay alive
+		unsigned char* m_pHostFullImage;
+		unsigned char* m_pDevFullImage;
+		Point2D* m_pDevXYPoints;
+		unsigned char* m_pDevFlatImage;
+		// m_pHostFlatImage is pinned host memory the flat image is read back into
+		unsigned char* m_pHostFlatImage;
+		// m_imageGeneration and m_mapGeneration track which source image and which map the slot's device
+		// buffers currently hold so unchanged data is not uploaded or recomputed
+		int m_imageGeneration;
+		int m_mapGeneration;
+		sycl::event m_readbackEvent;
+		bool m_bInFlight;
+		std::chrono::high_resolution_clock::time_point m_submitTime;
+	};
+
+	std::vector<SFrameSlot> m_slots;
+	int m_slotCount;
+	int m_nextSlot;
+	long long m_framesSubmitted;
+	SMapParams m_mapParams;
+	int m_mapGeneration;
+	int m_imageGeneration;
+	cv::Mat m_rotationMatrix;
+	int m_currentIndex;
+
+private:
+	// Pass in theta, phi, and psi in radians, not degrees
+	void ComputeRotationMatrix(float radTheta, float radPhi, float radPsi);
+	void SubmitFrame(SFrameSlot& slot);
+	void WaitForSlot(SFrameSlot& slot);
+
+public:
+
+	DpcppRemappingV16(SParameters& parameters);
+
+	virtual void FrameCalculations(bool bParametersChanged);
+	virtual cv::Mat ExtractFrameImage();
+	virtual cv::Mat GetDebugImage();
+
+	virtual std::string GetDescription();
+
+	virtual bool StartVariant();
+	virtual void StopVariant();
+
+};
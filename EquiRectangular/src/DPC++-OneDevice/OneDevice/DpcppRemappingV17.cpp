@@ -0,0 +1,432 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+// This code starts from V13 (device memory) and removes the host waits between the submissions for a frame
+
+#include "DpcppRemappingV17.hpp"
+#include "BufferPool.hpp"
+#include "ConfigurableDeviceSelector.hpp"
+#include "TimingStats.hpp"
+#include <opencv2/calib3d.hpp>
+
+#ifdef VTUNE_API
+#include "ittnotify.h"
+#pragma comment(lib, "libittnotify.lib")
+extern __itt_domain* pittTests_domain;
+// Create string handle for denoting when the kernel is running
+wchar_t const* pDpcppRemappingV17Submit = _T("DpcppRemappingV17 Submit Frame");
+__itt_string_handle* handle_DpcppRemappingV17_submit_frame = __itt_string_handle_create(pDpcppRemappingV17Submit);
+wchar_t const* pDpcppRemappingV17Wait = _T("DpcppRemappingV17 Wait Frame");
+__itt_string_handle* handle_DpcppRemappingV17_wait_frame = __itt_string_handle_create(pDpcppRemappingV17Wait);
+#endif
+
+const int pixelBytes = 3;
+
+DpcppRemappingV17::DpcppRemappingV17(SParameters& parameters) : DpcppBaseAlgorithm(parameters)
+{
+	m_asyncMode = ASYNC_MODE_INIT;
+	for (auto& slot : m_slots)
+	{
+		slot.m_pHostParams = NULL;
+		slot.m_pHostFlatImage = NULL;
+#ifdef SYCL_EXT_ONEAPI_GRAPH
+		slot.m_pMapExtractGraph = NULL;
+		slot.m_pExtractGraph = NULL;
+#endif
+	}
+	m_nextSlot = 0;
+}
+
+std::string DpcppRemappingV17::GetDescription()
+{
+	std::string strDesc = GetDeviceDescription();
+
+	switch (m_asyncMode)
+	{
+	case ASYNC_MODE_EVENTS:
+		return "DpcppRemappingV17: V13 device memory chaining kernels with events and no queue waits " + strDesc;
+		break;
+	case ASYNC_MODE_GRAPH:
+		return "DpcppRemappingV17: V13 device memory replaying a recorded command graph each frame " + strDesc;
+		break;
+	}
+
+	return "Unknown";
+}
+
+void DpcppRemappingV17::FrameCalculations(bool bParametersChanged)
+{
+	if (bParametersChanged || m_bFrameCalcRequired)
+	{
+		BaseAlgorithm::FrameCalculations(bParametersChanged);
+
+		ComputeRotationMatrix((float)m_parameters->m_yaw * DEGREE_CONVERSION_FACTOR, (float)m_parameters->m_pitch * DEGREE_CONVERSION_FACTOR, (float)m_parameters->m_roll * DEGREE_CONVERSION_FACTOR);
+
+		float f;
+		float cx;
+		float cy;
+
+		f = 0.5 * m_parameters->m_widthOutput * 1 / tan(0.5 * m_parameters->m_fov / 180.0 * M_PI);
+		cx = ((float)m_parameters->m_widthOutput - 1.0f) / 2.0f;
+		cy = ((float)m_parameters->m_heightOutput - 1.0f) / 2.0f;
+
+		SFrameSlot& slot = m_slots[m_nextSlot];
+		SMapParams* pHostParams = slot.m_pHostParams;
+
+		// The slot's last frame (two frames back) may still be copying its parameters to the device, so make
+		// sure it is done before overwriting them.  This is normally already complete since the caller has
+		// waited on that frame's future.
+		slot.m_frameEvent.wait();
+
+		pHostParams->m_invf = 1.0f / f;
+		pHostParams->m_translatecx = -cx * pHostParams->m_invf;
+		pHostParams->m_translatecy = -cy * pHostParams->m_invf;
+		pHostParams->m_m00 = m_rotationMatrix.at<float>(0, 0);
+		pHostParams->m_m01 = m_rotationMatrix.at<float>(0, 1);
+		pHostParams->m_m02 = m_rotationMatrix.at<float>(0, 2);
+		pHostParams->m_m10 = m_rotationMatrix.at<float>(1, 0);
+		pHostParams->m_m11 = m_rotationMatrix.at<float>(1, 1);
+		pHostParams->m_m12 = m_rotationMatrix.at<float>(1, 2);
+		pHostParams->m_m20 = m_rotationMatrix.at<float>(2, 0);
+		pHostParams->m_m21 = m_rotationMatrix.at<float>(2, 1);
+		pHostParams->m_m22 = m_rotationMatrix.at<float>(2, 2);
+		pHostParams->m_imageWidth = m_parameters->m_image[m_parameters->m_imageIndex].cols - 1;
+		pHostParams->m_imageHeight = m_parameters->m_image[m_parameters->m_imageIndex].rows - 1;
+
+		switch (m_asyncMode)
+		{
+		case ASYNC_MODE_EVENTS:
+			// Submit without waiting.  The previous frame has to be done with the parameters and the map before
+			// they are replaced, and the extract kernel picks up m_mapEvent as a dependency.
+			m_mapEvent = SubmitMapKernel(m_pQ->memcpy(m_pDevParams, pHostParams, sizeof(SMapParams), m_frameEvent));
+			break;
+		case ASYNC_MODE_GRAPH:
+			// The parameter copy and map kernel are part of the recorded graph
+			m_bMapDirty = true;
+			break;
+		}
+
+		m_bFrameCalcRequired = false;
+	}
+}
+
+sycl::event DpcppRemappingV17::SubmitMapKernel(sycl::event dependency)
+{
+	int height = m_parameters->m_heightOutput;
+	int width = m_parameters->m_widthOutput;
+	Point2D* pDevPoints = m_pDevXYPoints;
+	SMapParams* pParams = m_pDevParams;
+	float xDiv = 2 * M_PI;
+
+	return m_pQ->submit([&](sycl::handler& cgh) {
+		cgh.depends_on(dependency);
+		cgh.parallel_for(sycl::range<2>(height, width),
+		[=](sycl::id<2> item) {
+			Point2D* pElement = &pDevPoints[item[0] * width + item[1]];
+			float x = item[1] * pParams->m_invf + pParams->m_translatecx;
+			float y = item[0] * pParams->m_invf + pParams->m_translatecy;
+			float z = 1.0f;
+			float norm;
+
+			// Calculate xyz * R, save the initial x, y, and z values for the computation
+			float eX = x;
+			float eY = y;
+			float eZ = z;
+
+			x = eX * pParams->m_m00 + eY * pParams->m_m01 + eZ * pParams->m_m02;
+			y = eX * pParams->m_m10 + eY * pParams->m_m11 + eZ * pParams->m_m12;
+			z = eX * pParams->m_m20 + eY * pParams->m_m21 + eZ * pParams->m_m22;
+
+			norm = sqrt(x * x + y * y + z * z);
+
+			x = atan2(x / norm, z / norm);
+			y = asin(y / norm);
+
+			pElement->m_x = (x / xDiv + 0.5f) * pParams->m_imageWidth;
+			pElement->m_y = (y / M_PI + 0.5f) * pParams->m_imageHeight;
+		});
+	});
+}
+
+sycl::event DpcppRemappingV17::SubmitExtractAndReadback(std::vector<sycl::event> dependencies, unsigned char* pHostFlatImage)
+{
+	int height = m_parameters->m_heightOutput;
+	int width = m_parameters->m_widthOutput;
+	int imageWidth = m_parameters->m_image[m_parameters->m_imageIndex].cols;
+	unsigned char* pFlatImage = m_pDevFlatImage;
+	unsigned char* pDevFullImage = m_pDevFullImage;
+	Point2D* pDevXYPoints = m_pDevXYPoints;
+
+	sycl::event extractEvent = m_pQ->submit([&](sycl::handler& cgh) {
+		cgh.depends_on(dependencies);
+		cgh.parallel_for(sycl::range<2>(height, width),
+		[=](sycl::id<2> item) {
+			int offset = item[0] * width + item[1];
+			Point2D* pElement = &pDevXYPoints[offset];
+			unsigned char* pFlatPixel = &pFlatImage[offset * pixelBytes];
+			int top_left_x = static_cast<int>(pElement->m_x); // convert the subpixel value to an integer pixel value (top left pixel due to int() operator)
+			int top_left_y = static_cast<int>(pElement->m_y);
+			unsigned char* tl = pDevFullImage + (top_left_y * imageWidth + top_left_x) * pixelBytes;
+
+			// There is an assumption here that the image has 3 consecutive bytes for
+			// blue, green, and red (i.e., no alpha channel)
+			for (int i = 0; i < pixelBytes; i++)
+			{
+				pFlatPixel[i] = tl[i];
+			}
+		});
+	});
+
+	return m_pQ->submit([&](sycl::handler& cgh) {
+		cgh.depends_on(extractEvent);
+		cgh.memcpy(pHostFlatImage, pFlatImage, height * width * sizeof(unsigned char) * pixelBytes);
+	});
+}
+
+#ifdef SYCL_EXT_ONEAPI_GRAPH
+// RecordGraphs captures the per-frame submissions for a slot once.  The kernels read their inputs through the USM
+// pointers so replaying the graph picks up the new parameters and image without re-recording.
+void DpcppRemappingV17::RecordGraphs(SFrameSlot& slot)
+{
+	namespace sycl_exp = sycl::ext::oneapi::experimental;
+	sycl_exp::command_graph<sycl_exp::graph_state::modifiable> mapExtractGraph(m_pQ->get_context(), m_pQ->get_device());
+	sycl_exp::command_graph<sycl_exp::graph_state::modifiable> extractGraph(m_pQ->get_context(), m_pQ->get_device());
+
+	mapExtractGraph.begin_recording(*m_pQ);
+	sycl::event paramsEvent = m_pQ->memcpy(m_pDevParams, slot.m_pHostParams, sizeof(SMapParams));
+	SubmitExtractAndReadback({ SubmitMapKernel(paramsEvent) }, slot.m_pHostFlatImage);
+	mapExtractGraph.end_recording();
+	slot.m_pMapExtractGraph = new sycl_exp::command_graph<sycl_exp::graph_state::executable>(mapExtractGraph.finalize());
+
+	extractGraph.begin_recording(*m_pQ);
+	SubmitExtractAndReadback({}, slot.m_pHostFlatImage);
+	extractGraph.end_recording();
+	slot.m_pExtractGraph = new sycl_exp::command_graph<sycl_exp::graph_state::executable>(extractGraph.finalize());
+}
+#endif
+
+std::future<cv::Mat> DpcppRemappingV17::ExtractFrameImageAsync()
+{
+	std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+
+#ifdef VTUNE_API
+	__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV17_submit_frame);
+#endif
+	SFrameSlot& slot = m_slots[m_nextSlot];
+
+	if (m_currentIndex != m_parameters->m_imageIndex)
+	{
+		int imageHeight = m_parameters->m_image[m_parameters->m_imageIndex].rows;
+		int imageWidth = m_parameters->m_image[m_parameters->m_imageIndex].cols;
+
+		// TODO: This assumes that both images are the exact same size.  Perhaps should put an
+		// ASSERT here to check that assumption.  The previous frame's extract kernel may still be reading
+		// the old image.
+		m_uploadEvent = m_pQ->memcpy(m_pDevFullImage, m_parameters->m_image[m_parameters->m_imageIndex].data, imageHeight * imageWidth * sizeof(unsigned char) * pixelBytes, m_frameEvent);
+		m_currentIndex = m_parameters->m_imageIndex;
+	}
+
+	switch (m_asyncMode)
+	{
+	case ASYNC_MODE_EVENTS:
+		// m_frameEvent keeps the extract kernel from overwriting the flat image the previous frame is reading back
+		m_frameEvent = SubmitExtractAndReadback({ m_uploadEvent, m_mapEvent, m_frameEvent }, slot.m_pHostFlatImage);
+		break;
+#ifdef SYCL_EXT_ONEAPI_GRAPH
+	case ASYNC_MODE_GRAPH:
+	{
+		auto* pGraph = m_bMapDirty ? slot.m_pMapExtractGraph : slot.m_pExtractGraph;
+		std::vector<sycl::event> dependencies = { m_uploadEvent, m_frameEvent };
+
+		// The graphs of the slots share the device buffers so a frame runs after the previous one
+		m_frameEvent = m_pQ->submit([&](sycl::handler& cgh) {
+			cgh.depends_on(dependencies);
+			cgh.ext_oneapi_graph(*pGraph);
+		});
+		m_bMapDirty = false;
+		break;
+	}
+#endif
+	}
+	slot.m_frameEvent = m_frameEvent;
+	m_nextSlot = (m_nextSlot + 1) % ASYNC_FRAME_SLOTS;
+#ifdef VTUNE_API
+	__itt_task_end(pittTests_domain);
+#endif
+
+	// Deferred so nothing blocks until the caller actually asks for the image
+	sycl::event frameEvent = m_frameEvent;
+	int height = m_parameters->m_heightOutput;
+	int width = m_parameters->m_widthOutput;
+	unsigned char* pHostFlatImage = slot.m_pHostFlatImage;
+
+	return std::async(std::launch::deferred, [frameEvent, height, width, pHostFlatImage, startTime]() mutable {
+#ifdef VTUNE_API
+		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV17_wait_frame);
+#endif
+		frameEvent.wait();
+#ifdef VTUNE_API
+		__itt_task_end(pittTests_domain);
+#endif
+		TimingStats::GetTimingStats()->AddIterationResults(ETimingType::TIMING_REMAP, startTime, std::chrono::high_resolution_clock::now());
+
+		return cv::Mat(height, width, CV_8UC3, pHostFlatImage);
+	});
+}
+
+cv::Mat DpcppRemappingV17::ExtractFrameImage()
+{
+	return ExtractFrameImageAsync().get();
+}
+
+bool DpcppRemappingV17::SupportsAsyncFrames()
+{
+	// Each slot reads back into its own pinned host image
+	return true;
+}
+
+cv::Mat DpcppRemappingV17::GetDebugImage()
+{
+	// The map only lives in device memory so copy it back to the host for the base class to draw once the
+	// frames in flight are done with it
+	m_pQ->wait();
+	m_pQ->memcpy(m_pXYPoints, m_pDevXYPoints, m_parameters->m_widthOutput * m_parameters->m_heightOutput * sizeof(Point2D)).wait();
+
+	return DpcppBaseAlgorithm::GetDebugImage();
+}
+
+// Pass in theta, phi, and psi in radians, not degrees
+void DpcppRemappingV17::ComputeRotationMatrix(float radTheta, float radPhi, float radPsi)
+{
+	// Python code snippet that this is attempting to match
+	//# Compute a matrix representing the three rotations THETA, PHI, and PSI
+	//x_axis = np.array([1.0, 0.0, 0.0], np.float32)
+	//y_axis = np.array([0.0, 1.0, 0.0], np.float32)
+	//z_axis = np.array([0.0, 0.0, 1.0], np.float32)
+	//Ry, _ = cv2.Rodrigues(y_axis * np.radians(THETA))
+	//Rx, _ = cv2.Rodrigues(np.dot(Ry, x_axis) * np.radians(PHI))
+	//Rz, _ = cv2.Rodrigues(np.dot(Rx, np.dot(Ry, z_axis)) * np.radians(PSI))
+	//R = Rz @ Rx @ Ry
+	cv::Mat x_axis = (cv::Mat_<float>(3, 1) << 1, 0, 0);
+	cv::Mat y_axis = (cv::Mat_<float>(3, 1) << 0, 1, 0);
+	cv::Mat z_axis = (cv::Mat_<float>(3, 1) << 0, 0, 1);
+	cv::Mat Rx;
+	cv::Mat Ry;
+	cv::Mat Rz;
+	cv::Mat R;
+
+	cv::Rodrigues(y_axis * radTheta, Ry);
+	cv::Rodrigues(Ry * x_axis * radPhi, Rx);
+	cv::Rodrigues(Rx * Ry * z_axis * radPsi, Rz);
+
+	m_rotationMatrix = Rz * Rx * Ry;
+}
+
+bool DpcppRemappingV17::StartVariant()
+{
+	bool bRetVal = false;
+
+	m_currentIndex = -1;
+	if (m_asyncMode == ASYNC_MODE_INIT)
+	{
+		DpcppBaseAlgorithm::StartVariant();
+	}
+	m_asyncMode++;
+	if (m_pQ && m_asyncMode < ASYNC_MODE_MAX)
+	{
+		int size = m_parameters->m_widthOutput * m_parameters->m_heightOutput;
+		auto dev = m_pQ->get_device();
+		auto ctxt = m_pQ->get_context();
+
+		m_pDevParams = (SMapParams*)BufferPool::GetBufferPool()->Acquire(sizeof(SMapParams), BUFFER_USM_DEVICE, dev, ctxt);
+		m_pDevXYPoints = (Point2D*)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D), BUFFER_USM_DEVICE, dev, ctxt);
+		m_pDevFlatImage = (unsigned char*)BufferPool::GetBufferPool()->Acquire(size * pixelBytes * sizeof(unsigned char), BUFFER_USM_DEVICE, dev, ctxt);
+		m_pDevFullImage = (unsigned char*)BufferPool::GetBufferPool()->Acquire(m_parameters->m_image[m_parameters->m_imageIndex].cols * m_parameters->m_image[m_parameters->m_imageIndex].rows * pixelBytes * sizeof(unsigned char), BUFFER_USM_DEVICE, dev, ctxt);
+		m_pXYPoints = (Point2D*)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D), BUFFER_USM_HOST, dev, ctxt);
+		for (auto& slot : m_slots)
+		{
+			slot.m_pHostParams = (SMapParams*)BufferPool::GetBufferPool()->Acquire(sizeof(SMapParams), BUFFER_USM_HOST, dev, ctxt);
+			slot.m_pHostFlatImage = (unsigned char*)BufferPool::GetBufferPool()->Acquire(size * pixelBytes * sizeof(unsigned char), BUFFER_USM_HOST, dev, ctxt);
+			slot.m_frameEvent = sycl::event();
+#ifdef SYCL_EXT_ONEAPI_GRAPH
+			slot.m_pMapExtractGraph = NULL;
+			slot.m_pExtractGraph = NULL;
+#endif
+		}
+		m_nextSlot = 0;
+		m_uploadEvent = sycl::event();
+		m_mapEvent = sycl::event();
+		m_frameEvent = sycl::event();
+		m_bMapDirty = true;
+
+		switch (m_asyncMode)
+		{
+		case ASYNC_MODE_EVENTS:
+			printf("DpcppRemappingV17::StartVariant ASYNC_MODE_EVENTS\n");
+			break;
+#ifdef SYCL_EXT_ONEAPI_GRAPH
+		case ASYNC_MODE_GRAPH:
+			for (auto& slot : m_slots)
+			{
+				RecordGraphs(slot);
+			}
+			printf("DpcppRemappingV17::StartVariant ASYNC_MODE_GRAPH\n");
+			break;
+#endif
+		}
+		m_bFrameCalcRequired = true;
+		bRetVal = true;
+	}
+
+	return bRetVal;
+}
+
+void DpcppRemappingV17::StopVariant()
+{
+	if (m_pQ != NULL)
+	{
+		m_pQ->wait();
+		for (auto& slot : m_slots)
+		{
+#ifdef SYCL_EXT_ONEAPI_GRAPH
+			delete slot.m_pMapExtractGraph;
+			slot.m_pMapExtractGraph = NULL;
+			delete slot.m_pExtractGraph;
+			slot.m_pExtractGraph = NULL;
+#endif
+			BufferPool::GetBufferPool()->Release(slot.m_pHostParams);
+			slot.m_pHostParams = NULL;
+			BufferPool::GetBufferPool()->Release(slot.m_pHostFlatImage);
+			slot.m_pHostFlatImage = NULL;
+		}
+		BufferPool::GetBufferPool()->Release(m_pDevParams);
+		m_pDevParams = NULL;
+		BufferPool::GetBufferPool()->Release(m_pDevXYPoints);
+		m_pDevXYPoints = NULL;
+		BufferPool::GetBufferPool()->Release(m_pDevFlatImage);
+		m_pDevFlatImage = NULL;
+		BufferPool::GetBufferPool()->Release(m_pDevFullImage);
+		m_pDevFullImage = NULL;
+		BufferPool::GetBufferPool()->Release(m_pXYPoints);
+		m_pXYPoints = NULL;
+	}
+
+	// Only release the queue after the last mode so the next StartVariant moves on to the next device
+	if (m_asyncMode >= ASYNC_MODE_MAX - 1)
+	{
+		DpcppBaseAlgorithm::StopVariant();
+		m_asyncMode = ASYNC_MODE_INIT;
+	}
+}
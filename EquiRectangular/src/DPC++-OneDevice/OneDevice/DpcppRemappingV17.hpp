@@ -0,0 +1,113 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// The primary difference between this implementation and DpcppRemappingV13 (device memory) is that this one
+// never waits on the queue between steps.  The parameter upload, map kernel, extract kernel, and readback are
+// chained with sycl::event dependencies and ExtractFrameImageAsync hands back a future that only waits for
+// the readback.  When the compiler provides the SYCL command graph extension, a second variant records the
+// per-frame submissions once and replays the recorded graph each frame to cut the launch overhead.
+//
+// Each frame's submissions depend on the previous frame's, so the device buffers are never overwritten while
+// still in use.  The parameters and the flat image are staged in one of ASYNC_FRAME_SLOTS host slots so the next
+// frame can be prepared while the current one is in flight; the image from a future stays valid until two more
+// frames have been submitted.
+
+#include <future>
+#include <sycl/sycl.hpp>
+#include "DpcppBaseAlgorithm.hpp"
+#include "Point2D.hpp"
+#include "Point3D.hpp"
+
+const int ASYNC_MODE_INIT = -1;
+const int ASYNC_MODE_EVENTS = 0;
+const int ASYNC_MODE_GRAPH = 1;
+#ifdef SYCL_EXT_ONEAPI_GRAPH
+const int ASYNC_MODE_MAX = 2;
+#else
+const int ASYNC_MODE_MAX = 1;
+#endif
+const int ASYNC_FRAME_SLOTS = 2;
+
+class DpcppRemappingV17 : public DpcppBaseAlgorithm {
+private:
+	// SMapParams holds the values computed on the host in FrameCalculations that the map kernel needs.  They
+	// are passed through memory rather than captured by the kernel so a recorded graph sees the new values.
+	struct SMapParams {
+		float m_invf;
+		float m_translatecx;
+		float m_translatecy;
+		float m_m00, m_m01, m_m02;
+		float m_m10, m_m11, m_m12;
+		float m_m20, m_m21, m_m22;
+		float m_imageWidth;
+		float m_imageHeight;
+	};
+
+	struct SFrameSlot {
+		// m_pHostParams and m_pHostFlatImage are pinned host memory for the parameters uploaded for the frame
+		// and the flat image read back from it
+		SMapParams* m_pHostParams;
+		unsigned char* m_pHostFlatImage;
+		// m_frameEvent completes once the slot's last frame has been read back
+		sycl::event m_frameEvent;
+#ifdef SYCL_EXT_ONEAPI_GRAPH
+		// m_pMapExtractGraph recomputes the map before extracting and m_pExtractGraph only extracts
+		sycl::ext::oneapi::experimental::command_graph<sycl::ext::oneapi::experimental::graph_state::executable>* m_pMapExtractGraph;
+		sycl::ext::oneapi::experimental::command_graph<sycl::ext::oneapi::experimental::graph_state::executable>* m_pExtractGraph;
+#endif
+	};
+
+	SFrameSlot m_slots[ASYNC_FRAME_SLOTS];
+	int m_nextSlot;
+	SMapParams* m_pDevParams = NULL;
+	Point2D* m_pDevXYPoints = NULL;
+	unsigned char* m_pDevFlatImage = NULL;
+	unsigned char* m_pDevFullImage = NULL;
+	int m_asyncMode;
+	cv::Mat m_rotationMatrix;
+	int m_currentIndex;
+	bool m_bMapDirty;
+	sycl::event m_uploadEvent;
+	sycl::event m_mapEvent;
+	// m_frameEvent completes once the most recently submitted frame has been read back
+	sycl::event m_frameEvent;
+
+private:
+	// Pass in theta, phi, and psi in radians, not degrees
+	void ComputeRotationMatrix(float radTheta, float radPhi, float radPsi);
+	sycl::event SubmitMapKernel(sycl::event dependency);
+	sycl::event SubmitExtractAndReadback(std::vector<sycl::event> dependencies, unsigned char* pHostFlatImage);
+#ifdef SYCL_EXT_ONEAPI_GRAPH
+	void RecordGraphs(SFrameSlot& slot);
+#endif
+
+public:
+
+	DpcppRemappingV17(SParameters& parameters);
+
+	virtual void FrameCalculations(bool bParametersChanged);
+	virtual cv::Mat ExtractFrameImage();
+	virtual std::future<cv::Mat> ExtractFrameImageAsync();
+	virtual bool SupportsAsyncFrames();
+	virtual cv::Mat GetDebugImage();
+
+	virtual std::string GetDescription();
+
+	virtual bool StartVariant();
+	virtual void StopVariant();
+
+};
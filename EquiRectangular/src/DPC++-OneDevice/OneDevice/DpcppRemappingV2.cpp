@@ -17,6 +17,7 @@
 // kernels used has been collapsed to 1 to see how that impacts efficiency.
 
 #include "DpcppRemappingV2.hpp"
+#include "BufferPool.hpp"
 #include "ConfigurableDeviceSelector.hpp"
 #include "TimingStats.hpp"
 #include <opencv2/calib3d.hpp>
@@ -271,14 +272,14 @@ bool DpcppRemappingV2::StartVariant()
 		{
 			auto dev = m_pQ->get_device();
 			auto ctxt = m_pQ->get_context();
-			m_pXYPoints = (Point2D*)malloc_shared(size * sizeof(Point2D), dev, ctxt);
+			m_pXYPoints = (Point2D*)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D), BUFFER_USM_SHARED, dev, ctxt);
 
 			printf("DpcppRemappingV2::StartVariant STORAGE_TYPE_USM\n");
 			break;
 		}
 		case STORAGE_TYPE_DEVICE:
-			m_pXYPoints = (Point2D*)malloc(size * sizeof(Point2D));
-			m_pDevXYPoints = (Point2D*)malloc_device(size * sizeof(Point2D), m_pQ->get_device(), m_pQ->get_context());
+			m_pXYPoints = (Point2D*)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D));
+			m_pDevXYPoints = (Point2D*)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D), BUFFER_USM_DEVICE, m_pQ->get_device(), m_pQ->get_context());
 
 			printf("DpcppRemappingV2::StartVariant STORAGE_TYPE_DEVICE\n");
 			break;
@@ -296,17 +297,15 @@ void DpcppRemappingV2::StopVariant()
 	{
 	case STORAGE_TYPE_USM:
 	{
-		auto ctxt = m_pQ->get_context();
-
-		free(m_pXYPoints, ctxt);
+		BufferPool::GetBufferPool()->Release(m_pXYPoints);
 		m_pXYPoints = NULL;
 
 		break;
 	}
 	case STORAGE_TYPE_DEVICE:
-		delete m_pXYPoints;
+		BufferPool::GetBufferPool()->Release(m_pXYPoints);
 		m_pXYPoints = NULL;
-		free(m_pDevXYPoints, m_pQ->get_context());
+		BufferPool::GetBufferPool()->Release(m_pDevXYPoints);
 		m_pDevXYPoints = NULL;
 		break;
 	}
@@ -19,6 +19,7 @@
 // was worse for the FrameCalculations.
 
 #include "DpcppRemappingV3.hpp"
+#include "BufferPool.hpp"
 #include "ConfigurableDeviceSelector.hpp"
 #include "TimingStats.hpp"
 #include <opencv2/calib3d.hpp>
@@ -39,6 +40,12 @@ DpcppRemappingV3::DpcppRemappingV3(SParameters& parameters) : DpcppBaseAlgorithm
 	m_storageType = STORAGE_TYPE_INIT;
 }
 
+void DpcppRemappingV3::GetOutputAlignment(int& widthAlignment, int& heightAlignment)
+{
+	widthAlignment = OUTPUT_WIDTH_ALIGNMENT;
+	heightAlignment = OUTPUT_HEIGHT_ALIGNMENT;
+}
+
 std::string DpcppRemappingV3::GetDescription()
 {
     std::string strDesc = GetDeviceDescription();
@@ -286,15 +293,15 @@ bool DpcppRemappingV3::StartVariant()
 			auto dev = m_pQ->get_device();
 			auto ctxt = m_pQ->get_context();
 
-			m_pXYPoints = (Point2D*)malloc_shared(size * sizeof(Point2D), dev, ctxt);
+			m_pXYPoints = (Point2D*)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D), BUFFER_USM_SHARED, dev, ctxt);
 
 			printf("DpcppRemappingV3::StartVariant STORAGE_TYPE_USM\n");
 
 			break;
 		}
 		case STORAGE_TYPE_DEVICE:
-			m_pXYPoints = (Point2D*)malloc(size * sizeof(Point2D));
-			m_pDevXYPoints = (Point2D*)malloc_device(size * sizeof(Point2D), m_pQ->get_device(), m_pQ->get_context());
+			m_pXYPoints = (Point2D*)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D));
+			m_pDevXYPoints = (Point2D*)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D), BUFFER_USM_DEVICE, m_pQ->get_device(), m_pQ->get_context());
 
 			printf("DpcppRemappingV3::StartVariant STORAGE_TYPE_DEVICE\n");
 
@@ -313,17 +320,15 @@ void DpcppRemappingV3::StopVariant()
 	{
 	case STORAGE_TYPE_USM:
 	{
-		auto ctxt = m_pQ->get_context();
-
-		free(m_pXYPoints, ctxt);
+		BufferPool::GetBufferPool()->Release(m_pXYPoints);
 		m_pXYPoints = NULL;
 
 		break;
 	}
 	case STORAGE_TYPE_DEVICE:
-		delete m_pXYPoints;
+		BufferPool::GetBufferPool()->Release(m_pXYPoints);
 		m_pXYPoints = NULL;
-		free(m_pDevXYPoints, m_pQ->get_context());
+		BufferPool::GetBufferPool()->Release(m_pDevXYPoints);
 		m_pDevXYPoints = NULL;
 		break;
 	}
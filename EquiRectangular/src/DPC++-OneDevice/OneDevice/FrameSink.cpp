@@ -0,0 +1,322 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "FrameSink.hpp"
+#include <algorithm>
+#include <iostream>
+#include "opencv2/imgcodecs.hpp"
+
+#ifdef VTUNE_API
+#include "ittnotify.h"
+#pragma comment(lib, "libittnotify.lib")
+extern __itt_domain* pittTests_domain;
+// Create string handle for denoting when a frame is being encoded
+wchar_t const* pFrameSinkEncode = _T("FrameSink Encode");
+__itt_string_handle* handle_FrameSink_encode = __itt_string_handle_create(pFrameSinkEncode);
+#endif
+
+FrameSink::FrameSink(const char* pPath, int numThreads, int queueDepth, double videoFps /* = 30.0 */, int jpegQuality /* = 90 */)
+{
+	std::string extension;
+	size_t dot;
+
+	m_path = pPath;
+	dot = m_path.find_last_of('.');
+	if (dot != std::string::npos)
+	{
+		extension = m_path.substr(dot);
+		for (auto& c : extension)
+		{
+			c = tolower(c);
+		}
+	}
+	m_bVideo = (extension == ".avi" || extension == ".mp4" || extension == ".mkv" || extension == ".mov");
+	if (!m_bVideo && m_path.find('%') == std::string::npos)
+	{
+		// Treat the path as a prefix and number the stills after it
+		if (extension == ".jpg" || extension == ".jpeg")
+		{
+			m_path = m_path.substr(0, dot);
+		}
+		m_path += "-%06lld.jpg";
+	}
+	if (!m_bVideo && !ParseNamePattern())
+	{
+		std::cout << "FrameSink: " << m_path << " must have exactly one integer conversion such as %06lld, numbering the frames after it instead" << std::endl;
+		m_namePrefix = ((extension == ".jpg" || extension == ".jpeg") ? m_path.substr(0, dot) : m_path) + "-";
+		m_nameSuffix = ".jpg";
+		m_numberWidth = 6;
+		m_bNumberZeroPad = true;
+	}
+	if (m_bVideo || numThreads < 1)
+	{
+		numThreads = 1;
+	}
+	if (queueDepth < MIN_SINK_QUEUE_DEPTH)
+	{
+		queueDepth = MIN_SINK_QUEUE_DEPTH;
+	}
+	m_threads.resize(numThreads, NULL);
+	m_queueDepth = queueDepth;
+	m_videoFps = videoFps;
+	m_jpegQuality = jpegQuality;
+	m_nextFrameNumber = 0;
+	m_activeEncoders = 0;
+	m_bStopRequested = false;
+	ResetStats();
+}
+
+FrameSink::~FrameSink()
+{
+	Stop();
+}
+
+void FrameSink::Start()
+{
+	m_bStopRequested = false;
+	for (auto& pThread : m_threads)
+	{
+		pThread = new std::thread([this] { threadFunc(); });
+	}
+}
+
+void FrameSink::Stop()
+{
+	{
+		std::lock_guard<std::mutex> queueLock(m_queueMutex);
+		m_bStopRequested = true;
+	}
+	m_frameQueuedCondVar.notify_all();
+	for (auto& pThread : m_threads)
+	{
+		if (pThread != NULL)
+		{
+			pThread->join();
+			delete pThread;
+			pThread = NULL;
+		}
+	}
+	if (m_writer.isOpened())
+	{
+		m_writer.release();
+	}
+}
+
+bool FrameSink::ParseNamePattern()
+{
+	int conversions = 0;
+
+	m_namePrefix.clear();
+	m_nameSuffix.clear();
+	m_numberWidth = 0;
+	m_bNumberZeroPad = false;
+	for (size_t i = 0; i < m_path.size(); i++)
+	{
+		std::string& part = (conversions == 0) ? m_namePrefix : m_nameSuffix;
+
+		if (m_path[i] != '%')
+		{
+			part += m_path[i];
+			continue;
+		}
+		i++;
+		if (i < m_path.size() && m_path[i] == '%')
+		{
+			part += '%';
+			continue;
+		}
+		if (i < m_path.size() && m_path[i] == '0')
+		{
+			m_bNumberZeroPad = true;
+			i++;
+		}
+		while (i < m_path.size() && isdigit((unsigned char)m_path[i]))
+		{
+			m_numberWidth = std::min(m_numberWidth * 10 + (m_path[i] - '0'), MAX_SINK_NUMBER_WIDTH);
+			i++;
+		}
+		for (int length = 0; length < 2 && i < m_path.size() && m_path[i] == 'l'; length++)
+		{
+			i++;
+		}
+		if (i >= m_path.size() || (m_path[i] != 'd' && m_path[i] != 'i' && m_path[i] != 'u'))
+		{
+			return false;
+		}
+		conversions++;
+	}
+
+	return conversions == 1;
+}
+
+void FrameSink::threadFunc()
+{
+	while (true)
+	{
+		SSinkFrame frame;
+
+		{
+			std::unique_lock<std::mutex> queueLock(m_queueMutex);
+
+			m_frameQueuedCondVar.wait(queueLock, [this] {
+				return m_bStopRequested || !m_queue.empty();
+			});
+			// Drain the queue before honoring a stop so no accepted frame is lost
+			if (m_queue.empty())
+			{
+				break;
+			}
+			frame = m_queue.front();
+			m_queue.pop_front();
+			m_activeEncoders++;
+		}
+
+		std::chrono::high_resolution_clock::time_point encodeStartTime = std::chrono::high_resolution_clock::now();
+#ifdef VTUNE_API
+		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_FrameSink_encode);
+#endif
+		Encode(frame);
+#ifdef VTUNE_API
+		__itt_task_end(pittTests_domain);
+#endif
+		std::chrono::high_resolution_clock::time_point encodeEndTime = std::chrono::high_resolution_clock::now();
+
+		{
+			std::lock_guard<std::mutex> queueLock(m_queueMutex);
+
+			m_activeEncoders--;
+			m_statEncoded++;
+			m_statEncodeSum += encodeEndTime - encodeStartTime;
+		}
+		m_queueIdleCondVar.notify_all();
+	}
+}
+
+void FrameSink::Encode(SSinkFrame& frame)
+{
+	if (m_bVideo)
+	{
+		// Only one encoder thread runs for video so the writer can be opened lazily once the frame size is known
+		if (!m_writer.isOpened())
+		{
+			if (!m_writer.open(m_path, cv::VideoWriter::fourcc('m', 'p', '4', 'v'), m_videoFps, frame.m_image.size()))
+			{
+				std::cout << "FrameSink: unable to open video " << m_path << std::endl;
+			}
+		}
+		if (m_writer.isOpened())
+		{
+			m_writer.write(frame.m_image);
+		}
+	}
+	else
+	{
+		char number[64];
+		std::vector<int> params = { cv::IMWRITE_JPEG_QUALITY, m_jpegQuality };
+
+		snprintf(number, sizeof(number), m_bNumberZeroPad ? "%0*lld" : "%*lld", m_numberWidth, frame.m_frameNumber);
+
+		std::string filename = m_namePrefix + number + m_nameSuffix;
+
+		if (!cv::imwrite(filename, frame.m_image, params))
+		{
+			std::cout << "FrameSink: unable to write " << filename << std::endl;
+		}
+	}
+}
+
+bool FrameSink::Submit(const cv::Mat& frame)
+{
+	bool bRetVal = false;
+	SSinkFrame sinkFrame;
+
+	// The renderer reuses its output memory, so the sink needs its own copy of the pixels.  Copy before taking
+	// the lock so the encoder threads are not held up by the copy (the copy is wasted if the frame is dropped).
+	sinkFrame.m_image = frame.clone();
+
+	std::unique_lock<std::mutex> queueLock(m_queueMutex);
+
+	m_statSubmitted++;
+	m_statQueueDepthSum += m_queue.size();
+	if (m_queue.size() < m_queueDepth)
+	{
+		sinkFrame.m_frameNumber = m_nextFrameNumber;
+		m_queue.push_back(std::move(sinkFrame));
+		if (m_queue.size() > m_statMaxQueueDepth)
+		{
+			m_statMaxQueueDepth = m_queue.size();
+		}
+		bRetVal = true;
+	}
+	else
+	{
+		m_statDropped++;
+	}
+	m_nextFrameNumber++;
+	queueLock.unlock();
+	if (bRetVal)
+	{
+		m_frameQueuedCondVar.notify_one();
+	}
+
+	return bRetVal;
+}
+
+void FrameSink::Flush()
+{
+	std::unique_lock<std::mutex> queueLock(m_queueMutex);
+
+	m_queueIdleCondVar.wait(queueLock, [this] {
+		return m_queue.empty() && m_activeEncoders == 0;
+	});
+}
+
+int FrameSink::GetNumThreads()
+{
+	return (int)m_threads.size();
+}
+
+void FrameSink::ResetStats()
+{
+	std::lock_guard<std::mutex> queueLock(m_queueMutex);
+
+	m_statSubmitted = 0;
+	m_statDropped = 0;
+	m_statEncoded = 0;
+	m_statQueueDepthSum = 0;
+	m_statMaxQueueDepth = 0;
+	m_statEncodeSum = std::chrono::duration<double>::zero();
+}
+
+std::string FrameSink::GetStatsString()
+{
+	char line[1024];
+	std::lock_guard<std::mutex> queueLock(m_queueMutex);
+	double aveDepth = 0.0;
+	double aveEncodeMs = 0.0;
+
+	if (m_statSubmitted > 0)
+	{
+		aveDepth = (double)m_statQueueDepthSum / (double)m_statSubmitted;
+	}
+	if (m_statEncoded > 0)
+	{
+		aveEncodeMs = m_statEncodeSum.count() * 1000.0 / (double)m_statEncoded;
+	}
+	sprintf(line, "Frame sink,%lld,frames submitted,%lld,dropped,%lld,encoded,%8.3f,average queued,%d,max queued of,%d,%8.3f,ms average encode on,%d,threads\n",
+		m_statSubmitted, m_statDropped, m_statEncoded, aveDepth, (int)m_statMaxQueueDepth, (int)m_queueDepth, aveEncodeMs, (int)m_threads.size());
+
+	return line;
+}
@@ -0,0 +1,102 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// FrameSink encodes the rendered frames on its own pool of worker threads so the render loop only pays for
+// copying the frame into a bounded queue.  If the encoders fall behind and the queue is full the frame is
+// dropped (and counted) rather than stalling the render loop.  The sink either writes each frame as a JPEG
+// still (cv::imwrite, which uses the libjpeg-turbo codec in the standard OpenCV builds) or appends the
+// frames to a video through cv::VideoWriter.  A video stream has to be written in order so video sinks
+// always run a single encoder thread.
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "opencv2/core/core.hpp"
+#include "opencv2/videoio.hpp"
+
+const int MIN_SINK_QUEUE_DEPTH = 1;
+// Widest frame number padding accepted from the --sinkPath pattern
+const int MAX_SINK_NUMBER_WIDTH = 20;
+
+class FrameSink {
+private:
+	struct SSinkFrame {
+		cv::Mat		m_image;
+		long long	m_frameNumber;
+	};
+
+	std::string m_path;
+	// m_bVideo is true when m_path names a video container, otherwise m_path is a pattern for the JPEG file
+	// names with one integer conversion for the frame number (e.g., out/flat-%06lld.jpg)
+	bool m_bVideo;
+	// The JPEG file name is m_namePrefix, the frame number padded to m_numberWidth, then m_nameSuffix.  The
+	// pattern is split once so the user's path is never used as a format string.
+	std::string m_namePrefix;
+	std::string m_nameSuffix;
+	int m_numberWidth;
+	bool m_bNumberZeroPad;
+	double m_videoFps;
+	int m_jpegQuality;
+	cv::VideoWriter m_writer;
+	size_t m_queueDepth;
+	std::deque<SSinkFrame> m_queue;
+	std::vector<std::thread*> m_threads;
+	long long m_nextFrameNumber;
+	int m_activeEncoders;
+	bool m_bStopRequested;
+	std::mutex m_queueMutex;
+	std::condition_variable m_frameQueuedCondVar;
+	std::condition_variable m_queueIdleCondVar;
+
+	// Statistics since the last ResetStats
+	long long m_statSubmitted;
+	long long m_statDropped;
+	long long m_statEncoded;
+	long long m_statQueueDepthSum;
+	size_t m_statMaxQueueDepth;
+	std::chrono::duration<double> m_statEncodeSum;
+
+private:
+	// Function to run in each encoder thread
+	void threadFunc();
+	void Encode(SSinkFrame& frame);
+	// ParseNamePattern splits m_path into the file name parts.  Returns false unless m_path has exactly one
+	// conversion and it is an integer one (%d, %i, %u, optionally with a 0 flag, a width, and l or ll).
+	bool ParseNamePattern();
+
+public:
+	FrameSink(const char* pPath, int numThreads, int queueDepth, double videoFps = 30.0, int jpegQuality = 90);
+	~FrameSink();
+
+	void Start();
+	// Stop encodes whatever is still queued and then joins the encoder threads
+	void Stop();
+
+	// Submit copies the frame into the queue and returns right away.  Returns false if the queue was full
+	// and the frame was dropped.
+	bool Submit(const cv::Mat& frame);
+	// Flush blocks until every queued frame has been encoded
+	void Flush();
+
+	int GetNumThreads();
+	void ResetStats();
+	std::string GetStatsString();
+};
@@ -0,0 +1,253 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "FrameSource.hpp"
+#include <iostream>
+
+#ifdef VTUNE_API
+#include "ittnotify.h"
+#pragma comment(lib, "libittnotify.lib")
+extern __itt_domain* pittTests_domain;
+// Create string handle for denoting when a frame is being decoded
+wchar_t const* pFrameSourceDecode = _T("FrameSource Decode");
+__itt_string_handle* handle_FrameSource_decode = __itt_string_handle_create(pFrameSourceDecode);
+#endif
+
+FrameSource::FrameSource(const char* pFilename, int queueDepth)
+{
+	m_filename = pFilename;
+	if (queueDepth < MIN_FRAME_QUEUE_DEPTH)
+	{
+		queueDepth = MIN_FRAME_QUEUE_DEPTH;
+	}
+	m_slots.resize(queueDepth);
+	for (auto& slot : m_slots)
+	{
+		slot.m_state = SLOT_FREE;
+		slot.m_frameNumber = -1;
+	}
+	m_writeSlot = 0;
+	m_readSlot = 0;
+	m_framesDecoded = 0;
+	m_bEndOfStream = false;
+	m_bStopRequested = false;
+	m_pThread = NULL;
+	ResetStats();
+}
+
+FrameSource::~FrameSource()
+{
+	Stop();
+	m_capture.release();
+}
+
+bool FrameSource::Open()
+{
+	return m_capture.open(m_filename) && m_capture.isOpened();
+}
+
+void FrameSource::SetAllocator(cv::MatAllocator* pAllocator)
+{
+	for (auto& slot : m_slots)
+	{
+		slot.m_image.release();
+		slot.m_image.allocator = pAllocator;
+	}
+}
+
+void FrameSource::Start()
+{
+	m_bStopRequested = false;
+	m_pThread = new std::thread([this] { threadFunc(); });
+}
+
+void FrameSource::Stop()
+{
+	if (m_pThread != NULL)
+	{
+		{
+			std::lock_guard<std::mutex> slotLock(m_slotMutex);
+			m_bStopRequested = true;
+		}
+		m_slotFreeCondVar.notify_all();
+		m_pThread->join();
+		delete m_pThread;
+		m_pThread = NULL;
+	}
+}
+
+// Must be called with m_slotMutex held
+int FrameSource::ReadyCount()
+{
+	int count = 0;
+
+	for (auto& slot : m_slots)
+	{
+		if (slot.m_state == SLOT_READY)
+		{
+			count++;
+		}
+	}
+
+	return count;
+}
+
+void FrameSource::threadFunc()
+{
+	while (true)
+	{
+		SSlot* pSlot;
+
+		// Wait until the slot we need to write next has been released by the consumer
+		{
+			std::unique_lock<std::mutex> slotLock(m_slotMutex);
+
+			if (m_slots[m_writeSlot].m_state != SLOT_FREE && !m_bStopRequested)
+			{
+				m_statDecoderStalls++;
+				m_slotFreeCondVar.wait(slotLock, [this] {
+					return m_bStopRequested || m_slots[m_writeSlot].m_state == SLOT_FREE;
+				});
+			}
+			if (m_bStopRequested)
+			{
+				break;
+			}
+			pSlot = &m_slots[m_writeSlot];
+		}
+
+		// Decode outside of the lock.  The slot is FREE so the consumer will not touch it and
+		// cv::VideoCapture::read reuses the slot memory when the frame size does not change.
+#ifdef VTUNE_API
+		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_FrameSource_decode);
+#endif
+		pSlot->m_decodeStartTime = std::chrono::high_resolution_clock::now();
+		bool bDecoded = m_capture.read(pSlot->m_image);
+		if (!bDecoded)
+		{
+			// Loop back to the start of the video so benchmark runs can request more iterations
+			// than the video has frames
+			m_capture.set(cv::CAP_PROP_POS_FRAMES, 0);
+			bDecoded = m_capture.read(pSlot->m_image);
+		}
+		pSlot->m_decodeEndTime = std::chrono::high_resolution_clock::now();
+#ifdef VTUNE_API
+		__itt_task_end(pittTests_domain);
+#endif
+
+		{
+			std::lock_guard<std::mutex> slotLock(m_slotMutex);
+
+			if (bDecoded && !pSlot->m_image.empty())
+			{
+				pSlot->m_frameNumber = m_framesDecoded++;
+				pSlot->m_state = SLOT_READY;
+				m_writeSlot = (m_writeSlot + 1) % (int)m_slots.size();
+			}
+			else
+			{
+				m_bEndOfStream = true;
+			}
+		}
+		m_frameReadyCondVar.notify_one();
+
+		if (!bDecoded)
+		{
+			std::cout << "FrameSource: unable to decode a frame from " << m_filename << std::endl;
+			break;
+		}
+	}
+}
+
+bool FrameSource::AcquireFrame(SFrameHandle& handle)
+{
+	bool bRetVal = false;
+	std::unique_lock<std::mutex> slotLock(m_slotMutex);
+
+	if (m_slots[m_readSlot].m_state != SLOT_READY && !m_bEndOfStream)
+	{
+		// The decoder has not kept up with the consumer
+		m_statConsumerStalls++;
+		m_frameReadyCondVar.wait(slotLock, [this] {
+			return m_bEndOfStream || m_slots[m_readSlot].m_state == SLOT_READY;
+		});
+	}
+
+	SSlot& slot = m_slots[m_readSlot];
+
+	if (slot.m_state == SLOT_READY)
+	{
+		m_statAcquires++;
+		m_statQueueDepthSum += ReadyCount();
+
+		slot.m_state = SLOT_IN_USE;
+		handle.m_slot = m_readSlot;
+		handle.m_frameNumber = slot.m_frameNumber;
+		handle.m_image = slot.m_image;
+		handle.m_decodeStartTime = slot.m_decodeStartTime;
+		handle.m_decodeEndTime = slot.m_decodeEndTime;
+		m_readSlot = (m_readSlot + 1) % (int)m_slots.size();
+		bRetVal = true;
+	}
+
+	return bRetVal;
+}
+
+void FrameSource::ReleaseFrame(SFrameHandle& handle)
+{
+	if (handle.m_slot >= 0)
+	{
+		{
+			std::lock_guard<std::mutex> slotLock(m_slotMutex);
+
+			m_slots[handle.m_slot].m_state = SLOT_FREE;
+		}
+		m_slotFreeCondVar.notify_one();
+		handle.m_slot = -1;
+		handle.m_frameNumber = -1;
+		handle.m_image = cv::Mat();
+	}
+}
+
+int FrameSource::GetQueueDepth()
+{
+	return (int)m_slots.size();
+}
+
+void FrameSource::ResetStats()
+{
+	std::lock_guard<std::mutex> slotLock(m_slotMutex);
+
+	m_statAcquires = 0;
+	m_statQueueDepthSum = 0;
+	m_statConsumerStalls = 0;
+	m_statDecoderStalls = 0;
+}
+
+std::string FrameSource::GetStatsString()
+{
+	char line[1024];
+	std::lock_guard<std::mutex> slotLock(m_slotMutex);
+	double aveDepth = 0.0;
+
+	if (m_statAcquires > 0)
+	{
+		aveDepth = (double)m_statQueueDepthSum / (double)m_statAcquires;
+	}
+	sprintf(line, "Frame source,%lld,frames acquired,%8.3f,average decoded frames queued of,%d,slots,%lld,consumer stalls,%lld,decoder stalls\n",
+		m_statAcquires, aveDepth, (int)m_slots.size(), m_statConsumerStalls, m_statDecoderStalls);
+
+	return line;
+}
@@ -0,0 +1,117 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// FrameSource decodes a video file (anything cv::VideoCapture can open) on a dedicated thread into a
+// bounded ring of frame slots.  The main loop acquires decoded frames by handle, hands the image to the
+// algorithms through SParameters::m_image, and releases the handle once the algorithms can no longer
+// reference the frame.  This replaces the two still images that --deltaImage flips between when a
+// real 360 video should be used.
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "opencv2/core/core.hpp"
+#include "opencv2/videoio.hpp"
+
+// The consumer holds up to two frames (one per SParameters::m_image entry) so at least one more slot
+// is needed for the decoder to make progress.
+const int MIN_FRAME_QUEUE_DEPTH = 3;
+
+struct SFrameHandle {
+	// m_slot is the index of the ring buffer slot holding the frame or -1 if the handle is empty
+	int			m_slot;
+	// m_frameNumber counts the frames decoded since the source was opened (it keeps counting when
+	// the video loops back to the beginning)
+	long long	m_frameNumber;
+	// m_image is a view on the slot memory.  It is only valid until the handle is released.
+	cv::Mat		m_image;
+	std::chrono::high_resolution_clock::time_point m_decodeStartTime;
+	std::chrono::high_resolution_clock::time_point m_decodeEndTime;
+
+	SFrameHandle()
+	{
+		m_slot = -1;
+		m_frameNumber = -1;
+	}
+};
+
+class FrameSource {
+private:
+	enum ESlotState {
+		SLOT_FREE = 0,
+		SLOT_READY,
+		SLOT_IN_USE
+	};
+
+	struct SSlot {
+		cv::Mat		m_image;
+		ESlotState	m_state;
+		long long	m_frameNumber;
+		std::chrono::high_resolution_clock::time_point m_decodeStartTime;
+		std::chrono::high_resolution_clock::time_point m_decodeEndTime;
+	};
+
+	std::string m_filename;
+	cv::VideoCapture m_capture;
+	std::vector<SSlot> m_slots;
+	// m_writeSlot is the next slot the decoder fills and m_readSlot is the next slot handed to the
+	// consumer.  Slots are filled and consumed in ring order.
+	int m_writeSlot;
+	int m_readSlot;
+	long long m_framesDecoded;
+	bool m_bEndOfStream;
+	bool m_bStopRequested;
+	std::thread* m_pThread;
+	std::mutex m_slotMutex;
+	std::condition_variable m_frameReadyCondVar;
+	std::condition_variable m_slotFreeCondVar;
+
+	// Statistics since the last ResetStats
+	long long m_statAcquires;
+	long long m_statQueueDepthSum;
+	long long m_statConsumerStalls;
+	long long m_statDecoderStalls;
+
+private:
+	// Function to run in the decode thread
+	void threadFunc();
+	int ReadyCount();
+
+public:
+	FrameSource(const char* pFilename, int queueDepth);
+	~FrameSource();
+
+	bool Open();
+	// SetAllocator makes the slot images allocate through pAllocator (e.g., pinned memory).  Must be
+	// called before Start.
+	void SetAllocator(cv::MatAllocator* pAllocator);
+	void Start();
+	void Stop();
+
+	// AcquireFrame blocks until the next decoded frame is available.  Returns false if the stream
+	// ended and no more frames will arrive.
+	bool AcquireFrame(SFrameHandle& handle);
+	// ReleaseFrame gives the slot back to the decoder.  The handle is emptied.
+	void ReleaseFrame(SFrameHandle& handle);
+
+	int GetQueueDepth();
+	void ResetStats();
+	std::string GetStatsString();
+};
@@ -0,0 +1,257 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "HugePageAllocator.hpp"
+#include <iostream>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+HugePageAllocator* HugePageAllocator::c_pHugePageAllocator = NULL;
+std::mutex HugePageAllocator::c_allocationsMutex;
+std::map<void*, HugePageAllocator::SHugeAllocation> HugePageAllocator::c_allocations;
+long long HugePageAllocator::c_statAllocations[HUGE_PAGE_KIND_MAX] = { 0 };
+size_t HugePageAllocator::c_statBytes[HUGE_PAGE_KIND_MAX] = { 0 };
+
+#ifdef _WIN32
+// EnableLockMemoryPrivilege turns on SeLockMemoryPrivilege, which MEM_LARGE_PAGES needs, for the process.  A
+// privilege can only be enabled if the account holds it, which AdjustTokenPrivileges reports as
+// ERROR_NOT_ALL_ASSIGNED rather than as a failure.
+static bool EnableLockMemoryPrivilege()
+{
+	HANDLE hToken = NULL;
+	TOKEN_PRIVILEGES privileges;
+	bool bRetVal = false;
+
+	if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &hToken))
+	{
+		return false;
+	}
+	privileges.PrivilegeCount = 1;
+	privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+	if (LookupPrivilegeValue(NULL, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid) &&
+		AdjustTokenPrivileges(hToken, FALSE, &privileges, 0, NULL, NULL))
+	{
+		bRetVal = GetLastError() == ERROR_SUCCESS;
+	}
+	CloseHandle(hToken);
+
+	return bRetVal;
+}
+#endif
+
+void HugePageAllocator::Initialize()
+{
+	if (c_pHugePageAllocator == NULL)
+	{
+#ifdef _WIN32
+		if (!EnableLockMemoryPrivilege())
+		{
+			std::cout << "HugePageAllocator: the \"Lock pages in memory\" privilege is not granted to this account, so normal pages will be used" << std::endl;
+		}
+#endif
+		c_pHugePageAllocator = new HugePageAllocator();
+	}
+}
+
+HugePageAllocator* HugePageAllocator::GetHugePageAllocator()
+{
+	return c_pHugePageAllocator;
+}
+
+void HugePageAllocator::Terminate()
+{
+	// Any cv::Mat still using the allocator must be released before this is called
+	delete c_pHugePageAllocator;
+	c_pHugePageAllocator = NULL;
+}
+
+void* HugePageAllocator::Allocate(size_t bytes)
+{
+	size_t rounded = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+	void* pMemory = NULL;
+	EHugePageKind kind = HUGE_PAGE_EXPLICIT;
+
+#ifdef _WIN32
+	size_t largePage = GetLargePageMinimum();
+
+	if (largePage > 0)
+	{
+		size_t largeRounded = (bytes + largePage - 1) / largePage * largePage;
+
+		pMemory = VirtualAlloc(NULL, largeRounded, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		rounded = largeRounded;
+	}
+	if (pMemory == NULL)
+	{
+		kind = HUGE_PAGE_FALLBACK;
+		pMemory = VirtualAlloc(NULL, rounded, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	}
+#else
+	pMemory = mmap(NULL, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (pMemory == MAP_FAILED)
+	{
+		// No reserved huge pages, so map an extra huge page and trim to a 2 MB aligned range that transparent huge
+		// pages can back
+		unsigned char* pMapped = (unsigned char*)mmap(NULL, rounded + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		pMemory = NULL;
+		if (pMapped != MAP_FAILED)
+		{
+			unsigned char* pAligned = (unsigned char*)(((uintptr_t)pMapped + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+
+			if (pAligned > pMapped)
+			{
+				munmap(pMapped, pAligned - pMapped);
+			}
+			munmap(pAligned + rounded, (pMapped + HUGE_PAGE_SIZE) - pAligned);
+			pMemory = pAligned;
+			kind = madvise(pMemory, rounded, MADV_HUGEPAGE) == 0 ? HUGE_PAGE_TRANSPARENT : HUGE_PAGE_FALLBACK;
+		}
+	}
+#endif
+	if (pMemory == NULL)
+	{
+		std::cout << "HugePageAllocator: allocation of " << bytes << " bytes failed" << std::endl;
+		throw std::bad_alloc();
+	}
+
+	std::lock_guard<std::mutex> allocationsLock(c_allocationsMutex);
+
+	c_allocations[pMemory] = { rounded, kind };
+	c_statAllocations[kind]++;
+	c_statBytes[kind] += rounded;
+
+	return pMemory;
+}
+
+bool HugePageAllocator::Free(void* pMemory)
+{
+	if (pMemory == NULL)
+	{
+		return false;
+	}
+
+	size_t bytes = 0;
+
+	{
+		std::lock_guard<std::mutex> allocationsLock(c_allocationsMutex);
+		auto allocation = c_allocations.find(pMemory);
+
+		if (allocation == c_allocations.end())
+		{
+			return false;
+		}
+		bytes = allocation->second.m_bytes;
+		c_allocations.erase(allocation);
+	}
+#ifdef _WIN32
+	VirtualFree(pMemory, 0, MEM_RELEASE);
+#else
+	munmap(pMemory, bytes);
+#endif
+
+	return true;
+}
+
+void HugePageAllocator::Advise(void* pMemory, size_t bytes)
+{
+#ifndef _WIN32
+	uintptr_t start = ((uintptr_t)pMemory + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+	uintptr_t end = ((uintptr_t)pMemory + bytes) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+
+	if (end > start)
+	{
+		madvise((void*)start, end - start, MADV_HUGEPAGE);
+	}
+#endif
+}
+
+std::string HugePageAllocator::GetStatsString()
+{
+	char line[512];
+	std::lock_guard<std::mutex> allocationsLock(c_allocationsMutex);
+
+	sprintf(line, "Huge pages,%lld,explicit allocations,%8.1f,MB,%lld,transparent allocations,%8.1f,MB,%lld,fallback allocations,%8.1f,MB\n",
+		c_statAllocations[HUGE_PAGE_EXPLICIT], c_statBytes[HUGE_PAGE_EXPLICIT] / (1024.0 * 1024.0),
+		c_statAllocations[HUGE_PAGE_TRANSPARENT], c_statBytes[HUGE_PAGE_TRANSPARENT] / (1024.0 * 1024.0),
+		c_statAllocations[HUGE_PAGE_FALLBACK], c_statBytes[HUGE_PAGE_FALLBACK] / (1024.0 * 1024.0));
+
+	return line;
+}
+
+// This follows cv::StdMatAllocator with Allocate in place of cv::fastMalloc
+cv::UMatData* HugePageAllocator::allocate(int dims, const int* sizes, int type, void* data0, size_t* step, cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const
+{
+	size_t total = CV_ELEM_SIZE(type);
+
+	for (int i = dims - 1; i >= 0; i--)
+	{
+		if (step)
+		{
+			if (data0 && step[i] != CV_AUTOSTEP)
+			{
+				CV_Assert(total <= step[i]);
+				total = step[i];
+			}
+			else
+			{
+				step[i] = total;
+			}
+		}
+		total *= sizes[i];
+	}
+
+	unsigned char* data = (unsigned char*)data0;
+	if (data == NULL)
+	{
+		data = (unsigned char*)Allocate(total);
+	}
+
+	cv::UMatData* u = new cv::UMatData(this);
+	u->data = u->origdata = data;
+	u->size = total;
+	if (data0)
+	{
+		u->flags |= cv::UMatData::USER_ALLOCATED;
+	}
+
+	return u;
+}
+
+bool HugePageAllocator::allocate(cv::UMatData* u, cv::AccessFlag accessflags, cv::UMatUsageFlags usageFlags) const
+{
+	return u != NULL;
+}
+
+void HugePageAllocator::deallocate(cv::UMatData* u) const
+{
+	if (u != NULL)
+	{
+		CV_Assert(u->urefcount == 0);
+		CV_Assert(u->refcount == 0);
+		if (!(u->flags & cv::UMatData::USER_ALLOCATED))
+		{
+			Free(u->origdata);
+			u->origdata = NULL;
+		}
+		delete u;
+	}
+}
@@ -0,0 +1,73 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// HugePageAllocator backs cv::Mat images (sources and output) and raw buffers (maps) with 2 MB pages so gathers that
+// jump between distant rows of a large source, and walks over a large map, need far fewer TLB entries.  Each
+// allocation first tries explicit huge pages (MAP_HUGETLB on Linux, MEM_LARGE_PAGES on Windows), which need pages
+// reserved by the administrator (vm.nr_hugepages) or the "Lock pages in memory" privilege.  On Windows Initialize
+// enables SeLockMemoryPrivilege in the process token, but the account must already have been granted it (Local
+// Security Policy, User Rights Assignment, then sign in again); otherwise every allocation falls back to normal
+// pages.  On Linux it then falls back to 2 MB aligned memory advised for transparent huge pages (madvise
+// MADV_HUGEPAGE), and finally to normal pages.  The statistics tell which kind each allocation got.
+
+#include <map>
+#include <mutex>
+#include <string>
+#include "opencv2/core/core.hpp"
+
+const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+enum EHugePageKind {
+	HUGE_PAGE_EXPLICIT = 0,
+	HUGE_PAGE_TRANSPARENT,
+	HUGE_PAGE_FALLBACK,
+	HUGE_PAGE_KIND_MAX
+};
+
+class HugePageAllocator : public cv::MatAllocator {
+private:
+	struct SHugeAllocation {
+		size_t			m_bytes;
+		EHugePageKind	m_kind;
+	};
+
+	static HugePageAllocator* c_pHugePageAllocator;
+	static std::mutex c_allocationsMutex;
+	static std::map<void*, SHugeAllocation> c_allocations;
+	static long long c_statAllocations[HUGE_PAGE_KIND_MAX];
+	static size_t c_statBytes[HUGE_PAGE_KIND_MAX];
+
+public:
+	static void Initialize();
+	// GetHugePageAllocator returns NULL if Initialize was not called (--hugePages not given)
+	static HugePageAllocator* GetHugePageAllocator();
+	static void Terminate();
+
+	// Allocate returns huge page backed memory (rounded up to whole huge pages) or throws std::bad_alloc
+	static void* Allocate(size_t bytes);
+	// Free releases memory from Allocate.  Returns false (and does nothing) if pMemory did not come from Allocate.
+	static bool Free(void* pMemory);
+	// Advise asks for transparent huge pages on the whole huge pages inside memory allocated elsewhere (e.g., host
+	// USM or untouched NUMA memory).  Pages that are already touched may not be promoted.
+	static void Advise(void* pMemory, size_t bytes);
+
+	static std::string GetStatsString();
+
+	virtual cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step, cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const;
+	virtual bool allocate(cv::UMatData* data, cv::AccessFlag accessflags, cv::UMatUsageFlags usageFlags) const;
+	virtual void deallocate(cv::UMatData* data) const;
+};
@@ -0,0 +1,148 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "KernelWarmup.hpp"
+#include "ConfigurableDeviceSelector.hpp"
+#include "DeviceRegistry.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+
+std::mutex KernelWarmup::c_warmupsMutex;
+std::vector<KernelWarmup::SDeviceWarmup*> KernelWarmup::c_warmups;
+
+void KernelWarmup::EnablePersistentCache()
+{
+	if (getenv("SYCL_CACHE_PERSISTENT") == NULL)
+	{
+#ifdef _WIN32
+		_putenv_s("SYCL_CACHE_PERSISTENT", "1");
+#else
+		setenv("SYCL_CACHE_PERSISTENT", "1", 0);
+#endif
+	}
+}
+
+void KernelWarmup::Start(SParameters& parameters)
+{
+	std::vector<sycl::device> devices;
+	std::lock_guard<std::mutex> warmupsLock(c_warmupsMutex);
+
+	try {
+		if (parameters.m_platformName == "all" || parameters.m_deviceName == "all")
+		{
+			devices = sycl::device::get_devices();
+		}
+		else
+		{
+			devices.push_back(DeviceRegistry::SelectDevice(parameters.m_typePreference, parameters.m_platformName, parameters.m_deviceName, parameters.m_driverVersion));
+		}
+	}
+	catch (sycl::exception const& e) {
+		printf("Kernel warmup could not select a device: %s\n", e.what());
+	}
+	for (auto& device : devices)
+	{
+		SDeviceWarmup* pWarmup = new SDeviceWarmup(device);
+
+		c_warmups.push_back(pWarmup);
+		pWarmup->m_pThread = new std::thread(threadFunc, pWarmup);
+	}
+}
+
+void KernelWarmup::threadFunc(SDeviceWarmup* pWarmup)
+{
+	std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+
+	try {
+		DeviceRegistry::BuildKernels(pWarmup->m_device);
+	}
+	catch (sycl::exception const& e) {
+		pWarmup->m_error = e.what();
+	}
+	pWarmup->m_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+void KernelWarmup::WaitFor(SDeviceWarmup* pWarmup)
+{
+	if (pWarmup->m_pThread != NULL)
+	{
+		pWarmup->m_pThread->join();
+		delete pWarmup->m_pThread;
+		pWarmup->m_pThread = NULL;
+	}
+}
+
+void KernelWarmup::WaitForDevice(const sycl::device& device)
+{
+	std::lock_guard<std::mutex> warmupsLock(c_warmupsMutex);
+
+	for (auto pWarmup : c_warmups)
+	{
+		if (pWarmup->m_device == device)
+		{
+			WaitFor(pWarmup);
+		}
+	}
+}
+
+void KernelWarmup::Terminate()
+{
+	std::lock_guard<std::mutex> warmupsLock(c_warmupsMutex);
+
+	for (auto pWarmup : c_warmups)
+	{
+		WaitFor(pWarmup);
+		delete pWarmup;
+	}
+	c_warmups.clear();
+}
+
+const char* KernelWarmup::GetKernelCompilation()
+{
+#ifdef SYCL_AOT_KERNELS
+	return "ahead of time";
+#else
+	return "just in time";
+#endif
+}
+
+std::string KernelWarmup::GetStatsString()
+{
+	std::lock_guard<std::mutex> warmupsLock(c_warmupsMutex);
+	std::string retVal;
+	char line[1024];
+
+	for (auto pWarmup : c_warmups)
+	{
+		WaitFor(pWarmup);
+		if (pWarmup->m_error.empty())
+		{
+			sprintf(line, "Kernel warmup, %s, %10.3f,ms, %s kernels\n", ConfigurableDeviceSelector::get_device_description(pWarmup->m_device).c_str(),
+				pWarmup->m_seconds * 1000.0, GetKernelCompilation());
+		}
+		else
+		{
+			// The error text can be long, so it is not formatted into line
+			sprintf(line, "Kernel warmup, %s, failed after %.3f ms: ", ConfigurableDeviceSelector::get_device_description(pWarmup->m_device).c_str(),
+				pWarmup->m_seconds * 1000.0);
+			retVal += line;
+			sprintf(line, "\n");
+			retVal += pWarmup->m_error;
+		}
+		retVal += line;
+	}
+
+	return retVal;
+}
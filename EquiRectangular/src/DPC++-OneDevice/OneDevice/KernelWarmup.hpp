@@ -0,0 +1,74 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// KernelWarmup gets the DPC++ devices ready at startup, one thread per selected device, while the main thread loads
+// the images.  Without it the first StartVariant and first frame on a device pay for bringing up the backend,
+// creating the context, and JIT compiling the kernels (seconds on the CPU device).  Each thread has the
+// DeviceRegistry build the executable kernel bundle (every kernel of every algorithm) in its device's context, the
+// context the algorithms' queues come from, so they find the kernels already built.  The persistent kernel cache
+// (SYCL_CACHE_PERSISTENT) is also turned on, unless the environment already sets it, so later runs load the JIT
+// results from disk.
+//
+// With ahead of time compiled kernels (SyclAotTargets in OneDevice.vcxproj, which defines SYCL_AOT_KERNELS) the
+// targets that were compiled ahead of time have nothing to JIT and the warmup only brings the devices up.
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sycl/sycl.hpp>
+#include "ParseArgs.hpp"
+
+class KernelWarmup {
+private:
+	struct SDeviceWarmup {
+		sycl::device	m_device;
+		std::thread*	m_pThread;
+		double			m_seconds;
+		std::string		m_error;
+
+		SDeviceWarmup(const sycl::device& device) : m_device(device)
+		{
+			m_pThread = NULL;
+			m_seconds = 0.0;
+		}
+	};
+
+	static std::mutex c_warmupsMutex;
+	static std::vector<SDeviceWarmup*> c_warmups;
+
+private:
+	// Function to run in each warmup thread
+	static void threadFunc(SDeviceWarmup* pWarmup);
+	// WaitFor waits for the device's warmup to finish.  Must be called with c_warmupsMutex held.
+	static void WaitFor(SDeviceWarmup* pWarmup);
+
+public:
+	// EnablePersistentCache must be called before the first DPC++ call to have any effect
+	static void EnablePersistentCache();
+	// Start begins warming up every device the parameters select (all devices with --deviceName=all or
+	// --platformName=all).  Call it after PinnedMatAllocator::Initialize so the pinned context is the one warmed up.
+	static void Start(SParameters& parameters);
+	// WaitForDevice waits for the device's warmup to finish (returns at once if the device is not being warmed up)
+	static void WaitForDevice(const sycl::device& device);
+	static void Terminate();
+
+	// GetKernelCompilation tells how the kernels in this build were compiled
+	static const char* GetKernelCompilation();
+	static std::string GetStatsString();
+};
@@ -0,0 +1,326 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+// The map math matches SerialRemappingV2::FrameCalculations (array of structures layout)
+
+#include "MapCache.hpp"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include "ParseArgs.hpp"
+#include <opencv2/calib3d.hpp>
+
+#ifdef VTUNE_API
+#include "ittnotify.h"
+#pragma comment(lib, "libittnotify.lib")
+extern __itt_domain *pittTests_domain;
+// Create string handle for denoting when a speculative map is computed
+wchar_t const *pMapCacheSpeculate = _T("MapCache Speculate");
+__itt_string_handle *handle_MapCache_speculate = __itt_string_handle_create(pMapCacheSpeculate);
+#endif
+
+MapCache::MapCache(size_t capacity, int speculationThreads)
+{
+	m_capacity = std::max(capacity, (size_t)1);
+	m_bStopRequested = false;
+	m_speculationThreads = speculationThreads;
+	m_useCounter = 0;
+	m_statRequests = 0;
+	m_statHits = 0;
+	m_statSpeculativeHits = 0;
+	m_statInFlightHits = 0;
+	m_statMisses = 0;
+	m_statSpeculated = 0;
+	m_statWasted = 0;
+	m_statComputed = 0;
+	m_statComputeSum = std::chrono::duration<double>(0);
+	m_statWaitSum = std::chrono::duration<double>(0);
+
+	for (int thread = 0; thread < speculationThreads; thread++)
+	{
+		m_threads.push_back(new std::thread(&MapCache::speculationThreadFunc, this));
+	}
+}
+
+MapCache::~MapCache()
+{
+	Stop();
+}
+
+void MapCache::Stop()
+{
+	{
+		std::lock_guard<std::mutex> cacheLock(m_cacheMutex);
+
+		m_bStopRequested = true;
+		m_speculationQueue.clear();
+	}
+	m_speculationQueuedCondVar.notify_all();
+	for (auto pThread : m_threads)
+	{
+		pThread->join();
+		delete pThread;
+	}
+	m_threads.clear();
+}
+
+int MapCache::GetDefaultSpeculationThreads()
+{
+	int threads = (int)std::thread::hardware_concurrency() / 2;
+
+	return std::max(1, std::min(threads, MAX_SPECULATION_THREADS));
+}
+
+void MapCache::ComputeMap(const SMapKey& key, std::vector<Point2D>& map)
+{
+	// Compute a matrix representing the three rotations (see SerialRemappingV2::ComputeRotationMatrix)
+	cv::Mat x_axis = (cv::Mat_<float>(3, 1) << 1, 0, 0);
+	cv::Mat y_axis = (cv::Mat_<float>(3, 1) << 0, 1, 0);
+	cv::Mat z_axis = (cv::Mat_<float>(3, 1) << 0, 0, 1);
+	cv::Mat Rx;
+	cv::Mat Ry;
+	cv::Mat Rz;
+	cv::Mat R;
+
+	cv::Rodrigues(y_axis * ((float)key.m_yaw * DEGREE_CONVERSION_FACTOR), Ry);
+	cv::Rodrigues(Ry * x_axis * ((float)key.m_pitch * DEGREE_CONVERSION_FACTOR), Rx);
+	cv::Rodrigues(Rx * Ry * z_axis * ((float)key.m_roll * DEGREE_CONVERSION_FACTOR), Rz);
+	R = Rz * Rx * Ry;
+
+	float m00 = R.at<float>(0, 0);
+	float m01 = R.at<float>(0, 1);
+	float m02 = R.at<float>(0, 2);
+	float m10 = R.at<float>(1, 0);
+	float m11 = R.at<float>(1, 1);
+	float m12 = R.at<float>(1, 2);
+	float m20 = R.at<float>(2, 0);
+	float m21 = R.at<float>(2, 1);
+	float m22 = R.at<float>(2, 2);
+	float imageWidth = key.m_imageWidth - 1;
+	float imageHeight = key.m_imageHeight - 1;
+	float xDiv = 2 * M_PI;
+	float f = 0.5 * key.m_widthOutput * 1 / tan(0.5 * key.m_fov / 180.0 * M_PI);
+	float cx = ((float)key.m_widthOutput - 1.0f) / 2.0f;
+	float cy = ((float)key.m_heightOutput - 1.0f) / 2.0f;
+	float invf = 1.0f / f;
+	float translatecx = -cx * invf;
+	float translatecy = -cy * invf;
+
+	map.resize((size_t)key.m_widthOutput * key.m_heightOutput);
+
+	Point2D *pPoints = map.data();
+
+	for (int row = 0; row < key.m_heightOutput; row++)
+	{
+		for (int col = 0; col < key.m_widthOutput; col++)
+		{
+			float eX = col * invf + translatecx;
+			float eY = row * invf + translatecy;
+			float eZ = 1.0f;
+			float x = eX * m00 + eY * m01 + eZ * m02;
+			float y = eX * m10 + eY * m11 + eZ * m12;
+			float z = eX * m20 + eY * m21 + eZ * m22;
+			float norm = sqrt(x * x + y * y + z * z);
+
+			x = atan2(x / norm, z / norm);
+			y = asin(y / norm);
+
+			pPoints->m_x = (x / xDiv + 0.5) * imageWidth;
+			pPoints->m_y = (y / M_PI + 0.5) * imageHeight;
+
+			pPoints++;
+		}
+	}
+}
+
+void MapCache::MakeRoom()
+{
+	while (m_entries.size() >= m_capacity)
+	{
+		auto oldest = m_entries.end();
+
+		for (auto entry = m_entries.begin(); entry != m_entries.end(); entry++)
+		{
+			// Maps still being computed or still wanted by a waiting GetMap cannot be evicted
+			if (entry->second.m_bReady && entry->second.m_waiters == 0 && (oldest == m_entries.end() || entry->second.m_lastUse < oldest->second.m_lastUse))
+			{
+				oldest = entry;
+			}
+		}
+		if (oldest == m_entries.end())
+		{
+			// Everything is in flight so go over capacity for now
+			break;
+		}
+		if (oldest->second.m_bSpeculative && !oldest->second.m_bUsed)
+		{
+			m_statWasted++;
+		}
+		m_entries.erase(oldest);
+	}
+}
+
+void MapCache::ComputeEntry(const SMapKey& key, std::unique_lock<std::mutex>& cacheLock)
+{
+	MapPtr pMap = std::make_shared<std::vector<Point2D>>();
+	std::chrono::high_resolution_clock::time_point startTime;
+	std::chrono::high_resolution_clock::time_point endTime;
+
+	cacheLock.unlock();
+	startTime = std::chrono::high_resolution_clock::now();
+	ComputeMap(key, *pMap);
+	endTime = std::chrono::high_resolution_clock::now();
+	cacheLock.lock();
+
+	SMapEntry& entry = m_entries[key];
+
+	entry.m_pMap = pMap;
+	entry.m_bReady = true;
+	// The map was just needed (or guessed to be needed) so it is the last to go if room must be made
+	entry.m_lastUse = ++m_useCounter;
+	m_statComputed++;
+	m_statComputeSum += endTime - startTime;
+	m_mapReadyCondVar.notify_all();
+}
+
+MapPtr MapCache::GetMap(const SMapKey& key)
+{
+	std::unique_lock<std::mutex> cacheLock(m_cacheMutex);
+	auto found = m_entries.find(key);
+
+	m_statRequests++;
+	if (found == m_entries.end())
+	{
+		auto queued = std::find(m_speculationQueue.begin(), m_speculationQueue.end(), key);
+
+		if (queued != m_speculationQueue.end())
+		{
+			m_speculationQueue.erase(queued);
+		}
+		MakeRoom();
+		m_entries[key] = { nullptr, false, false, true, ++m_useCounter, 0 };
+		ComputeEntry(key, cacheLock);
+		// The entry was not ready while the lock was released, so it could not have been evicted
+		found = m_entries.find(key);
+		m_statMisses++;
+	}
+	else if (!found->second.m_bReady)
+	{
+		std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+
+		// Pin the entry so a speculation thread making room cannot evict it before this thread wakes up
+		found->second.m_waiters++;
+		m_mapReadyCondVar.wait(cacheLock, [this, &key] { return m_entries.find(key)->second.m_bReady; });
+		found = m_entries.find(key);
+		found->second.m_waiters--;
+		m_statWaitSum += std::chrono::high_resolution_clock::now() - startTime;
+		m_statInFlightHits++;
+	}
+	else
+	{
+		m_statHits++;
+		if (found->second.m_bSpeculative && !found->second.m_bUsed)
+		{
+			m_statSpeculativeHits++;
+		}
+	}
+
+	// Take the shared_ptr while the lock is held so the map outlives a later eviction of the entry
+	MapPtr pMap = found->second.m_pMap;
+
+	found->second.m_bUsed = true;
+	found->second.m_lastUse = ++m_useCounter;
+
+	return pMap;
+}
+
+void MapCache::Speculate(const std::vector<SMapKey>& keys)
+{
+	if (m_threads.empty())
+	{
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> cacheLock(m_cacheMutex);
+
+		// Earlier guesses that were not started are stale now that the viewer has moved
+		m_speculationQueue.clear();
+		for (auto& key : keys)
+		{
+			if (m_entries.find(key) == m_entries.end())
+			{
+				m_speculationQueue.push_back(key);
+			}
+		}
+	}
+	m_speculationQueuedCondVar.notify_all();
+}
+
+void MapCache::speculationThreadFunc()
+{
+	std::unique_lock<std::mutex> cacheLock(m_cacheMutex);
+
+	while (!m_bStopRequested)
+	{
+		m_speculationQueuedCondVar.wait(cacheLock, [this] { return m_bStopRequested || !m_speculationQueue.empty(); });
+		if (m_bStopRequested)
+		{
+			break;
+		}
+
+		SMapKey key = m_speculationQueue.front();
+
+		m_speculationQueue.pop_front();
+		if (m_entries.find(key) != m_entries.end())
+		{
+			continue;
+		}
+#ifdef VTUNE_API
+		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_MapCache_speculate);
+#endif
+		MakeRoom();
+		m_entries[key] = { nullptr, false, true, false, ++m_useCounter, 0 };
+		m_statSpeculated++;
+		ComputeEntry(key, cacheLock);
+#ifdef VTUNE_API
+		__itt_task_end(pittTests_domain);
+#endif
+	}
+}
+
+std::string MapCache::GetStatsString()
+{
+	char line[1024];
+	std::lock_guard<std::mutex> cacheLock(m_cacheMutex);
+	double hitRate = 0.0;
+	double aveComputeMs = 0.0;
+	double savedMs = 0.0;
+
+	if (m_statRequests > 0)
+	{
+		hitRate = (double)(m_statHits + m_statInFlightHits) * 100.0 / (double)m_statRequests;
+	}
+	if (m_statComputed > 0)
+	{
+		aveComputeMs = m_statComputeSum.count() * 1000.0 / (double)m_statComputed;
+	}
+	// Each hit saves a map computation on the render thread; waiting for an in flight map saves the rest of it
+	savedMs = aveComputeMs * (double)(m_statHits + m_statInFlightHits) - m_statWaitSum.count() * 1000.0;
+	sprintf(line, "Map cache,%lld,requests,%8.3f,%% hit rate,%lld,hits,%lld,speculative hits,%lld,in flight hits,%lld,misses,%lld,speculated,%lld,wasted,%8.3f,ms average compute,%8.3f,ms waited,%8.3f,ms latency saved,%d,speculation threads\n",
+		m_statRequests, hitRate, m_statHits, m_statSpeculativeHits, m_statInFlightHits, m_statMisses, m_statSpeculated, m_statWasted,
+		aveComputeMs, m_statWaitSum.count() * 1000.0, savedMs, m_speculationThreads);
+
+	return line;
+}
@@ -0,0 +1,125 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// MapCache holds the remap tables (one Point2D per output pixel) for the most recently used poses so returning to
+// a pose, or arriving at a pose that was computed ahead of time, skips the frame calculations.  Speculate queues
+// poses the viewer is likely to move to next (see PosePredictor) and the speculation threads compute them while
+// the render thread is idle.  A request for a map that is still being computed waits for it rather than starting
+// a second computation, and a request for a map that is only queued takes it off the queue and computes it
+// directly.
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include "Point2D.hpp"
+
+const size_t DEFAULT_MAP_CACHE_CAPACITY = 8;
+const int MAX_SPECULATION_THREADS = 4;
+
+struct SMapKey {
+	int m_yaw;
+	int m_pitch;
+	int m_roll;
+	int m_fov;
+	int m_widthOutput;
+	int m_heightOutput;
+	int m_imageWidth;
+	int m_imageHeight;
+
+	bool operator<(const SMapKey& a) const
+	{
+		return std::tie(m_yaw, m_pitch, m_roll, m_fov, m_widthOutput, m_heightOutput, m_imageWidth, m_imageHeight) <
+			std::tie(a.m_yaw, a.m_pitch, a.m_roll, a.m_fov, a.m_widthOutput, a.m_heightOutput, a.m_imageWidth, a.m_imageHeight);
+	}
+	bool operator==(const SMapKey& a) const
+	{
+		return !(*this < a) && !(a < *this);
+	}
+};
+
+typedef std::shared_ptr<std::vector<Point2D>> MapPtr;
+
+class MapCache {
+private:
+	struct SMapEntry {
+		MapPtr		m_pMap;
+		// m_bReady is false while the map is being computed
+		bool		m_bReady;
+		// m_bSpeculative is true if a speculation thread computed the map and m_bUsed once it has been requested
+		bool		m_bSpeculative;
+		bool		m_bUsed;
+		long long	m_lastUse;
+		// m_waiters counts the GetMap calls waiting for the map; an entry with waiters is never evicted
+		int			m_waiters;
+	};
+
+	size_t m_capacity;
+	std::map<SMapKey, SMapEntry> m_entries;
+	std::deque<SMapKey> m_speculationQueue;
+	std::vector<std::thread*> m_threads;
+	int m_speculationThreads;
+	bool m_bStopRequested;
+	long long m_useCounter;
+	std::mutex m_cacheMutex;
+	std::condition_variable m_speculationQueuedCondVar;
+	std::condition_variable m_mapReadyCondVar;
+
+	// Statistics since the cache was created
+	long long m_statRequests;
+	long long m_statHits;
+	long long m_statSpeculativeHits;
+	long long m_statInFlightHits;
+	long long m_statMisses;
+	long long m_statSpeculated;
+	long long m_statWasted;
+	long long m_statComputed;
+	std::chrono::duration<double> m_statComputeSum;
+	std::chrono::duration<double> m_statWaitSum;
+
+private:
+	// Function to run in each speculation thread
+	void speculationThreadFunc();
+	// ComputeEntry computes the map for an entry already inserted as not ready.  Call with cacheLock held; the lock
+	// is released during the computation.
+	void ComputeEntry(const SMapKey& key, std::unique_lock<std::mutex>& cacheLock);
+	// MakeRoom evicts the least recently used ready maps until a new entry fits.  Call with m_cacheMutex held.
+	void MakeRoom();
+
+public:
+	MapCache(size_t capacity, int speculationThreads);
+	~MapCache();
+
+	// GetMap returns the map for key, computing it on the calling thread if it is neither cached nor in progress
+	MapPtr GetMap(const SMapKey& key);
+	// Speculate replaces the queue of maps to compute ahead of time (most likely first)
+	void Speculate(const std::vector<SMapKey>& keys);
+	void Stop();
+
+	std::string GetStatsString();
+
+	// ComputeMap fills map with the source image coordinate for each output pixel of the pose in key
+	static void ComputeMap(const SMapKey& key, std::vector<Point2D>& map);
+	// GetDefaultSpeculationThreads returns half the hardware threads (at most MAX_SPECULATION_THREADS)
+	static int GetDefaultSpeculationThreads();
+};
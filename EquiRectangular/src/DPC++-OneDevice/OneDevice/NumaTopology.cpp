@@ -0,0 +1,262 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "NumaTopology.hpp"
+#include "HugePageAllocator.hpp"
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+NumaTopology* NumaTopology::c_pTopology = NULL;
+
+NumaTopology::NumaTopology()
+{
+	Discover();
+}
+
+NumaTopology* NumaTopology::GetTopology()
+{
+	if (c_pTopology == NULL)
+	{
+		c_pTopology = new NumaTopology();
+	}
+
+	return c_pTopology;
+}
+
+void NumaTopology::AddNode(int nodeId, const std::vector<int>& cpus)
+{
+	m_nodeCpus.push_back(cpus);
+	m_nodeIds.push_back(nodeId);
+}
+
+void NumaTopology::Discover()
+{
+#ifdef _WIN32
+	ULONG highestNode = 0;
+
+	if (GetNumaHighestNodeNumber(&highestNode))
+	{
+		for (USHORT node = 0; node <= highestNode; node++)
+		{
+			GROUP_AFFINITY affinity;
+			std::vector<int> cpus;
+
+			// Only the processors in the first processor group (64) can be pinned with SetThreadAffinityMask
+			if (GetNumaNodeProcessorMaskEx(node, &affinity) && affinity.Group == 0)
+			{
+				for (int cpu = 0; cpu < 64; cpu++)
+				{
+					if (affinity.Mask & ((KAFFINITY)1 << cpu))
+					{
+						cpus.push_back(cpu);
+					}
+				}
+			}
+			if (!cpus.empty())
+			{
+				AddNode(node, cpus);
+			}
+		}
+	}
+#else
+	// The node numbers can have gaps (e.g., after memory hot remove or on some multi socket systems), so list the
+	// node directories rather than counting up from node0
+	std::vector<int> nodeIds;
+	DIR* pDir = opendir("/sys/devices/system/node");
+
+	if (pDir != NULL)
+	{
+		struct dirent* pEntry;
+
+		while ((pEntry = readdir(pDir)) != NULL)
+		{
+			int nodeId;
+			char extra;
+
+			if (sscanf(pEntry->d_name, "node%d%c", &nodeId, &extra) == 1)
+			{
+				nodeIds.push_back(nodeId);
+			}
+		}
+		closedir(pDir);
+	}
+	std::sort(nodeIds.begin(), nodeIds.end());
+	for (int node : nodeIds)
+	{
+		char path[128];
+		char cpuList[4096];
+		FILE* pFile;
+		std::vector<int> cpus;
+
+		sprintf(path, "/sys/devices/system/node/node%d/cpulist", node);
+		pFile = fopen(path, "r");
+		if (pFile == NULL)
+		{
+			continue;
+		}
+		if (fgets(cpuList, sizeof(cpuList), pFile) != NULL)
+		{
+			// The list looks like 0-15,32-47
+			char* pRange = strtok(cpuList, ",\n");
+
+			while (pRange != NULL)
+			{
+				int first;
+				int last;
+				int fields = sscanf(pRange, "%d-%d", &first, &last);
+
+				if (fields == 1)
+				{
+					last = first;
+				}
+				for (int cpu = first; fields >= 1 && cpu <= last; cpu++)
+				{
+					cpus.push_back(cpu);
+				}
+				pRange = strtok(NULL, ",\n");
+			}
+		}
+		fclose(pFile);
+		// Nodes with memory but no processors (e.g., CXL or HBM only nodes) cannot run workers
+		if (!cpus.empty())
+		{
+			AddNode(node, cpus);
+		}
+	}
+#endif
+	if (m_nodeCpus.empty())
+	{
+		std::vector<int> cpus;
+		int threads = (int)std::thread::hardware_concurrency();
+
+		for (int cpu = 0; cpu < (threads > 0 ? threads : 1); cpu++)
+		{
+			cpus.push_back(cpu);
+		}
+		AddNode(0, cpus);
+	}
+}
+
+int NumaTopology::GetNodeCount()
+{
+	return (int)m_nodeCpus.size();
+}
+
+const std::vector<int>& NumaTopology::GetNodeCpus(int node)
+{
+	return m_nodeCpus[node % m_nodeCpus.size()];
+}
+
+void NumaTopology::PinCurrentThread(int node, int index)
+{
+	const std::vector<int>& cpus = GetNodeCpus(node);
+#ifdef _WIN32
+	DWORD_PTR mask = 0;
+
+	for (size_t cpu = 0; cpu < cpus.size(); cpu++)
+	{
+		if (index < 0 || (int)cpu == index % (int)cpus.size())
+		{
+			mask |= (DWORD_PTR)1 << cpus[cpu];
+		}
+	}
+	SetThreadAffinityMask(GetCurrentThread(), mask);
+#else
+	cpu_set_t cpuSet;
+
+	CPU_ZERO(&cpuSet);
+	for (size_t cpu = 0; cpu < cpus.size(); cpu++)
+	{
+		if (index < 0 || (int)cpu == index % (int)cpus.size())
+		{
+			CPU_SET(cpus[cpu], &cpuSet);
+		}
+	}
+	pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#endif
+}
+
+void* NumaTopology::AllocateUntouched(size_t bytes)
+{
+	if (HugePageAllocator::GetHugePageAllocator() != NULL)
+	{
+		return HugePageAllocator::Allocate(bytes);
+	}
+#ifdef _WIN32
+	return VirtualAlloc(NULL, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+	void* pMemory = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	return pMemory == MAP_FAILED ? NULL : pMemory;
+#endif
+}
+
+void* NumaTopology::AllocateOnNode(size_t bytes, int node)
+{
+#ifdef _WIN32
+	if (HugePageAllocator::GetHugePageAllocator() != NULL)
+	{
+		// Large pages cannot be requested per node here, so take them and let the first touch decide
+		return HugePageAllocator::Allocate(bytes);
+	}
+
+	return VirtualAllocExNuma(GetCurrentProcess(), NULL, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, (DWORD)m_nodeIds[node % m_nodeIds.size()]);
+#else
+	void* pMemory = AllocateUntouched(bytes);
+
+	if (pMemory != NULL)
+	{
+		// Touch every page from a thread running on the node so first touch places them there
+		std::thread toucher([this, pMemory, bytes, node]() {
+			long pageSize = sysconf(_SC_PAGESIZE);
+
+			PinCurrentThread(node, -1);
+			for (size_t offset = 0; offset < bytes; offset += pageSize)
+			{
+				((volatile char*)pMemory)[offset] = 0;
+			}
+		});
+		toucher.join();
+	}
+
+	return pMemory;
+#endif
+}
+
+void NumaTopology::Free(void* pMemory, size_t bytes)
+{
+	if (pMemory == NULL || HugePageAllocator::Free(pMemory))
+	{
+		return;
+	}
+#ifdef _WIN32
+	VirtualFree(pMemory, 0, MEM_RELEASE);
+#else
+	munmap(pMemory, bytes);
+#endif
+}
@@ -0,0 +1,60 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// NumaTopology finds the NUMA nodes of the machine and the hardware threads on each, and places memory and threads
+// on a node.  Memory from AllocateUntouched has no physical pages yet, so each page ends up on the node of the
+// thread that first writes it (the default first touch policy of both Linux and Windows).  Writing a buffer from
+// threads pinned to the node that will read it therefore places it without needing libnuma.  AllocateOnNode places
+// the whole buffer on one node up front.  With --hugePages both come from HugePageAllocator (still untouched) so
+// the placement is done in 2 MB pages.
+//
+// The node arguments below are indexes into the nodes found (0 to GetNodeCount() - 1), not operating system node
+// numbers.  On Linux the nodes come from /sys/devices/system/node.  On Windows they come from GetNumaHighestNodeNumber.  If
+// neither is available the machine is treated as a single node holding every hardware thread.
+
+#include <stddef.h>
+#include <vector>
+
+class NumaTopology {
+private:
+	// m_nodeCpus holds the hardware thread numbers of each node and m_nodeIds the operating system's number for
+	// the node.  Nodes without processors are left out, so the node numbers need not be 0, 1, 2, ...
+	std::vector<std::vector<int>> m_nodeCpus;
+	std::vector<int> m_nodeIds;
+
+	static NumaTopology* c_pTopology;
+
+private:
+	NumaTopology();
+	void Discover();
+	void AddNode(int nodeId, const std::vector<int>& cpus);
+
+public:
+	static NumaTopology* GetTopology();
+
+	int GetNodeCount();
+	const std::vector<int>& GetNodeCpus(int node);
+	// PinCurrentThread pins the calling thread to one hardware thread of the node (index picks which, wrapping) or
+	// to all of the node's hardware threads if index is negative
+	void PinCurrentThread(int node, int index);
+
+	// AllocateUntouched returns page aligned memory that has not been touched yet (NULL on failure)
+	static void* AllocateUntouched(size_t bytes);
+	// AllocateOnNode returns memory whose pages are all placed on node (NULL on failure)
+	void* AllocateOnNode(size_t bytes, int node);
+	static void Free(void* pMemory, size_t bytes);
+};
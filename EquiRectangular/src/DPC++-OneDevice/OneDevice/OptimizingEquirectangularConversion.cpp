@@ -29,6 +29,8 @@
 #include "SerialRemappingV1b.hpp"
 #include "SerialRemappingV1c.hpp"
 #include "SerialRemappingV2.hpp"
+#include "SerialRemappingV3.hpp"
+#include "ThreadPoolRemapping.hpp"
 #include "DpcppRemapping.hpp"
 #include "DpcppRemappingV2.hpp"
 #include "DpcppRemappingV3.hpp"
@@ -44,9 +46,25 @@
 #include "DpcppRemappingV13.hpp"
 #include "DpcppRemappingV14.hpp"
 #include "DpcppRemappingV15.hpp"
+#include "DpcppRemappingV16.hpp"
+#include "DpcppRemappingV17.hpp"
 #include "OptimizingEquirectangularConversion.h"
 #include "TimingStats.hpp"
 #include "ConfigurableDeviceSelector.hpp"
+#include "BatchRunner.hpp"
+#include "BufferPool.hpp"
+#include "DeviceBenchmark.hpp"
+#include "DeviceRegistry.hpp"
+#include "FrameSink.hpp"
+#include "FrameSource.hpp"
+#include "HugePageAllocator.hpp"
+#include "KernelWarmup.hpp"
+#include "PerfCounters.hpp"
+#include "PinnedMatAllocator.hpp"
+#include "PosePredictor.hpp"
+#include "RenderService.hpp"
+#include "ResultsWriter.hpp"
+#include "SharedMemoryRing.hpp"
 
 using namespace cl::sycl;
 
@@ -64,9 +82,114 @@ wchar_t const *pPrintParameters = _T("Print Parameters");
 __itt_string_handle *handle_print_parameters = __itt_string_handle_create(pPrintParameters);
 #endif
 
+// AdvanceVideoFrame moves to the next decoded video frame.  The new frame is placed in the m_image entry that is
+// not current (so algorithms that cache the source by m_imageIndex notice the change) and the frame that was
+// previously held in that entry is released back to the frame source.
+void AdvanceVideoFrame(FrameSource* pFrameSource, SFrameHandle frameHandles[2], SParameters& parameters)
+{
+    TimingStats* pTimingStats = TimingStats::GetTimingStats();
+    int nextIndex = (parameters.m_imageIndex + 1) % 2;
+    SFrameHandle nextHandle;
+    std::chrono::high_resolution_clock::time_point waitStartTime = std::chrono::high_resolution_clock::now();
+
+    if (pFrameSource->AcquireFrame(nextHandle))
+    {
+        pTimingStats->AddIterationResults(ETimingType::TIMING_FRAME_WAIT, waitStartTime, std::chrono::high_resolution_clock::now());
+        pTimingStats->AddIterationResults(ETimingType::TIMING_FRAME_DECODE, nextHandle.m_decodeStartTime, nextHandle.m_decodeEndTime);
+        parameters.m_image[nextIndex] = nextHandle.m_image;
+        pFrameSource->ReleaseFrame(frameHandles[nextIndex]);
+        frameHandles[nextIndex] = nextHandle;
+        parameters.m_imageIndex = nextIndex;
+    }
+}
+
+// CreateAlgorithm creates the algorithm with the given number (see --algorithm) or returns NULL if there is no
+// such algorithm.  The batch runner uses this as well to create one algorithm per worker.
+BaseAlgorithm* CreateAlgorithm(int algorithm, SParameters& parameters)
+{
+    switch (algorithm)
+    {
+    case 0:
+        return new Equi2Rect(parameters);
+        break;
+    case 1:
+        return new SerialRemappingV1a(parameters);
+        break;
+    case 2:
+        return new SerialRemappingV1b(parameters);
+        break;
+    case 3:
+        return new SerialRemappingV1c(parameters);
+        break;
+    case 4:
+        return new SerialRemappingV2(parameters);
+        break;
+    case 5:
+        return new DpcppRemapping(parameters);
+        break;
+    case 6:
+        return new DpcppRemappingV2(parameters);
+        break;
+    case 7:
+        return new DpcppRemappingV3(parameters);
+        break;
+    case 8:
+        return new DpcppRemappingV4(parameters);
+        break;
+    case 9:
+        return new DpcppRemappingV5(parameters);
+        break;
+    case 10:
+        return new DpcppRemappingV6(parameters);
+        break;
+    case 11:
+        return new DpcppRemappingV7(parameters);
+        break;
+    case 12:
+        return new DpcppRemappingV8(parameters);
+        break;
+    case 13:
+        return new DpcppRemappingV9(parameters);
+        break;
+    case 14:
+        return new DpcppRemappingV10(parameters);
+        break;
+    case 15:
+        return new DpcppRemappingV11(parameters);
+        break;
+    case 16:
+        return new DpcppRemappingV12(parameters);
+        break;
+    case 17:
+        return new DpcppRemappingV13(parameters);
+        break;
+    case 18:
+        return new DpcppRemappingV14(parameters);
+        break;
+    case 19:
+        return new DpcppRemappingV15(parameters);
+        break;
+    case 20:
+        return new DpcppRemappingV16(parameters);
+        break;
+    case 21:
+        return new DpcppRemappingV17(parameters);
+        break;
+    case 22:
+        return new SerialRemappingV3(parameters);
+        break;
+    case 23:
+        return new ThreadPoolRemapping(parameters);
+        break;
+    }
+
+    return NULL;
+}
+
 int main(int argc, char** argv) {
     try {
-
+        // programStartTime is the start of the cold start to first frame time
+        std::chrono::high_resolution_clock::time_point programStartTime = std::chrono::high_resolution_clock::now();
         SParameters parameters;
         char errorMessage[MAX_ERROR_MESSAGE];
 
@@ -75,6 +198,18 @@ int main(int argc, char** argv) {
             PrintUsage(argv[0], errorMessage);
             exit(1);
         }
+        TimingStats::SetWarmupIterations(parameters.m_warmupIterations);
+        if (parameters.m_compareBaseline[0] != '\0')
+        {
+            int regressions = ResultsWriter::Compare(parameters.m_compareBaseline, parameters.m_compareCandidate, parameters.m_regressionThreshold);
+
+            exit((regressions < 0) ? 1 : (regressions > 0) ? 2 : 0);
+        }
+        if (parameters.m_bWarmupKernels)
+        {
+            // Has to happen before the DPC++ runtime reads its configuration
+            KernelWarmup::EnablePersistentCache();
+        }
 
         std::string description;
         BaseAlgorithm* pAlg = NULL;
@@ -100,6 +235,7 @@ int main(int argc, char** argv) {
         int sign = 1;
         cv::Mat debugImg;
         cv::Mat flatImg;
+        cv::Mat outputImg;
         int delta = 10;
         int prevDelta = 10;
         bool bRunningVariant;
@@ -108,6 +244,22 @@ int main(int argc, char** argv) {
         int origYaw = parameters.m_yaw;
         int origPitch = parameters.m_pitch;
         int origRoll = parameters.m_roll;
+        FrameSource* pFrameSource = NULL;
+        FrameSink* pFrameSink = NULL;
+        SharedMemoryRing* pShmRing = NULL;
+        PerfCounters* pPerfCounters = NULL;
+        ResultsWriter* pResultsWriter = NULL;
+        std::string deviceName;
+        std::string driverVersion;
+        long long framesPublished = 0;
+        bool bColdStartReported = false;
+        double coldStartSeconds = 0.0;
+        SFrameHandle frameHandles[2];
+
+        if (parameters.m_resultsPath[0] != '\0')
+        {
+            pResultsWriter = new ResultsWriter(parameters.m_resultsPath, argc, argv);
+        }
 
         //cv::utils::logging::setLogLevel(cv::utils::logging::LogLevel::LOG_LEVEL_SILENT);
         //cv::utils::logging::setLogLevel(cv::utils::logging::LogLevel::LOG_LEVEL_FATAL);
@@ -156,103 +308,173 @@ int main(int argc, char** argv) {
             exit(0);
         }
 
+        if (parameters.m_bRankDevices)
+        {
+            // Before any device is selected so every selection uses the measured ranking
+            DeviceBenchmark::RankDevices(parameters.m_widthOutput, parameters.m_heightOutput,
+                (parameters.m_rankingCache[0] != '\0') ? parameters.m_rankingCache : DEFAULT_RANKING_CACHE);
+        }
+
+        // Batch mode renders the job file without any highgui calls so it also works on headless servers
+        if (parameters.m_batchFilename[0] != '\0')
+        {
+            BatchRunner batchRunner(parameters, CreateAlgorithm);
+
+            if (!batchRunner.LoadJobs(parameters.m_batchFilename, errorMessage))
+            {
+                printf("%s\n", errorMessage);
+                exit(1);
+            }
+            printf("Running batch %s on %d worker(s)\n", parameters.m_batchFilename, batchRunner.GetNumWorkers());
+            batchRunner.Run();
+            printf("%s", batchRunner.GetStatsString().c_str());
+            DeviceRegistry::Terminate();
+            return 0;
+        }
+
+        // Service mode keeps the algorithm warm and renders requests from other processes until told to shut down
+        if (parameters.m_servePath[0] != '\0')
+        {
+            RenderService renderService(parameters, CreateAlgorithm);
+
+            if (!renderService.Open())
+            {
+                exit(1);
+            }
+            renderService.Run();
+            printf("%s", renderService.GetStatsString().c_str());
+            DeviceRegistry::Terminate();
+            return 0;
+        }
+
         // Adjust the width to be a factor of 16 and the height to be a factor of 8 to make the
         // parallel algorithms not need to worry about odd sized images.  Later this could be relaxed
         // by making an internal space that meets these criteria and then pulling the user requested
         // size from within that space.
-        if (parameters.m_widthOutput % 16 != 0)
+        if (parameters.m_widthOutput % OUTPUT_WIDTH_ALIGNMENT != 0)
         {
-            parameters.m_widthOutput = ((parameters.m_widthOutput / 16) + 1) * 16;
+            parameters.m_widthOutput = ((parameters.m_widthOutput / OUTPUT_WIDTH_ALIGNMENT) + 1) * OUTPUT_WIDTH_ALIGNMENT;
         }
-        if (parameters.m_heightOutput % 8 != 0)
+        if (parameters.m_heightOutput % OUTPUT_HEIGHT_ALIGNMENT != 0)
         {
-            parameters.m_heightOutput = ((parameters.m_heightOutput / 8) + 1) * 8;
+            parameters.m_heightOutput = ((parameters.m_heightOutput / OUTPUT_HEIGHT_ALIGNMENT) + 1) * OUTPUT_HEIGHT_ALIGNMENT;
         }
-        // read src image0
-        printf("Loading Image0\n");
-        parameters.m_image[0] = cv::imread(parameters.m_imgFilename[0], cv::IMREAD_COLOR);
-        if (parameters.m_image[0].empty())
+        if (parameters.m_bPinnedMemory)
         {
-            printf("Error: Could not load image 0 from %s\n", parameters.m_imgFilename[0]);
-            throw std::invalid_argument("Error: Could not load image 0.");
+            // Pinned memory has to come from the context the DPC++ queues will use, so locate the device now and
+            // build the allocator's context from its platform
+            ConfigurableDeviceSelector::set_search(parameters.m_typePreference,
+                (parameters.m_platformName == "all") ? "" : parameters.m_platformName,
+                (parameters.m_deviceName == "all") ? "" : parameters.m_deviceName,
+                parameters.m_driverVersion);
+            sycl::device device(ConfigurableDeviceSelector::device_selector);
+            PinnedMatAllocator::Initialize(device);
+            printf("Using pinned host memory on %s\n", device.get_platform().get_info<sycl::info::platform::name>().c_str());
         }
-        // read src image1
-        printf("Loading Image1\n");
-        parameters.m_image[1] = cv::imread(parameters.m_imgFilename[1], cv::IMREAD_COLOR);
-        if (parameters.m_image[1].empty())
+        if (parameters.m_bHugePages)
         {
-            printf("Error: Could not load image 1 from %s\n", parameters.m_imgFilename[1]);
-            throw std::invalid_argument("Error: Could not load image 1.");
+            HugePageAllocator::Initialize();
+        }
+        BufferPool::GetBufferPool()->SetPooling(parameters.m_bBufferPool);
+        if (parameters.m_bWarmupKernels)
+        {
+            // The kernels build on their own threads while the images load
+            KernelWarmup::Start(parameters);
+        }
+        // Sources are decoded into pinned memory if requested, otherwise huge pages if requested (a NULL allocator
+        // keeps the OpenCV default)
+        cv::MatAllocator* pSourceAllocator = PinnedMatAllocator::GetPinnedAllocator();
+
+        if (pSourceAllocator == NULL)
+        {
+            pSourceAllocator = HugePageAllocator::GetHugePageAllocator();
+        }
+        if (parameters.m_videoFilename[0] != '\0')
+        {
+            printf("Opening video %s\n", parameters.m_videoFilename);
+            pFrameSource = new FrameSource(parameters.m_videoFilename, parameters.m_frameQueueDepth);
+            if (!pFrameSource->Open())
+            {
+                printf("Error: Could not open video from %s\n", parameters.m_videoFilename);
+                throw std::invalid_argument("Error: Could not open video.");
+            }
+            // Decode straight into the pinned or huge page memory
+            pFrameSource->SetAllocator(pSourceAllocator);
+            pFrameSource->Start();
+            // Prime both image entries so the algorithms can size their buffers from the video frames
+            for (int i = 0; i < 2; i++)
+            {
+                if (!pFrameSource->AcquireFrame(frameHandles[i]))
+                {
+                    printf("Error: Could not decode a frame from %s\n", parameters.m_videoFilename);
+                    throw std::invalid_argument("Error: Could not decode video frame.");
+                }
+                parameters.m_image[i] = frameHandles[i].m_image;
+            }
+            printf("Video opened.\n");
+        }
+        else
+        {
+            // read src image0
+            printf("Loading Image0\n");
+            parameters.m_image[0] = cv::imread(parameters.m_imgFilename[0], cv::IMREAD_COLOR);
+            if (parameters.m_image[0].empty())
+            {
+                printf("Error: Could not load image 0 from %s\n", parameters.m_imgFilename[0]);
+                throw std::invalid_argument("Error: Could not load image 0.");
+            }
+            // read src image1
+            printf("Loading Image1\n");
+            parameters.m_image[1] = cv::imread(parameters.m_imgFilename[1], cv::IMREAD_COLOR);
+            if (parameters.m_image[1].empty())
+            {
+                printf("Error: Could not load image 1 from %s\n", parameters.m_imgFilename[1]);
+                throw std::invalid_argument("Error: Could not load image 1.");
+            }
+            if (pSourceAllocator != NULL)
+            {
+                // cv::imread has no allocator parameter, so move the decoded pixels into pinned (or huge page) memory once
+                for (int i = 0; i < 2; i++)
+                {
+                    cv::Mat hostImage;
+
+                    hostImage.allocator = pSourceAllocator;
+                    parameters.m_image[i].copyTo(hostImage);
+                    parameters.m_image[i] = hostImage;
+                }
+            }
+            printf("Images loaded.\n");
+        }
+        if (parameters.m_sinkPath[0] != '\0')
+        {
+            pFrameSink = new FrameSink(parameters.m_sinkPath, parameters.m_sinkThreads, parameters.m_sinkQueueDepth);
+            pFrameSink->Start();
+            printf("Encoding frames to %s on %d thread(s)\n", parameters.m_sinkPath, pFrameSink->GetNumThreads());
+        }
+        if (parameters.m_shmRingName[0] != '\0')
+        {
+            pShmRing = new SharedMemoryRing(parameters.m_shmRingName);
+            if (!pShmRing->Create(parameters.m_shmSlots, parameters.m_widthOutput, parameters.m_heightOutput))
+            {
+                printf("Error: Could not create the shared memory ring %s\n", parameters.m_shmRingName);
+                throw std::invalid_argument("Error: Could not create the shared memory ring.");
+            }
+            printf("Publishing frames to shared memory ring %s with %d slots\n", parameters.m_shmRingName, pShmRing->GetSlotCount());
+        }
+        if (parameters.m_bPerfCounters)
+        {
+            // Open before the algorithms start their worker threads so the threads inherit the counters
+            pPerfCounters = new PerfCounters();
+            pPerfCounters->Open();
+            // The frame sections in the loop below (and the CPU remaps) also get counts of their own
+            TimingStats::SetCounters(true, (long long)parameters.m_widthOutput * parameters.m_heightOutput);
         }
-        printf("Images loaded.\n");
         int algorithm = startAlgorithm;
 
         while (algorithm <= endAlgorithm)
         {
             initStartTime = std::chrono::high_resolution_clock::now();
-            switch (algorithm)
-            {
-            case 0:
-                pAlg = new Equi2Rect(parameters);
-                break;
-            case 1:
-                pAlg = new SerialRemappingV1a(parameters);
-                break;
-            case 2:
-                pAlg = new SerialRemappingV1b(parameters);
-                break;
-            case 3:
-                pAlg = new SerialRemappingV1c(parameters);
-                break;
-            case 4:
-                pAlg = new SerialRemappingV2(parameters);
-                break;
-            case 5:
-                pAlg = new DpcppRemapping(parameters);
-                break;
-            case 6:
-                pAlg = new DpcppRemappingV2(parameters);
-                break;
-            case 7:
-                pAlg = new DpcppRemappingV3(parameters);
-                break;
-            case 8:
-                pAlg = new DpcppRemappingV4(parameters);
-                break;
-            case 9:
-                pAlg = new DpcppRemappingV5(parameters);
-                break;
-            case 10:
-                pAlg = new DpcppRemappingV6(parameters);
-                break;
-            case 11:
-                pAlg = new DpcppRemappingV7(parameters);
-                break;
-            case 12:
-                pAlg = new DpcppRemappingV8(parameters);
-                break;
-            case 13:
-                pAlg = new DpcppRemappingV9(parameters);
-                break;
-            case 14:
-                pAlg = new DpcppRemappingV10(parameters);
-                break;
-            case 15:
-                pAlg = new DpcppRemappingV11(parameters);
-                break;
-            case 16:
-                pAlg = new DpcppRemappingV12(parameters);
-                break;
-            case 17:
-                pAlg = new DpcppRemappingV13(parameters);
-                break;
-            case 18:
-                pAlg = new DpcppRemappingV14(parameters);
-                break;
-            case 19:
-                pAlg = new DpcppRemappingV15(parameters);
-                break;
-            }
+            pAlg = CreateAlgorithm(algorithm, parameters);
 
             if (pAlg != NULL)
             {
@@ -261,12 +483,21 @@ int main(int argc, char** argv) {
                 bVariantValid = true;
                 while (bVariantValid)
                 {
+                    if (pPerfCounters != NULL)
+                    {
+                        pPerfCounters->Start();
+                    }
+                    // Before StartVariant so the per-variant buffers are counted
+                    BufferPool::GetBufferPool()->ResetStats();
                     variantInitStartTime = std::chrono::high_resolution_clock::now();
                     bVariantValid = pAlg->StartVariant();
 
                     if (bVariantValid)
                     {
                         description = pAlg->GetDescription();
+                        // Before StopVariant hands the device queue back
+                        deviceName = pAlg->GetDeviceName();
+                        driverVersion = pAlg->GetDriverVersion();
                         // Reset the perspective back to the inital values so each algorithm
                         // works from the same baseline
                         parameters.m_yaw = origYaw;
@@ -276,8 +507,20 @@ int main(int argc, char** argv) {
                         iteration = 0;
 
                         pTimingStats->Reset();
+                        if (pFrameSource != NULL)
+                        {
+                            pFrameSource->ResetStats();
+                        }
+                        if (pFrameSink != NULL)
+                        {
+                            pFrameSink->ResetStats();
+                        }
                         pTimingStats->AddIterationResults(ETimingType::TIMING_INITIALIZATION, initStartTime, initEndTime);
                         pTimingStats->AddIterationResults(ETimingType::VARIANT_INITIALIZATION, variantInitStartTime, std::chrono::high_resolution_clock::now());
+                        if (parameters.m_bOutputBuffer)
+                        {
+                            outputImg = pAlg->AllocateOutputImage();
+                        }
                         bRunningVariant = true;
                         totalTimeStart = std::chrono::high_resolution_clock::now();
                         while (bRunningVariant)
@@ -293,6 +536,11 @@ int main(int argc, char** argv) {
                             {
                                 if (bDoIterations)
                                 {
+                                    // With --asyncFrames the frame submitted on the previous pass (and the pose it was
+                                    // rendered at) is still in flight
+                                    std::future<cv::Mat> pendingFrame;
+                                    SPose pendingPose = { 0, 0, 0, 0 };
+
                                     do
                                     {
                                         if (parameters.m_pitch > 90)
@@ -330,20 +578,69 @@ int main(int argc, char** argv) {
                                         }
 
                                         bool bParametersChanged = prevParameters != parameters;
+                                        bool bFrameReady = true;
+                                        SPose framePose = { parameters.m_yaw, parameters.m_pitch, parameters.m_roll, parameters.m_fov };
 
                                         frameStartTime = std::chrono::high_resolution_clock::now();
+                                        pTimingStats->StartCounters(ETimingType::TIMING_FRAME);
+                                        pTimingStats->StartCounters(ETimingType::TIMING_FRAME_CALCULATIONS);
                                         pAlg->FrameCalculations(bParametersChanged);
                                         pTimingStats->AddIterationResults(ETimingType::TIMING_FRAME_CALCULATIONS, frameStartTime, std::chrono::high_resolution_clock::now());
                                         prevParameters = parameters;
                                         extractionStartTime = std::chrono::high_resolution_clock::now();
-                                        flatImg = pAlg->ExtractFrameImage();
+                                        pTimingStats->StartCounters(ETimingType::TIMING_IMAGE_EXTRACTION);
+                                        if (parameters.m_bOutputBuffer)
+                                        {
+                                            pAlg->ExtractFrameImage(outputImg);
+                                            flatImg = outputImg;
+                                        }
+                                        else if (parameters.m_bAsyncFrames && pAlg->SupportsAsyncFrames())
+                                        {
+                                            // Keep one frame in flight: submit this frame and then wait for the one submitted on
+                                            // the previous pass, so the device renders this frame while the previous one is
+                                            // published and shown.  The first pass only fills the pipeline.
+                                            std::future<cv::Mat> frameFuture = pAlg->ExtractFrameImageAsync();
+
+                                            bFrameReady = pendingFrame.valid();
+                                            if (bFrameReady)
+                                            {
+                                                flatImg = pendingFrame.get();
+                                                std::swap(framePose, pendingPose);
+                                            }
+                                            else
+                                            {
+                                                pendingPose = framePose;
+                                            }
+                                            pendingFrame = std::move(frameFuture);
+                                        }
+                                        else
+                                        {
+                                            flatImg = pAlg->ExtractFrameImage();
+                                        }
                                         frameEndTime = std::chrono::high_resolution_clock::now();
-                                        pTimingStats->AddIterationResults(ETimingType::TIMING_IMAGE_EXTRACTION, extractionStartTime, frameEndTime);
-                                        pTimingStats->AddIterationResults(ETimingType::TIMING_FRAME, frameStartTime, frameEndTime, bInteractive);
-                                        iteration++;
-                                        if (!bInteractive)
+                                        if (bFrameReady)
                                         {
-                                            if (parameters.m_bShowFrames)
+                                            pTimingStats->AddIterationResults(ETimingType::TIMING_IMAGE_EXTRACTION, extractionStartTime, frameEndTime);
+                                            pTimingStats->AddIterationResults(ETimingType::TIMING_FRAME, frameStartTime, frameEndTime, bInteractive);
+                                            if (!bColdStartReported)
+                                            {
+                                                coldStartSeconds = std::chrono::duration<double>(frameEndTime - programStartTime).count();
+                                                printf("Cold start to first frame: %.3f s (%s kernels, warmup %s)\n", coldStartSeconds,
+                                                    KernelWarmup::GetKernelCompilation(), parameters.m_bWarmupKernels ? "on" : "off");
+                                                bColdStartReported = true;
+                                            }
+                                            if (pShmRing != NULL)
+                                            {
+                                                pShmRing->Publish(flatImg, framesPublished++, framePose.m_yaw, framePose.m_pitch, framePose.m_roll, framePose.m_fov,
+                                                    std::chrono::steady_clock::now());
+                                            }
+                                            if (pFrameSink != NULL && !bInteractive)
+                                            {
+                                                // Only the copy into the sink's queue happens here, the encoding runs on the sink's threads
+                                                pFrameSink->Submit(flatImg);
+                                            }
+                                            iteration++;
+                                            if (!bInteractive && parameters.m_bShowFrames)
                                             {
                                                 char windowText[1024];
 
@@ -354,15 +651,32 @@ int main(int argc, char** argv) {
                                                 // should show the frame
                                                 key = cv::waitKeyEx(1);
                                             }
+                                        }
+                                        if (!bInteractive)
+                                        {
                                             parameters.m_yaw += parameters.m_deltaYaw;
                                             parameters.m_pitch += parameters.m_deltaPitch;
                                             parameters.m_roll += parameters.m_deltaRoll;
-                                            if (parameters.m_deltaImage)
+                                            if (pFrameSource != NULL)
+                                            {
+                                                AdvanceVideoFrame(pFrameSource, frameHandles, parameters);
+                                            }
+                                            else if (parameters.m_deltaImage)
                                             {
                                                 parameters.m_imageIndex = (parameters.m_imageIndex + 1) % 2;
                                             }
                                         }
                                     } while (iteration < parameters.m_iterations);
+                                    if (pendingFrame.valid())
+                                    {
+                                        // The last frame submitted is only needed when it is the one to show
+                                        cv::Mat lastImg = pendingFrame.get();
+
+                                        if (bInteractive)
+                                        {
+                                            flatImg = lastImg;
+                                        }
+                                    }
 #ifdef VTUNE_API
                                     __itt_pause();
 #endif
@@ -384,6 +698,15 @@ int main(int argc, char** argv) {
 
                                     printf("Algorithm description: %s\n", description.c_str());
                                     pTimingStats->ReportTimes(true);
+                                    printf("%s", pAlg->GetAlgorithmStats().c_str());
+                                    if (pFrameSource != NULL)
+                                    {
+                                        printf("%s", pFrameSource->GetStatsString().c_str());
+                                    }
+                                    if (pFrameSink != NULL)
+                                    {
+                                        printf("%s", pFrameSink->GetStatsString().c_str());
+                                    }
 
                                 }
                             }
@@ -487,7 +810,14 @@ int main(int argc, char** argv) {
                                     }
                                     else if (key == 102)        // f key (change frame)
                                     {
-                                        parameters.m_imageIndex = (parameters.m_imageIndex + 1) % 2;
+                                        if (pFrameSource != NULL)
+                                        {
+                                            AdvanceVideoFrame(pFrameSource, frameHandles, parameters);
+                                        }
+                                        else
+                                        {
+                                            parameters.m_imageIndex = (parameters.m_imageIndex + 1) % 2;
+                                        }
                                     }
                                     else if (key == 97)         // a key (algorithm selection)
                                     {
@@ -523,8 +853,15 @@ int main(int argc, char** argv) {
                                         char filename[1024];
 
                                         // Save out the different images
-                                        sprintf(filename, "flat-view-%d-%d-%d-%d.jpg", parameters.m_yaw, parameters.m_pitch, parameters.m_roll, parameters.m_fov);
-                                        cv::imwrite(filename, flatImg);
+                                        if (pFrameSink != NULL)
+                                        {
+                                            pFrameSink->Submit(flatImg);
+                                        }
+                                        else
+                                        {
+                                            sprintf(filename, "flat-view-%d-%d-%d-%d.jpg", parameters.m_yaw, parameters.m_pitch, parameters.m_roll, parameters.m_fov);
+                                            cv::imwrite(filename, flatImg);
+                                        }
                                         if (bDebug)
                                         {
                                             sprintf(filename, "full-view-%d-%d-%d-%d.jpg", parameters.m_yaw, parameters.m_pitch, parameters.m_roll, parameters.m_fov);
@@ -550,10 +887,68 @@ int main(int argc, char** argv) {
                             }
                         }
 
+                        if (pFrameSink != NULL)
+                        {
+                            // Let the encoders catch up so the sink statistics cover every frame of this variant
+                            pFrameSink->Flush();
+                        }
+                        // Collect the algorithm's statistics before StopVariant releases them
+                        std::string pipelineStats = pAlg->GetAlgorithmStats();
+
                         variantInitStopTime = std::chrono::high_resolution_clock::now();
+                        if (parameters.m_bOutputBuffer)
+                        {
+                            flatImg.release();
+                            pAlg->FreeOutputImage(outputImg);
+                        }
                         pAlg->StopVariant();
                         pTimingStats->AddIterationResults(ETimingType::VARIANT_TERMINATION, variantInitStopTime, std::chrono::high_resolution_clock::now());
-                        summaryStats.push_back(description + "\n" + pTimingStats->SummaryStats(false));
+                        if (pPerfCounters != NULL)
+                        {
+                            // After StopVariant so the counts of the variant's (now joined) threads are included
+                            pPerfCounters->Stop();
+                            pipelineStats += pPerfCounters->GetStatsString(iteration);
+                        }
+                        pipelineStats += BufferPool::GetBufferPool()->GetStatsString(iteration);
+
+                        if (pFrameSource != NULL)
+                        {
+                            pipelineStats += pFrameSource->GetStatsString();
+                        }
+                        if (pFrameSink != NULL)
+                        {
+                            pipelineStats += pFrameSink->GetStatsString();
+                        }
+                        summaryStats.push_back(description + "\n" + pTimingStats->SummaryStats(false) + pipelineStats);
+                        if (pResultsWriter != NULL)
+                        {
+                            const LatencyHistogram& frameHistogram = pTimingStats->GetHistogram(ETimingType::TIMING_FRAME);
+
+                            pResultsWriter->BeginRecord();
+                            pResultsWriter->AddField("algorithm", algorithm);
+                            pResultsWriter->AddField("description", description);
+                            pResultsWriter->AddField("device", deviceName);
+                            pResultsWriter->AddField("driverVersion", driverVersion);
+                            pResultsWriter->AddField("sourceWidth", parameters.m_image[0].cols);
+                            pResultsWriter->AddField("sourceHeight", parameters.m_image[0].rows);
+                            pResultsWriter->AddField("outputWidth", parameters.m_widthOutput);
+                            pResultsWriter->AddField("outputHeight", parameters.m_heightOutput);
+                            pResultsWriter->AddField("fov", parameters.m_fov);
+                            pResultsWriter->AddField("yaw", origYaw);
+                            pResultsWriter->AddField("pitch", origPitch);
+                            pResultsWriter->AddField("roll", origRoll);
+                            pResultsWriter->AddField("deltaYaw", parameters.m_deltaYaw);
+                            pResultsWriter->AddField("deltaPitch", parameters.m_deltaPitch);
+                            pResultsWriter->AddField("deltaRoll", parameters.m_deltaRoll);
+                            pResultsWriter->AddField("deltaImage", parameters.m_deltaImage ? 1 : 0);
+                            pResultsWriter->AddField("iterations", parameters.m_iterations);
+                            pResultsWriter->AddField("poolThreads", parameters.m_poolThreads);
+                            pResultsWriter->AddSystemFields();
+                            pResultsWriter->AddFrameFields(frameHistogram, pTimingStats->GetWarmupDuration(ETimingType::TIMING_FRAME), pTimingStats->GetWarmupIterations(ETimingType::TIMING_FRAME));
+                            // One frame is in flight at a time so the frame rate follows from the mean frame time
+                            pResultsWriter->AddField("fps", (frameHistogram.GetMean() > 0.0) ? 1.0 / frameHistogram.GetMean() : 0.0);
+                            pResultsWriter->EndRecord();
+                        }
                     }
                 }
                 delete pAlg;
@@ -562,6 +957,73 @@ int main(int argc, char** argv) {
             algorithm++;
         }
 
+        if (pFrameSource != NULL)
+        {
+            for (int i = 0; i < 2; i++)
+            {
+                parameters.m_image[i] = cv::Mat();
+                pFrameSource->ReleaseFrame(frameHandles[i]);
+            }
+            delete pFrameSource;
+            pFrameSource = NULL;
+        }
+        if (pShmRing != NULL)
+        {
+            delete pShmRing;
+            pShmRing = NULL;
+        }
+        if (pFrameSink != NULL)
+        {
+            pFrameSink->Stop();
+            delete pFrameSink;
+            pFrameSink = NULL;
+        }
+        if (pResultsWriter != NULL)
+        {
+            delete pResultsWriter;
+            pResultsWriter = NULL;
+        }
+        if (parameters.m_bWarmupKernels)
+        {
+            printf("%s", KernelWarmup::GetStatsString().c_str());
+            KernelWarmup::Terminate();
+        }
+        // The pooled buffers may come from the huge page allocator, so free them before it goes away
+        BufferPool::Terminate();
+        // Every algorithm has returned its queue by now
+        printf("%s", DeviceRegistry::GetStatsString().c_str());
+        DeviceRegistry::Terminate();
+        if (parameters.m_bPinnedMemory)
+        {
+            // Every Mat using the pinned allocator must be gone before the allocator is
+            for (int i = 0; i < 2; i++)
+            {
+                parameters.m_image[i].release();
+            }
+            debugImg.release();
+            flatImg.release();
+            outputImg.release();
+            PinnedMatAllocator::Terminate();
+        }
+        if (pPerfCounters != NULL)
+        {
+            delete pPerfCounters;
+            pPerfCounters = NULL;
+        }
+        if (parameters.m_bHugePages)
+        {
+            // Every Mat using the huge page allocator must be gone before the allocator is
+            for (int i = 0; i < 2; i++)
+            {
+                parameters.m_image[i].release();
+            }
+            debugImg.release();
+            flatImg.release();
+            outputImg.release();
+            printf("%s", HugePageAllocator::GetStatsString().c_str());
+            HugePageAllocator::Terminate();
+        }
+
         // Make the text be in green (see codeproject.com/Tips/5255355/How-to-Put-Color-on-Windows-Console for colors)
         printf("\033[32m");
         printf("All done!  Summary of all runs:\n");
@@ -570,6 +1032,11 @@ int main(int argc, char** argv) {
         {
             printf("%s\n", element.c_str());
         }
+        if (bColdStartReported)
+        {
+            printf("Cold start to first frame, %10.3f,ms, %s kernels, warmup %s\n", coldStartSeconds * 1000.0,
+                KernelWarmup::GetKernelCompilation(), parameters.m_bWarmupKernels ? "on" : "off");
+        }
         if (!bInteractive)
         {
             key = cv::waitKeyEx(0);             // Show windows and wait for any key close down
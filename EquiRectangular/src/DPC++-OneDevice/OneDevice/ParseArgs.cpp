@@ -21,6 +21,7 @@
 #include <iostream>
 
 #include "ParseArgs.hpp"
+#include "ResultsWriter.hpp"
 
 _SParameters::_SParameters()
 {
@@ -42,11 +43,40 @@ _SParameters::_SParameters()
     // m_iterations = 0 means interactive
     m_iterations = 0;
     m_bShowFrames = false;
+    m_bAsyncFrames = false;
+    m_bOutputBuffer = false;
+    m_bPinnedMemory = false;
+    m_bHugePages = false;
+    m_bBufferPool = false;
+    m_bWarmupKernels = false;
+    m_bRankDevices = false;
+    m_rankingCache[0] = '\0';
+    m_bPerfCounters = false;
+    m_bNuma = false;
+    m_bPoolPinning = false;
+    m_bPoolScaling = false;
+    m_resultsPath[0] = '\0';
+    m_compareBaseline[0] = '\0';
+    m_compareCandidate[0] = '\0';
+    m_regressionThreshold = DEFAULT_REGRESSION_THRESHOLD;
     for (int i = 0; i < 3; i++)
     {
         m_offsets[i] = 0;
     }
     m_imageIndex = 0;
+    m_videoFilename[0] = '\0';
+    m_frameQueueDepth = 4;
+    m_warmupIterations = 1;
+    m_batchFilename[0] = '\0';
+    m_batchWorkers = 0;
+    m_servePath[0] = '\0';
+    m_serviceQueueDepth = 16;
+    m_shmRingName[0] = '\0';
+    m_shmSlots = 4;
+    m_poolThreads = 0;
+    m_sinkPath[0] = '\0';
+    m_sinkThreads = 2;
+    m_sinkQueueDepth = 8;
     m_typePreference = "";
     m_platformName = "";
     m_deviceName = "";
@@ -124,6 +154,50 @@ bool ParseArgs(int argc, char** argv, SParameters *parameters, char *errorMessag
             {
                 parameters->m_bShowFrames = true;
             }
+            else if (_strnicmp("asyncFrames", flagStart, flagLength) == 0)
+            {
+                parameters->m_bAsyncFrames = true;
+            }
+            else if (_strnicmp("outputBuffer", flagStart, flagLength) == 0)
+            {
+                parameters->m_bOutputBuffer = true;
+            }
+            else if (_strnicmp("pinnedMemory", flagStart, flagLength) == 0)
+            {
+                parameters->m_bPinnedMemory = true;
+            }
+            else if (_strnicmp("hugePages", flagStart, flagLength) == 0)
+            {
+                parameters->m_bHugePages = true;
+            }
+            else if (_strnicmp("bufferPool", flagStart, flagLength) == 0)
+            {
+                parameters->m_bBufferPool = true;
+            }
+            else if (_strnicmp("warmupKernels", flagStart, flagLength) == 0)
+            {
+                parameters->m_bWarmupKernels = true;
+            }
+            else if (_strnicmp("rankDevices", flagStart, flagLength) == 0)
+            {
+                parameters->m_bRankDevices = true;
+            }
+            else if (_strnicmp("perfCounters", flagStart, flagLength) == 0)
+            {
+                parameters->m_bPerfCounters = true;
+            }
+            else if (_strnicmp("numa", flagStart, flagLength) == 0)
+            {
+                parameters->m_bNuma = true;
+            }
+            else if (_strnicmp("poolPinning", flagStart, flagLength) == 0)
+            {
+                parameters->m_bPoolPinning = true;
+            }
+            else if (_strnicmp("poolScaling", flagStart, flagLength) == 0)
+            {
+                parameters->m_bPoolScaling = true;
+            }
             else
             {
                 if (valueStart == NULL)
@@ -242,6 +316,138 @@ bool ParseArgs(int argc, char** argv, SParameters *parameters, char *errorMessag
                     {
                         strcpy_s(parameters->m_imgFilename[1], valueStart);
                     }
+                    else if (_strnicmp("video", flagStart, flagLength) == 0)
+                    {
+                        strcpy_s(parameters->m_videoFilename, valueStart);
+                    }
+                    else if (_strnicmp("frameQueueDepth", flagStart, flagLength) == 0)
+                    {
+                        parameters->m_frameQueueDepth = atoi(valueStart);
+                        if (parameters->m_frameQueueDepth < 3)
+                        {
+                            sprintf(errorMessage, "Error: Illegal value for frameQueueDepth (%s).  Must be 3 or more.", valueStart);
+                            bRetVal = false;
+                            break;
+                        }
+                    }
+                    else if (_strnicmp("warmupIterations", flagStart, flagLength) == 0)
+                    {
+                        parameters->m_warmupIterations = atoi(valueStart);
+                        if (parameters->m_warmupIterations < 0)
+                        {
+                            sprintf(errorMessage, "Error: Illegal value for warmupIterations (%s).  Must be 0 or more.", valueStart);
+                            bRetVal = false;
+                            break;
+                        }
+                    }
+                    else if (_strnicmp("batch", flagStart, flagLength) == 0)
+                    {
+                        strcpy_s(parameters->m_batchFilename, valueStart);
+                    }
+                    else if (_strnicmp("results", flagStart, flagLength) == 0)
+                    {
+                        strcpy_s(parameters->m_resultsPath, valueStart);
+                    }
+                    else if (_strnicmp("compare", flagStart, flagLength) == 0)
+                    {
+                        const char* pSeparator = strchr(valueStart, ';');
+
+                        if (pSeparator == NULL || pSeparator == valueStart || pSeparator[1] == '\0' || pSeparator - valueStart >= MAX_PATH)
+                        {
+                            sprintf(errorMessage, "Error: Illegal value for compare (%s).  Must be baselinePath;candidatePath.", valueStart);
+                            bRetVal = false;
+                            break;
+                        }
+                        strncpy(parameters->m_compareBaseline, valueStart, pSeparator - valueStart);
+                        parameters->m_compareBaseline[pSeparator - valueStart] = '\0';
+                        strcpy_s(parameters->m_compareCandidate, pSeparator + 1);
+                    }
+                    else if (_strnicmp("regressionThreshold", flagStart, flagLength) == 0)
+                    {
+                        parameters->m_regressionThreshold = atof(valueStart);
+                        if (parameters->m_regressionThreshold < 0.0)
+                        {
+                            sprintf(errorMessage, "Error: Illegal value for regressionThreshold (%s).  Must be 0 or more.", valueStart);
+                            bRetVal = false;
+                            break;
+                        }
+                    }
+                    else if (_strnicmp("rankingCache", flagStart, flagLength) == 0)
+                    {
+                        strcpy_s(parameters->m_rankingCache, valueStart);
+                    }
+                    else if (_strnicmp("batchWorkers", flagStart, flagLength) == 0)
+                    {
+                        parameters->m_batchWorkers = atoi(valueStart);
+                        if (parameters->m_batchWorkers < 0)
+                        {
+                            sprintf(errorMessage, "Error: Illegal value for batchWorkers (%s).  Must be 0 or more.", valueStart);
+                            bRetVal = false;
+                            break;
+                        }
+                    }
+                    else if (_strnicmp("poolThreads", flagStart, flagLength) == 0)
+                    {
+                        parameters->m_poolThreads = atoi(valueStart);
+                        if (parameters->m_poolThreads < 0)
+                        {
+                            sprintf(errorMessage, "Error: Illegal value for poolThreads (%s).  Must be 0 or more.", valueStart);
+                            bRetVal = false;
+                            break;
+                        }
+                    }
+                    else if (_strnicmp("serve", flagStart, flagLength) == 0)
+                    {
+                        strcpy_s(parameters->m_servePath, valueStart);
+                    }
+                    else if (_strnicmp("serviceQueueDepth", flagStart, flagLength) == 0)
+                    {
+                        parameters->m_serviceQueueDepth = atoi(valueStart);
+                        if (parameters->m_serviceQueueDepth < 1)
+                        {
+                            sprintf(errorMessage, "Error: Illegal value for serviceQueueDepth (%s).  Must be 1 or more.", valueStart);
+                            bRetVal = false;
+                            break;
+                        }
+                    }
+                    else if (_strnicmp("shmRing", flagStart, flagLength) == 0)
+                    {
+                        strcpy_s(parameters->m_shmRingName, valueStart);
+                    }
+                    else if (_strnicmp("shmSlots", flagStart, flagLength) == 0)
+                    {
+                        parameters->m_shmSlots = atoi(valueStart);
+                        if (parameters->m_shmSlots < 2)
+                        {
+                            sprintf(errorMessage, "Error: Illegal value for shmSlots (%s).  Must be 2 or more.", valueStart);
+                            bRetVal = false;
+                            break;
+                        }
+                    }
+                    else if (_strnicmp("sinkPath", flagStart, flagLength) == 0)
+                    {
+                        strcpy_s(parameters->m_sinkPath, valueStart);
+                    }
+                    else if (_strnicmp("sinkThreads", flagStart, flagLength) == 0)
+                    {
+                        parameters->m_sinkThreads = atoi(valueStart);
+                        if (parameters->m_sinkThreads < 1)
+                        {
+                            sprintf(errorMessage, "Error: Illegal value for sinkThreads (%s).  Must be 1 or more.", valueStart);
+                            bRetVal = false;
+                            break;
+                        }
+                    }
+                    else if (_strnicmp("sinkQueueDepth", flagStart, flagLength) == 0)
+                    {
+                        parameters->m_sinkQueueDepth = atoi(valueStart);
+                        if (parameters->m_sinkQueueDepth < 1)
+                        {
+                            sprintf(errorMessage, "Error: Illegal value for sinkQueueDepth (%s).  Must be 1 or more.", valueStart);
+                            bRetVal = false;
+                            break;
+                        }
+                    }
                     else if (_strnicmp("widthOutput", flagStart, flagLength) == 0)
                     {
                         parameters->m_widthOutput = atoi(valueStart);
@@ -322,6 +528,25 @@ void PrintUsage(char* pProgramName, char* pMessage)
     printf("     9 = Algorithm 6 and optimized ExtractFrame using DPC++.\n");
     printf("    10 = Algorithm 9 USM but just taking the truncated pixel point.\n");
     printf("    11 = Algorithm 10 USM but on CPU don't copy memory.\n");
+    printf("    20 = Algorithm 17 device memory pipelined across 1 to 3 frame slots to overlap upload, compute and readback.\n");
+    printf("    21 = Algorithm 17 device memory chaining kernels with events (and replaying a SYCL command graph if supported).\n");
+    printf("    22 = Algorithm 4 with a cache of maps and the maps for the predicted next poses computed on idle threads.\n");
+    printf("    23 = Tiled map and nearest/bilinear extraction on a native work stealing thread pool (no SYCL).\n");
+    printf("--asyncFrames requests each frame through the asynchronous (future based) frame API and keeps one frame in\n");
+    printf("    flight, so the frame shown or saved is the one submitted on the previous iteration.  Only algorithm 21 renders\n");
+    printf("    frames into separate buffers; the other algorithms keep rendering each frame synchronously.  Defaults to false.\n");
+    printf("--batch=filePath where filePath is a job file to render without opening any windows.  Each line (other than\n");
+    printf("    blank lines and lines starting with #) is: sourcePath, yaw, pitch, roll, fov, widthOutput, heightOutput, outputPath\n");
+    printf("    Jobs are grouped by source so each source is decoded once.  Uses --algorithm (default 4).  Jobs are rendered at\n");
+    printf("    exactly their size, so with algorithms 7, 8, 14, and 15 the width has to be a multiple of 16 and the height of 8.\n");
+    printf("--batchWorkers=N where N is the number of batch worker threads, each with its own algorithm instance.\n");
+    printf("    Only used with --batch.  Defaults to 0 (one per core).\n");
+    printf("--bufferPool keeps the working buffers (maps, coordinate arrays, and USM images) that variants and frames release\n");
+    printf("    and hands them out again instead of allocating new ones.  The buffer requests and allocations per frame are\n");
+    printf("    reported in the summary either way.  Applies to algorithms 1 to 3, 5, and 17.  Defaults to false.\n");
+    printf("--compare=baselinePath;candidatePath compares the frame times of the runs in two --results files instead of the\n");
+    printf("    normal run.  Runs are matched by algorithm, description, and output size and each change is tested with Welch's\n");
+    printf("    t-test.  Exits with 2 if any run is significantly slower by more than --regressionThreshold.\n");
     printf("--deltaImage is a flag to indicate that the image should be changed between each iteration to\n");
     printf("    simulate a video stream.\n");
     printf("--deltaPitch=N where N is the amount of pitch to add each iteration (up or down).  This can run from\n");
@@ -339,29 +564,88 @@ void PrintUsage(char* pProgramName, char* pMessage)
     printf("    DPC++ algorithms.  Defaults to empty string (select any)\n");
     printf("--endAlgorithm=N where N denotes the last algorithm to run.  Use -1 to run to end of all algorithms.\n");
     printf("    Defaults to -1\n");
+    printf("--frameQueueDepth=N where N is the number of decoded video frames that can be buffered ahead of the algorithms.\n");
+    printf("    Must be 3 or more.  Only used with --video.  Default is 4.\n");
     printf("--fov the number of integer degrees wide to use when flattening the image.  This can be from 1 to 120.  Default is 60.\n");
     printf("--heightOutput=N where N is the number of pixels height the flattened image will be.  Default is 540.\n");
     printf("--help|-h|-? means to display the usage message\n");
+    printf("--hugePages backs the source images, the maps of algorithms 4 and 23, and the output images with 2 MB pages\n");
+    printf("    (explicit huge pages if reserved, otherwise transparent huge pages) to cut TLB misses.  With --pinnedMemory the\n");
+    printf("    pinned buffers are advised to use transparent huge pages.  Defaults to false.\n");
     printf("--img0=filePath where filePath is the path to an equirectangular image to load for the first frame.\n");
     printf("    Defaults to ..\\..\\..\\images\\IMG_20230629_082736_00_095.jpg.\n");
     printf("--img1=filePath where filePath is the path to an equirectangular image to load for the second frame.\n");
     printf("    Defaults to ..\\..\\..\\images\\ImageAndOverlay - equirectangular.jpg.\n");
     printf("--iterations=N where N is the number of iterations.  Defaults to 0 (interactive)\n");
+    printf("--numa runs each variant of algorithm 23 a second time with its threads kept on their NUMA nodes, the source\n");
+    printf("    replicated on every node, and the map and output first touched by the node that processes each tile, then\n");
+    printf("    reports the speedup over the default placement.  Defaults to false.\n");
+    printf("--outputBuffer renders each frame into an output image allocated once per variant (USM for DPC++ algorithms)\n");
+    printf("    instead of a new image each frame.  Takes precedence over --asyncFrames.  Defaults to false.\n");
     printf("--platformName=value where value is a string to match against platform names.\n");
     printf("    Other options include:\n");
     printf("      all - to run on all platforms or\n");
     printf("      list - to list the platforms.\n");
     printf("    Only used for DPC++ algorithms.  Defaults to empty string (select any)\n");
+    printf("--perfCounters reports the dTLB loads and misses of each variant and the IPC, cycles, cache, dTLB, and branch misses\n");
+    printf("    per output pixel of the frame, frame calculation, image extraction, and CPU remap times (Linux perf_event_open).\n");
+    printf("    Defaults to false.\n");
+    printf("--pinnedMemory decodes the source images into pinned (page locked) host memory and reads the DPC++ frames\n");
+    printf("    back into pinned memory so the transfers can use DMA directly.  Upload and readback bandwidth are reported\n");
+    printf("    either way for comparison.  Defaults to false.\n");
     printf("--pitch=N where N is the pitch of the viewer's perspective (up or down).  This can run from\n");
     printf("    -90 to 90 integer degrees.  The negative values are down and positive are up.  0 is straight ahead.  Default is 0\n");
+    printf("--poolPinning pins each thread of the work stealing pool (algorithm 23) to its own hardware thread.\n");
+    printf("    Defaults to false.\n");
+    printf("--poolScaling runs algorithm 23 with 1, 2, 4, ... threads up to --poolThreads and reports the speedup and\n");
+    printf("    efficiency of each relative to 1 thread.  Defaults to false (only --poolThreads threads).\n");
+    printf("--poolThreads=N where N is the number of threads in the work stealing pool of algorithm 23.  Default is 0\n");
+    printf("    (one per hardware thread).\n");
+    printf("--rankDevices picks among the devices that match --typePreference, --platformName, --deviceName, and\n");
+    printf("    --driverVersion by the frames per second of a small remap benchmark at the output size instead of by compute\n");
+    printf("    units.  The results are cached per device, driver, and output size in --rankingCache.  Defaults to false.\n");
+    printf("--rankingCache=filePath where filePath is the --rankDevices cache file.  Defaults to DeviceRanking.txt.\n");
+    printf("--regressionThreshold=N where N is the percent a significantly slower frame time must exceed to count as a\n");
+    printf("    regression with --compare.  Default is 5.\n");
+    printf("--results=filePath saves a record of each run (settings, device, driver, CPU model, git revision, and the frame\n");
+    printf("    time statistics) to filePath as CSV if it ends in .csv and JSON otherwise.  Defaults to none.\n");
     printf("--roll=N where N defines how level the camera is.  This can run from 0 to 360 degrees.  The rotation is counter\n");
     printf("    clockwise so 90 integer degrees will lift the right side of the 'camera' up to be on top.  180 will flip the\n");
     printf("     'camera' upside down.  270 will place the left side of the camera on top.  Default is 0\n");
+    printf("--serve=socketPath runs a render service on the Unix domain socket socketPath instead of the normal run.  The\n");
+    printf("    algorithm (--algorithm, default 17) stays initialized between requests.  Each request is a text line\n");
+    printf("    \"RENDER sourcePath yaw pitch roll fov widthOutput heightOutput\" answered by \"OK width height bytes\" and the\n");
+    printf("    BGR pixels, \"BUSY\" when the queue is full, or \"ERROR message\".  \"STATS\" returns the latency percentiles and\n");
+    printf("    \"SHUTDOWN\" stops the service.  Requests are rendered at exactly their size, so with algorithms 7, 8, 14, and 15\n");
+    printf("    the width has to be a multiple of 16 and the height of 8.  Defaults to empty string (no service).\n");
+    printf("--serviceQueueDepth=N where N is the number of render requests that can wait before the service answers BUSY.\n");
+    printf("    Only used with --serve.  Default is 16.\n");
+    printf("--shmRing=name publishes every rendered frame (with its pose, frame number, and timestamps) into the shared\n");
+    printf("    memory ring called name so other processes can read the frames in place.  See ShmRingConsumer for a sample\n");
+    printf("    consumer.  Defaults to empty string (no ring).\n");
+    printf("--shmSlots=N where N is the number of frames the shared memory ring holds.  Only used with --shmRing.  Default is 4.\n");
+    printf("--sinkPath=path encodes every rendered frame on the frame sink's encoder threads.  A path ending in .avi, .mp4,\n");
+    printf("    .mkv, or .mov is written as a video.  Otherwise the path is a JPEG name that is numbered per frame (it may\n");
+    printf("    also be a pattern with one integer conversion such as out/flat-%%06lld.jpg).  In interactive mode the s key goes\n");
+    printf("    to the sink as well.\n");
+    printf("    Defaults to empty string (no sink).\n");
+    printf("--sinkQueueDepth=N where N is the number of frames that can wait for an encoder before frames are dropped.\n");
+    printf("    Only used with --sinkPath.  Default is 8.\n");
+    printf("--sinkThreads=N where N is the number of encoder threads for JPEG sinks.  Only used with --sinkPath.  Default is 2.\n");
     printf("--startAlgorithm=N where N defines the first algorithm number to run and then all algorithms up to and including\n");
     printf("    --endAlgorithm will be run in succession.  Defaults to 0.\n");
     printf("--showFrames indicates each calculated frame should be shown.  Defaults to true for interactive mode, false otherwise.\n");
     printf("--typePreference=type1;type2;... where the types can be CPU, GPU, or \n");
     printf("    ACC (for Accelerator such as FPGA.  type1 is highest preference, then type2, etc.\n");
+    printf("--video=filePath where filePath is a video file (any format cv::VideoCapture can open) to decode on a separate\n");
+    printf("    thread and use as the frame source instead of --img0 and --img1.  Each iteration moves to the next frame and the\n");
+    printf("    video loops back to the start when it ends.  In interactive mode the f key moves to the next frame.\n");
+    printf("--warmupKernels builds the kernels of every algorithm for the selected devices (all devices with --deviceName=all\n");
+    printf("    or --platformName=all) on one thread per device while the images load, and turns on the persistent kernel cache\n");
+    printf("    (SYCL_CACHE_PERSISTENT) unless the environment sets it.  The cold start to first frame time is reported either way.\n");
+    printf("    Defaults to false.\n");
+    printf("--warmupIterations=N where N is the number of first results of each timing type reported as warmup instead of\n");
+    printf("    being included in the averages and the p50/p90/p99/p99.9 latency percentiles.  Default is 1.\n");
     printf("--widthOutput=N where N is the number of pixels width the flattened image will be.  Default is 1080.\n");
     printf("--yaw=N where N defines the yaw of the viewer's perspective (left or right angle).  This can run from\n");
     printf("    -180 to 180 integer degrees.  Negative values are to the left of center and positive to the right.  0 is\n");
@@ -26,7 +26,7 @@
 const int MAX_PATH = 1024;
 const int MAX_ERROR_MESSAGE = 1024;
 const float DEGREE_CONVERSION_FACTOR = 2.0f * M_PI / 360.0f;
-const int MAX_ALGORITHM = 19;
+const int MAX_ALGORITHM = 23;
 
 typedef struct _SParameters {
 	// m_algorithm defines the algorithm to use during the current run of the program
@@ -79,6 +79,40 @@ typedef struct _SParameters {
 	cv::Mat		m_image[2];
 	// m_imageIndex holds the index into m_image that is the current image being used.
 	int			m_imageIndex;
+	// m_videoFilename holds the path to a video file to decode frames from instead of using the two images in
+	// m_imgFilename.  When this is "" (the default), the two images are used.  When a video is used, each
+	// iteration advances to the next decoded frame (stored in the m_image entry that was not current).
+	char		m_videoFilename[MAX_PATH];
+	// m_frameQueueDepth is the number of decoded frames the video frame source can buffer ahead of the algorithms
+	int			m_frameQueueDepth;
+	// m_warmupIterations is the number of first results of each timing type that TimingStats reports as warmup
+	// rather than folding into the averages and percentiles
+	int			m_warmupIterations;
+	// m_batchFilename holds the path to a batch job file.  When this is set the jobs in the file are rendered
+	// without any windows (see BatchRunner) instead of the normal run.  Defaults to "" (no batch).
+	char		m_batchFilename[MAX_PATH];
+	// m_batchWorkers is the number of batch worker threads (each with its own algorithm).  0 means one per core.
+	int			m_batchWorkers;
+	// m_servePath holds the path of the Unix domain socket to serve render requests on (see RenderService).  When
+	// this is set the program runs as a render service instead of the normal run.  Defaults to "" (no service).
+	char		m_servePath[MAX_PATH];
+	// m_serviceQueueDepth is the number of render requests that can wait before the service answers BUSY
+	int			m_serviceQueueDepth;
+	// m_shmRingName is the name of a shared memory ring (see SharedMemoryRing) to publish every rendered frame to for
+	// other processes.  When this is "" (the default) no ring is created.
+	char		m_shmRingName[MAX_PATH];
+	// m_shmSlots is the number of frames the shared memory ring holds
+	int			m_shmSlots;
+	// m_poolThreads is the number of threads in the native work stealing pool (algorithm 23).  0 means one per
+	// hardware thread.
+	int			m_poolThreads;
+	// m_sinkPath is where the frame sink encodes each rendered frame to.  A video extension (.avi, .mp4, .mkv, .mov)
+	// writes a video, anything else is a JPEG file name pattern.  When this is "" (the default) no sink is used.
+	char		m_sinkPath[MAX_PATH];
+	// m_sinkThreads is the number of encoder threads used by the frame sink (video sinks always use 1)
+	int			m_sinkThreads;
+	// m_sinkQueueDepth is the number of rendered frames that can wait for an encoder before frames are dropped
+	int			m_sinkQueueDepth;
 	// m_typePreference provides a way to specify the type of the device to select when
 	// running.  This can be "" to allow any type to be selected or it can be CPU, GPU, or
 	// ACC (accelerator such as FPGA).  It can also be a semi-colon (;) separated priority
@@ -105,6 +139,40 @@ typedef struct _SParameters {
 	// will be considered depending on how the other parameters are set.
 	std::string m_driverVersion;
 	bool m_bShowFrames;
+	// m_bAsyncFrames tells the main loop to request frames through ExtractFrameImageAsync rather than ExtractFrameImage
+	bool m_bAsyncFrames;
+	// m_bOutputBuffer tells the main loop to allocate the output image once per variant (through the algorithm so
+	// DPC++ algorithms can provide USM memory) and have the algorithm render into it each frame
+	bool m_bOutputBuffer;
+	// m_bPinnedMemory places the source images and the read back frames in pinned (sycl::malloc_host) memory
+	bool m_bPinnedMemory;
+	// m_bPoolPinning pins each work stealing pool thread to its own hardware thread
+	bool m_bPoolPinning;
+	// m_bHugePages backs the source images, maps, and output images with 2 MB pages (see HugePageAllocator)
+	bool m_bHugePages;
+	// m_bBufferPool keeps the released working buffers (see BufferPool) for reuse instead of freeing them
+	bool m_bBufferPool;
+	// m_bWarmupKernels builds the kernels for the selected devices while the images load (see KernelWarmup)
+	bool m_bWarmupKernels;
+	// m_bRankDevices ranks the matching devices by measured frames per second (see DeviceBenchmark)
+	bool m_bRankDevices;
+	// m_rankingCache is the file of cached DeviceBenchmark results.  Empty means DEFAULT_RANKING_CACHE.
+	char		m_rankingCache[MAX_PATH];
+	// m_bPerfCounters reports hardware counters (see PerfCounters) for each variant and for the timed frame sections
+	bool m_bPerfCounters;
+	// m_bNuma runs each work stealing pool variant a second time with NUMA aware placement of the threads and memory
+	bool m_bNuma;
+	// m_bPoolScaling runs the work stealing pool with 1, 2, 4, ... threads up to m_poolThreads to report the scaling
+	bool m_bPoolScaling;
+	// m_resultsPath is the JSON or CSV file (by extension) that ResultsWriter saves a record of each run to.
+	// Empty (the default) means no results file.
+	char		m_resultsPath[MAX_PATH];
+	// m_compareBaseline and m_compareCandidate are the results files to compare (see ResultsWriter::Compare)
+	// instead of the normal run.  Empty (the default) means no comparison.
+	char		m_compareBaseline[MAX_PATH];
+	char		m_compareCandidate[MAX_PATH];
+	// m_regressionThreshold is how many percent slower a significant frame time change must be to be a regression
+	double		m_regressionThreshold;
 
 	_SParameters();
 
@@ -0,0 +1,278 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "PerfCounters.hpp"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char* PerfCounters::c_counterNames[PERF_COUNTER_MAX] = { "dTLB loads", "dTLB load misses" };
+
+PerfCounters::PerfCounters()
+{
+	m_bOpen = false;
+	for (int counter = 0; counter < PERF_COUNTER_MAX; counter++)
+	{
+		m_fds[counter] = -1;
+		m_values[counter] = 0;
+	}
+}
+
+PerfCounters::~PerfCounters()
+{
+	Close();
+}
+
+bool PerfCounters::Open()
+{
+#ifdef __linux__
+	for (int counter = 0; counter < PERF_COUNTER_MAX; counter++)
+	{
+		struct perf_event_attr attr;
+
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HW_CACHE;
+		attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+			((counter == PERF_DTLB_LOAD_MISSES ? PERF_COUNT_HW_CACHE_RESULT_MISS : PERF_COUNT_HW_CACHE_RESULT_ACCESS) << 16);
+		attr.disabled = 1;
+		attr.inherit = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		// pid 0 and cpu -1 counts this process on any CPU
+		m_fds[counter] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+		if (m_fds[counter] < 0)
+		{
+			printf("Warning: Could not open the %s counter (check /proc/sys/kernel/perf_event_paranoid)\n", c_counterNames[counter]);
+			Close();
+
+			return false;
+		}
+	}
+	m_bOpen = true;
+#endif
+
+	return m_bOpen;
+}
+
+void PerfCounters::Close()
+{
+#ifdef __linux__
+	for (int counter = 0; counter < PERF_COUNTER_MAX; counter++)
+	{
+		if (m_fds[counter] >= 0)
+		{
+			close(m_fds[counter]);
+			m_fds[counter] = -1;
+		}
+	}
+#endif
+	m_bOpen = false;
+}
+
+void PerfCounters::Start()
+{
+	for (int counter = 0; counter < PERF_COUNTER_MAX; counter++)
+	{
+		m_values[counter] = 0;
+	}
+#ifdef __linux__
+	if (m_bOpen)
+	{
+		for (int counter = 0; counter < PERF_COUNTER_MAX; counter++)
+		{
+			ioctl(m_fds[counter], PERF_EVENT_IOC_RESET, 0);
+			ioctl(m_fds[counter], PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+#endif
+}
+
+void PerfCounters::Stop()
+{
+#ifdef __linux__
+	if (m_bOpen)
+	{
+		for (int counter = 0; counter < PERF_COUNTER_MAX; counter++)
+		{
+			long long value = 0;
+
+			ioctl(m_fds[counter], PERF_EVENT_IOC_DISABLE, 0);
+			if (read(m_fds[counter], &value, sizeof(value)) == sizeof(value))
+			{
+				m_values[counter] = value;
+			}
+		}
+	}
+#endif
+}
+
+long long PerfCounters::GetValue(EPerfCounter counter)
+{
+	return m_values[counter];
+}
+
+std::string PerfCounters::GetStatsString(long long frames)
+{
+	char line[512];
+
+	if (!m_bOpen)
+	{
+		return "Perf counters,unavailable\n";
+	}
+
+	double missRate = 0.0;
+
+	if (m_values[PERF_DTLB_LOADS] > 0)
+	{
+		missRate = (double)m_values[PERF_DTLB_LOAD_MISSES] * 100.0 / (double)m_values[PERF_DTLB_LOADS];
+	}
+	sprintf(line, "Perf counters,%lld,dTLB loads,%lld,dTLB load misses,%8.4f,%% dTLB miss rate,%12.1f,dTLB load misses per frame\n",
+		m_values[PERF_DTLB_LOADS], m_values[PERF_DTLB_LOAD_MISSES], missRate,
+		frames > 0 ? (double)m_values[PERF_DTLB_LOAD_MISSES] / (double)frames : 0.0);
+
+	return line;
+}
+
+const char* PerfCounterGroup::c_counterNames[PERF_GROUP_MAX] = { "cycles", "instructions", "LLC misses", "dTLB misses", "branch misses" };
+std::atomic<bool> PerfCounterGroup::c_bWarningPrinted(false);
+
+PerfCounterGroup::PerfCounterGroup()
+{
+	m_bOpen = false;
+	for (int counter = 0; counter < PERF_GROUP_MAX; counter++)
+	{
+		m_fds[counter] = -1;
+	}
+}
+
+PerfCounterGroup::~PerfCounterGroup()
+{
+	Close();
+}
+
+bool PerfCounterGroup::Open()
+{
+#ifdef __linux__
+	for (int counter = 0; counter < PERF_GROUP_MAX; counter++)
+	{
+		struct perf_event_attr attr;
+
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		switch (counter)
+		{
+		case PERF_GROUP_CYCLES:
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_CPU_CYCLES;
+			break;
+		case PERF_GROUP_INSTRUCTIONS:
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+			break;
+		case PERF_GROUP_LLC_MISSES:
+			attr.type = PERF_TYPE_HW_CACHE;
+			attr.config = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+			break;
+		case PERF_GROUP_DTLB_MISSES:
+			attr.type = PERF_TYPE_HW_CACHE;
+			attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+			break;
+		case PERF_GROUP_BRANCH_MISSES:
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+			break;
+		}
+		attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		// pid 0 and cpu -1 counts the calling thread on any CPU.  The first counter leads the group.
+		m_fds[counter] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, (counter == 0) ? -1 : m_fds[0], 0);
+		if (m_fds[counter] < 0)
+		{
+			if (!c_bWarningPrinted.exchange(true))
+			{
+				printf("Warning: Could not open the %s counter (check /proc/sys/kernel/perf_event_paranoid)\n", c_counterNames[counter]);
+			}
+			Close();
+
+			return false;
+		}
+	}
+	m_bOpen = true;
+#endif
+
+	return m_bOpen;
+}
+
+void PerfCounterGroup::Close()
+{
+#ifdef __linux__
+	// Close the members before the group leader
+	for (int counter = PERF_GROUP_MAX - 1; counter >= 0; counter--)
+	{
+		if (m_fds[counter] >= 0)
+		{
+			close(m_fds[counter]);
+			m_fds[counter] = -1;
+		}
+	}
+#endif
+	m_bOpen = false;
+}
+
+bool PerfCounterGroup::IsOpen()
+{
+	return m_bOpen;
+}
+
+bool PerfCounterGroup::Read(long long values[PERF_GROUP_MAX])
+{
+#ifdef __linux__
+	if (m_bOpen)
+	{
+		// PERF_FORMAT_GROUP returns the number of counters, the enabled and running times, then the counts
+		unsigned long long data[3 + PERF_GROUP_MAX];
+
+		if (read(m_fds[0], data, sizeof(data)) == sizeof(data) && data[0] == PERF_GROUP_MAX)
+		{
+			unsigned long long timeEnabled = data[1];
+			unsigned long long timeRunning = data[2];
+
+			for (int counter = 0; counter < PERF_GROUP_MAX; counter++)
+			{
+				if (timeRunning > 0 && timeRunning < timeEnabled)
+				{
+					values[counter] = (long long)((double)data[3 + counter] * (double)timeEnabled / (double)timeRunning);
+				}
+				else
+				{
+					values[counter] = (long long)data[3 + counter];
+				}
+			}
+
+			return true;
+		}
+	}
+#endif
+
+	return false;
+}
@@ -0,0 +1,97 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// PerfCounters reads hardware event counts for the whole process (including threads created after Open) through
+// the Linux perf_event_open interface.  Open it before any worker threads of interest are created, since only
+// threads created afterwards inherit the counters.  Reading an inherited counter sums the opening thread and every
+// thread that inherited it, whether still running or already exited, so a read while workers run gives the counts
+// so far; Stop after the variant's threads are joined (i.e., after StopVariant) so all of their work is included.
+// On other platforms, or when /proc/sys/kernel/perf_event_paranoid does not allow counting, Open returns false and
+// the statistics say the counters are unavailable.
+//
+// PerfCounterGroup reads a group of counters (cycles, instructions, LLC misses, dTLB misses, and branch misses) of
+// the calling thread only; the group is not inherited, as many kernels refuse group reads of inherited counters.
+// The counters run from Open on and Read returns the running counts, so the counts of a section of code are the
+// difference of a Read before and after it (see TimingStats::StartCounters).  The group is scheduled onto the PMU
+// as a whole so the counts of one Read are from the same intervals; when the kernel has to multiplex the counters
+// the counts are scaled up to the time the group was enabled.
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+enum EPerfCounter {
+	PERF_DTLB_LOADS = 0,
+	PERF_DTLB_LOAD_MISSES,
+	PERF_COUNTER_MAX
+};
+
+enum EPerfGroupCounter {
+	PERF_GROUP_CYCLES = 0,
+	PERF_GROUP_INSTRUCTIONS,
+	PERF_GROUP_LLC_MISSES,
+	PERF_GROUP_DTLB_MISSES,
+	PERF_GROUP_BRANCH_MISSES,
+	PERF_GROUP_MAX
+};
+
+// Each last level cache miss fills one line, so the misses times the line size estimates the memory read traffic
+const int PERF_CACHE_LINE_BYTES = 64;
+
+class PerfCounters {
+private:
+	int m_fds[PERF_COUNTER_MAX];
+	long long m_values[PERF_COUNTER_MAX];
+	bool m_bOpen;
+
+	static const char* c_counterNames[PERF_COUNTER_MAX];
+
+public:
+	PerfCounters();
+	~PerfCounters();
+
+	bool Open();
+	void Close();
+	// Start zeroes and enables the counters; Stop disables them and reads the totals
+	void Start();
+	void Stop();
+
+	long long GetValue(EPerfCounter counter);
+	// GetStatsString reports the totals from the last Stop and the counts per frame
+	std::string GetStatsString(long long frames);
+};
+
+class PerfCounterGroup {
+private:
+	int m_fds[PERF_GROUP_MAX];
+	bool m_bOpen;
+
+	static const char* c_counterNames[PERF_GROUP_MAX];
+	// Every thread opens its own group, so only the first failure is reported
+	static std::atomic<bool> c_bWarningPrinted;
+
+public:
+	PerfCounterGroup();
+	~PerfCounterGroup();
+
+	// Open starts counting the calling thread.  Call it from the thread to be measured.
+	bool Open();
+	void Close();
+	bool IsOpen();
+	// Read fills values with the counts since Open.  Returns false if the group is not open or cannot be read.
+	bool Read(long long values[PERF_GROUP_MAX]);
+};
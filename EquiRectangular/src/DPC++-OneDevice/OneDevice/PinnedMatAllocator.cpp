@@ -0,0 +1,136 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "PinnedMatAllocator.hpp"
+#include "HugePageAllocator.hpp"
+#include <iostream>
+
+PinnedMatAllocator* PinnedMatAllocator::c_pPinnedAllocator = NULL;
+
+void PinnedMatAllocator::Initialize(const sycl::device& device)
+{
+	if (c_pPinnedAllocator == NULL)
+	{
+		c_pPinnedAllocator = new PinnedMatAllocator(sycl::context(device.get_platform().get_devices()));
+	}
+}
+
+PinnedMatAllocator* PinnedMatAllocator::GetPinnedAllocator()
+{
+	return c_pPinnedAllocator;
+}
+
+void PinnedMatAllocator::Terminate()
+{
+	// Any cv::Mat still using the allocator must be released before this is called
+	delete c_pPinnedAllocator;
+	c_pPinnedAllocator = NULL;
+}
+
+sycl::context PinnedMatAllocator::GetContext(const sycl::device& device)
+{
+	if (c_pPinnedAllocator != NULL)
+	{
+		for (auto& contextDevice : c_pPinnedAllocator->m_context.get_devices())
+		{
+			if (contextDevice == device)
+			{
+				return c_pPinnedAllocator->m_context;
+			}
+		}
+	}
+
+	return sycl::context(device);
+}
+
+PinnedMatAllocator::PinnedMatAllocator(const sycl::context& context)
+{
+	m_context = context;
+}
+
+const sycl::context& PinnedMatAllocator::GetAllocatorContext()
+{
+	return m_context;
+}
+
+// This follows cv::StdMatAllocator with sycl::malloc_host in place of cv::fastMalloc
+cv::UMatData* PinnedMatAllocator::allocate(int dims, const int* sizes, int type, void* data0, size_t* step, cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const
+{
+	size_t total = CV_ELEM_SIZE(type);
+
+	for (int i = dims - 1; i >= 0; i--)
+	{
+		if (step)
+		{
+			if (data0 && step[i] != CV_AUTOSTEP)
+			{
+				CV_Assert(total <= step[i]);
+				total = step[i];
+			}
+			else
+			{
+				step[i] = total;
+			}
+		}
+		total *= sizes[i];
+	}
+
+	unsigned char* data = (unsigned char*)data0;
+	if (data == NULL)
+	{
+		data = (unsigned char*)sycl::malloc_host(total, m_context);
+		if (data == NULL)
+		{
+			std::cout << "PinnedMatAllocator: malloc_host of " << total << " bytes failed" << std::endl;
+			throw std::bad_alloc();
+		}
+		if (HugePageAllocator::GetHugePageAllocator() != NULL)
+		{
+			// Host USM comes from the runtime so only transparent huge pages can be requested (and the runtime may
+			// have already touched the pages)
+			HugePageAllocator::Advise(data, total);
+		}
+	}
+
+	cv::UMatData* u = new cv::UMatData(this);
+	u->data = u->origdata = data;
+	u->size = total;
+	if (data0)
+	{
+		u->flags |= cv::UMatData::USER_ALLOCATED;
+	}
+
+	return u;
+}
+
+bool PinnedMatAllocator::allocate(cv::UMatData* u, cv::AccessFlag accessflags, cv::UMatUsageFlags usageFlags) const
+{
+	return u != NULL;
+}
+
+void PinnedMatAllocator::deallocate(cv::UMatData* u) const
+{
+	if (u != NULL)
+	{
+		CV_Assert(u->urefcount == 0);
+		CV_Assert(u->refcount == 0);
+		if (!(u->flags & cv::UMatData::USER_ALLOCATED))
+		{
+			sycl::free(u->origdata, m_context);
+			u->origdata = NULL;
+		}
+		delete u;
+	}
+}
@@ -0,0 +1,52 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// PinnedMatAllocator lets cv::Mat memory come from sycl::malloc_host (pinned, page locked memory).  Copies between
+// pinned host memory and device memory can be done directly by the device's DMA engine, whereas copies from normal
+// (pageable) memory force the runtime to bounce the data through an internal pinned buffer first.
+//
+// USM is only recognized within the sycl::context it was allocated in, so the allocator owns one context covering
+// every device of the selected platform and DpcppBaseAlgorithm creates its queues in that context when
+// --pinnedMemory is used.
+
+#include <sycl/sycl.hpp>
+#include "opencv2/core/core.hpp"
+
+class PinnedMatAllocator : public cv::MatAllocator {
+private:
+	static PinnedMatAllocator* c_pPinnedAllocator;
+
+	sycl::context m_context;
+
+public:
+	// Initialize creates the allocator with a context over all the devices on the platform of the given device
+	static void Initialize(const sycl::device& device);
+	// GetPinnedAllocator returns NULL if Initialize was not called
+	static PinnedMatAllocator* GetPinnedAllocator();
+	static void Terminate();
+	// GetContext returns the shared context if the device is part of it.  Otherwise a context for just the device is
+	// returned (pinned images will then be treated as pageable memory by that device).
+	static sycl::context GetContext(const sycl::device& device);
+
+	PinnedMatAllocator(const sycl::context& context);
+
+	const sycl::context& GetAllocatorContext();
+
+	virtual cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step, cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const;
+	virtual bool allocate(cv::UMatData* data, cv::AccessFlag accessflags, cv::UMatUsageFlags usageFlags) const;
+	virtual void deallocate(cv::UMatData* data) const;
+};
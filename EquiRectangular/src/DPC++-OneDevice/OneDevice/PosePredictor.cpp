@@ -0,0 +1,171 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "PosePredictor.hpp"
+#include <stdlib.h>
+
+PosePredictor::PosePredictor()
+{
+	Reset();
+}
+
+void PosePredictor::Reset()
+{
+	m_history.clear();
+	m_lastYawStep = 0;
+	m_lastPitchStep = 0;
+}
+
+int PosePredictor::YawDelta(int fromYaw, int toYaw)
+{
+	int delta = toYaw - fromYaw;
+
+	if (delta > 180)
+	{
+		delta -= 360;
+	}
+	else if (delta < -180)
+	{
+		delta += 360;
+	}
+
+	return delta;
+}
+
+void PosePredictor::AddPose(const SPose& pose)
+{
+	if (!m_history.empty())
+	{
+		SPose& last = m_history.back();
+
+		if (last == pose)
+		{
+			return;
+		}
+
+		int yawStep = abs(YawDelta(last.m_yaw, pose.m_yaw));
+		int pitchStep = abs(pose.m_pitch - last.m_pitch);
+
+		if (yawStep != 0)
+		{
+			m_lastYawStep = yawStep;
+		}
+		if (pitchStep != 0)
+		{
+			m_lastPitchStep = pitchStep;
+		}
+	}
+	m_history.push_back(pose);
+	if (m_history.size() > POSE_HISTORY)
+	{
+		m_history.pop_front();
+	}
+}
+
+std::vector<SPose> PosePredictor::Predict(int maxPredictions)
+{
+	std::vector<SPose> candidates;
+	std::vector<SPose> predictions;
+
+	if (m_history.empty())
+	{
+		return predictions;
+	}
+
+	const SPose& current = m_history.back();
+
+	if (m_history.size() >= 2)
+	{
+		const SPose& previous = m_history[m_history.size() - 2];
+		int yawVelocity = YawDelta(previous.m_yaw, current.m_yaw);
+		int pitchVelocity = current.m_pitch - previous.m_pitch;
+		int rollVelocity = current.m_roll - previous.m_roll;
+		int fovVelocity = current.m_fov - previous.m_fov;
+
+		// Constant velocity, one and two steps ahead
+		for (int step = 1; step <= 2; step++)
+		{
+			candidates.push_back({ current.m_yaw + yawVelocity * step, current.m_pitch + pitchVelocity * step,
+				current.m_roll + rollVelocity * step, current.m_fov + fovVelocity * step });
+		}
+	}
+	// One step in each direction from where the viewer is now
+	if (m_lastYawStep != 0)
+	{
+		candidates.push_back({ current.m_yaw + m_lastYawStep, current.m_pitch, current.m_roll, current.m_fov });
+		candidates.push_back({ current.m_yaw - m_lastYawStep, current.m_pitch, current.m_roll, current.m_fov });
+	}
+	if (m_lastPitchStep != 0)
+	{
+		candidates.push_back({ current.m_yaw, current.m_pitch + m_lastPitchStep, current.m_roll, current.m_fov });
+		candidates.push_back({ current.m_yaw, current.m_pitch - m_lastPitchStep, current.m_roll, current.m_fov });
+	}
+
+	for (auto& candidate : candidates)
+	{
+		SPose pose = Normalize(candidate);
+		bool bDuplicate = pose == current;
+
+		for (auto& prediction : predictions)
+		{
+			bDuplicate = bDuplicate || prediction == pose;
+		}
+		if (!bDuplicate && (int)predictions.size() < maxPredictions)
+		{
+			predictions.push_back(pose);
+		}
+	}
+
+	return predictions;
+}
+
+SPose PosePredictor::Normalize(SPose pose)
+{
+	// Keep this in step with the clamping at the top of the main loop
+	if (pose.m_pitch > 90)
+	{
+		pose.m_pitch = 90;
+	}
+	else if (pose.m_pitch < -90)
+	{
+		pose.m_pitch = -90;
+	}
+	if (pose.m_fov < 10)
+	{
+		pose.m_fov = 10;
+	}
+	else if (pose.m_fov > 120)
+	{
+		pose.m_fov = 120;
+	}
+	if (pose.m_yaw > 180)
+	{
+		pose.m_yaw = (-180 + pose.m_yaw) % 360 - 180;
+	}
+	else if (pose.m_yaw < -180)
+	{
+		pose.m_yaw = (180 + pose.m_yaw) % 360 + 180;
+	}
+	if (pose.m_roll < 0)
+	{
+		pose.m_roll = 360 + (pose.m_roll % -360);
+	}
+	else if (pose.m_roll >= 360)
+	{
+		pose.m_roll = pose.m_roll % 360;
+	}
+
+	return pose;
+}
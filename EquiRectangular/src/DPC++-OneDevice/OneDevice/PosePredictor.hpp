@@ -0,0 +1,64 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// PosePredictor guesses the next viewer poses from the recent pose history so the map for a pose can be computed
+// before it is requested.  The first guesses assume the viewer keeps moving at the last velocity (one and two steps
+// ahead).  The remaining guesses are one step (the last non-zero step on that axis) left, right, up, and down
+// from the current pose, which covers a viewer who is still but will press an arrow key next.
+
+#include <deque>
+#include <vector>
+
+// Number of poses of history kept
+const int POSE_HISTORY = 4;
+// Most poses Predict can return (two constant velocity guesses and four single steps)
+const int POSE_MAX_PREDICTIONS = 6;
+
+struct SPose {
+	int m_yaw;
+	int m_pitch;
+	int m_roll;
+	int m_fov;
+
+	bool operator==(const SPose& a) const
+	{
+		return m_yaw == a.m_yaw && m_pitch == a.m_pitch && m_roll == a.m_roll && m_fov == a.m_fov;
+	}
+};
+
+class PosePredictor {
+private:
+	std::deque<SPose> m_history;
+	// m_lastStep holds the last non-zero yaw and pitch change (sign dropped) for the one step guesses
+	int m_lastYawStep;
+	int m_lastPitchStep;
+
+private:
+	// YawDelta returns the change in yaw taking the wrap at +/-180 into account
+	static int YawDelta(int fromYaw, int toYaw);
+
+public:
+	PosePredictor();
+
+	void Reset();
+	// AddPose records the pose being rendered.  Repeats of the last pose are ignored.
+	void AddPose(const SPose& pose);
+	// Predict returns up to maxPredictions poses, most likely first.  The current pose is never included.
+	std::vector<SPose> Predict(int maxPredictions);
+	// Normalize applies the same wrapping and clamping the main loop applies to the parameters
+	static SPose Normalize(SPose pose);
+};
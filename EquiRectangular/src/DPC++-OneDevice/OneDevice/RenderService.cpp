@@ -0,0 +1,566 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "RenderService.hpp"
+#include <algorithm>
+#include <iostream>
+#include "opencv2/imgcodecs.hpp"
+#include "TimingStats.hpp"
+
+#ifdef _WIN32
+#include <afunix.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+const ServiceSocket INVALID_SOCKET = -1;
+#endif
+
+#ifdef MSG_NOSIGNAL
+// A client that disconnects while a frame is being sent must not raise SIGPIPE (which would end the service); the
+// send fails with EPIPE instead and only that client's connection is closed
+const int SERVICE_SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int SERVICE_SEND_FLAGS = 0;
+#endif
+
+#ifdef VTUNE_API
+#include "ittnotify.h"
+#pragma comment(lib, "libittnotify.lib")
+extern __itt_domain* pittTests_domain;
+// Create string handle for denoting when a service request is being rendered
+wchar_t const* pRenderServiceRender = _T("RenderService Render");
+__itt_string_handle* handle_RenderService_render = __itt_string_handle_create(pRenderServiceRender);
+#endif
+
+RenderService::RenderService(SParameters& parameters, CreateAlgorithmFunc pCreateAlgorithm)
+{
+	m_baseParameters = parameters;
+	m_pCreateAlgorithm = pCreateAlgorithm;
+	m_algorithm = (parameters.m_algorithm > -1) ? parameters.m_algorithm : DEFAULT_SERVICE_ALGORITHM;
+	m_widthAlignment = 1;
+	m_heightAlignment = 1;
+
+	// Constructing an algorithm does not touch a device, so a throwaway instance can report the alignment
+	BaseAlgorithm* pAlg = m_pCreateAlgorithm(m_algorithm, m_baseParameters);
+
+	if (pAlg != NULL)
+	{
+		pAlg->GetOutputAlignment(m_widthAlignment, m_heightAlignment);
+		delete pAlg;
+	}
+	m_socketPath = parameters.m_servePath;
+	m_queueDepth = (parameters.m_serviceQueueDepth > 0) ? parameters.m_serviceQueueDepth : 1;
+	m_listenSocket = INVALID_SOCKET;
+	m_bStopRequested = false;
+	m_pRenderThread = NULL;
+	m_statRequests = 0;
+	m_statRendered = 0;
+	m_statCoalesced = 0;
+	m_statRejected = 0;
+	m_statErrors = 0;
+}
+
+RenderService::~RenderService()
+{
+	Stop();
+}
+
+bool RenderService::Open()
+{
+	struct sockaddr_un address;
+
+#ifdef _WIN32
+	WSADATA wsaData;
+
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+	{
+		printf("RenderService: WSAStartup failed\n");
+		return false;
+	}
+#endif
+	if (m_socketPath.length() >= sizeof(address.sun_path))
+	{
+		printf("RenderService: socket path %s is too long\n", m_socketPath.c_str());
+		return false;
+	}
+	m_listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (m_listenSocket == INVALID_SOCKET)
+	{
+		printf("RenderService: unable to create a socket\n");
+		return false;
+	}
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, m_socketPath.c_str(), sizeof(address.sun_path) - 1);
+	// Remove a socket file left behind by a previous run
+	remove(m_socketPath.c_str());
+	if (bind(m_listenSocket, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(m_listenSocket, SOMAXCONN) != 0)
+	{
+		printf("RenderService: unable to listen on %s\n", m_socketPath.c_str());
+		CloseSocket(m_listenSocket);
+		m_listenSocket = INVALID_SOCKET;
+		return false;
+	}
+
+	return true;
+}
+
+void RenderService::Run()
+{
+	m_bStopRequested = false;
+	m_pRenderThread = new std::thread([this] { renderThreadFunc(); });
+	printf("RenderService: listening on %s\n", m_socketPath.c_str());
+	while (true)
+	{
+		ServiceSocket clientSocket = accept(m_listenSocket, NULL, NULL);
+
+		if (clientSocket == INVALID_SOCKET)
+		{
+			// Stop closes the listening socket to break out of accept
+			break;
+		}
+
+		std::lock_guard<std::mutex> queueLock(m_queueMutex);
+		if (m_bStopRequested)
+		{
+			CloseSocket(clientSocket);
+			break;
+		}
+		ReapClientThreads();
+		m_clientSockets.insert(clientSocket);
+		m_clientThreads.push_back(new std::thread([this, clientSocket] { clientThreadFunc(clientSocket); }));
+	}
+	Stop();
+}
+
+// Must be called with m_queueMutex held.  Joins the client threads that have finished so a long running service does
+// not collect one thread object per connection.
+void RenderService::ReapClientThreads()
+{
+	for (auto finishedId : m_finishedClientThreads)
+	{
+		for (auto pThread = m_clientThreads.begin(); pThread != m_clientThreads.end(); pThread++)
+		{
+			if ((*pThread)->get_id() == finishedId)
+			{
+				// The thread no longer needs m_queueMutex once it is on the finished list, so this join is short
+				(*pThread)->join();
+				delete *pThread;
+				m_clientThreads.erase(pThread);
+				break;
+			}
+		}
+	}
+	m_finishedClientThreads.clear();
+}
+
+void RenderService::Stop()
+{
+	{
+		std::lock_guard<std::mutex> queueLock(m_queueMutex);
+
+		m_bStopRequested = true;
+		CloseListenSocket();
+	}
+	m_requestQueuedCondVar.notify_all();
+	// The render thread finishes whatever is queued so no client waits forever
+	if (m_pRenderThread != NULL)
+	{
+		m_pRenderThread->join();
+		delete m_pRenderThread;
+		m_pRenderThread = NULL;
+	}
+	{
+		std::lock_guard<std::mutex> queueLock(m_queueMutex);
+
+		// Wake up the client threads blocked reading their sockets
+		for (auto clientSocket : m_clientSockets)
+		{
+#ifdef _WIN32
+			shutdown(clientSocket, SD_BOTH);
+#else
+			shutdown(clientSocket, SHUT_RDWR);
+#endif
+		}
+	}
+	for (auto pThread : m_clientThreads)
+	{
+		pThread->join();
+		delete pThread;
+	}
+	m_clientThreads.clear();
+	m_finishedClientThreads.clear();
+}
+
+std::shared_future<cv::Mat> RenderService::SubmitRequest(std::shared_ptr<SRenderRequest> pRequest)
+{
+	std::shared_future<cv::Mat> result;
+
+	{
+		std::lock_guard<std::mutex> queueLock(m_queueMutex);
+		auto pending = m_pending.find(pRequest->m_key);
+
+		if (pending != m_pending.end())
+		{
+			// Same source, pose, and size as a request that has not finished, so share its frame
+			std::lock_guard<std::mutex> statsLock(m_statsMutex);
+			m_statCoalesced++;
+			return pending->second->m_result;
+		}
+		if (m_bStopRequested || m_queue.size() >= m_queueDepth)
+		{
+			std::lock_guard<std::mutex> statsLock(m_statsMutex);
+			m_statRejected++;
+			return result;
+		}
+		pRequest->m_result = pRequest->m_promise.get_future().share();
+		m_queue.push_back(pRequest);
+		m_pending[pRequest->m_key] = pRequest;
+		result = pRequest->m_result;
+	}
+	m_requestQueuedCondVar.notify_one();
+
+	return result;
+}
+
+void RenderService::renderThreadFunc()
+{
+	SParameters parameters = m_baseParameters;
+	SParameters prevParameters;
+	BaseAlgorithm* pAlg = NULL;
+	// sources holds the most recently used source images with the request count they were last used at
+	std::map<std::string, std::pair<cv::Mat, long long>> sources;
+	long long sourceUses = 0;
+	std::string currentSource = "";
+
+	parameters.m_imageIndex = 0;
+	while (true)
+	{
+		std::shared_ptr<SRenderRequest> pRequest;
+		cv::Mat result;
+
+		{
+			std::unique_lock<std::mutex> queueLock(m_queueMutex);
+
+			m_requestQueuedCondVar.wait(queueLock, [this] {
+				return m_bStopRequested || !m_queue.empty();
+			});
+			if (m_queue.empty())
+			{
+				break;
+			}
+			pRequest = m_queue.front();
+			m_queue.pop_front();
+		}
+
+#ifdef VTUNE_API
+		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_RenderService_render);
+#endif
+		// Keep the last few sources loaded.  Clients can name any number of paths, so the least recently used
+		// source is dropped once SERVICE_SOURCE_CACHE_SIZE are loaded.  The current source stays alive through
+		// parameters.m_image even when it is dropped here.
+		auto source = sources.find(pRequest->m_source);
+		if (source == sources.end())
+		{
+			if (sources.size() >= SERVICE_SOURCE_CACHE_SIZE)
+			{
+				auto oldest = sources.begin();
+
+				for (auto entry = sources.begin(); entry != sources.end(); entry++)
+				{
+					if (entry->second.second < oldest->second.second)
+					{
+						oldest = entry;
+					}
+				}
+				sources.erase(oldest);
+			}
+			source = sources.insert(std::make_pair(pRequest->m_source, std::make_pair(cv::imread(pRequest->m_source, cv::IMREAD_COLOR), 0LL))).first;
+		}
+		source->second.second = ++sourceUses;
+		if (!source->second.first.empty())
+		{
+			int widthOutput = pRequest->m_widthOutput;
+			int heightOutput = pRequest->m_heightOutput;
+
+			if (pRequest->m_source != currentSource)
+			{
+				// Place the image in the entry that is not current so algorithms caching the source by
+				// m_imageIndex upload the new source
+				parameters.m_imageIndex = (parameters.m_imageIndex + 1) % 2;
+				parameters.m_image[parameters.m_imageIndex] = source->second.first;
+				currentSource = pRequest->m_source;
+			}
+			parameters.m_yaw = pRequest->m_yaw;
+			parameters.m_pitch = pRequest->m_pitch;
+			parameters.m_roll = pRequest->m_roll;
+			parameters.m_fov = pRequest->m_fov;
+			if (pAlg == NULL || widthOutput != parameters.m_widthOutput || heightOutput != parameters.m_heightOutput)
+			{
+				// The algorithms size their buffers for the output in StartVariant so a new size needs a new instance
+				if (pAlg != NULL)
+				{
+					pAlg->StopVariant();
+					delete pAlg;
+					pAlg = NULL;
+				}
+				parameters.m_widthOutput = widthOutput;
+				parameters.m_heightOutput = heightOutput;
+				pAlg = m_pCreateAlgorithm(m_algorithm, parameters);
+				if (pAlg != NULL && !pAlg->StartVariant())
+				{
+					delete pAlg;
+					pAlg = NULL;
+				}
+				if (pAlg != NULL)
+				{
+					printf("RenderService: rendering %dx%d with %s\n", widthOutput, heightOutput, pAlg->GetDescription().c_str());
+				}
+			}
+			if (pAlg != NULL)
+			{
+				bool bParametersChanged = prevParameters != parameters;
+
+				// The map is only recomputed when the pose or size changed since the last request
+				pAlg->FrameCalculations(bParametersChanged);
+				prevParameters = parameters;
+				// The algorithm reuses its output memory so the frame handed to the clients is a copy
+				result = pAlg->ExtractFrameImage().clone();
+			}
+		}
+#ifdef VTUNE_API
+		__itt_task_end(pittTests_domain);
+#endif
+
+		{
+			std::lock_guard<std::mutex> queueLock(m_queueMutex);
+			m_pending.erase(pRequest->m_key);
+		}
+		// An empty frame tells the client threads the render failed
+		pRequest->m_promise.set_value(result);
+		if (!result.empty())
+		{
+			std::lock_guard<std::mutex> statsLock(m_statsMutex);
+			m_statRendered++;
+		}
+	}
+
+	if (pAlg != NULL)
+	{
+		pAlg->StopVariant();
+		delete pAlg;
+	}
+	TimingStats::ReleaseTimingStats();
+}
+
+void RenderService::clientThreadFunc(ServiceSocket clientSocket)
+{
+	std::string buffer;
+	std::string line;
+	bool bConnected = true;
+
+	while (bConnected && ReadLine(clientSocket, buffer, line))
+	{
+		std::chrono::high_resolution_clock::time_point receivedTime = std::chrono::high_resolution_clock::now();
+		char command[32];
+		char source[MAX_PATH];
+		std::shared_ptr<SRenderRequest> pRequest = std::make_shared<SRenderRequest>();
+		char reply[1024];
+
+		if (sscanf(line.c_str(), "%31s", command) != 1)
+		{
+			continue;
+		}
+		if (strcmp(command, "RENDER") == 0)
+		{
+			if (sscanf(line.c_str(), "%*s %1023s %d %d %d %d %d %d", source, &pRequest->m_yaw, &pRequest->m_pitch, &pRequest->m_roll, &pRequest->m_fov,
+					&pRequest->m_widthOutput, &pRequest->m_heightOutput) != 7 ||
+				pRequest->m_fov < 1 || pRequest->m_fov > 120 || pRequest->m_pitch < -90 || pRequest->m_pitch > 90 ||
+				pRequest->m_widthOutput <= 0 || pRequest->m_heightOutput <= 0)
+			{
+				bConnected = SendAll(clientSocket, "ERROR malformed RENDER request\n", 31);
+				RequestFinished(receivedTime, false);
+				continue;
+			}
+			if (pRequest->m_widthOutput % m_widthAlignment != 0 || pRequest->m_heightOutput % m_heightAlignment != 0)
+			{
+				sprintf(reply, "ERROR algorithm %d needs the width to be a multiple of %d and the height of %d\n", m_algorithm,
+					m_widthAlignment, m_heightAlignment);
+				bConnected = SendAll(clientSocket, reply, strlen(reply));
+				RequestFinished(receivedTime, false);
+				continue;
+			}
+			pRequest->m_source = source;
+			sprintf(reply, "%s %d %d %d %d %d %d", source, pRequest->m_yaw, pRequest->m_pitch, pRequest->m_roll, pRequest->m_fov,
+				pRequest->m_widthOutput, pRequest->m_heightOutput);
+			pRequest->m_key = reply;
+
+			std::shared_future<cv::Mat> result = SubmitRequest(pRequest);
+
+			if (!result.valid())
+			{
+				// Backpressure: the caller should retry later rather than have the queue grow without bound
+				bConnected = SendAll(clientSocket, "BUSY\n", 5);
+				continue;
+			}
+
+			cv::Mat frame = result.get();
+
+			if (frame.empty())
+			{
+				sprintf(reply, "ERROR unable to render from %s\n", source);
+				bConnected = SendAll(clientSocket, reply, strlen(reply));
+				RequestFinished(receivedTime, false);
+				continue;
+			}
+			sprintf(reply, "OK %d %d %zu\n", frame.cols, frame.rows, frame.total() * frame.elemSize());
+			bConnected = SendAll(clientSocket, reply, strlen(reply)) &&
+				SendAll(clientSocket, (const char*)frame.data, frame.total() * frame.elemSize());
+			RequestFinished(receivedTime, bConnected);
+		}
+		else if (strcmp(command, "STATS") == 0)
+		{
+			std::string stats = GetStatsString();
+
+			bConnected = SendAll(clientSocket, stats.c_str(), stats.length());
+		}
+		else if (strcmp(command, "SHUTDOWN") == 0)
+		{
+			bConnected = false;
+			{
+				std::lock_guard<std::mutex> queueLock(m_queueMutex);
+
+				m_bStopRequested = true;
+				// Closing the listening socket makes Run fall out of accept and call Stop
+				CloseListenSocket();
+			}
+			m_requestQueuedCondVar.notify_all();
+		}
+		else
+		{
+			sprintf(reply, "ERROR unknown command %s\n", command);
+			bConnected = SendAll(clientSocket, reply, strlen(reply));
+		}
+	}
+
+	CloseSocket(clientSocket);
+	{
+		std::lock_guard<std::mutex> queueLock(m_queueMutex);
+		m_clientSockets.erase(clientSocket);
+		m_finishedClientThreads.push_back(std::this_thread::get_id());
+	}
+}
+
+void RenderService::RequestFinished(std::chrono::high_resolution_clock::time_point receivedTime, bool bSucceeded)
+{
+	std::chrono::duration<double> latency = std::chrono::high_resolution_clock::now() - receivedTime;
+	std::lock_guard<std::mutex> statsLock(m_statsMutex);
+
+	m_statRequests++;
+	if (bSucceeded)
+	{
+		m_statLatencies.Record(latency);
+	}
+	else
+	{
+		m_statErrors++;
+	}
+}
+
+bool RenderService::ReadLine(ServiceSocket clientSocket, std::string& buffer, std::string& line)
+{
+	size_t newline;
+
+	while ((newline = buffer.find('\n')) == std::string::npos)
+	{
+		char data[1024];
+		int received = recv(clientSocket, data, sizeof(data), 0);
+
+		if (received <= 0)
+		{
+			return false;
+		}
+		buffer.append(data, received);
+	}
+	line = buffer.substr(0, newline);
+	buffer.erase(0, newline + 1);
+
+	return true;
+}
+
+bool RenderService::SendAll(ServiceSocket clientSocket, const char* pData, size_t length)
+{
+	while (length > 0)
+	{
+		int sent = send(clientSocket, pData, (int)std::min(length, (size_t)(1 << 30)), SERVICE_SEND_FLAGS);
+
+		if (sent <= 0)
+		{
+#ifndef _WIN32
+			if (sent < 0 && errno == EINTR)
+			{
+				continue;
+			}
+#endif
+			// EPIPE or ECONNRESET: the client went away, which only ends this connection
+			return false;
+		}
+		pData += sent;
+		length -= sent;
+	}
+
+	return true;
+}
+
+// Must be called with m_queueMutex held
+void RenderService::CloseListenSocket()
+{
+	if (m_listenSocket != INVALID_SOCKET)
+	{
+		// Shutting the socket down first wakes up a thread blocked in accept
+#ifdef _WIN32
+		shutdown(m_listenSocket, SD_BOTH);
+#else
+		shutdown(m_listenSocket, SHUT_RDWR);
+#endif
+		CloseSocket(m_listenSocket);
+		m_listenSocket = INVALID_SOCKET;
+		remove(m_socketPath.c_str());
+	}
+}
+
+void RenderService::CloseSocket(ServiceSocket serviceSocket)
+{
+#ifdef _WIN32
+	closesocket(serviceSocket);
+#else
+	close(serviceSocket);
+#endif
+}
+
+std::string RenderService::GetStatsString()
+{
+	char line[1024];
+	std::lock_guard<std::mutex> statsLock(m_statsMutex);
+
+	sprintf(line, "Render service,%lld,requests,%lld,rendered,%lld,coalesced,%lld,rejected busy,%lld,errors,%10.3f,ms p50,%10.3f,ms p90,%10.3f,ms p99,%10.3f,ms max\n",
+		m_statRequests, m_statRendered, m_statCoalesced, m_statRejected, m_statErrors, m_statLatencies.GetPercentile(50.0) * 1000.0,
+		m_statLatencies.GetPercentile(90.0) * 1000.0, m_statLatencies.GetPercentile(99.0) * 1000.0, m_statLatencies.GetMax() * 1000.0);
+
+	return line;
+}
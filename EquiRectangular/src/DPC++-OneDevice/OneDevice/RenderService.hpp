@@ -0,0 +1,131 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// RenderService keeps one algorithm warm (device queue, compiled kernels, uploaded sources, and the cached map)
+// and renders requests received over a local Unix domain socket so callers do not pay the variant initialization
+// for every frame.  The protocol is line based text with the pixels returned as raw bytes:
+//
+//     RENDER sourcePath yaw pitch roll fov widthOutput heightOutput\n
+//         -> OK widthOutput heightOutput byteCount\n followed by byteCount bytes of BGR pixels (row major)
+//         -> BUSY\n if the request queue is full (the caller should back off and retry)
+//         -> ERROR message\n (including sizes that are not a multiple of the algorithm's output alignment)
+//     STATS\n      -> one line of request counts and latency percentiles
+//     SHUTDOWN\n   -> stops the service after the queued requests are rendered
+//
+// Identical requests that arrive while one is queued or rendering share the single render.
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "opencv2/core/core.hpp"
+#include "BaseAlgorithm.hpp"
+#include "LatencyHistogram.hpp"
+#include "ParseArgs.hpp"
+
+#ifdef _WIN32
+#include <winsock2.h>
+typedef SOCKET ServiceSocket;
+#else
+typedef int ServiceSocket;
+#endif
+
+// The algorithm used when --algorithm is not given along with --serve (device memory DpcppRemappingV13)
+const int DEFAULT_SERVICE_ALGORITHM = 17;
+// The number of source images the render thread keeps loaded (least recently used ones are dropped)
+const size_t SERVICE_SOURCE_CACHE_SIZE = 4;
+
+class RenderService {
+private:
+	struct SRenderRequest {
+		// m_key identifies identical requests for coalescing
+		std::string	m_key;
+		std::string	m_source;
+		int			m_yaw;
+		int			m_pitch;
+		int			m_roll;
+		int			m_fov;
+		int			m_widthOutput;
+		int			m_heightOutput;
+		std::promise<cv::Mat>		m_promise;
+		std::shared_future<cv::Mat>	m_result;
+	};
+
+	SParameters m_baseParameters;
+	CreateAlgorithmFunc m_pCreateAlgorithm;
+	int m_algorithm;
+	// Requests are rendered at exactly their size, so it has to be a multiple of the algorithm's output alignment
+	int m_widthAlignment;
+	int m_heightAlignment;
+	std::string m_socketPath;
+	size_t m_queueDepth;
+	ServiceSocket m_listenSocket;
+	bool m_bStopRequested;
+	std::thread* m_pRenderThread;
+	std::vector<std::thread*> m_clientThreads;
+	// m_finishedClientThreads holds the ids of client threads that are exiting and can be joined
+	std::vector<std::thread::id> m_finishedClientThreads;
+	std::set<ServiceSocket> m_clientSockets;
+	std::deque<std::shared_ptr<SRenderRequest>> m_queue;
+	// m_pending holds every request that is queued or rendering (by key) so new identical requests can join it
+	std::map<std::string, std::shared_ptr<SRenderRequest>> m_pending;
+	std::mutex m_queueMutex;
+	std::condition_variable m_requestQueuedCondVar;
+	std::mutex m_statsMutex;
+
+	// Statistics since the service started
+	long long m_statRequests;
+	long long m_statRendered;
+	long long m_statCoalesced;
+	long long m_statRejected;
+	long long m_statErrors;
+	// m_statLatencies holds the distribution of the completed request latencies (receipt to last byte sent)
+	LatencyHistogram m_statLatencies;
+
+private:
+	// Function to run in the render thread
+	void renderThreadFunc();
+	// Function to run in each client connection thread
+	void clientThreadFunc(ServiceSocket clientSocket);
+	// SubmitRequest returns the (possibly shared) result or an invalid future if the queue is full
+	std::shared_future<cv::Mat> SubmitRequest(std::shared_ptr<SRenderRequest> pRequest);
+	void RequestFinished(std::chrono::high_resolution_clock::time_point receivedTime, bool bSucceeded);
+	static bool ReadLine(ServiceSocket clientSocket, std::string& buffer, std::string& line);
+	static bool SendAll(ServiceSocket clientSocket, const char* pData, size_t length);
+	void ReapClientThreads();
+	void CloseListenSocket();
+	static void CloseSocket(ServiceSocket serviceSocket);
+
+public:
+	RenderService(SParameters& parameters, CreateAlgorithmFunc pCreateAlgorithm);
+	~RenderService();
+
+	// Open creates the listening socket.  Returns false (after printing the reason) if it cannot.
+	bool Open();
+	// Run accepts connections until a SHUTDOWN request arrives
+	void Run();
+	void Stop();
+
+	std::string GetStatsString();
+};
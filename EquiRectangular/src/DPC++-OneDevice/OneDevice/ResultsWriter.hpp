@@ -0,0 +1,94 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// ResultsWriter saves one record per algorithm run to a JSON or CSV file (picked by the extension of the path
+// given to --results) so runs can be loaded by other tools or compared with --compare instead of pasting the
+// printed summary lines into the results workbooks.  A record is a flat list of named fields: the run settings,
+// the machine (CPU model, hardware threads, git revision), and the frame time statistics.
+//
+// The JSON file is an array with one object per line.  The CSV file has a header line with the field names of
+// the first record.  The whole file is rewritten after every record so an interrupted run still leaves a valid
+// file with the runs that finished.
+//
+// Compare matches the runs of two result files by algorithm, description, scheduling mode, device list, reorder
+// policy, and output size and uses Welch's t-test on the frame times to decide whether a change is significant.
+// When a file has several runs with the same settings only the first is compared and the others are reported.
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include "LatencyHistogram.hpp"
+
+// Changes with a two sided p-value below COMPARE_SIGNIFICANCE are treated as real
+const double COMPARE_SIGNIFICANCE = 0.05;
+// The default for --regressionThreshold (percent slower frame time that counts as a regression)
+const double DEFAULT_REGRESSION_THRESHOLD = 5.0;
+
+typedef std::map<std::string, std::string> ResultsRecord;
+
+class ResultsWriter {
+private:
+	struct SField {
+		std::string	m_name;
+		std::string	m_value;
+		// m_bNumeric fields are written without quotes in JSON
+		bool		m_bNumeric;
+	};
+
+	std::string m_path;
+	bool m_bJson;
+	// m_arguments is the command line of the program (without the program name)
+	std::string m_arguments;
+	std::vector<std::vector<SField>> m_records;
+
+private:
+	bool Write();
+	static std::string EscapeJson(const std::string& value);
+	static std::string EscapeCsv(const std::string& value);
+	static bool ReadJson(FILE* pFile, std::vector<ResultsRecord>& records);
+	static bool ReadCsv(FILE* pFile, std::vector<ResultsRecord>& records);
+	static std::string GetRecordKey(ResultsRecord& record);
+	// GetTwoSidedPValue returns the probability of a Student t value at least as far from 0 as t
+	static double GetTwoSidedPValue(double t, double degreesOfFreedom);
+
+public:
+	ResultsWriter(const char* pPath, int argc, char** argv);
+
+	void BeginRecord();
+	void AddField(const char* pName, const std::string& value);
+	void AddField(const char* pName, const char* pValue);
+	void AddField(const char* pName, int value);
+	void AddField(const char* pName, double value);
+	// AddSystemFields adds the command line, time, git revision, CPU model, and hardware thread count
+	void AddSystemFields();
+	// AddFrameFields adds the warmup and post-warmup frame time statistics (in milliseconds).  The caller adds the
+	// frame rate since how it follows from the frame times depends on how many frames are in flight.
+	void AddFrameFields(const LatencyHistogram& histogram, std::chrono::duration<double> warmupDuration, int warmupIterations);
+	// EndRecord finishes the record and rewrites the file.  Returns false (after printing why) if it cannot.
+	bool EndRecord();
+
+	static std::string GetCpuModel();
+	// GetGitRevision returns GIT_REVISION when the build defines it, otherwise asks git for the working copy
+	static std::string GetGitRevision();
+
+	static bool Read(const char* pPath, std::vector<ResultsRecord>& records);
+	// Compare prints the frame time change of every run in both files and returns the number of regressions
+	// (slower by more than thresholdPercent and significant), or -1 if a file cannot be read.
+	static int Compare(const char* pBaselinePath, const char* pCandidatePath, double thresholdPercent);
+};
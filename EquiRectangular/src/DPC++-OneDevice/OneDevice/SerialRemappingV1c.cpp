@@ -21,6 +21,7 @@
 #include "SerialRemappingV1c.hpp"
 #include <chrono>
 #include "TimingStats.hpp"
+#include "BufferPool.hpp"
 #include <opencv2/calib3d.hpp>
 
 #ifdef VTUNE_API
@@ -339,6 +340,7 @@ cv::Mat SerialRemappingV1c::ExtractFrameImage()
 	std::chrono::high_resolution_clock::time_point startTime;
 
 	startTime = std::chrono::high_resolution_clock::now();
+	TimingStats::GetTimingStats()->StartCounters(ETimingType::TIMING_REMAP);
 
 	switch (m_storageOrder)
 	{
@@ -357,8 +359,8 @@ cv::Mat SerialRemappingV1c::ExtractFrameImage()
 		// The image is in row/col format, but we have stored data in col/row format, so need to be careful here and
 		// transpose the data
 		Point2D* pXYElement = &m_pXYPoints[0];
-		float* m_pX = new float[m_parameters->m_widthOutput * m_parameters->m_heightOutput];
-		float* m_pY = new float[m_parameters->m_widthOutput * m_parameters->m_heightOutput];
+		float* m_pX = (float*)BufferPool::GetBufferPool()->Acquire(m_parameters->m_widthOutput * m_parameters->m_heightOutput * sizeof(float));
+		float* m_pY = (float*)BufferPool::GetBufferPool()->Acquire(m_parameters->m_widthOutput * m_parameters->m_heightOutput * sizeof(float));
 		float* pXElement = &m_pX[0];
 		float* pYElement = &m_pY[0];
 
@@ -381,9 +383,10 @@ cv::Mat SerialRemappingV1c::ExtractFrameImage()
 		TimingStats::GetTimingStats()->AddIterationResults(ETimingType::TIMING_CREATE_MAP, startTime, std::chrono::high_resolution_clock::now());
 
 		startTime = std::chrono::high_resolution_clock::now();
+		TimingStats::GetTimingStats()->StartCounters(ETimingType::TIMING_REMAP);
 		cv::remap(m_parameters->m_image[m_parameters->m_imageIndex], retVal, mapX, mapY, cv::INTER_CUBIC, cv::BORDER_WRAP);
-		delete[] m_pX;
-		delete[] m_pY;
+		BufferPool::GetBufferPool()->Release(m_pX);
+		BufferPool::GetBufferPool()->Release(m_pY);
 		TimingStats::GetTimingStats()->AddIterationResults(ETimingType::TIMING_REMAP, startTime, std::chrono::high_resolution_clock::now());
 		break;
 	}
@@ -491,9 +494,9 @@ bool SerialRemappingV1c::StartVariant()
 		int size = m_parameters->m_widthOutput * m_parameters->m_heightOutput;
 
 		// Reserve the space for the 3D points
-		m_pXYZPoints = new Point3D[size];
-		m_pXYPoints = new Point2D[size];
-		m_pLonLatPoints = new Point2D[size];
+		m_pXYZPoints = (Point3D*)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point3D));
+		m_pXYPoints = (Point2D*)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D));
+		m_pLonLatPoints = (Point2D*)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D));
 		bRetVal = true;
 		m_bFrameCalcRequired = true;
 	}
@@ -503,11 +506,11 @@ bool SerialRemappingV1c::StartVariant()
 
 void SerialRemappingV1c::StopVariant()
 {
-	delete[] m_pXYZPoints;
+	BufferPool::GetBufferPool()->Release(m_pXYZPoints);
 	m_pXYZPoints = NULL;
-	delete[] m_pXYPoints;
+	BufferPool::GetBufferPool()->Release(m_pXYPoints);
 	m_pXYPoints = NULL;
-	delete[] m_pLonLatPoints;
+	BufferPool::GetBufferPool()->Release(m_pLonLatPoints);
 	m_pLonLatPoints = NULL;
 }
 
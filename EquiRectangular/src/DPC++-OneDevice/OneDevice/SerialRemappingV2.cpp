@@ -21,6 +21,7 @@
 #include "SerialRemappingV2.hpp"
 #include <chrono>
 #include "TimingStats.hpp"
+#include "BufferPool.hpp"
 #include <opencv2/calib3d.hpp>
 
 #ifdef VTUNE_API
@@ -223,15 +224,26 @@ void SerialRemappingV2::FrameCalculations(bool bParametersChanged)
 }
 
 cv::Mat SerialRemappingV2::ExtractFrameImage()
+{
+	cv::Mat retVal;
+
+	ExtractFrameImage(retVal);
+
+	return retVal;
+}
+
+// cv::remap only allocates the destination when it is empty or the wrong size, so rendering into the
+// caller's image avoids a new allocation each frame
+void SerialRemappingV2::ExtractFrameImage(cv::Mat& output)
 {
 #ifdef VTUNE_API
 	__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_SerialRemappingV2_extract_kernel);
 #endif
 
-	cv::Mat retVal;
 	std::chrono::high_resolution_clock::time_point startTime;
 
 	startTime = std::chrono::high_resolution_clock::now();
+	TimingStats::GetTimingStats()->StartCounters(ETimingType::TIMING_REMAP);
 
 	switch (m_storageType)
 	{
@@ -239,7 +251,7 @@ cv::Mat SerialRemappingV2::ExtractFrameImage()
 	{
 		cv::Mat map = cv::Mat(m_parameters->m_heightOutput, m_parameters->m_widthOutput, CV_32FC2, m_pXYPoints);
 
-		cv::remap(m_parameters->m_image[m_parameters->m_imageIndex], retVal, map, cv::Mat{}, cv::INTER_CUBIC, cv::BORDER_WRAP);
+		cv::remap(m_parameters->m_image[m_parameters->m_imageIndex], output, map, cv::Mat{}, cv::INTER_CUBIC, cv::BORDER_WRAP);
 
 		TimingStats::GetTimingStats()->AddIterationResults(ETimingType::TIMING_REMAP, startTime, std::chrono::high_resolution_clock::now());
 
@@ -250,7 +262,7 @@ cv::Mat SerialRemappingV2::ExtractFrameImage()
 		cv::Mat mapX = cv::Mat(m_parameters->m_heightOutput, m_parameters->m_widthOutput, CV_32FC1, m_pXPoints);
 		cv::Mat mapY = cv::Mat(m_parameters->m_heightOutput, m_parameters->m_widthOutput, CV_32FC1, m_pYPoints);
 
-		cv::remap(m_parameters->m_image[m_parameters->m_imageIndex], retVal, mapX, mapY, cv::INTER_CUBIC, cv::BORDER_WRAP);
+		cv::remap(m_parameters->m_image[m_parameters->m_imageIndex], output, mapX, mapY, cv::INTER_CUBIC, cv::BORDER_WRAP);
 
 		TimingStats::GetTimingStats()->AddIterationResults(ETimingType::TIMING_REMAP, startTime, std::chrono::high_resolution_clock::now());
 		break;
@@ -260,8 +272,6 @@ cv::Mat SerialRemappingV2::ExtractFrameImage()
 #ifdef VTUNE_API
 	__itt_task_end(pittTests_domain);
 #endif
-
-	return retVal;
 }
 
 cv::Mat SerialRemappingV2::GetDebugImage()
@@ -365,17 +375,18 @@ bool SerialRemappingV2::StartVariant()
 	{
 		int size = m_parameters->m_widthOutput * m_parameters->m_heightOutput;
 
+		// The pool backs the points with huge pages when --hugePages is given
 		switch (m_storageType)
 		{
 		case SRV2_AOS:
 		{
-			m_pXYPoints = new Point2D[size];
+			m_pXYPoints = (Point2D *)BufferPool::GetBufferPool()->Acquire(size * sizeof(Point2D));
 			break;
 		}
 		case SRV2_SOA:
 		{
-			m_pXPoints = new float[size];
-			m_pYPoints = new float[size];
+			m_pXPoints = (float *)BufferPool::GetBufferPool()->Acquire(size * sizeof(float));
+			m_pYPoints = (float *)BufferPool::GetBufferPool()->Acquire(size * sizeof(float));
 			break;
 		}
 		}
@@ -388,11 +399,11 @@ bool SerialRemappingV2::StartVariant()
 
 void SerialRemappingV2::StopVariant()
 {
-	delete[] m_pXYPoints;
+	BufferPool::GetBufferPool()->Release(m_pXYPoints);
+	BufferPool::GetBufferPool()->Release(m_pXPoints);
+	BufferPool::GetBufferPool()->Release(m_pYPoints);
 	m_pXYPoints = NULL;
-	delete[] m_pXPoints;
 	m_pXPoints = NULL;
-	delete[] m_pYPoints;
 	m_pYPoints = NULL;
 }
 
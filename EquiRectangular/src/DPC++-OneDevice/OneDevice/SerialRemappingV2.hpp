@@ -46,6 +46,7 @@ public:
 
 	virtual void FrameCalculations(bool bParametersChanged);
 	virtual cv::Mat ExtractFrameImage();
+	virtual void ExtractFrameImage(cv::Mat& output);
 	virtual cv::Mat GetDebugImage();
 
 	virtual std::string GetDescription();
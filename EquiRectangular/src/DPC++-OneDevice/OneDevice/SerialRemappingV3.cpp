@@ -0,0 +1,213 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "SerialRemappingV3.hpp"
+#include <chrono>
+#include "TimingStats.hpp"
+
+#ifdef VTUNE_API
+#include "ittnotify.h"
+#pragma comment(lib, "libittnotify.lib")
+extern __itt_domain *pittTests_domain;
+// Create string handle for denoting when the kernel is running
+wchar_t const *pSerialRemappingV3Extract = _T("SerialRemappingV3 Extract Kernel");
+__itt_string_handle *handle_SerialRemappingV3_extract_kernel = __itt_string_handle_create(pSerialRemappingV3Extract);
+wchar_t const *pSerialRemappingV3Calc = _T("SerialRemappingV3 Calc Kernel");
+__itt_string_handle *handle_SerialRemappingV3_calc_kernel = __itt_string_handle_create(pSerialRemappingV3Calc);
+#endif
+
+SerialRemappingV3::SerialRemappingV3(SParameters& parameters) : BaseAlgorithm(parameters)
+{
+	m_variant = SRV3_INIT;
+}
+
+SerialRemappingV3::~SerialRemappingV3()
+{
+	StopVariant();
+}
+
+std::string SerialRemappingV3::GetDescription()
+{
+	switch (m_variant)
+	{
+	case SRV3_CACHE:
+		return "V3 Algorithm 4 array of structures maps kept in a cache of recent poses.";
+		break;
+	case SRV3_SPECULATE:
+		return "V3 Algorithm 4 array of structures maps cached and computed ahead for the predicted next poses.";
+		break;
+	}
+
+	return "Unknown";
+}
+
+std::string SerialRemappingV3::GetAlgorithmStats()
+{
+	if (m_pMapCache == NULL)
+	{
+		return "";
+	}
+
+	return m_pMapCache->GetStatsString();
+}
+
+SMapKey SerialRemappingV3::MakeKey(const SPose& pose)
+{
+	SMapKey key;
+
+	key.m_yaw = pose.m_yaw;
+	key.m_pitch = pose.m_pitch;
+	key.m_roll = pose.m_roll;
+	key.m_fov = pose.m_fov;
+	key.m_widthOutput = m_parameters->m_widthOutput;
+	key.m_heightOutput = m_parameters->m_heightOutput;
+	key.m_imageWidth = m_parameters->m_image[m_parameters->m_imageIndex].cols;
+	key.m_imageHeight = m_parameters->m_image[m_parameters->m_imageIndex].rows;
+
+	return key;
+}
+
+void SerialRemappingV3::FrameCalculations(bool bParametersChanged)
+{
+	if (bParametersChanged || m_bFrameCalcRequired)
+	{
+#ifdef VTUNE_API
+		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_SerialRemappingV3_calc_kernel);
+#endif
+		BaseAlgorithm::FrameCalculations(bParametersChanged);
+
+		SPose pose = { m_parameters->m_yaw, m_parameters->m_pitch, m_parameters->m_roll, m_parameters->m_fov };
+
+		m_pMap = m_pMapCache->GetMap(MakeKey(pose));
+
+		if (m_variant == SRV3_SPECULATE)
+		{
+			std::vector<SMapKey> keys;
+
+			m_posePredictor.AddPose(pose);
+			for (auto& predicted : m_posePredictor.Predict(SRV3_PREDICTIONS))
+			{
+				keys.push_back(MakeKey(predicted));
+			}
+			m_pMapCache->Speculate(keys);
+		}
+#ifdef VTUNE_API
+		__itt_task_end(pittTests_domain);
+#endif
+	}
+}
+
+cv::Mat SerialRemappingV3::ExtractFrameImage()
+{
+	cv::Mat retVal;
+
+	ExtractFrameImage(retVal);
+
+	return retVal;
+}
+
+void SerialRemappingV3::ExtractFrameImage(cv::Mat& output)
+{
+#ifdef VTUNE_API
+	__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_SerialRemappingV3_extract_kernel);
+#endif
+
+	std::chrono::high_resolution_clock::time_point startTime;
+
+	startTime = std::chrono::high_resolution_clock::now();
+	TimingStats::GetTimingStats()->StartCounters(ETimingType::TIMING_REMAP);
+
+	cv::Mat map = cv::Mat(m_parameters->m_heightOutput, m_parameters->m_widthOutput, CV_32FC2, m_pMap->data());
+
+	cv::remap(m_parameters->m_image[m_parameters->m_imageIndex], output, map, cv::Mat{}, cv::INTER_CUBIC, cv::BORDER_WRAP);
+
+	TimingStats::GetTimingStats()->AddIterationResults(ETimingType::TIMING_REMAP, startTime, std::chrono::high_resolution_clock::now());
+
+#ifdef VTUNE_API
+	__itt_task_end(pittTests_domain);
+#endif
+}
+
+cv::Mat SerialRemappingV3::GetDebugImage()
+{
+	cv::Mat retVal;
+	Point2D *pXYElement = m_pMap->data();
+
+	m_parameters->m_image[m_parameters->m_imageIndex].copyTo(retVal);
+
+	// Draw the points across the top of the viewing region using blue
+	for (int x = 0; x < m_parameters->m_widthOutput; x++)
+	{
+		cv::Point pt = cv::Point(pXYElement->m_x, pXYElement->m_y);
+		cv::line(retVal, pt, pt, cv::Scalar(255, 0, 0), 10);
+
+		pXYElement++;
+	}
+	// Draw the left (red) and right (green) sides of the viewing region
+	for (int y = 1; y < m_parameters->m_heightOutput - 2; y++)
+	{
+		cv::Point ptLeft = cv::Point(pXYElement->m_x, pXYElement->m_y);
+		cv::line(retVal, ptLeft, ptLeft, cv::Scalar(0, 0, 255), 10);
+
+		pXYElement += m_parameters->m_widthOutput - 1;
+		cv::Point ptRight = cv::Point(pXYElement->m_x, pXYElement->m_y);
+		cv::line(retVal, ptRight, ptRight, cv::Scalar(0, 255, 0), 10);
+
+		pXYElement++;
+	}
+
+	// Draw the points across the bottom of the viewing region in tan
+	for (int x = 0; x < m_parameters->m_widthOutput; x++)
+	{
+		cv::Point pt = cv::Point(pXYElement->m_x, pXYElement->m_y);
+		cv::line(retVal, pt, pt, cv::Scalar(74, 136, 175), 10);
+
+		pXYElement++;
+	}
+
+	return retVal;
+}
+
+bool SerialRemappingV3::StartVariant()
+{
+	BaseAlgorithm::StartVariant();
+
+	bool bRetVal = false;
+
+	m_variant++;
+
+	if (m_variant < SRV3_MAX)
+	{
+		int speculationThreads = 0;
+
+		if (m_variant == SRV3_SPECULATE)
+		{
+			speculationThreads = MapCache::GetDefaultSpeculationThreads();
+		}
+		m_pMapCache = new MapCache(DEFAULT_MAP_CACHE_CAPACITY, speculationThreads);
+		m_posePredictor.Reset();
+		bRetVal = true;
+		m_bFrameCalcRequired = true;
+	}
+
+	return bRetVal;
+}
+
+void SerialRemappingV3::StopVariant()
+{
+	m_pMap.reset();
+	delete m_pMapCache;
+	m_pMapCache = NULL;
+}
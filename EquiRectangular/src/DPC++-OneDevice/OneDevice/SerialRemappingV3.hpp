@@ -0,0 +1,58 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+#include "BaseAlgorithm.hpp"
+#include "MapCache.hpp"
+#include "PosePredictor.hpp"
+#include <opencv2/core/mat.hpp>
+
+const int SRV3_INIT = -1;
+// Cache the maps of recent poses but do not compute any ahead of time
+const int SRV3_CACHE = 0;
+// Also compute the maps for the predicted next poses on idle threads
+const int SRV3_SPECULATE = 1;
+const int SRV3_MAX = 2;
+
+// Number of predicted poses queued for speculation each time the pose changes (all the predictor's guesses)
+const int SRV3_PREDICTIONS = POSE_MAX_PREDICTIONS;
+
+class SerialRemappingV3 : public BaseAlgorithm {
+
+private:
+	int m_variant;
+	MapCache *m_pMapCache = NULL;
+	PosePredictor m_posePredictor;
+	// m_pMap is the map for the current pose (shared with the cache)
+	MapPtr m_pMap;
+
+	SMapKey MakeKey(const SPose& pose);
+
+public:
+	SerialRemappingV3(SParameters &parameters);
+	~SerialRemappingV3();
+
+	virtual void FrameCalculations(bool bParametersChanged);
+	virtual cv::Mat ExtractFrameImage();
+	virtual void ExtractFrameImage(cv::Mat& output);
+	virtual cv::Mat GetDebugImage();
+
+	virtual std::string GetDescription();
+	virtual std::string GetAlgorithmStats();
+
+	virtual bool StartVariant();
+	virtual void StopVariant();
+};
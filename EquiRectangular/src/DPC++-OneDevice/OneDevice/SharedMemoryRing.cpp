@@ -0,0 +1,293 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "SharedMemoryRing.hpp"
+#include <iostream>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SharedMemoryRing::SharedMemoryRing(const char* pName)
+{
+	m_name = pName;
+#ifndef _WIN32
+	// POSIX shared memory names start with a single slash
+	if (m_name.empty() || m_name[0] != '/')
+	{
+		m_name = "/" + m_name;
+	}
+#endif
+	m_bProducer = false;
+	m_mappingBytes = 0;
+	m_pMapping = NULL;
+	m_pHeader = NULL;
+#ifdef _WIN32
+	m_hMapping = NULL;
+#else
+	m_fd = -1;
+#endif
+}
+
+SharedMemoryRing::~SharedMemoryRing()
+{
+	Close();
+}
+
+bool SharedMemoryRing::Map(bool bCreate)
+{
+#ifdef _WIN32
+	if (bCreate)
+	{
+		m_hMapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((uint64_t)m_mappingBytes >> 32), (DWORD)(m_mappingBytes & 0xffffffff), m_name.c_str());
+	}
+	else
+	{
+		m_hMapping = OpenFileMappingA(FILE_MAP_READ, FALSE, m_name.c_str());
+	}
+	if (m_hMapping == NULL)
+	{
+		return false;
+	}
+	m_pMapping = (unsigned char*)MapViewOfFile(m_hMapping, bCreate ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, bCreate ? m_mappingBytes : 0);
+	if (m_pMapping != NULL && !bCreate)
+	{
+		MEMORY_BASIC_INFORMATION info;
+
+		VirtualQuery(m_pMapping, &info, sizeof(info));
+		m_mappingBytes = info.RegionSize;
+	}
+#else
+	if (bCreate)
+	{
+		// Replace any ring left behind by a producer that did not shut down cleanly
+		shm_unlink(m_name.c_str());
+		m_fd = shm_open(m_name.c_str(), O_CREAT | O_RDWR, SHM_RING_MODE);
+		if (m_fd < 0 || ftruncate(m_fd, m_mappingBytes) != 0)
+		{
+			return false;
+		}
+	}
+	else
+	{
+		struct stat info;
+
+		m_fd = shm_open(m_name.c_str(), O_RDONLY, 0);
+		if (m_fd < 0 || fstat(m_fd, &info) != 0)
+		{
+			return false;
+		}
+		m_mappingBytes = info.st_size;
+	}
+	void* pMapping = mmap(NULL, m_mappingBytes, bCreate ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, m_fd, 0);
+	m_pMapping = (pMapping == MAP_FAILED) ? NULL : (unsigned char*)pMapping;
+#endif
+	m_pHeader = (SShmRingHeader*)m_pMapping;
+
+	return m_pMapping != NULL;
+}
+
+bool SharedMemoryRing::Create(int slotCount, int maxWidth, int maxHeight)
+{
+	uint64_t slotStride;
+
+	Close();
+	if (slotCount < MIN_SHM_RING_SLOTS)
+	{
+		slotCount = MIN_SHM_RING_SLOTS;
+	}
+	// Round each slot up to whole cache lines so every slot header starts on its own line
+	slotStride = SHM_SLOT_PIXEL_OFFSET + (uint64_t)maxWidth * maxHeight * 3;
+	slotStride = (slotStride + SHM_CACHE_LINE - 1) / SHM_CACHE_LINE * SHM_CACHE_LINE;
+	m_mappingBytes = sizeof(SShmRingHeader) + slotStride * slotCount;
+	m_bProducer = true;
+	if (!Map(true))
+	{
+		std::cout << "SharedMemoryRing: unable to create " << m_name << std::endl;
+		Close();
+		return false;
+	}
+	memset(m_pMapping, 0, m_mappingBytes);
+	m_pHeader->m_version = SHM_RING_VERSION;
+	m_pHeader->m_slotCount = slotCount;
+	m_pHeader->m_maxWidth = maxWidth;
+	m_pHeader->m_maxHeight = maxHeight;
+	m_pHeader->m_channels = 3;
+	m_pHeader->m_slotStride = slotStride;
+	m_pHeader->m_published.store(0, std::memory_order_relaxed);
+	for (int i = 0; i < slotCount; i++)
+	{
+		GetSlot(i)->m_sequence.store(0, std::memory_order_relaxed);
+	}
+	// Consumers check the magic value last so they never attach to a half initialized ring
+	std::atomic_thread_fence(std::memory_order_release);
+	m_pHeader->m_magic = SHM_RING_MAGIC;
+
+	return true;
+}
+
+bool SharedMemoryRing::Open()
+{
+	Close();
+	m_bProducer = false;
+	if (!Map(false) || m_mappingBytes < sizeof(SShmRingHeader) || m_pHeader->m_magic != SHM_RING_MAGIC ||
+		m_pHeader->m_version != SHM_RING_VERSION || m_mappingBytes < sizeof(SShmRingHeader) + m_pHeader->m_slotStride * m_pHeader->m_slotCount)
+	{
+		Close();
+		return false;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	return true;
+}
+
+void SharedMemoryRing::Close()
+{
+#ifdef _WIN32
+	if (m_pMapping != NULL)
+	{
+		UnmapViewOfFile(m_pMapping);
+	}
+	if (m_hMapping != NULL)
+	{
+		CloseHandle(m_hMapping);
+		m_hMapping = NULL;
+	}
+#else
+	if (m_pMapping != NULL)
+	{
+		munmap(m_pMapping, m_mappingBytes);
+	}
+	if (m_fd >= 0)
+	{
+		close(m_fd);
+		m_fd = -1;
+		if (m_bProducer)
+		{
+			// Consumers that are still attached keep their mapping, new ones will not find the ring
+			shm_unlink(m_name.c_str());
+		}
+	}
+#endif
+	m_pMapping = NULL;
+	m_pHeader = NULL;
+	m_mappingBytes = 0;
+}
+
+SShmSlotHeader* SharedMemoryRing::GetSlot(int slot)
+{
+	return (SShmSlotHeader*)(m_pMapping + sizeof(SShmRingHeader) + m_pHeader->m_slotStride * slot);
+}
+
+bool SharedMemoryRing::Publish(const cv::Mat& frame, long long frameNumber, int yaw, int pitch, int roll, int fov, std::chrono::steady_clock::time_point renderTime)
+{
+	if (!m_bProducer || m_pHeader == NULL || frame.type() != CV_8UC3 || frame.cols > (int)m_pHeader->m_maxWidth || frame.rows > (int)m_pHeader->m_maxHeight)
+	{
+		return false;
+	}
+
+	uint64_t publishIndex = m_pHeader->m_published.load(std::memory_order_relaxed);
+	SShmSlotHeader* pSlot = GetSlot((int)(publishIndex % m_pHeader->m_slotCount));
+	unsigned char* pPixels = (unsigned char*)pSlot + SHM_SLOT_PIXEL_OFFSET;
+	size_t rowBytes = frame.cols * frame.elemSize();
+
+	// Odd sequence tells consumers the slot is changing (see the seqlock description in the header)
+	pSlot->m_sequence.store(publishIndex * 2 + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	pSlot->m_frameNumber = frameNumber;
+	pSlot->m_yaw = yaw;
+	pSlot->m_pitch = pitch;
+	pSlot->m_roll = roll;
+	pSlot->m_fov = fov;
+	pSlot->m_width = frame.cols;
+	pSlot->m_height = frame.rows;
+	pSlot->m_renderTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(renderTime.time_since_epoch()).count();
+	if (frame.isContinuous())
+	{
+		memcpy(pPixels, frame.data, rowBytes * frame.rows);
+	}
+	else
+	{
+		for (int row = 0; row < frame.rows; row++)
+		{
+			memcpy(pPixels + row * rowBytes, frame.ptr(row), rowBytes);
+		}
+	}
+	pSlot->m_publishTimeNs = NowNs();
+	pSlot->m_sequence.store(publishIndex * 2 + 2, std::memory_order_release);
+	m_pHeader->m_published.store(publishIndex + 1, std::memory_order_release);
+
+	return true;
+}
+
+uint64_t SharedMemoryRing::GetPublishedCount()
+{
+	return (m_pHeader != NULL) ? m_pHeader->m_published.load(std::memory_order_acquire) : 0;
+}
+
+bool SharedMemoryRing::ReadFrame(uint64_t publishedIndex, SShmFrameView& view)
+{
+	if (m_pHeader == NULL)
+	{
+		return false;
+	}
+
+	int slot = (int)(publishedIndex % m_pHeader->m_slotCount);
+	SShmSlotHeader* pSlot = GetSlot(slot);
+	uint64_t sequence = pSlot->m_sequence.load(std::memory_order_acquire);
+
+	if (sequence != publishedIndex * 2 + 2)
+	{
+		return false;
+	}
+	view.m_header.m_frameNumber = pSlot->m_frameNumber;
+	view.m_header.m_yaw = pSlot->m_yaw;
+	view.m_header.m_pitch = pSlot->m_pitch;
+	view.m_header.m_roll = pSlot->m_roll;
+	view.m_header.m_fov = pSlot->m_fov;
+	view.m_header.m_width = pSlot->m_width;
+	view.m_header.m_height = pSlot->m_height;
+	view.m_header.m_renderTimeNs = pSlot->m_renderTimeNs;
+	view.m_header.m_publishTimeNs = pSlot->m_publishTimeNs;
+	view.m_sequence = sequence;
+	view.m_slot = slot;
+	view.m_pPixels = (const unsigned char*)pSlot + SHM_SLOT_PIXEL_OFFSET;
+
+	// The header copy is only trustworthy if the slot did not change while it was read
+	return IsStillValid(view);
+}
+
+bool SharedMemoryRing::IsStillValid(const SShmFrameView& view)
+{
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	return GetSlot(view.m_slot)->m_sequence.load(std::memory_order_relaxed) == view.m_sequence;
+}
+
+int SharedMemoryRing::GetSlotCount()
+{
+	return (m_pHeader != NULL) ? (int)m_pHeader->m_slotCount : 0;
+}
+
+int64_t SharedMemoryRing::NowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,120 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// SharedMemoryRing publishes rendered frames into a named shared memory ring of slots so other processes on the
+// same machine can read them in place.  There is one producer and any number of consumers.  Nothing is locked:
+// each slot carries a sequence counter that the producer makes odd while it rewrites the slot and even (and
+// larger) once the slot is complete, so a consumer checks the counter before and after reading a slot to know
+// the frame was not overwritten underneath it (a seqlock).  Consumers never block the producer; a consumer that
+// falls more than a ring behind simply sees newer frames.
+//
+// The memory is a SShmRingHeader followed by m_slotCount slots of m_slotStride bytes.  Each slot starts with a
+// SShmSlotHeader and the BGR pixels follow at SHM_SLOT_PIXEL_OFFSET.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "opencv2/core/core.hpp"
+
+const uint32_t SHM_RING_MAGIC = 0x45515249;	// "EQRI"
+const uint32_t SHM_RING_VERSION = 1;
+const int MIN_SHM_RING_SLOTS = 2;
+// Keep the headers on their own cache lines so the sequence counters do not false share with the pixels
+const size_t SHM_CACHE_LINE = 64;
+const size_t SHM_SLOT_PIXEL_OFFSET = 128;
+// Permissions of the POSIX shared memory object: only the user running the producer can read the frames.  Raise
+// this (e.g., to 0640 or 0644) if the consumers run as a different user.
+const int SHM_RING_MODE = 0600;
+
+struct alignas(SHM_CACHE_LINE) SShmRingHeader {
+	uint32_t	m_magic;
+	uint32_t	m_version;
+	uint32_t	m_slotCount;
+	uint32_t	m_maxWidth;
+	uint32_t	m_maxHeight;
+	uint32_t	m_channels;
+	uint64_t	m_slotStride;
+	// m_published counts the frames published.  The newest frame is in slot (m_published - 1) % m_slotCount.
+	std::atomic<uint64_t>	m_published;
+};
+
+struct alignas(SHM_CACHE_LINE) SShmSlotHeader {
+	// m_sequence is odd while the producer writes the slot
+	std::atomic<uint64_t>	m_sequence;
+	int64_t		m_frameNumber;
+	int32_t		m_yaw;
+	int32_t		m_pitch;
+	int32_t		m_roll;
+	int32_t		m_fov;
+	int32_t		m_width;
+	int32_t		m_height;
+	// Both times are std::chrono::steady_clock nanoseconds so they can be compared across processes
+	int64_t		m_renderTimeNs;
+	int64_t		m_publishTimeNs;
+};
+
+// SShmFrameView describes a frame read in place from the ring.  The pixels stay valid only while
+// SharedMemoryRing::IsStillValid returns true for the view.
+struct SShmFrameView {
+	SShmSlotHeader	m_header;
+	uint64_t		m_sequence;
+	int				m_slot;
+	const unsigned char*	m_pPixels;
+};
+
+class SharedMemoryRing {
+private:
+	std::string m_name;
+	bool m_bProducer;
+	size_t m_mappingBytes;
+	unsigned char* m_pMapping;
+	SShmRingHeader* m_pHeader;
+#ifdef _WIN32
+	void* m_hMapping;
+#else
+	int m_fd;
+#endif
+
+private:
+	SShmSlotHeader* GetSlot(int slot);
+	bool Map(bool bCreate);
+
+public:
+	SharedMemoryRing(const char* pName);
+	~SharedMemoryRing();
+
+	// Create makes (or replaces) the ring as the producer with room for frames up to maxWidth x maxHeight
+	bool Create(int slotCount, int maxWidth, int maxHeight);
+	// Open attaches to an existing ring as a consumer
+	bool Open();
+	void Close();
+
+	// Publish copies the frame into the next slot.  Only the producer may call this.
+	bool Publish(const cv::Mat& frame, long long frameNumber, int yaw, int pitch, int roll, int fov, std::chrono::steady_clock::time_point renderTime);
+
+	// GetPublishedCount returns the number of frames published so far (0 if none)
+	uint64_t GetPublishedCount();
+	// ReadFrame fills view with the frame numbered publishedIndex (0 based publish order) if it is still in the
+	// ring.  Returns false if the slot is being rewritten or already holds a newer frame.
+	bool ReadFrame(uint64_t publishedIndex, SShmFrameView& view);
+	// IsStillValid returns true if the producer has not started overwriting the frame since ReadFrame
+	bool IsStillValid(const SShmFrameView& view);
+
+	int GetSlotCount();
+	static int64_t NowNs();
+};
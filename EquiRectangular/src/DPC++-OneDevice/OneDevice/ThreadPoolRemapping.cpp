@@ -0,0 +1,551 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+// The map math matches SerialRemappingV2::FrameCalculations but each tile of the output is a separate task for the
+// work stealing pool.  The extraction samples the source directly (rather than with cv::remap) so the whole frame
+// runs on the pool's threads.
+
+#include "ThreadPoolRemapping.hpp"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include "HugePageAllocator.hpp"
+#include "TimingStats.hpp"
+#include <opencv2/calib3d.hpp>
+
+#ifdef VTUNE_API
+#include "ittnotify.h"
+#pragma comment(lib, "libittnotify.lib")
+extern __itt_domain *pittTests_domain;
+// Create string handle for denoting when the kernel is running
+wchar_t const *pThreadPoolRemappingExtract = _T("ThreadPoolRemapping Extract Kernel");
+__itt_string_handle *handle_ThreadPoolRemapping_extract_kernel = __itt_string_handle_create(pThreadPoolRemappingExtract);
+wchar_t const *pThreadPoolRemappingCalc = _T("ThreadPoolRemapping Calc Kernel");
+__itt_string_handle *handle_ThreadPoolRemapping_calc_kernel = __itt_string_handle_create(pThreadPoolRemappingCalc);
+#endif
+
+ThreadPoolRemapping::ThreadPoolRemapping(SParameters& parameters) : BaseAlgorithm(parameters)
+{
+	int maxThreads = parameters.m_poolThreads > 0 ? parameters.m_poolThreads : WorkStealingPool::GetHardwareThreads();
+	std::vector<int> threadCounts;
+
+	// With --poolScaling run 1, 2, 4, ... threads up to maxThreads so the efficiency of each can be reported
+	if (parameters.m_bPoolScaling)
+	{
+		for (int threads = 1; threads < maxThreads; threads *= 2)
+		{
+			threadCounts.push_back(threads);
+		}
+	}
+	threadCounts.push_back(maxThreads);
+	for (int interpolation = TPR_NEAREST; interpolation <= TPR_BILINEAR; interpolation++)
+	{
+		for (int threads : threadCounts)
+		{
+			m_variants.push_back({ interpolation, threads, false });
+			// With --numa each thread count runs again with NUMA placement to compare against the default
+			if (parameters.m_bNuma)
+			{
+				m_variants.push_back({ interpolation, threads, true });
+			}
+		}
+	}
+	m_variant = -1;
+}
+
+ThreadPoolRemapping::~ThreadPoolRemapping()
+{
+	StopVariant();
+}
+
+std::string ThreadPoolRemapping::GetDescription()
+{
+	if (m_variant < 0 || m_variant >= (int)m_variants.size())
+	{
+		return "Unknown";
+	}
+
+	char description[256];
+
+	sprintf(description, "Native work stealing pool of %d thread%s%s, tiled map and %s extraction%s.",
+		m_variants[m_variant].m_threads, m_variants[m_variant].m_threads == 1 ? "" : "s", m_parameters->m_bPoolPinning ? " (pinned)" : "",
+		m_variants[m_variant].m_interpolation == TPR_NEAREST ? "nearest" : "bilinear",
+		m_variants[m_variant].m_bNuma ? " with NUMA placement (source replicated per node)" : "");
+
+	return description;
+}
+
+// Pass in theta, phi, and psi in radians, not degrees
+void ThreadPoolRemapping::ComputeRotationMatrix(float radTheta, float radPhi, float radPsi)
+{
+	cv::Mat x_axis = (cv::Mat_<float>(3, 1) << 1, 0, 0);
+	cv::Mat y_axis = (cv::Mat_<float>(3, 1) << 0, 1, 0);
+	cv::Mat z_axis = (cv::Mat_<float>(3, 1) << 0, 0, 1);
+	cv::Mat Rx;
+	cv::Mat Ry;
+	cv::Mat Rz;
+
+	cv::Rodrigues(y_axis * radTheta, Ry);
+	cv::Rodrigues(Ry * x_axis * radPhi, Rx);
+	cv::Rodrigues(Rx * Ry * z_axis * radPsi, Rz);
+
+	m_rotationMatrix = Rz * Rx * Ry;
+}
+
+void ThreadPoolRemapping::FrameCalculations(bool bParametersChanged)
+{
+	if (bParametersChanged || m_bFrameCalcRequired)
+	{
+#ifdef VTUNE_API
+		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_ThreadPoolRemapping_calc_kernel);
+#endif
+		BaseAlgorithm::FrameCalculations(bParametersChanged);
+
+		std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+
+		ComputeRotationMatrix((float)m_parameters->m_yaw * DEGREE_CONVERSION_FACTOR, (float)m_parameters->m_pitch * DEGREE_CONVERSION_FACTOR, (float)m_parameters->m_roll * DEGREE_CONVERSION_FACTOR);
+
+		float m00 = m_rotationMatrix.at<float>(0, 0);
+		float m01 = m_rotationMatrix.at<float>(0, 1);
+		float m02 = m_rotationMatrix.at<float>(0, 2);
+		float m10 = m_rotationMatrix.at<float>(1, 0);
+		float m11 = m_rotationMatrix.at<float>(1, 1);
+		float m12 = m_rotationMatrix.at<float>(1, 2);
+		float m20 = m_rotationMatrix.at<float>(2, 0);
+		float m21 = m_rotationMatrix.at<float>(2, 1);
+		float m22 = m_rotationMatrix.at<float>(2, 2);
+		float imageWidth = m_parameters->m_image[m_parameters->m_imageIndex].cols - 1;
+		float imageHeight = m_parameters->m_image[m_parameters->m_imageIndex].rows - 1;
+		float xDiv = 2 * M_PI;
+		int widthOutput = m_parameters->m_widthOutput;
+		int heightOutput = m_parameters->m_heightOutput;
+		float f = 0.5 * widthOutput * 1 / tan(0.5 * m_parameters->m_fov / 180.0 * M_PI);
+		float cx = ((float)widthOutput - 1.0f) / 2.0f;
+		float cy = ((float)heightOutput - 1.0f) / 2.0f;
+		float invf = 1.0f / f;
+		float translatecx = -cx * invf;
+		float translatecy = -cy * invf;
+		int tilesAcross = (widthOutput + TPR_TILE_WIDTH - 1) / TPR_TILE_WIDTH;
+		int tilesDown = (heightOutput + TPR_TILE_HEIGHT - 1) / TPR_TILE_HEIGHT;
+		Point2D *pMap = m_pMap;
+
+		m_pPool->ParallelFor(tilesAcross * tilesDown, [&](int tile) {
+			int startRow = (tile / tilesAcross) * TPR_TILE_HEIGHT;
+			int startCol = (tile % tilesAcross) * TPR_TILE_WIDTH;
+			int endRow = std::min(startRow + TPR_TILE_HEIGHT, heightOutput);
+			int endCol = std::min(startCol + TPR_TILE_WIDTH, widthOutput);
+
+			for (int row = startRow; row < endRow; row++)
+			{
+				Point2D *pPoints = pMap + (size_t)row * widthOutput + startCol;
+
+				for (int col = startCol; col < endCol; col++)
+				{
+					float eX = col * invf + translatecx;
+					float eY = row * invf + translatecy;
+					float eZ = 1.0f;
+					float x = eX * m00 + eY * m01 + eZ * m02;
+					float y = eX * m10 + eY * m11 + eZ * m12;
+					float z = eX * m20 + eY * m21 + eZ * m22;
+					float norm = sqrt(x * x + y * y + z * z);
+
+					x = atan2(x / norm, z / norm);
+					y = asin(y / norm);
+
+					pPoints->m_x = (x / xDiv + 0.5) * imageWidth;
+					pPoints->m_y = (y / M_PI + 0.5) * imageHeight;
+
+					pPoints++;
+				}
+			}
+		});
+
+		if (m_mapCount++ > 0)
+		{
+			m_mapSum += std::chrono::high_resolution_clock::now() - startTime;
+		}
+		m_bFrameCalcRequired = false;
+#ifdef VTUNE_API
+		__itt_task_end(pittTests_domain);
+#endif
+	}
+}
+
+void ThreadPoolRemapping::ExtractTile(const cv::Mat& image, cv::Mat& output, int tile, int tilesAcross)
+{
+	int widthOutput = m_parameters->m_widthOutput;
+	int startRow = (tile / tilesAcross) * TPR_TILE_HEIGHT;
+	int startCol = (tile % tilesAcross) * TPR_TILE_WIDTH;
+	int endRow = std::min(startRow + TPR_TILE_HEIGHT, m_parameters->m_heightOutput);
+	int endCol = std::min(startCol + TPR_TILE_WIDTH, widthOutput);
+	int imageWidth = image.cols;
+	int imageHeight = image.rows;
+
+	for (int row = startRow; row < endRow; row++)
+	{
+		const Point2D *pPoints = m_pMap + (size_t)row * widthOutput + startCol;
+		unsigned char *pOut = output.ptr(row) + startCol * 3;
+
+		if (m_variants[m_variant].m_interpolation == TPR_NEAREST)
+		{
+			for (int col = startCol; col < endCol; col++)
+			{
+				int x = (int)(pPoints->m_x + 0.5f);
+				int y = (int)(pPoints->m_y + 0.5f);
+
+				// Wrap around horizontally (the image is 360 degrees) and clamp vertically
+				x = x >= imageWidth ? x - imageWidth : x;
+				y = y >= imageHeight ? imageHeight - 1 : y;
+
+				const unsigned char *pIn = image.ptr(y) + x * 3;
+
+				pOut[0] = pIn[0];
+				pOut[1] = pIn[1];
+				pOut[2] = pIn[2];
+				pOut += 3;
+				pPoints++;
+			}
+		}
+		else
+		{
+			for (int col = startCol; col < endCol; col++)
+			{
+				int x0 = (int)pPoints->m_x;
+				int y0 = (int)pPoints->m_y;
+				float fx = pPoints->m_x - x0;
+				float fy = pPoints->m_y - y0;
+				int x1 = x0 + 1 >= imageWidth ? 0 : x0 + 1;
+				int y1 = y0 + 1 >= imageHeight ? imageHeight - 1 : y0 + 1;
+				const unsigned char *pRow0 = image.ptr(y0);
+				const unsigned char *pRow1 = image.ptr(y1);
+				const unsigned char *p00 = pRow0 + x0 * 3;
+				const unsigned char *p01 = pRow0 + x1 * 3;
+				const unsigned char *p10 = pRow1 + x0 * 3;
+				const unsigned char *p11 = pRow1 + x1 * 3;
+				float w00 = (1.0f - fx) * (1.0f - fy);
+				float w01 = fx * (1.0f - fy);
+				float w10 = (1.0f - fx) * fy;
+				float w11 = fx * fy;
+
+				for (int channel = 0; channel < 3; channel++)
+				{
+					pOut[channel] = (unsigned char)(p00[channel] * w00 + p01[channel] * w01 + p10[channel] * w10 + p11[channel] * w11 + 0.5f);
+				}
+				pOut += 3;
+				pPoints++;
+			}
+		}
+	}
+}
+
+cv::Mat ThreadPoolRemapping::ExtractFrameImage()
+{
+	cv::Mat retVal;
+
+	ExtractFrameImage(retVal);
+
+	return retVal;
+}
+
+void ThreadPoolRemapping::ExtractFrameImage(cv::Mat& output)
+{
+#ifdef VTUNE_API
+	__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_ThreadPoolRemapping_extract_kernel);
+#endif
+
+	std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+	const cv::Mat& image = m_parameters->m_image[m_parameters->m_imageIndex];
+	bool bNuma = m_variants[m_variant].m_bNuma;
+	int tilesAcross = (m_parameters->m_widthOutput + TPR_TILE_WIDTH - 1) / TPR_TILE_WIDTH;
+	int tilesDown = (m_parameters->m_heightOutput + TPR_TILE_HEIGHT - 1) / TPR_TILE_HEIGHT;
+
+	output.create(m_parameters->m_heightOutput, m_parameters->m_widthOutput, CV_8UC3);
+	if (bNuma)
+	{
+		UpdateReplicas();
+	}
+	m_pPool->ParallelFor(tilesAcross * tilesDown, [&](int tile) {
+		// Each tile reads the copy of the source on the node of the thread running it
+		ExtractTile(bNuma ? m_replicas[m_parameters->m_imageIndex][WorkStealingPool::GetCurrentNode()].m_image : image, output, tile, tilesAcross);
+	});
+
+	std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
+
+	TimingStats::GetTimingStats()->AddIterationResults(ETimingType::TIMING_REMAP, startTime, endTime);
+	if (m_extractCount++ > 0)
+	{
+		m_extractSum += endTime - startTime;
+	}
+
+#ifdef VTUNE_API
+	__itt_task_end(pittTests_domain);
+#endif
+}
+
+void ThreadPoolRemapping::UpdateReplicas()
+{
+	const cv::Mat& image = m_parameters->m_image[m_parameters->m_imageIndex];
+	std::vector<SSourceReplica>& replicas = m_replicas[m_parameters->m_imageIndex];
+	size_t rowBytes = (size_t)image.cols * image.elemSize();
+	size_t bytes = rowBytes * image.rows;
+	// Video frames may be decoded into the same buffer so they always need a fresh copy
+	bool bChanged = m_parameters->m_videoFilename[0] != '\0';
+	NumaTopology* pTopology = NumaTopology::GetTopology();
+
+	for (int node = 0; node < (int)replicas.size(); node++)
+	{
+		SSourceReplica& replica = replicas[node];
+
+		if (replica.m_bytes != bytes)
+		{
+			NumaTopology::Free(replica.m_pMemory, replica.m_bytes);
+			replica.m_pMemory = pTopology->AllocateOnNode(bytes, node);
+			replica.m_bytes = bytes;
+			replica.m_image = cv::Mat(image.rows, image.cols, image.type(), replica.m_pMemory);
+			replica.m_pSource = NULL;
+		}
+		bChanged = bChanged || replica.m_pSource != image.data;
+		replica.m_pSource = image.data;
+	}
+	if (!bChanged)
+	{
+		return;
+	}
+
+	int rowsPerBlock = (image.rows + TPR_REPLICA_BLOCKS - 1) / TPR_REPLICA_BLOCKS;
+
+	// The pool deals block b of node n (task n * TPR_REPLICA_BLOCKS + b) to the threads of node n, which then copy
+	// the rows with node local writes
+	m_pPool->ParallelFor((int)replicas.size() * TPR_REPLICA_BLOCKS, [&](int task) {
+		cv::Mat& replica = replicas[task / TPR_REPLICA_BLOCKS].m_image;
+		int startRow = (task % TPR_REPLICA_BLOCKS) * rowsPerBlock;
+		int endRow = std::min(startRow + rowsPerBlock, image.rows);
+
+		for (int row = startRow; row < endRow; row++)
+		{
+			memcpy(replica.ptr(row), image.ptr(row), rowBytes);
+		}
+	});
+}
+
+void ThreadPoolRemapping::FreeBuffers()
+{
+	if (m_bHugeMap)
+	{
+		HugePageAllocator::Free(m_pMap);
+		m_bHugeMap = false;
+	}
+	else if (m_pMap != NULL && m_pMap != m_map.data())
+	{
+		NumaTopology::Free(m_pMap, m_numaMapBytes);
+	}
+	for (int image = 0; image < 2; image++)
+	{
+		for (auto& replica : m_replicas[image])
+		{
+			replica.m_image.release();
+			NumaTopology::Free(replica.m_pMemory, replica.m_bytes);
+		}
+		m_replicas[image].clear();
+	}
+}
+
+// With NUMA placement the output is untouched memory so each page lands on the node of the threads writing its
+// tiles.  Otherwise the default output image is used.
+cv::Mat ThreadPoolRemapping::AllocateOutputImage()
+{
+	if (m_pOutputMemory != NULL || m_variant < 0 || m_variant >= (int)m_variants.size() || !m_variants[m_variant].m_bNuma)
+	{
+		return BaseAlgorithm::AllocateOutputImage();
+	}
+	m_outputBytes = (size_t)m_parameters->m_widthOutput * m_parameters->m_heightOutput * 3;
+	m_pOutputMemory = NumaTopology::AllocateUntouched(m_outputBytes);
+
+	return cv::Mat(m_parameters->m_heightOutput, m_parameters->m_widthOutput, CV_8UC3, m_pOutputMemory);
+}
+
+void ThreadPoolRemapping::FreeOutputImage(cv::Mat& output)
+{
+	bool bNumaOutput = m_pOutputMemory != NULL && output.data == m_pOutputMemory;
+
+	output.release();
+	if (bNumaOutput)
+	{
+		NumaTopology::Free(m_pOutputMemory, m_outputBytes);
+		m_pOutputMemory = NULL;
+	}
+}
+
+cv::Mat ThreadPoolRemapping::GetDebugImage()
+{
+	cv::Mat retVal;
+	Point2D *pXYElement = m_pMap;
+
+	m_parameters->m_image[m_parameters->m_imageIndex].copyTo(retVal);
+
+	// Draw the points across the top of the viewing region using blue
+	for (int x = 0; x < m_parameters->m_widthOutput; x++)
+	{
+		cv::Point pt = cv::Point(pXYElement->m_x, pXYElement->m_y);
+		cv::line(retVal, pt, pt, cv::Scalar(255, 0, 0), 10);
+
+		pXYElement++;
+	}
+	// Draw the left (red) and right (green) sides of the viewing region
+	for (int y = 1; y < m_parameters->m_heightOutput - 2; y++)
+	{
+		cv::Point ptLeft = cv::Point(pXYElement->m_x, pXYElement->m_y);
+		cv::line(retVal, ptLeft, ptLeft, cv::Scalar(0, 0, 255), 10);
+
+		pXYElement += m_parameters->m_widthOutput - 1;
+		cv::Point ptRight = cv::Point(pXYElement->m_x, pXYElement->m_y);
+		cv::line(retVal, ptRight, ptRight, cv::Scalar(0, 255, 0), 10);
+
+		pXYElement++;
+	}
+
+	// Draw the points across the bottom of the viewing region in tan
+	for (int x = 0; x < m_parameters->m_widthOutput; x++)
+	{
+		cv::Point pt = cv::Point(pXYElement->m_x, pXYElement->m_y);
+		cv::line(retVal, pt, pt, cv::Scalar(74, 136, 175), 10);
+
+		pXYElement++;
+	}
+
+	return retVal;
+}
+
+ThreadPoolRemapping::SScalingResult ThreadPoolRemapping::GetCurrentResult()
+{
+	SScalingResult result = { m_variants[m_variant].m_interpolation, m_variants[m_variant].m_threads, m_variants[m_variant].m_bNuma, 0.0, 0.0 };
+
+	if (m_mapCount > 1)
+	{
+		result.m_mapMs = m_mapSum.count() * 1000.0 / (m_mapCount - 1);
+	}
+	if (m_extractCount > 1)
+	{
+		result.m_extractMs = m_extractSum.count() * 1000.0 / (m_extractCount - 1);
+	}
+
+	return result;
+}
+
+// Reports this variant's averages along with the speedup and efficiency (speedup / threads) relative to the single
+// thread variant with the same interpolation and placement, if one has run (see --poolScaling).  NUMA variants also
+// report their extraction speedup over the default placement run just before them (see --numa).
+std::string ThreadPoolRemapping::GetAlgorithmStats()
+{
+	if (m_pPool == NULL)
+	{
+		return "";
+	}
+
+	char line[1024];
+	SScalingResult current = GetCurrentResult();
+	double mapSpeedup = 0.0;
+	double extractSpeedup = 0.0;
+
+	double numaSpeedup = 0.0;
+
+	for (auto& result : m_scalingResults)
+	{
+		if (current.m_bNuma && !result.m_bNuma && result.m_interpolation == current.m_interpolation && result.m_threads == current.m_threads &&
+			current.m_extractMs > 0.0)
+		{
+			numaSpeedup = result.m_extractMs / current.m_extractMs;
+		}
+		if (result.m_interpolation == current.m_interpolation && result.m_threads == 1 && result.m_bNuma == current.m_bNuma)
+		{
+			if (current.m_mapMs > 0.0)
+			{
+				mapSpeedup = result.m_mapMs / current.m_mapMs;
+			}
+			if (current.m_extractMs > 0.0)
+			{
+				extractSpeedup = result.m_extractMs / current.m_extractMs;
+			}
+		}
+	}
+	if (current.m_threads == 1)
+	{
+		mapSpeedup = current.m_mapMs > 0.0 ? 1.0 : 0.0;
+		extractSpeedup = current.m_extractMs > 0.0 ? 1.0 : 0.0;
+	}
+	sprintf(line, "Thread pool,%d,threads,%lld,steals,%8.3f,ms average map,%8.3f,x map speedup,%8.3f,%% map efficiency,%8.3f,ms average extraction,%8.3f,x extraction speedup,%8.3f,%% extraction efficiency,%d,nodes,%8.3f,x NUMA extraction speedup\n",
+		current.m_threads, m_pPool->GetSteals(), current.m_mapMs, mapSpeedup, mapSpeedup * 100.0 / current.m_threads,
+		current.m_extractMs, extractSpeedup, extractSpeedup * 100.0 / current.m_threads, m_pPool->GetNodeCount(), numaSpeedup);
+
+	return line;
+}
+
+bool ThreadPoolRemapping::StartVariant()
+{
+	BaseAlgorithm::StartVariant();
+
+	bool bRetVal = false;
+
+	m_variant++;
+
+	if (m_variant < (int)m_variants.size())
+	{
+		size_t size = (size_t)m_parameters->m_widthOutput * m_parameters->m_heightOutput;
+
+		m_pPool = new WorkStealingPool(m_variants[m_variant].m_threads, m_parameters->m_bPoolPinning, m_variants[m_variant].m_bNuma);
+		if (m_variants[m_variant].m_bNuma)
+		{
+			m_numaMapBytes = size * sizeof(Point2D);
+			m_pMap = (Point2D *)NumaTopology::AllocateUntouched(m_numaMapBytes);
+			for (int image = 0; image < 2; image++)
+			{
+				m_replicas[image].assign(m_pPool->GetNodeCount(), { NULL, NULL, 0, cv::Mat() });
+			}
+		}
+		else if (HugePageAllocator::GetHugePageAllocator() != NULL)
+		{
+			m_pMap = (Point2D *)HugePageAllocator::Allocate(size * sizeof(Point2D));
+			memset(m_pMap, 0, size * sizeof(Point2D));
+			m_bHugeMap = true;
+		}
+		else
+		{
+			m_map.assign(size, { 0.0f, 0.0f });
+			m_pMap = m_map.data();
+		}
+		m_mapCount = 0;
+		m_extractCount = 0;
+		m_mapSum = std::chrono::duration<double>(0);
+		m_extractSum = std::chrono::duration<double>(0);
+		bRetVal = true;
+		m_bFrameCalcRequired = true;
+	}
+
+	return bRetVal;
+}
+
+void ThreadPoolRemapping::StopVariant()
+{
+	if (m_pPool != NULL)
+	{
+		m_scalingResults.push_back(GetCurrentResult());
+		delete m_pPool;
+		m_pPool = NULL;
+	}
+	FreeBuffers();
+	m_map.clear();
+	m_map.shrink_to_fit();
+	m_pMap = NULL;
+}
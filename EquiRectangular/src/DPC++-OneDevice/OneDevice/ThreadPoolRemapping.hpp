@@ -0,0 +1,105 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+#include "BaseAlgorithm.hpp"
+#include "NumaTopology.hpp"
+#include "Point2D.hpp"
+#include "WorkStealingPool.hpp"
+#include <chrono>
+#include <opencv2/core/mat.hpp>
+#include <vector>
+
+const int TPR_NEAREST = 0;
+const int TPR_BILINEAR = 1;
+
+// Size of the tiles (in output pixels) handed to the pool as tasks
+const int TPR_TILE_WIDTH = 128;
+const int TPR_TILE_HEIGHT = 16;
+// Number of tasks per NUMA node used to copy the source into the node's replica
+const int TPR_REPLICA_BLOCKS = 16;
+
+class ThreadPoolRemapping : public BaseAlgorithm {
+
+private:
+	struct SPoolVariant {
+		int		m_interpolation;
+		int		m_threads;
+		// m_bNuma places the map, source replicas, and output on the NUMA node of the threads that use them
+		bool	m_bNuma;
+	};
+	// SScalingResult holds the average times of a finished variant so later variants can report their speedup
+	struct SScalingResult {
+		int		m_interpolation;
+		int		m_threads;
+		bool	m_bNuma;
+		double	m_mapMs;
+		double	m_extractMs;
+	};
+
+	std::vector<SPoolVariant> m_variants;
+	int m_variant;
+	WorkStealingPool *m_pPool = NULL;
+	// With default placement m_map holds the map (zeroed, so first touched, by the thread that starts the variant).
+	// With NUMA placement m_pMap is untouched memory that the pool's threads first touch tile by tile.
+	std::vector<Point2D> m_map;
+	Point2D *m_pMap = NULL;
+	size_t m_numaMapBytes;
+	// m_bHugeMap is true when the default placement map came from HugePageAllocator (--hugePages)
+	bool m_bHugeMap = false;
+	// m_replicas holds a copy of each source image on each NUMA node ([imageIndex][node])
+	struct SSourceReplica {
+		const unsigned char*	m_pSource;
+		void*		m_pMemory;
+		size_t		m_bytes;
+		cv::Mat		m_image;
+	};
+	std::vector<SSourceReplica> m_replicas[2];
+	void *m_pOutputMemory = NULL;
+	size_t m_outputBytes;
+	cv::Mat m_rotationMatrix;
+	std::vector<SScalingResult> m_scalingResults;
+	// The first map and extraction of each variant are left out of the averages (thread start up, page faults)
+	int m_mapCount;
+	int m_extractCount;
+	std::chrono::duration<double> m_mapSum;
+	std::chrono::duration<double> m_extractSum;
+
+	// Pass in theta, phi, and psi in radians, not degrees
+	void ComputeRotationMatrix(float radTheta, float radPhi, float radPsi);
+	void ExtractTile(const cv::Mat& image, cv::Mat& output, int tile, int tilesAcross);
+	SScalingResult GetCurrentResult();
+	// UpdateReplicas copies the current source to every node if it changed since the last copy
+	void UpdateReplicas();
+	void FreeBuffers();
+
+public:
+	ThreadPoolRemapping(SParameters &parameters);
+	~ThreadPoolRemapping();
+
+	virtual void FrameCalculations(bool bParametersChanged);
+	virtual cv::Mat ExtractFrameImage();
+	virtual void ExtractFrameImage(cv::Mat& output);
+	virtual cv::Mat AllocateOutputImage();
+	virtual void FreeOutputImage(cv::Mat& output);
+	virtual cv::Mat GetDebugImage();
+
+	virtual std::string GetDescription();
+	virtual std::string GetAlgorithmStats();
+
+	virtual bool StartVariant();
+	virtual void StopVariant();
+};
@@ -17,19 +17,54 @@
 #include <string>
 #include <iostream>
 
-TimingStats* TimingStats::c_timingStats = new TimingStats();
+thread_local TimingStats* TimingStats::c_timingStats = NULL;
+int TimingStats::c_warmupIterations = 1;
+bool TimingStats::c_bCounters = false;
+long long TimingStats::c_outputPixels = 0;
 
 TimingStats *TimingStats::GetTimingStats()
 {
+	if (c_timingStats == NULL)
+	{
+		c_timingStats = new TimingStats();
+	}
+
 	return c_timingStats;
 }
 
+void TimingStats::ReleaseTimingStats()
+{
+	delete c_timingStats;
+	c_timingStats = NULL;
+}
+
+void TimingStats::SetWarmupIterations(int warmupIterations)
+{
+	c_warmupIterations = warmupIterations;
+}
+
+void TimingStats::SetCounters(bool bCounters, long long outputPixels)
+{
+	c_bCounters = bCounters;
+	c_outputPixels = outputPixels;
+}
+
 TimingStats::TimingStats()
 {
+	m_pCounterGroup = NULL;
 	Reset();
 	ResetLap();
 }
 
+TimingStats::~TimingStats()
+{
+	if (m_pCounterGroup != NULL)
+	{
+		delete m_pCounterGroup;
+		m_pCounterGroup = NULL;
+	}
+}
+
 void TimingStats::Reset()
 {
 	for (int i = 0; i < ETimingType::TIMING_MAX; i++)
@@ -37,6 +72,16 @@ void TimingStats::Reset()
 		m_iterations[i] = 0;
 		m_durationsSum[i] = std::chrono::duration<double>::zero();
 		m_durationWarmup[i] = std::chrono::duration<double>::zero();
+		m_warmupIterations[i] = 0;
+		m_histograms[i].Reset();
+		m_bytesWarmup[i] = 0.0;
+		m_bytesSum[i] = 0.0;
+		m_bCounterStarted[i] = false;
+		m_counterIterations[i] = 0;
+		for (int counter = 0; counter < PERF_GROUP_MAX; counter++)
+		{
+			m_counterSums[i][counter] = 0;
+		}
 	}
 }
 
@@ -46,6 +91,7 @@ void TimingStats::ResetLap()
 	{
 		m_lapIterations[i] = 0;
 		m_lapDurationsSum[i] = std::chrono::duration<double>::zero();
+		m_lapBytesSum[i] = 0.0;
 	}
 }
 
@@ -53,6 +99,21 @@ void TimingStats::AddIterationResults(ETimingType timingType, std::chrono::high_
 {
 	std::chrono::duration<double> duration = std::chrono::duration<double>(endTime - startTime);
 
+	if (m_bCounterStarted[timingType])
+	{
+		long long counts[PERF_GROUP_MAX];
+
+		m_bCounterStarted[timingType] = false;
+		// Skip the warmup sections the same way the durations below do
+		if (m_warmupIterations[timingType] >= c_warmupIterations && m_pCounterGroup->Read(counts))
+		{
+			for (int counter = 0; counter < PERF_GROUP_MAX; counter++)
+			{
+				m_counterSums[timingType][counter] += counts[counter] - m_counterStart[timingType][counter];
+			}
+			m_counterIterations[timingType]++;
+		}
+	}
 	if (timingType == TIMING_TOTAL)
 	{
 		m_lapIterations[timingType] = m_lapIterations[TIMING_FRAME];
@@ -60,21 +121,52 @@ void TimingStats::AddIterationResults(ETimingType timingType, std::chrono::high_
 	}
 	else
 	{
-		if (m_durationWarmup[timingType] == std::chrono::duration<double>::zero())
+		if (m_warmupIterations[timingType] < c_warmupIterations)
 		{
-			m_durationWarmup[timingType] = duration;
+			m_durationWarmup[timingType] += duration;
+			m_warmupIterations[timingType]++;
 		}
 		else
 		{
 			m_iterations[timingType]++;
 			m_durationsSum[timingType] += duration;
+			m_histograms[timingType].Record(duration);
 		}
 		m_lapIterations[timingType]++;
 		m_lapDurationsSum[timingType] += duration;
 	}
 }
 
-std::string TimingStats::GetSummaryLine(std::string strDesc, std::string typeString, std::chrono::duration<double> durationSum, int numIterations, ETimingType timingType)
+void TimingStats::StartCounters(ETimingType timingType)
+{
+	if (!c_bCounters)
+	{
+		return;
+	}
+	if (m_pCounterGroup == NULL)
+	{
+		m_pCounterGroup = new PerfCounterGroup();
+		m_pCounterGroup->Open();
+	}
+	m_bCounterStarted[timingType] = m_pCounterGroup->Read(m_counterStart[timingType]);
+}
+
+void TimingStats::AddTransferResults(ETimingType timingType, std::chrono::high_resolution_clock::time_point startTime, std::chrono::high_resolution_clock::time_point endTime, size_t bytes)
+{
+	// Mirror the warmup split done by AddIterationResults so the bytes line up with the durations
+	if (m_warmupIterations[timingType] < c_warmupIterations)
+	{
+		m_bytesWarmup[timingType] += (double)bytes;
+	}
+	else
+	{
+		m_bytesSum[timingType] += (double)bytes;
+	}
+	m_lapBytesSum[timingType] += (double)bytes;
+	AddIterationResults(timingType, startTime, endTime);
+}
+
+std::string TimingStats::GetSummaryLine(std::string strDesc, std::string typeString, std::chrono::duration<double> durationSum, int numIterations, ETimingType timingType, double bytesSum /* = 0.0 */)
 {
 	char line1[1024];
 	char line2[1024];
@@ -85,9 +177,11 @@ std::string TimingStats::GetSummaryLine(std::string strDesc, std::string typeStr
 	// The Comma Separated Variables output is useful when loading the output into a program such as Excel
 	char const *pFmt = "%15s,%5d,%23s,%12.8f,s,%12.5f,ms,%12.3f,us, ";
 	char const *pFmt2 = "FPS, %12.7f\n";
+	char const *pFmt3 = "GB/s, %12.5f\n";
 #else
 	char const *pFmt = "%15s %5d %23s %12.8fs %12.5fms %12.3fus ";
 	char const *pFmt2 = "FPS = %12.7f\n";
+	char const *pFmt3 = "GB/s = %12.5f\n";
 #endif
 	std::chrono::duration<double> aveDuration = durationSum / numIterations;
 	sprintf(line1, pFmt, strDesc.c_str(), numIterations, typeString.c_str(), aveDuration, aveDuration * 1000.0, aveDuration * 1000000.0);
@@ -99,6 +193,10 @@ std::string TimingStats::GetSummaryLine(std::string strDesc, std::string typeStr
 	{
 		sprintf(line2, pFmt2, 1.0 / (aveDuration.count() * std::chrono::duration<double>::period::num / std::chrono::duration<double>::period::den));
 	}
+	else if (bytesSum > 0.0 && durationSum.count() > 0.0)
+	{
+		sprintf(line2, pFmt3, bytesSum / durationSum.count() / 1.0e9);
+	}
 	else
 	{
 		sprintf(line2, "\n");
@@ -110,9 +208,52 @@ std::string TimingStats::GetSummaryLine(std::string strDesc, std::string typeStr
 	return retVal;
 }
 
-void TimingStats::ReportTime(std::string strDesc, std::string typeString, std::chrono::duration<double> durationSum, int numIterations, ETimingType timingType)
+std::string TimingStats::GetPercentileLine(std::string strDesc, std::string typeString, const LatencyHistogram& histogram)
+{
+	char line[1024];
+
+#ifdef CSV_OUTPUT
+	char const *pFmt = "%15s,%5llu,%23s,min,%12.5f,ms,p50,%12.5f,ms,p90,%12.5f,ms,p99,%12.5f,ms,p99.9,%12.5f,ms,max,%12.5f,ms,stddev,%12.5f,ms\n";
+#else
+	char const *pFmt = "%15s %5llu %23s min %12.5fms p50 %12.5fms p90 %12.5fms p99 %12.5fms p99.9 %12.5fms max %12.5fms stddev %12.5fms\n";
+#endif
+	sprintf(line, pFmt, strDesc.c_str(), (unsigned long long)histogram.GetCount(), typeString.c_str(), histogram.GetMin() * 1000.0,
+		histogram.GetPercentile(50.0) * 1000.0, histogram.GetPercentile(90.0) * 1000.0, histogram.GetPercentile(99.0) * 1000.0,
+		histogram.GetPercentile(99.9) * 1000.0, histogram.GetMax() * 1000.0, histogram.GetStdDev() * 1000.0);
+
+	return line;
+}
+
+std::string TimingStats::GetCounterLine(std::string strDesc, ETimingType timingType)
+{
+	char line[1024];
+	int iterations = m_counterIterations[timingType];
+
+	if (iterations == 0 || c_outputPixels <= 0)
+	{
+		return "";
+	}
+
+	double pixels = (double)iterations * (double)c_outputPixels;
+	long long* pSums = m_counterSums[timingType];
+
+#ifdef CSV_OUTPUT
+	char const *pFmt = "%15s,%5d,%23s,IPC,%8.3f,cycles/pixel,%10.3f,LLC misses/pixel,%10.5f,dTLB misses/pixel,%10.5f,branch misses/pixel,%10.5f,bytes/pixel,%10.3f\n";
+#else
+	char const *pFmt = "%15s %5d %23s IPC %8.3f cycles/pixel %10.3f LLC misses/pixel %10.5f dTLB misses/pixel %10.5f branch misses/pixel %10.5f bytes/pixel %10.3f\n";
+#endif
+	sprintf(line, pFmt, strDesc.c_str(), iterations, GetTypeString(timingType).c_str(),
+		(pSums[PERF_GROUP_CYCLES] > 0) ? (double)pSums[PERF_GROUP_INSTRUCTIONS] / (double)pSums[PERF_GROUP_CYCLES] : 0.0,
+		(double)pSums[PERF_GROUP_CYCLES] / pixels, (double)pSums[PERF_GROUP_LLC_MISSES] / pixels,
+		(double)pSums[PERF_GROUP_DTLB_MISSES] / pixels, (double)pSums[PERF_GROUP_BRANCH_MISSES] / pixels,
+		(double)pSums[PERF_GROUP_LLC_MISSES] * PERF_CACHE_LINE_BYTES / pixels);
+
+	return line;
+}
+
+void TimingStats::ReportTime(std::string strDesc, std::string typeString, std::chrono::duration<double> durationSum, int numIterations, ETimingType timingType, double bytesSum /* = 0.0 */)
 {
-	printf("%s", GetSummaryLine(strDesc, typeString, durationSum, numIterations, timingType).c_str());
+	printf("%s", GetSummaryLine(strDesc, typeString, durationSum, numIterations, timingType, bytesSum).c_str());
 }
 
 std::string TimingStats::GetTypeString(ETimingType timingType)
@@ -127,6 +268,12 @@ std::string TimingStats::GetTypeString(ETimingType timingType)
 	case VARIANT_INITIALIZATION:
 		strDesc = "Variant initialization";
 		break;
+	case TIMING_FRAME_DECODE:
+		strDesc = "Frame decode";
+		break;
+	case TIMING_FRAME_WAIT:
+		strDesc = "Frame source wait";
+		break;
 	case TIMING_CREATE_XYZ_COORDS:
 		strDesc = "Create XYZ Coords";
 		break;
@@ -148,6 +295,18 @@ std::string TimingStats::GetTypeString(ETimingType timingType)
 	case TIMING_IMAGE_EXTRACTION:
 		strDesc = "Image extraction";
 		break;
+	case TIMING_FRAME_LATENCY:
+		strDesc = "Frame latency";
+		break;
+	case TIMING_OUTPUT_COPY:
+		strDesc = "Output copy";
+		break;
+	case TIMING_UPLOAD:
+		strDesc = "Source upload";
+		break;
+	case TIMING_READBACK:
+		strDesc = "Output readback";
+		break;
 	case TIMING_FRAME:
 		strDesc = "frame(s)";
 		break;
@@ -172,10 +331,10 @@ void TimingStats::ReportTimes(bool bIncludeLap)
 	desc = "warmup";
 	for (int i = 0; i < ETimingType::TIMING_MAX; i++)
 	{
-		if (m_durationWarmup[i] != std::chrono::duration<double>::zero())
+		if (m_warmupIterations[i] != 0)
 		{
 			std::string typeString = GetTypeString((ETimingType)i);
-			ReportTime(desc, typeString, m_durationWarmup[i], 1, (ETimingType)i);
+			ReportTime(desc, typeString, m_durationWarmup[i], m_warmupIterations[i], (ETimingType)i, m_bytesWarmup[i]);
 		}
 	}
 	desc = "times averaging";
@@ -184,9 +343,22 @@ void TimingStats::ReportTimes(bool bIncludeLap)
 		if (m_iterations[i] != 0)
 		{
 			std::string typeString = GetTypeString((ETimingType)i);
-			ReportTime(desc, typeString, m_durationsSum[i], m_iterations[i], (ETimingType)i);
+			ReportTime(desc, typeString, m_durationsSum[i], m_iterations[i], (ETimingType)i, m_bytesSum[i]);
+		}
+	}
+	desc = "percentiles";
+	for (int i = 0; i < ETimingType::TIMING_MAX; i++)
+	{
+		if (m_iterations[i] != 0)
+		{
+			printf("%s", GetPercentileLine(desc, GetTypeString((ETimingType)i), m_histograms[i]).c_str());
 		}
 	}
+	desc = "counters";
+	for (int i = 0; i < ETimingType::TIMING_MAX; i++)
+	{
+		printf("%s", GetCounterLine(desc, (ETimingType)i).c_str());
+	}
 	if (bIncludeLap)
 	{
 		desc = "lap averaging";
@@ -201,7 +373,7 @@ void TimingStats::ReportTimes(bool bIncludeLap)
 				}
 				else
 				{
-					ReportTime(desc, typeString, m_lapDurationsSum[i], m_lapIterations[i], (ETimingType)i);
+					ReportTime(desc, typeString, m_lapDurationsSum[i], m_lapIterations[i], (ETimingType)i, m_lapBytesSum[i]);
 				}
 			}
 		}
@@ -212,13 +384,33 @@ std::string TimingStats::SummaryStats(bool bIncludeLap /* = true */)
 {
 	std::string retVal = "";
 
-	if (m_durationWarmup[ETimingType::TIMING_FRAME] != std::chrono::duration<double>::zero())
+	if (m_warmupIterations[ETimingType::TIMING_FRAME] != 0)
 	{
-		retVal += GetSummaryLine("warmup", GetTypeString(ETimingType::TIMING_FRAME), m_durationWarmup[ETimingType::TIMING_FRAME], 1, ETimingType::TIMING_FRAME);
+		retVal += GetSummaryLine("warmup", GetTypeString(ETimingType::TIMING_FRAME), m_durationWarmup[ETimingType::TIMING_FRAME], m_warmupIterations[ETimingType::TIMING_FRAME], ETimingType::TIMING_FRAME);
 	}
 	if (m_iterations[ETimingType::TIMING_FRAME] != 0)
 	{
 		retVal += GetSummaryLine("times averaging", GetTypeString(ETimingType::TIMING_FRAME), m_durationsSum[ETimingType::TIMING_FRAME], m_iterations[ETimingType::TIMING_FRAME], ETimingType::TIMING_FRAME);
+		retVal += GetPercentileLine("percentiles", GetTypeString(ETimingType::TIMING_FRAME), m_histograms[ETimingType::TIMING_FRAME]);
+	}
+	if (m_iterations[ETimingType::TIMING_FRAME_LATENCY] != 0)
+	{
+		// Pipelined algorithms hand back a frame several calls after it was submitted so the frame time
+		// alone understates how old the returned image is
+		retVal += GetSummaryLine("times averaging", GetTypeString(ETimingType::TIMING_FRAME_LATENCY), m_durationsSum[ETimingType::TIMING_FRAME_LATENCY], m_iterations[ETimingType::TIMING_FRAME_LATENCY], ETimingType::TIMING_FRAME_LATENCY);
+		retVal += GetPercentileLine("percentiles", GetTypeString(ETimingType::TIMING_FRAME_LATENCY), m_histograms[ETimingType::TIMING_FRAME_LATENCY]);
+	}
+	for (int i = ETimingType::TIMING_UPLOAD; i <= ETimingType::TIMING_READBACK; i++)
+	{
+		if (m_iterations[i] != 0)
+		{
+			retVal += GetSummaryLine("times averaging", GetTypeString((ETimingType)i), m_durationsSum[i], m_iterations[i], (ETimingType)i, m_bytesSum[i]);
+		}
+	}
+	for (int i = 0; i < ETimingType::TIMING_MAX; i++)
+	{
+		// Only the sections wrapped by StartCounters have counts
+		retVal += GetCounterLine("counters", (ETimingType)i);
 	}
 	if (m_lapIterations[ETimingType::TIMING_TOTAL] != 0)
 	{
@@ -232,3 +424,17 @@ std::string TimingStats::SummaryStats(bool bIncludeLap /* = true */)
 	return retVal;
 }
 
+const LatencyHistogram& TimingStats::GetHistogram(ETimingType timingType)
+{
+	return m_histograms[timingType];
+}
+
+std::chrono::duration<double> TimingStats::GetWarmupDuration(ETimingType timingType)
+{
+	return m_durationWarmup[timingType];
+}
+
+int TimingStats::GetWarmupIterations(ETimingType timingType)
+{
+	return m_warmupIterations[timingType];
+}
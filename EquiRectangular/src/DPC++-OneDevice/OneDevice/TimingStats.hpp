@@ -16,10 +16,15 @@
 #pragma once
 
 #include <chrono>
+#include <string>
+#include "LatencyHistogram.hpp"
+#include "PerfCounters.hpp"
 
 enum ETimingType {
 	TIMING_INITIALIZATION = 0,
 	VARIANT_INITIALIZATION,
+	TIMING_FRAME_DECODE,
+	TIMING_FRAME_WAIT,
 	TIMING_CREATE_XYZ_COORDS,
 	TIMING_CREATE_LON_LAT_COORDS,
 	TIMING_CREATE_XY_COORDS,
@@ -27,6 +32,10 @@ enum ETimingType {
 	TIMING_CREATE_MAP,
 	TIMING_REMAP,
 	TIMING_IMAGE_EXTRACTION,
+	TIMING_FRAME_LATENCY,
+	TIMING_OUTPUT_COPY,
+	TIMING_UPLOAD,
+	TIMING_READBACK,
 	TIMING_FRAME,
 	VARIANT_TERMINATION,
 	TIMING_TOTAL,
@@ -36,35 +45,81 @@ enum ETimingType {
 class TimingStats {
 
 private:
-	static TimingStats* c_timingStats;
+	// Each thread gets its own statistics (e.g., the --batch workers) so AddIterationResults needs no locking
+	static thread_local TimingStats* c_timingStats;
+	// c_warmupIterations is the number of first results of each timing type that count as warmup (--warmupIterations)
+	static int c_warmupIterations;
+	// c_bCounters turns on the hardware counters per timing type (--perfCounters on Linux) and c_outputPixels is
+	// the output frame size the per pixel counts are based on
+	static bool c_bCounters;
+	static long long c_outputPixels;
 
-	// m_durationWarmup holds the very first duration for each timing type.  The "warmup" run
-	// is often much longer than the subsequent runs since the kernel may need to be compiled, etc.
-	std::chrono::duration<float> m_durationWarmup[TIMING_MAX];
-	// m_iterations holds the number of times a given timing type has been reported (minus the warmup run)
+	// m_durationWarmup holds the sum of the first c_warmupIterations durations for each timing type.  The "warmup"
+	// run is often much longer than the subsequent runs since the kernel may need to be compiled, etc.
+	std::chrono::duration<double> m_durationWarmup[TIMING_MAX];
+	int m_warmupIterations[TIMING_MAX];
+	// m_iterations holds the number of times a given timing type has been reported (minus the warmup runs)
 	int m_iterations[TIMING_MAX];
-	// m_durationsSum holds the sum of all the post-warmup runs
-	std::chrono::duration<float> m_durationsSum[TIMING_MAX];
+	// m_durationsSum holds the sum of all the post-warmup runs.  It is kept in double since a float sum stops
+	// growing once it is about 2^24 times larger than the durations added to it.
+	std::chrono::duration<double> m_durationsSum[TIMING_MAX];
+	// m_histograms holds the distribution of the post-warmup runs for the percentiles, min, max, and deviation
+	LatencyHistogram m_histograms[TIMING_MAX];
 	// m_lapIterations holds a "lap" counter that helps when looking at instantaneous runs rather than the total
 	// run.  For example if the algorithm takes a lot of time to compute when parameters are changed, but less
 	// time when flipping frames, then the lap time can be used to show the latest frame while the m_iterations
 	// and m_durationsSum will report the overall results including both the runs where parameters were changed
 	// and those where they were not.
 	int m_lapIterations[TIMING_MAX];
-	std::chrono::duration<float> m_lapDurationsSum[TIMING_MAX];
+	std::chrono::duration<double> m_lapDurationsSum[TIMING_MAX];
+	// m_bytes* hold the number of bytes moved for the timing types that are memory transfers (reported through
+	// AddTransferResults) so the bandwidth can be reported.  They follow the same warmup, total, and lap split.
+	double m_bytesWarmup[TIMING_MAX];
+	double m_bytesSum[TIMING_MAX];
+	double m_lapBytesSum[TIMING_MAX];
+	// m_pCounterGroup counts this thread's events (see PerfCounterGroup).  It is opened by the first StartCounters
+	// call since it has to be opened on the thread it counts.  m_counterStart holds the counts read by StartCounters
+	// and m_counterSums the post-warmup differences over m_counterIterations sections of each timing type.
+	PerfCounterGroup* m_pCounterGroup;
+	bool m_bCounterStarted[TIMING_MAX];
+	long long m_counterStart[TIMING_MAX][PERF_GROUP_MAX];
+	long long m_counterSums[TIMING_MAX][PERF_GROUP_MAX];
+	int m_counterIterations[TIMING_MAX];
 
 public:
 	static TimingStats* GetTimingStats();
+	// ReleaseTimingStats frees the calling thread's statistics.  Worker threads call this before exiting.
+	static void ReleaseTimingStats();
+	// SetWarmupIterations applies to the statistics of every thread.  Call it before any results are added.
+	static void SetWarmupIterations(int warmupIterations);
+	// SetCounters turns the hardware counters per timing type on or off for every thread.  Call it before any
+	// results are added.
+	static void SetCounters(bool bCounters, long long outputPixels);
 
 	TimingStats();
-	//~TimingStats();
+	~TimingStats();
 
 	void Reset();
 	void ResetLap();
 	void AddIterationResults(ETimingType timingType, std::chrono::high_resolution_clock::time_point startTime, std::chrono::high_resolution_clock::time_point endTime, bool bReportIteration = false);
+	// StartCounters reads the thread's counters at the start of a timingType section; the next AddIterationResults
+	// of timingType reads them again and adds the difference.  Only the counts of the calling thread are included, so
+	// the work of pool threads shows up in the variant totals (PerfCounters) rather than here.
+	void StartCounters(ETimingType timingType);
+	void AddTransferResults(ETimingType timingType, std::chrono::high_resolution_clock::time_point startTime, std::chrono::high_resolution_clock::time_point endTime, size_t bytes);
 	std::string GetTypeString(ETimingType timingType);
-	void ReportTime(std::string strDesc, std::string typeString, std::chrono::duration<double> durationSum, int numIterations, ETimingType timingType);
+	void ReportTime(std::string strDesc, std::string typeString, std::chrono::duration<double> durationSum, int numIterations, ETimingType timingType, double bytesSum = 0.0);
 	void ReportTimes(bool bIncludeLap);
-	std::string GetSummaryLine(std::string strDesc, std::string typeString, std::chrono::duration<double> durationSum, int numIterations, ETimingType timingType);
+	std::string GetSummaryLine(std::string strDesc, std::string typeString, std::chrono::duration<double> durationSum, int numIterations, ETimingType timingType, double bytesSum = 0.0);
+	// GetPercentileLine returns the min, p50, p90, p99, p99.9, max, and standard deviation line for histogram
+	std::string GetPercentileLine(std::string strDesc, std::string typeString, const LatencyHistogram& histogram);
+	// GetCounterLine returns the instructions per cycle and the cycles, misses, and estimated memory read bytes per
+	// output pixel of timingType, or "" if no counts were added
+	std::string GetCounterLine(std::string strDesc, ETimingType timingType);
 	std::string SummaryStats(bool bIncludeLap = true);
+	// GetHistogram, GetWarmupDuration, and GetWarmupIterations return the statistics of timingType (e.g., for the
+	// results file)
+	const LatencyHistogram& GetHistogram(ETimingType timingType);
+	std::chrono::duration<double> GetWarmupDuration(ETimingType timingType);
+	int GetWarmupIterations(ETimingType timingType);
 };
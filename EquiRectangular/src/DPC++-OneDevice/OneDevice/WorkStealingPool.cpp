@@ -0,0 +1,280 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "WorkStealingPool.hpp"
+#include <algorithm>
+#include "NumaTopology.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+thread_local int WorkStealingPool::c_currentNode = 0;
+
+WorkStealingPool::WorkStealingPool(int threadCount, bool bPinThreads, bool bNumaAware)
+{
+	m_threadCount = threadCount > 0 ? threadCount : GetHardwareThreads();
+	m_bPinThreads = bPinThreads;
+	m_bNumaAware = bNumaAware;
+	m_nodeCount = 1;
+	m_pTileFunc = NULL;
+	m_generation = 0;
+	m_bStopRequested = false;
+	m_tilesRemaining = 0;
+	m_statSteals = 0;
+
+	if (m_bNumaAware)
+	{
+		m_nodeCount = std::min(NumaTopology::GetTopology()->GetNodeCount(), m_threadCount);
+	}
+	m_nodeQueues.resize(m_nodeCount);
+	for (int queue = 0; queue < m_threadCount; queue++)
+	{
+		// Contiguous blocks of threads per node so thread counts that do not divide evenly stay balanced
+		int node = (int)((long long)queue * m_nodeCount / m_threadCount);
+
+		m_queues.push_back(new STaskQueue);
+		m_queueNodes.push_back(node);
+		m_nodeQueues[node].push_back(queue);
+	}
+#ifdef _WIN32
+	DWORD_PTR processAffinity = 0;
+	DWORD_PTR systemAffinity = 0;
+
+	// Windows cannot query a thread's affinity, but threads start with the process affinity
+	GetProcessAffinityMask(GetCurrentProcess(), &processAffinity, &systemAffinity);
+	m_callerAffinity = processAffinity;
+#else
+	pthread_getaffinity_np(pthread_self(), sizeof(m_callerAffinity), &m_callerAffinity);
+#endif
+	PlaceCurrentThread(0);
+	for (int worker = 1; worker < m_threadCount; worker++)
+	{
+		m_workers.push_back(new std::thread(&WorkStealingPool::workerThreadFunc, this, worker));
+	}
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	{
+		std::lock_guard<std::mutex> poolLock(m_poolMutex);
+
+		m_bStopRequested = true;
+	}
+	m_workReadyCondVar.notify_all();
+	for (auto pWorker : m_workers)
+	{
+		pWorker->join();
+		delete pWorker;
+	}
+	for (auto pQueue : m_queues)
+	{
+		delete pQueue;
+	}
+	if (m_bPinThreads || m_bNumaAware)
+	{
+#ifdef _WIN32
+		if (m_callerAffinity != 0)
+		{
+			SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)m_callerAffinity);
+		}
+#else
+		pthread_setaffinity_np(pthread_self(), sizeof(m_callerAffinity), &m_callerAffinity);
+#endif
+	}
+	c_currentNode = 0;
+}
+
+int WorkStealingPool::GetHardwareThreads()
+{
+	int threads = (int)std::thread::hardware_concurrency();
+
+	return threads > 0 ? threads : 1;
+}
+
+int WorkStealingPool::GetThreadCount()
+{
+	return m_threadCount;
+}
+
+int WorkStealingPool::GetNodeCount()
+{
+	return m_nodeCount;
+}
+
+int WorkStealingPool::GetCurrentNode()
+{
+	return c_currentNode;
+}
+
+long long WorkStealingPool::GetSteals()
+{
+	return m_statSteals;
+}
+
+void WorkStealingPool::PinCurrentThread(int core)
+{
+	core = core % GetHardwareThreads();
+#ifdef _WIN32
+	SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << core);
+#else
+	cpu_set_t cpuSet;
+
+	CPU_ZERO(&cpuSet);
+	CPU_SET(core, &cpuSet);
+	pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#endif
+}
+
+void WorkStealingPool::PlaceCurrentThread(int queueIndex)
+{
+	if (m_bNumaAware)
+	{
+		int node = m_queueNodes[queueIndex];
+		int indexInNode = queueIndex - m_nodeQueues[node][0];
+
+		// Without pinning the thread may still move between the hardware threads of its node
+		NumaTopology::GetTopology()->PinCurrentThread(node, m_bPinThreads ? indexInNode : -1);
+		c_currentNode = node;
+	}
+	else if (m_bPinThreads)
+	{
+		PinCurrentThread(queueIndex);
+	}
+}
+
+bool WorkStealingPool::TakeTile(int queueIndex, int& tile)
+{
+	{
+		STaskQueue* pOwn = m_queues[queueIndex];
+		std::lock_guard<std::mutex> queueLock(pOwn->m_mutex);
+
+		if (!pOwn->m_tiles.empty())
+		{
+			tile = pOwn->m_tiles.back();
+			pOwn->m_tiles.pop_back();
+
+			return true;
+		}
+	}
+	// Steal (only within the node when NUMA aware), starting with the next queue so the thieves spread out over
+	// the victims
+	const std::vector<int>& nodeQueues = m_nodeQueues[m_queueNodes[queueIndex]];
+	int queueCount = m_bNumaAware ? (int)nodeQueues.size() : m_threadCount;
+	int ownPosition = m_bNumaAware ? queueIndex - nodeQueues[0] : queueIndex;
+
+	for (int offset = 1; offset < queueCount; offset++)
+	{
+		int victim = (ownPosition + offset) % queueCount;
+		STaskQueue* pVictim = m_queues[m_bNumaAware ? nodeQueues[victim] : victim];
+		std::lock_guard<std::mutex> queueLock(pVictim->m_mutex);
+
+		if (!pVictim->m_tiles.empty())
+		{
+			tile = pVictim->m_tiles.front();
+			pVictim->m_tiles.pop_front();
+			m_statSteals++;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void WorkStealingPool::RunTiles(int queueIndex)
+{
+	int tile;
+
+	while (TakeTile(queueIndex, tile))
+	{
+		(*m_pTileFunc)(tile);
+		if (--m_tilesRemaining == 0)
+		{
+			std::lock_guard<std::mutex> poolLock(m_poolMutex);
+
+			m_workDoneCondVar.notify_all();
+		}
+	}
+}
+
+void WorkStealingPool::workerThreadFunc(int queueIndex)
+{
+	long long lastGeneration = 0;
+
+	PlaceCurrentThread(queueIndex);
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> poolLock(m_poolMutex);
+
+			m_workReadyCondVar.wait(poolLock, [this, lastGeneration] { return m_bStopRequested || m_generation != lastGeneration; });
+			if (m_bStopRequested)
+			{
+				break;
+			}
+			lastGeneration = m_generation;
+		}
+		RunTiles(queueIndex);
+	}
+}
+
+void WorkStealingPool::ParallelFor(int tileCount, const std::function<void(int)>& tileFunc)
+{
+	if (tileCount <= 0)
+	{
+		return;
+	}
+	if (m_threadCount == 1)
+	{
+		for (int tile = 0; tile < tileCount; tile++)
+		{
+			tileFunc(tile);
+		}
+
+		return;
+	}
+	m_pTileFunc = &tileFunc;
+	m_tilesRemaining = tileCount;
+	for (int tile = 0; tile < tileCount; tile++)
+	{
+		int queue = tile % m_threadCount;
+
+		if (m_bNumaAware)
+		{
+			const std::vector<int>& nodeQueues = m_nodeQueues[(long long)tile * m_nodeCount / tileCount];
+
+			queue = nodeQueues[tile % nodeQueues.size()];
+		}
+
+		STaskQueue* pQueue = m_queues[queue];
+		std::lock_guard<std::mutex> queueLock(pQueue->m_mutex);
+
+		pQueue->m_tiles.push_back(tile);
+	}
+	{
+		std::lock_guard<std::mutex> poolLock(m_poolMutex);
+
+		m_generation++;
+	}
+	m_workReadyCondVar.notify_all();
+	RunTiles(0);
+
+	std::unique_lock<std::mutex> poolLock(m_poolMutex);
+
+	m_workDoneCondVar.wait(poolLock, [this] { return m_tilesRemaining == 0; });
+}
@@ -0,0 +1,104 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// WorkStealingPool runs a loop of independent tiles on native threads (no SYCL runtime needed).  ParallelFor deals
+// the tiles out round robin onto one deque per thread.  Each thread takes tiles from the back of its own deque
+// (most recently dealt, so still warm in cache on a repeat of the same loop) and when that runs dry steals from the
+// front of the other deques, so threads that get cheap tiles (e.g., ones mapping to a small part of the source)
+// help out the ones that got expensive tiles.  The calling thread works as one of the threads so a pool of N
+// threads starts N - 1 workers and a pool of 1 runs serially.
+//
+// A NUMA aware pool spreads its threads over the NUMA nodes (see NumaTopology) and keeps each thread on its node.
+// ParallelFor then deals contiguous blocks of tiles to each node (the first 1 / nodes of the tiles to node 0 and so
+// on) and only steals within a node, so a tile always runs on the same node from frame to frame and the memory it
+// first touched stays local.
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <sched.h>
+#endif
+
+class WorkStealingPool {
+private:
+	struct STaskQueue {
+		std::mutex		m_mutex;
+		std::deque<int>	m_tiles;
+	};
+
+	int m_threadCount;
+	bool m_bPinThreads;
+	bool m_bNumaAware;
+	int m_nodeCount;
+	// m_queueNodes holds the node of each queue's thread and m_nodeQueues the queues of each node
+	std::vector<int> m_queueNodes;
+	std::vector<std::vector<int>> m_nodeQueues;
+	// The calling thread's affinity is put back when the pool is destroyed
+#ifdef _WIN32
+	unsigned long long m_callerAffinity;
+#else
+	cpu_set_t m_callerAffinity;
+#endif
+	std::vector<std::thread*> m_workers;
+	// Queue 0 belongs to the calling thread, queue n to worker n - 1
+	std::vector<STaskQueue*> m_queues;
+	const std::function<void(int)>* m_pTileFunc;
+	// m_generation changes with each ParallelFor so idle workers know there is new work
+	long long m_generation;
+	bool m_bStopRequested;
+	std::atomic<int> m_tilesRemaining;
+	std::atomic<long long> m_statSteals;
+	std::mutex m_poolMutex;
+	std::condition_variable m_workReadyCondVar;
+	std::condition_variable m_workDoneCondVar;
+
+private:
+	// Function to run in each worker thread
+	void workerThreadFunc(int queueIndex);
+	// RunTiles processes tiles (own queue first, then stealing) until none are left to take
+	void RunTiles(int queueIndex);
+	bool TakeTile(int queueIndex, int& tile);
+	// PlaceCurrentThread pins (or with NUMA, keeps on its node) the thread that owns queueIndex
+	void PlaceCurrentThread(int queueIndex);
+	static void PinCurrentThread(int core);
+
+	static thread_local int c_currentNode;
+
+public:
+	// threadCount of 0 uses one thread per hardware thread.  bPinThreads pins thread n to hardware thread n (or with
+	// bNumaAware, to its own hardware thread of its node).
+	WorkStealingPool(int threadCount, bool bPinThreads, bool bNumaAware = false);
+	~WorkStealingPool();
+
+	// ParallelFor calls tileFunc(tile) for every tile from 0 to tileCount - 1 and returns once all have finished
+	void ParallelFor(int tileCount, const std::function<void(int)>& tileFunc);
+
+	int GetThreadCount();
+	// GetNodeCount returns the number of NUMA nodes the threads are spread over (1 unless NUMA aware)
+	int GetNodeCount();
+	// GetCurrentNode returns the NUMA node of the pool thread calling it (0 unless NUMA aware)
+	static int GetCurrentNode();
+	// GetSteals returns the number of tiles run by a thread other than the one they were dealt to
+	long long GetSteals();
+	static int GetHardwareThreads();
+};
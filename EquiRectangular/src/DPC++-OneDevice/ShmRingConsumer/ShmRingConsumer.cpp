@@ -0,0 +1,170 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+// ShmRingConsumer is a sample consumer process for the OneDevice --shmRing output.  It attaches to the shared
+// memory ring, reads each frame in place (no copy), and reports the consumer side throughput and the publish to
+// consume latency.  Run it next to (or several copies next to) OneDevice started with --shmRing=name.
+//
+// Usage: ShmRingConsumer [--ring=name] [--seconds=N] [--show]
+//     --ring=name   name of the ring (same as OneDevice --shmRing).  Defaults to equirect.
+//     --seconds=N   number of seconds to consume before reporting.  Defaults to 10.
+//     --show        show each consumed frame in a window (adds a copy and the highgui time to each frame).
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "opencv2/core/core.hpp"
+#include "opencv2/highgui/highgui.hpp"
+#include "../OneDevice/SharedMemoryRing.hpp"
+
+// Wait this long for the producer to create the ring before giving up
+const int OPEN_TIMEOUT_SECONDS = 30;
+
+static double Percentile(std::vector<double>& sortedValues, double fraction)
+{
+	if (sortedValues.empty())
+	{
+		return 0.0;
+	}
+
+	return sortedValues[(size_t)(fraction * (sortedValues.size() - 1) + 0.5)];
+}
+
+int main(int argc, char** argv)
+{
+	std::string ringName = "equirect";
+	int seconds = 10;
+	bool bShow = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strncmp(argv[i], "--ring=", 7) == 0)
+		{
+			ringName = argv[i] + 7;
+		}
+		else if (strncmp(argv[i], "--seconds=", 10) == 0)
+		{
+			seconds = std::max(1, atoi(argv[i] + 10));
+		}
+		else if (strcmp(argv[i], "--show") == 0)
+		{
+			bShow = true;
+		}
+		else
+		{
+			printf("Usage: %s [--ring=name] [--seconds=N] [--show]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	SharedMemoryRing ring(ringName.c_str());
+	std::chrono::steady_clock::time_point openStartTime = std::chrono::steady_clock::now();
+
+	while (!ring.Open())
+	{
+		if (std::chrono::steady_clock::now() - openStartTime > std::chrono::seconds(OPEN_TIMEOUT_SECONDS))
+		{
+			printf("Error: ring %s was not found\n", ringName.c_str());
+			return 1;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+	printf("Attached to ring %s with %d slots\n", ringName.c_str(), ring.GetSlotCount());
+
+	std::vector<double> publishLatencies;
+	std::vector<double> renderLatencies;
+	long long framesConsumed = 0;
+	long long framesTorn = 0;
+	long long framesMissed = 0;
+	double bytesRead = 0.0;
+	unsigned long long checksum = 0;
+	uint64_t nextIndex = ring.GetPublishedCount();
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point endTime = startTime + std::chrono::seconds(seconds);
+
+	while (std::chrono::steady_clock::now() < endTime)
+	{
+		uint64_t published = ring.GetPublishedCount();
+		SShmFrameView view;
+
+		if (nextIndex >= published)
+		{
+			// Nothing new.  Polling keeps the consumer free of per frame system calls.
+			std::this_thread::yield();
+			continue;
+		}
+		if (published - nextIndex > (uint64_t)ring.GetSlotCount() - 1)
+		{
+			// The producer lapped this consumer so jump to the newest frame
+			framesMissed += published - 1 - nextIndex;
+			nextIndex = published - 1;
+		}
+		if (!ring.ReadFrame(nextIndex, view))
+		{
+			framesTorn++;
+			nextIndex++;
+			continue;
+		}
+
+		int64_t consumeTimeNs = SharedMemoryRing::NowNs();
+		size_t frameBytes = (size_t)view.m_header.m_width * view.m_header.m_height * 3;
+
+		// Touch every byte in place as a stand in for the real analytics
+		for (size_t i = 0; i < frameBytes; i += sizeof(unsigned long long))
+		{
+			unsigned long long value;
+
+			memcpy(&value, view.m_pPixels + i, std::min(sizeof(value), frameBytes - i));
+			checksum += value;
+		}
+		if (bShow)
+		{
+			cv::Mat frame(view.m_header.m_height, view.m_header.m_width, CV_8UC3, (void*)view.m_pPixels);
+
+			cv::imshow("ShmRingConsumer", frame.clone());
+			cv::waitKeyEx(1);
+		}
+		if (ring.IsStillValid(view))
+		{
+			framesConsumed++;
+			bytesRead += frameBytes;
+			publishLatencies.push_back((consumeTimeNs - view.m_header.m_publishTimeNs) / 1000.0);
+			renderLatencies.push_back((consumeTimeNs - view.m_header.m_renderTimeNs) / 1000.0);
+		}
+		else
+		{
+			// The producer started rewriting the slot while it was being read
+			framesTorn++;
+		}
+		nextIndex++;
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+	std::sort(publishLatencies.begin(), publishLatencies.end());
+	std::sort(renderLatencies.begin(), renderLatencies.end());
+	printf("Consumer,%lld,frames,%lld,torn,%lld,missed,%12.3f,FPS,%12.5f,GB/s read in place,checksum,%llx\n",
+		framesConsumed, framesTorn, framesMissed, framesConsumed / elapsed.count(), bytesRead / elapsed.count() / 1.0e9, checksum);
+	printf("Publish to consume latency,%10.1f,us p50,%10.1f,us p99,%10.1f,us max\n",
+		Percentile(publishLatencies, 0.50), Percentile(publishLatencies, 0.99), Percentile(publishLatencies, 1.0));
+	printf("Render to consume latency,%10.1f,us p50,%10.1f,us p99,%10.1f,us max\n",
+		Percentile(renderLatencies, 0.50), Percentile(renderLatencies, 0.99), Percentile(renderLatencies, 1.0));
+
+	return 0;
+}
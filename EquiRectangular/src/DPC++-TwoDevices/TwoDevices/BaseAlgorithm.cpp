@@ -32,6 +32,11 @@ void BaseAlgorithm::FrameCalculations(bool bParametersChanged)
 	m_bFrameCalcRequired = false;
 }
 
+bool BaseAlgorithm::SupportsSplitFrame()
+{
+	return false;
+}
+
 bool BaseAlgorithm::StartVariant()
 {
 	bool bRetVal = true;
@@ -42,6 +42,8 @@ public:
 	virtual cv::Mat GetDebugImage() = 0;
 
 	virtual std::string GetDescription() = 0;
+	// SupportsSplitFrame returns true if the algorithm honors m_firstRow, m_rowCount, and m_pSplitOutput
+	virtual bool SupportsSplitFrame();
 
 	virtual bool StartVariant();
 	virtual void StopVariant() = 0;
@@ -0,0 +1,393 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "DeviceScheduler.hpp"
+#include "ConfigurableDeviceSelector.hpp"
+#include "TimingStats.hpp"
+#include "TraceRecorder.hpp"
+#include <algorithm>
+#include <stdio.h>
+
+DeviceScheduler::DeviceScheduler()
+{
+	m_inFlight = 0;
+	m_bStopRequested = false;
+	m_bCopyFrames = false;
+	ResetStats();
+}
+
+DeviceScheduler::~DeviceScheduler()
+{
+	Stop();
+	for (auto pFrame : m_completed)
+	{
+		delete pFrame;
+	}
+	for (auto pWorker : m_workers)
+	{
+		for (auto pFrame : pWorker->m_queue)
+		{
+			delete pFrame;
+		}
+		delete pWorker;
+	}
+}
+
+std::vector<sycl::device> DeviceScheduler::GetDevices(const std::string& deviceList, SParameters& parameters)
+{
+	std::vector<sycl::device> devices;
+	size_t start = 0;
+
+	while (start <= deviceList.size())
+	{
+		size_t end = deviceList.find(';', start);
+		std::string entry = deviceList.substr(start, (end == std::string::npos) ? std::string::npos : end - start);
+		size_t colon = entry.find(':');
+		std::string type = entry.substr(0, colon);
+		std::string partition = (colon == std::string::npos) ? "" : entry.substr(colon + 1);
+
+		start = (end == std::string::npos) ? deviceList.size() + 1 : end + 1;
+		if (type.empty())
+		{
+			continue;
+		}
+		try
+		{
+			ConfigurableDeviceSelector::set_search(type, parameters.m_platformName, parameters.m_deviceName, parameters.m_driverVersion);
+			sycl::device device(ConfigurableDeviceSelector::device_selector);
+			std::vector<sycl::device> subDevices;
+
+			if (partition == "affinity")
+			{
+				subDevices = device.create_sub_devices<sycl::info::partition_property::partition_by_affinity_domain>(sycl::info::partition_affinity_domain::next_partitionable);
+			}
+			else if (!partition.empty())
+			{
+				int count = atoi(partition.c_str());
+				unsigned int computeUnits = device.get_info<sycl::info::device::max_compute_units>();
+
+				if (count > 1 && (unsigned int)count <= computeUnits)
+				{
+					auto properties = device.get_info<sycl::info::device::partition_properties>();
+					std::string split;
+
+					if (std::find(properties.begin(), properties.end(), sycl::info::partition_property::partition_by_counts) != properties.end())
+					{
+						// Spread the compute units that do not divide evenly over the first sub-devices
+						std::vector<size_t> counts;
+
+						for (int i = 0; i < count; i++)
+						{
+							counts.push_back(computeUnits / count + (((unsigned int)i < computeUnits % count) ? 1 : 0));
+							split += (i == 0 ? "" : "+") + std::to_string(counts.back());
+						}
+						subDevices = device.create_sub_devices<sycl::info::partition_property::partition_by_counts>(counts);
+					}
+					else
+					{
+						// partition_equally makes as many sub-devices as fit, which is more than count when the compute
+						// units do not divide evenly, so only the first count are used
+						subDevices = device.create_sub_devices<sycl::info::partition_property::partition_equally>(computeUnits / count);
+						if (subDevices.size() > (size_t)count)
+						{
+							subDevices.resize(count);
+						}
+						split = std::to_string(subDevices.size()) + "x" + std::to_string(computeUnits / count);
+					}
+					printf("Partitioned %s (%u compute units) into %d sub-devices of %s compute units\n", type.c_str(), computeUnits,
+						(int)subDevices.size(), split.c_str());
+				}
+			}
+			if (subDevices.empty())
+			{
+				if (!partition.empty())
+				{
+					printf("Could not partition %s as %s, using the whole device\n", type.c_str(), partition.c_str());
+				}
+				devices.push_back(device);
+			}
+			else
+			{
+				devices.insert(devices.end(), subDevices.begin(), subDevices.end());
+			}
+		}
+		catch (sycl::exception const& e)
+		{
+			// Either no such device or it cannot be partitioned that way
+			printf("Device entry %s skipped: %s\n", entry.c_str(), e.what());
+		}
+	}
+
+	return devices;
+}
+
+void DeviceScheduler::AddDevice(DpcppBaseAlgorithm* pAlgorithm, SParameters* pParameters, const std::string& name)
+{
+	SDeviceWorker* pWorker = new SDeviceWorker();
+
+	pWorker->m_name = name;
+	pWorker->m_pAlgorithm = pAlgorithm;
+	pWorker->m_pParameters = pParameters;
+	pWorker->m_pThread = NULL;
+	pWorker->m_bBusy = false;
+	pWorker->m_frames = 0;
+	pWorker->m_stolen = 0;
+	pWorker->m_busySeconds = 0.0;
+	m_workers.push_back(pWorker);
+}
+
+int DeviceScheduler::GetDeviceCount()
+{
+	return (int)m_workers.size();
+}
+
+void DeviceScheduler::SetCopyFrames(bool bCopyFrames)
+{
+	m_bCopyFrames = bCopyFrames;
+}
+
+void DeviceScheduler::Start()
+{
+	m_bStopRequested = false;
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i]->m_pThread = new std::thread([this, i] { workerThreadFunc((int)i); });
+	}
+}
+
+void DeviceScheduler::Stop()
+{
+	{
+		std::lock_guard<std::mutex> schedulerLock(m_schedulerMutex);
+
+		m_bStopRequested = true;
+	}
+	m_workQueuedCondVar.notify_all();
+	for (auto pWorker : m_workers)
+	{
+		if (pWorker->m_pThread != NULL)
+		{
+			pWorker->m_pThread->join();
+			delete pWorker->m_pThread;
+			pWorker->m_pThread = NULL;
+		}
+	}
+}
+
+void DeviceScheduler::Submit(const SParameters& parameters, long long frameNumber)
+{
+	SScheduledFrame* pFrame = new SScheduledFrame();
+
+	pFrame->m_frameNumber = frameNumber;
+	pFrame->m_pose = parameters;
+	pFrame->m_deviceIndex = -1;
+	pFrame->m_bStolen = false;
+	{
+		std::lock_guard<std::mutex> schedulerLock(m_schedulerMutex);
+		SDeviceWorker* pLeastLoaded = NULL;
+		size_t leastLoad = 0;
+
+		// Queue on the device with the least work waiting (a frame being rendered counts as one)
+		for (auto pWorker : m_workers)
+		{
+			size_t load = pWorker->m_queue.size() + (pWorker->m_bBusy ? 1 : 0);
+
+			if (pLeastLoaded == NULL || load < leastLoad)
+			{
+				pLeastLoaded = pWorker;
+				leastLoad = load;
+			}
+		}
+		pFrame->m_submitTime = std::chrono::high_resolution_clock::now();
+		pLeastLoaded->m_queue.push_back(pFrame);
+		m_inFlight++;
+	}
+	m_workQueuedCondVar.notify_all();
+}
+
+int DeviceScheduler::GetInFlight()
+{
+	std::lock_guard<std::mutex> schedulerLock(m_schedulerMutex);
+
+	return m_inFlight;
+}
+
+SScheduledFrame* DeviceScheduler::WaitForFrame()
+{
+	std::unique_lock<std::mutex> schedulerLock(m_schedulerMutex);
+	SScheduledFrame* pFrame;
+
+	TraceRecorder::Begin("Wait for Frame", "wait");
+	m_frameDoneCondVar.wait(schedulerLock, [this] { return !m_completed.empty(); });
+	TraceRecorder::End();
+	pFrame = m_completed.front();
+	m_completed.pop_front();
+
+	return pFrame;
+}
+
+SScheduledFrame* DeviceScheduler::TakeFrame(int deviceIndex)
+{
+	SDeviceWorker* pWorker = m_workers[deviceIndex];
+	SDeviceWorker* pVictim = NULL;
+	SScheduledFrame* pFrame = NULL;
+
+	if (!pWorker->m_queue.empty())
+	{
+		pFrame = pWorker->m_queue.front();
+		pWorker->m_queue.pop_front();
+	}
+	else
+	{
+		for (auto pOther : m_workers)
+		{
+			if (!pOther->m_queue.empty() && (pVictim == NULL || pOther->m_queue.size() > pVictim->m_queue.size()))
+			{
+				pVictim = pOther;
+			}
+		}
+		if (pVictim != NULL)
+		{
+			// Take the newest frame so the owner keeps the ones it will get to soonest
+			pFrame = pVictim->m_queue.back();
+			pVictim->m_queue.pop_back();
+			pFrame->m_bStolen = true;
+			pWorker->m_stolen++;
+		}
+	}
+
+	return pFrame;
+}
+
+void DeviceScheduler::workerThreadFunc(int deviceIndex)
+{
+	SDeviceWorker* pWorker = m_workers[deviceIndex];
+	SParameters prevParameters = *(pWorker->m_pParameters);
+	TimingStats* pTimingStats = TimingStats::GetTimingStats();
+	unsigned int uiStatsIndex = pWorker->m_pParameters->m_uiDevIndex;
+
+	TraceRecorder::SetThreadName("Device " + std::to_string(deviceIndex) + " scheduler thread");
+	while (true)
+	{
+		SScheduledFrame* pFrame = NULL;
+
+		TraceRecorder::Begin("Wait for Work", "wait");
+		{
+			std::unique_lock<std::mutex> schedulerLock(m_schedulerMutex);
+
+			m_workQueuedCondVar.wait(schedulerLock, [&] {
+				return m_bStopRequested || (pFrame = TakeFrame(deviceIndex)) != NULL;
+				});
+			if (pFrame == NULL)
+			{
+				TraceRecorder::End();
+				break;
+			}
+			pWorker->m_bBusy = true;
+		}
+		TraceRecorder::End();
+
+		std::chrono::high_resolution_clock::time_point frameStartTime = std::chrono::high_resolution_clock::now();
+		std::chrono::high_resolution_clock::time_point extractionStartTime;
+		std::chrono::high_resolution_clock::time_point frameEndTime;
+
+		try
+		{
+			*(pWorker->m_pParameters) = pFrame->m_pose;
+			TraceRecorder::Begin("FrameCalculations", "host");
+			pWorker->m_pAlgorithm->FrameCalculations(prevParameters != *(pWorker->m_pParameters));
+			TraceRecorder::End();
+			pTimingStats->AddIterationResults(ETimingType::TIMING_FRAME_CALCULATIONS, uiStatsIndex, frameStartTime, std::chrono::high_resolution_clock::now());
+			prevParameters = *(pWorker->m_pParameters);
+			extractionStartTime = std::chrono::high_resolution_clock::now();
+			TraceRecorder::Begin("ExtractFrameImage", "host");
+			pFrame->m_image = pWorker->m_pAlgorithm->ExtractFrameImage();
+			TraceRecorder::End();
+			if (m_bCopyFrames)
+			{
+				TraceRecorder::Begin("Copy Frame", "copy");
+				pFrame->m_image = pFrame->m_image.clone();
+				TraceRecorder::End();
+			}
+			frameEndTime = std::chrono::high_resolution_clock::now();
+			pTimingStats->AddIterationResults(ETimingType::TIMING_IMAGE_EXTRACTION, uiStatsIndex, extractionStartTime, frameEndTime);
+			pTimingStats->AddIterationResults(ETimingType::TIMING_FRAME, uiStatsIndex, frameStartTime, frameEndTime);
+		}
+		catch (sycl::exception const& e) {
+			std::cout << "SYCL exception caught during scheduled frame " << e.what() << std::endl;
+			frameEndTime = std::chrono::high_resolution_clock::now();
+		}
+		catch (std::exception const& e) {
+			std::cout << "Exception caught during scheduled frame." << std::endl;
+			std::cout << e.what() << std::endl;
+			frameEndTime = std::chrono::high_resolution_clock::now();
+		}
+
+		{
+			std::lock_guard<std::mutex> schedulerLock(m_schedulerMutex);
+
+			pWorker->m_bBusy = false;
+			pWorker->m_frames++;
+			pWorker->m_busySeconds += std::chrono::duration<double>(frameEndTime - frameStartTime).count();
+			pFrame->m_deviceIndex = deviceIndex;
+			pFrame->m_completeTime = frameEndTime;
+			m_lastCompleteTime = frameEndTime;
+			m_completed.push_back(pFrame);
+			m_inFlight--;
+		}
+		m_frameDoneCondVar.notify_one();
+	}
+}
+
+void DeviceScheduler::ResetStats()
+{
+	std::lock_guard<std::mutex> schedulerLock(m_schedulerMutex);
+
+	for (auto pWorker : m_workers)
+	{
+		pWorker->m_frames = 0;
+		pWorker->m_stolen = 0;
+		pWorker->m_busySeconds = 0.0;
+	}
+	m_statsStartTime = std::chrono::high_resolution_clock::now();
+	m_lastCompleteTime = m_statsStartTime;
+}
+
+std::string DeviceScheduler::GetStatsString()
+{
+	std::lock_guard<std::mutex> schedulerLock(m_schedulerMutex);
+	std::string retVal = "";
+	char line[1024];
+	long long totalFrames = 0;
+	// Idle time is measured up to the last completed frame so time spent after the run is not counted
+	double elapsed = std::chrono::duration<double>(m_lastCompleteTime - m_statsStartTime).count();
+
+	for (auto pWorker : m_workers)
+	{
+		totalFrames += pWorker->m_frames;
+	}
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		SDeviceWorker* pWorker = m_workers[i];
+		double idle = elapsed - pWorker->m_busySeconds;
+
+		sprintf(line, "%2zu,%s,%5lld,frames,%8.2f,%% of frames,%5lld,stolen,%10.4f,s busy,%10.4f,s idle,%8.2f,%% busy\n",
+			i, pWorker->m_name.c_str(), pWorker->m_frames, (totalFrames > 0) ? pWorker->m_frames * 100.0 / totalFrames : 0.0,
+			pWorker->m_stolen, pWorker->m_busySeconds, (idle > 0.0) ? idle : 0.0, (elapsed > 0.0) ? pWorker->m_busySeconds * 100.0 / elapsed : 0.0);
+		retVal += line;
+	}
+
+	return retVal;
+}
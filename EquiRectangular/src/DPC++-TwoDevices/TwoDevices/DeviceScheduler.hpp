@@ -0,0 +1,112 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// DeviceScheduler generalizes the two device bitmask protocol (CPU_DEVICE_MASK / GPU_DEVICE_MASK) to any number of
+// devices or sub-devices.  Each device has a worker thread running its own algorithm instance and its own queue of
+// frames.  Submit places a frame on the least loaded queue; a worker whose queue is empty steals the newest frame
+// from the longest other queue so a fast device is never left idle behind a slow one.  Frames are a few
+// milliseconds of work each, so a single mutex guards all the queues.
+//
+// The devices are described by a semicolon separated list (see GetDevices), e.g. "CPU;GPU" or "CPU:affinity" to
+// split the CPU into sub-devices by affinity domain, or "CPU:4" to split it into 4 sub-devices (whose compute unit
+// counts differ by at most one when they do not divide evenly).
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sycl/sycl.hpp>
+#include "DpcppBaseAlgorithm.hpp"
+#include "ParseArgs.hpp"
+
+// Frames kept in flight per device so there is queued work to steal
+const int SCHEDULER_FRAMES_PER_DEVICE = 2;
+
+struct SScheduledFrame {
+	long long	m_frameNumber;
+	// m_pose holds the perspective to render (SParameters::operator= copies only the pose and output size)
+	SParameters	m_pose;
+	std::chrono::high_resolution_clock::time_point	m_submitTime;
+	std::chrono::high_resolution_clock::time_point	m_completeTime;
+	// Filled in when the frame is done
+	cv::Mat		m_image;
+	int			m_deviceIndex;
+	bool		m_bStolen;
+};
+
+class DeviceScheduler {
+private:
+	struct SDeviceWorker {
+		std::string				m_name;
+		DpcppBaseAlgorithm*		m_pAlgorithm;
+		// m_pParameters is the structure the algorithm was built with
+		SParameters*			m_pParameters;
+		std::thread*			m_pThread;
+		std::deque<SScheduledFrame*>	m_queue;
+		bool					m_bBusy;
+		// Statistics since ResetStats
+		long long				m_frames;
+		long long				m_stolen;
+		double					m_busySeconds;
+	};
+
+	std::vector<SDeviceWorker*> m_workers;
+	std::mutex m_schedulerMutex;
+	std::condition_variable m_workQueuedCondVar;
+	std::condition_variable m_frameDoneCondVar;
+	std::deque<SScheduledFrame*> m_completed;
+	int m_inFlight;
+	bool m_bStopRequested;
+	bool m_bCopyFrames;
+	std::chrono::high_resolution_clock::time_point m_statsStartTime;
+	std::chrono::high_resolution_clock::time_point m_lastCompleteTime;
+
+private:
+	// Function to run in each device's worker thread
+	void workerThreadFunc(int deviceIndex);
+	// TakeFrame returns the next frame for the worker (its own oldest, otherwise one stolen from the back of the
+	// longest queue) or NULL if there is none.  Call with m_schedulerMutex held.
+	SScheduledFrame* TakeFrame(int deviceIndex);
+
+public:
+	DeviceScheduler();
+	~DeviceScheduler();
+
+	// GetDevices resolves the device list (see the top of this file) into devices and sub-devices
+	static std::vector<sycl::device> GetDevices(const std::string& deviceList, SParameters& parameters);
+
+	// AddDevice adds a device whose algorithm was constructed with pParameters.  Call before Start.
+	void AddDevice(DpcppBaseAlgorithm* pAlgorithm, SParameters* pParameters, const std::string& name);
+	int GetDeviceCount();
+	// SetCopyFrames makes each finished frame a copy so it survives the device rendering its next frame
+	void SetCopyFrames(bool bCopyFrames);
+
+	void Start();
+	void Stop();
+
+	void Submit(const SParameters& parameters, long long frameNumber);
+	int GetInFlight();
+	// WaitForFrame blocks until a frame finishes and returns it.  The caller deletes it.
+	SScheduledFrame* WaitForFrame();
+
+	void ResetStats();
+	// GetStatsString reports each device's frames, share of the frames, steals, and busy / idle time
+	std::string GetStatsString();
+};
@@ -16,6 +16,7 @@
 #include "DpcppBaseAlgorithm.hpp"
 #include "ConfigurableDeviceSelector.hpp"
 #include "TimingStats.hpp"
+#include "TraceRecorder.hpp"
 
 #ifdef VTUNE_API
 // Assuming you have 2023 of VTune installed, you will need to add
@@ -32,6 +33,13 @@ DpcppBaseAlgorithm::DpcppBaseAlgorithm(SParameters& parameters) : BaseAlgorithm(
     m_pQ = NULL;
     m_bInitRequired = true;
     m_bThreadStopRequested = false;
+    m_bFixedDevice = false;
+}
+
+void DpcppBaseAlgorithm::SetDevice(const sycl::device& device)
+{
+    m_fixedDevice = device;
+    m_bFixedDevice = true;
 }
 
 DpcppBaseAlgorithm::~DpcppBaseAlgorithm()
@@ -64,8 +72,15 @@ sycl::queue* DpcppBaseAlgorithm::GetDeviceQ()
             delete m_pQ;
             m_pQ = NULL;
         }
-        ConfigurableDeviceSelector::set_search(m_typePreference, m_platformName, m_deviceName, m_driverVersion);
-        m_pQ = new sycl::queue(ConfigurableDeviceSelector::device_selector, ehandler);
+        if (m_bFixedDevice)
+        {
+            m_pQ = new sycl::queue(m_fixedDevice, ehandler);
+        }
+        else
+        {
+            ConfigurableDeviceSelector::set_search(m_typePreference, m_platformName, m_deviceName, m_driverVersion);
+            m_pQ = new sycl::queue(ConfigurableDeviceSelector::device_selector, ehandler);
+        }
 #define SHOW_RESULTS
 #ifdef SHOW_RESULTS
         if (m_pQ)
@@ -147,7 +162,7 @@ bool DpcppBaseAlgorithm::StartVariant()
         // First time, so we need to figure out if this is a one-shot run (i.e.,
         // neither the m_platformName nor m_deviceName == all or if we will be looping
         // due to either being all.
-        if (m_pParameters->m_platformName == "all" || m_pParameters->m_deviceName == "all")
+        if (!m_bFixedDevice && (m_pParameters->m_platformName == "all" || m_pParameters->m_deviceName == "all"))
         {
             m_platforms = sycl::platform::get_platforms();
             m_curPlatform = m_platforms.begin();
@@ -322,11 +337,13 @@ unsigned int DpcppBaseAlgorithm::threadFunc()
         __itt_thread_set_name(pThreadName);
     }
 #endif
+    TraceRecorder::SetThreadName("Device " + std::to_string(m_pParameters->m_uiDevIndex) + " orchestrator thread");
 
     while (!m_bThreadStopRequested)
     {
         // We will await a command from the commanding layer that we should do
         // our work
+        TraceRecorder::Begin("Wait for Work", "wait");
         {
             std::unique_lock<std::mutex> requestWorkLock(*(m_pParameters->m_pRequestWorkMutex));
             m_pParameters->m_pRequestWorkCondVar->wait(requestWorkLock, [this] {return (*(m_pParameters->m_pRequestWork) & m_pParameters->m_uiMyMask) == m_pParameters->m_uiMyMask; });
@@ -334,6 +351,7 @@ unsigned int DpcppBaseAlgorithm::threadFunc()
             // the request, and release the lock in case other layers need to see it too
             *(m_pParameters->m_pRequestWork) &= ~m_pParameters->m_uiMyMask;
         }
+        TraceRecorder::End();
 
         if (!m_bThreadStopRequested)
         {
@@ -342,14 +360,19 @@ unsigned int DpcppBaseAlgorithm::threadFunc()
             frameStartTime = std::chrono::high_resolution_clock::now();
             try
             {
+                TraceRecorder::Begin("FrameCalculations", "host");
                 FrameCalculations(bParametersChanged);
+                TraceRecorder::End();
                 pTimingStats->AddIterationResults(ETimingType::TIMING_FRAME_CALCULATIONS, m_pParameters->m_uiDevIndex, frameStartTime, std::chrono::high_resolution_clock::now());
                 prevParameters = *m_pParameters;
                 extractionStartTime = std::chrono::high_resolution_clock::now();
+                TraceRecorder::Begin("ExtractFrameImage", "host");
                 m_pParameters->m_FlatImg = ExtractFrameImage();
+                TraceRecorder::End();
                 frameEndTime = std::chrono::high_resolution_clock::now();
                 pTimingStats->AddIterationResults(ETimingType::TIMING_IMAGE_EXTRACTION, m_pParameters->m_uiDevIndex, extractionStartTime, frameEndTime);
                 pTimingStats->AddIterationResults(ETimingType::TIMING_FRAME, m_pParameters->m_uiDevIndex, frameStartTime, frameEndTime);
+                m_pParameters->m_frameSeconds = std::chrono::duration<double>(frameEndTime - frameStartTime).count();
             }
             catch (cl::sycl::exception const& e) {
                 std::cout << "SYCL exception caught during main loop " << e.what() << std::endl;
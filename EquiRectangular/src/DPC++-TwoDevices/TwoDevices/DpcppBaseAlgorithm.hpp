@@ -37,6 +37,10 @@ private:
 	std::string m_platformName;
 	std::string m_deviceName;
 	std::string m_driverVersion;
+	// m_bFixedDevice means the queue is created on m_fixedDevice (which may be a sub-device) rather than by
+	// searching with the selector
+	bool m_bFixedDevice;
+	sycl::device m_fixedDevice;
 
 private:
 	// Class function that will start a thread for a given instance
@@ -59,6 +63,8 @@ public:
 	DpcppBaseAlgorithm(SParameters& parameters);
 	virtual ~DpcppBaseAlgorithm();
 	std::string GetDeviceDescription();
+	// SetDevice makes the algorithm run on the given device (call before the first StartVariant)
+	void SetDevice(const sycl::device& device);
 
 	virtual cv::Mat GetDebugImage();
 
@@ -20,6 +20,7 @@
 #include "DpcppRemapping.hpp"
 #include "ConfigurableDeviceSelector.hpp"
 #include "TimingStats.hpp"
+#include "TraceRecorder.hpp"
 #include <opencv2/calib3d.hpp>
 
 #ifdef VTUNE_API
@@ -59,6 +60,7 @@ void DpcppRemapping::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemapping_calc_kernel);
 #endif
+		TraceRecorder::Begin("DpcppRemappingV1 Calc Kernel", "kernel");
 		BaseAlgorithm::FrameCalculations(bParametersChanged);
 
 		std::chrono::high_resolution_clock::time_point startTime;
@@ -78,6 +80,7 @@ void DpcppRemapping::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 		__itt_task_end(pittTests_domain);
 #endif
+		TraceRecorder::End();
 	}
 }
 
@@ -86,6 +89,7 @@ cv::Mat DpcppRemapping::ExtractFrameImage()
 #ifdef VTUNE_API
 	__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemapping_extract_kernel);
 #endif
+	TraceRecorder::Begin("DpcppRemappingV1 Extract Kernel", "kernel");
 	std::chrono::high_resolution_clock::time_point startTime	= std::chrono::high_resolution_clock::now();
 	cv::Mat retVal;
 
@@ -105,6 +109,7 @@ cv::Mat DpcppRemapping::ExtractFrameImage()
 #ifdef VTUNE_API
 	__itt_task_end(pittTests_domain);
 #endif
+	TraceRecorder::End();
 
 	return retVal;
 }
@@ -21,6 +21,7 @@
 #include "DpcppRemappingV10.hpp"
 #include "ConfigurableDeviceSelector.hpp"
 #include "TimingStats.hpp"
+#include "TraceRecorder.hpp"
 #include <opencv2/calib3d.hpp>
 
 #ifdef VTUNE_API
@@ -63,6 +64,7 @@ void DpcppRemappingV10::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV10_calc_kernel);
 #endif
+		TraceRecorder::Begin("DpcppRemappingV10 Calc Kernel", "kernel");
 
 		BaseAlgorithm::FrameCalculations(bParametersChanged);
 
@@ -196,6 +198,7 @@ void DpcppRemappingV10::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 		__itt_task_end(pittTests_domain);
 #endif
+		TraceRecorder::End();
 
 	}
 
@@ -206,6 +209,7 @@ cv::Mat DpcppRemappingV10::ExtractFrameImage()
 #ifdef VTUNE_API
 	__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV10_extract_kernel);
 #endif
+	TraceRecorder::Begin("DpcppRemappingV2 Extract Kernel", "kernel");
 
 	std::chrono::high_resolution_clock::time_point startTime	= std::chrono::high_resolution_clock::now();
 	cv::Mat retVal;
@@ -234,6 +238,7 @@ cv::Mat DpcppRemappingV10::ExtractFrameImage()
 #ifdef VTUNE_API
 	__itt_task_end(pittTests_domain);
 #endif
+	TraceRecorder::End();
 
 	return retVal;
 }
@@ -18,6 +18,7 @@
 #include "DpcppRemappingV13.hpp"
 #include "ConfigurableDeviceSelector.hpp"
 #include "TimingStats.hpp"
+#include "TraceRecorder.hpp"
 #include <opencv2/calib3d.hpp>
 
 #ifdef VTUNE_API
@@ -57,6 +58,12 @@ std::string DpcppRemappingV13::GetDescription()
 	return "Unknown";
 }
 
+bool DpcppRemappingV13::SupportsSplitFrame()
+{
+	// The map and the extraction only cover the band of rows given by m_firstRow and m_rowCount
+	return true;
+}
+
 void DpcppRemappingV13::FrameCalculations(bool bParametersChanged)
 {
 	if (bParametersChanged || m_bFrameCalcRequired)
@@ -71,7 +78,9 @@ void DpcppRemappingV13::FrameCalculations(bool bParametersChanged)
 		float invf;
 		float translatecx;
 		float translatecy;
-		int height = m_pParameters->m_heightOutput;
+		// Only the rows of this device's band are mapped (the whole frame unless splitting frames)
+		int firstRow = m_pParameters->m_firstRow;
+		int height = (m_pParameters->m_rowCount > 0) ? m_pParameters->m_rowCount : m_pParameters->m_heightOutput;
 		int width = m_pParameters->m_widthOutput;
 		Point2D* pPoints = m_pXYPoints;
 		Point2D* pDevPoints = m_pDevXYPoints;
@@ -112,12 +121,13 @@ void DpcppRemappingV13::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 			__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV13_calc_kernel);
 #endif
+			TraceRecorder::Begin("DpcppRemappingV13 Calc Kernel", "kernel");
 			m_pQ->submit([&](sycl::handler& cgh) {
 				cgh.parallel_for(sycl::range<2>(height, width),
 				[=](sycl::id<2> item) {
 					Point2D *pElement = &pPoints[item[0] * width + item[1]];
 					float x = item[1] * invf + translatecx;
-					float y = item[0] * invf + translatecy;
+					float y = (item[0] + firstRow) * invf + translatecy;
 					float z = 1.0f;
 					float norm;
 
@@ -143,6 +153,7 @@ void DpcppRemappingV13::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 			__itt_task_end(pittTests_domain);
 #endif
+			TraceRecorder::End();
 
 			break;
 		}
@@ -153,7 +164,7 @@ void DpcppRemappingV13::FrameCalculations(bool bParametersChanged)
 				[=](sycl::id<2> item) {
 					Point2D *pElement = &pDevPoints[item[0] * width + item[1]];
 					float x = item[1] * invf + translatecx;
-					float y = item[0] * invf + translatecy;
+					float y = (item[0] + firstRow) * invf + translatecy;
 					float z = 1.0f;
 					float norm;
 
@@ -194,7 +205,7 @@ cv::Mat DpcppRemappingV13::ExtractFrameImage()
 	{
 	case STORAGE_TYPE_USM:
 	{
-		int height = m_pParameters->m_heightOutput;
+		int height = (m_pParameters->m_rowCount > 0) ? m_pParameters->m_rowCount : m_pParameters->m_heightOutput;
 		int width = m_pParameters->m_widthOutput;
 		int imageHeight = m_pParameters->m_image[m_pParameters->m_imageIndex].rows;
 		int imageWidth = m_pParameters->m_image[m_pParameters->m_imageIndex].cols;
@@ -206,6 +217,7 @@ cv::Mat DpcppRemappingV13::ExtractFrameImage()
 #ifdef VTUNE_API
 			__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV13_copy_image);
 #endif
+			TraceRecorder::Begin("DpcppRemappingV13 Copy Image to USM", "copy");
 			// TODO: This assumes that both images are the exact same size.  Perhaps should put an
 			// ASSERT here to check that assumption
 			memcpy(m_pFullImage, m_pParameters->m_image[m_pParameters->m_imageIndex].data, imageHeight * imageWidth * sizeof(unsigned char) * pixelBytes);
@@ -213,6 +225,7 @@ cv::Mat DpcppRemappingV13::ExtractFrameImage()
 #ifdef VTUNE_API
 			__itt_task_end(pittTests_domain);
 #endif
+			TraceRecorder::End();
 		}
 
 		unsigned char *pFullImage = m_pFullImage;
@@ -220,6 +233,7 @@ cv::Mat DpcppRemappingV13::ExtractFrameImage()
 #ifdef VTUNE_API
 		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV13_extract_kernel);
 #endif
+		TraceRecorder::Begin("DpcppRemappingV13 Extract Kernel", "kernel");
 		m_pQ->submit([&](sycl::handler &cgh) {
 			cgh.parallel_for(sycl::range<2>(height, width),
 			[=](sycl::id<2> item) {
@@ -241,17 +255,29 @@ cv::Mat DpcppRemappingV13::ExtractFrameImage()
 			});
 		}).wait();
 
-		retVal = cv::Mat(m_pParameters->m_heightOutput, m_pParameters->m_widthOutput, CV_8UC3, m_pFlatImage);
+		if (m_pParameters->m_pSplitOutput != NULL)
+		{
+			// Place this device's band in the frame shared with the other device
+			unsigned char* pBand = m_pParameters->m_pSplitOutput + (size_t)m_pParameters->m_firstRow * width * pixelBytes;
+
+			memcpy(pBand, m_pFlatImage, (size_t)height * width * pixelBytes);
+			retVal = cv::Mat(height, width, CV_8UC3, pBand);
+		}
+		else
+		{
+			retVal = cv::Mat(height, width, CV_8UC3, m_pFlatImage);
+		}
 		TimingStats::GetTimingStats()->AddIterationResults(ETimingType::TIMING_REMAP, m_pParameters->m_uiDevIndex, startTime, std::chrono::high_resolution_clock::now());
 #ifdef VTUNE_API
 		__itt_task_end(pittTests_domain);
 #endif
+		TraceRecorder::End();
 
 		break;
 	}
 	case STORAGE_TYPE_DEVICE:
 	{
-		int height = m_pParameters->m_heightOutput;
+		int height = (m_pParameters->m_rowCount > 0) ? m_pParameters->m_rowCount : m_pParameters->m_heightOutput;
 		int width = m_pParameters->m_widthOutput;
 		int imageHeight = m_pParameters->m_image[m_pParameters->m_imageIndex].rows;
 		int imageWidth = m_pParameters->m_image[m_pParameters->m_imageIndex].cols;
@@ -264,6 +290,7 @@ cv::Mat DpcppRemappingV13::ExtractFrameImage()
 #ifdef VTUNE_API
 			__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV13_copy_image);
 #endif
+			TraceRecorder::Begin("DpcppRemappingV13 Copy Image to USM", "copy");
 			// TODO: This assumes that both images are the exact same size.  Perhaps should put an
 			// ASSERT here to check that assumption
 			m_pQ->memcpy(m_pDevFullImage, m_pParameters->m_image[m_pParameters->m_imageIndex].data, imageHeight * imageWidth * sizeof(unsigned char) * pixelBytes);
@@ -272,11 +299,13 @@ cv::Mat DpcppRemappingV13::ExtractFrameImage()
 #ifdef VTUNE_API
 			__itt_task_end(pittTests_domain);
 #endif
+			TraceRecorder::End();
 		}
 
 #ifdef VTUNE_API
 		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV13_extract_kernel);
 #endif
+		TraceRecorder::Begin("DpcppRemappingV13 Extract Kernel", "kernel");
 		m_pQ->submit([&](sycl::handler &cgh) {
 			cgh.parallel_for(sycl::range<2>(height, width),
 			[=](sycl::id<2> item) {
@@ -297,13 +326,22 @@ cv::Mat DpcppRemappingV13::ExtractFrameImage()
 				}
 			});
 		}).wait();
-		retVal = cv::Mat(m_pParameters->m_heightOutput, m_pParameters->m_widthOutput, CV_8UC3);
-		m_pQ->memcpy(retVal.data, m_pDevFlatImage, m_pParameters->m_heightOutput * m_pParameters->m_widthOutput * sizeof(unsigned char) * pixelBytes);
+		if (m_pParameters->m_pSplitOutput != NULL)
+		{
+			// Read the band straight back into its rows of the frame shared with the other device
+			retVal = cv::Mat(height, width, CV_8UC3, m_pParameters->m_pSplitOutput + (size_t)m_pParameters->m_firstRow * width * pixelBytes);
+		}
+		else
+		{
+			retVal = cv::Mat(height, width, CV_8UC3);
+		}
+		m_pQ->memcpy(retVal.data, m_pDevFlatImage, height * width * sizeof(unsigned char) * pixelBytes);
 		m_pQ->wait();
 		TimingStats::GetTimingStats()->AddIterationResults(ETimingType::TIMING_REMAP, m_pParameters->m_uiDevIndex, startTime, std::chrono::high_resolution_clock::now());
 #ifdef VTUNE_API
 		__itt_task_end(pittTests_domain);
 #endif
+		TraceRecorder::End();
 		break;
 	}
 	}
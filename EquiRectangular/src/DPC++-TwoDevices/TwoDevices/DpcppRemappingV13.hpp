@@ -53,6 +53,7 @@ public:
 	virtual cv::Mat ExtractFrameImage();
 
 	virtual std::string GetDescription();
+	virtual bool SupportsSplitFrame();
 
 	virtual bool StartVariant();
 	virtual void StopVariant();
@@ -18,6 +18,7 @@
 #include "DpcppRemappingV14.hpp"
 #include "ConfigurableDeviceSelector.hpp"
 #include "TimingStats.hpp"
+#include "TraceRecorder.hpp"
 #include <opencv2/calib3d.hpp>
 
 #ifdef VTUNE_API
@@ -112,6 +113,7 @@ void DpcppRemappingV14::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 			__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV14_calc_kernel);
 #endif
+			TraceRecorder::Begin("DpcppRemappingV14 Calc Kernel", "kernel");
 
 			m_pQ->submit([&](sycl::handler& cgh) {
 				cgh.parallel_for(sycl::range<2>(height, width),
@@ -145,6 +147,7 @@ void DpcppRemappingV14::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 			__itt_task_end(pittTests_domain);
 #endif
+			TraceRecorder::End();
 
 			break;
 		}
@@ -216,12 +219,14 @@ cv::Mat DpcppRemappingV14::ExtractFrameImage()
 #ifdef VTUNE_API
 				__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV14_copy_image);
 #endif				// TODO: This assumes that both images are the exact same size.  Perhaps should put an
+				TraceRecorder::Begin("DpcppRemappingV14 Copy Image to USM", "copy");
 				// ASSERT here to check that assumption
 				memcpy(m_pFullImage, m_pParameters->m_image[m_pParameters->m_imageIndex].data, imageHeight * imageWidth * sizeof(unsigned char) * pixelBytes);
 				m_currentIndex = m_pParameters->m_imageIndex;
 #ifdef VTUNE_API
 				__itt_task_end(pittTests_domain);
 #endif
+				TraceRecorder::End();
 			}
 
 			pFullImage = m_pFullImage;
@@ -230,6 +235,7 @@ cv::Mat DpcppRemappingV14::ExtractFrameImage()
 #ifdef VTUNE_API
 		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV14_extract_kernel);
 #endif
+		TraceRecorder::Begin("DpcppRemappingV14 Extract Kernel", "kernel");
 		m_pQ->submit([&](sycl::handler &cgh) {
 			//sycl::stream out(65535, 256, cgh);
 
@@ -259,6 +265,7 @@ cv::Mat DpcppRemappingV14::ExtractFrameImage()
 #ifdef VTUNE_API
 		__itt_task_end(pittTests_domain);
 #endif
+		TraceRecorder::End();
 
 		break;
 	}
@@ -284,6 +291,7 @@ cv::Mat DpcppRemappingV14::ExtractFrameImage()
 #ifdef VTUNE_API
 				__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV14_copy_image);
 #endif				// TODO: This assumes that both images are the exact same size.  Perhaps should put an
+				TraceRecorder::Begin("DpcppRemappingV14 Copy Image to USM", "copy");
 				// TODO: This assumes that both images are the exact same size.  Perhaps should put an
 				// ASSERT here to check that assumption
 				m_pQ->memcpy(m_pDevFullImage, m_pParameters->m_image[m_pParameters->m_imageIndex].data, imageHeight * imageWidth * sizeof(unsigned char) * pixelBytes);
@@ -292,6 +300,7 @@ cv::Mat DpcppRemappingV14::ExtractFrameImage()
 #ifdef VTUNE_API
 				__itt_task_end(pittTests_domain);
 #endif
+				TraceRecorder::End();
 			}
 
 			pDevFullImage = m_pDevFullImage;
@@ -300,6 +309,7 @@ cv::Mat DpcppRemappingV14::ExtractFrameImage()
 #ifdef VTUNE_API
 		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV14_extract_kernel);
 #endif
+		TraceRecorder::Begin("DpcppRemappingV14 Extract Kernel", "kernel");
 		m_pQ->submit([&](sycl::handler &cgh) {
 			cgh.parallel_for(sycl::range<2>(height, width),
 			[=](sycl::id<2> item) {
@@ -327,6 +337,7 @@ cv::Mat DpcppRemappingV14::ExtractFrameImage()
 #ifdef VTUNE_API
 		__itt_task_end(pittTests_domain);
 #endif
+		TraceRecorder::End();
 		break;
 	}
 	}
@@ -18,6 +18,7 @@
 #include "DpcppRemappingV15.hpp"
 #include "ConfigurableDeviceSelector.hpp"
 #include "TimingStats.hpp"
+#include "TraceRecorder.hpp"
 #include <opencv2/calib3d.hpp>
 
 #ifdef VTUNE_API
@@ -112,6 +113,7 @@ void DpcppRemappingV15::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 			__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV15_calc_kernel);
 #endif
+			TraceRecorder::Begin("DpcppRemappingV15 Calc Kernel", "kernel");
 
 			m_pQ->submit([&](sycl::handler& cgh) {
 				cgh.parallel_for(sycl::range<2>(height, width),
@@ -145,6 +147,7 @@ void DpcppRemappingV15::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 			__itt_task_end(pittTests_domain);
 #endif
+			TraceRecorder::End();
 
 			break;
 		}
@@ -210,6 +213,7 @@ cv::Mat DpcppRemappingV15::ExtractFrameImage()
 #ifdef VTUNE_API
 			__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV15_copy_image);
 #endif
+			TraceRecorder::Begin("DpcppRemappingV15 Copy Image to USM", "copy");
 			// TODO: This assumes that both images are the exact same size.  Perhaps should put an
 			// ASSERT here to check that assumption
 			memcpy(m_pFullImage, m_pParameters->m_image[m_pParameters->m_imageIndex].data, imageHeight * imageWidth * sizeof(unsigned char) * pixelBytes);
@@ -217,6 +221,7 @@ cv::Mat DpcppRemappingV15::ExtractFrameImage()
 #ifdef VTUNE_API
 			__itt_task_end(pittTests_domain);
 #endif
+			TraceRecorder::End();
 		}
 
 		pFullImage = m_pFullImage;
@@ -224,6 +229,7 @@ cv::Mat DpcppRemappingV15::ExtractFrameImage()
 #ifdef VTUNE_API
 		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV15_extract_kernel);
 #endif
+		TraceRecorder::Begin("DpcppRemappingV15 Extract Kernel", "kernel");
 		m_pQ->submit([&](sycl::handler &cgh) {
 			//sycl::stream out(65535, 256, cgh);
 
@@ -253,6 +259,7 @@ cv::Mat DpcppRemappingV15::ExtractFrameImage()
 #ifdef VTUNE_API
 		__itt_task_end(pittTests_domain);
 #endif
+		TraceRecorder::End();
 
 		break;
 	}
@@ -272,6 +279,7 @@ cv::Mat DpcppRemappingV15::ExtractFrameImage()
 #ifdef VTUNE_API
 			__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV15_copy_image);
 #endif
+			TraceRecorder::Begin("DpcppRemappingV15 Copy Image to USM", "copy");
 			// TODO: This assumes that both images are the exact same size.  Perhaps should put an
 				// ASSERT here to check that assumption
 				m_pQ->memcpy(m_pDevFullImage, m_pParameters->m_image[m_pParameters->m_imageIndex].data, imageHeight * imageWidth * sizeof(unsigned char) * pixelBytes);
@@ -280,6 +288,7 @@ cv::Mat DpcppRemappingV15::ExtractFrameImage()
 #ifdef VTUNE_API
 				__itt_task_end(pittTests_domain);
 #endif
+				TraceRecorder::End();
 		}
 
 		pDevFullImage = m_pDevFullImage;
@@ -287,6 +296,7 @@ cv::Mat DpcppRemappingV15::ExtractFrameImage()
 #ifdef VTUNE_API
 		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV15_extract_kernel);
 #endif
+		TraceRecorder::Begin("DpcppRemappingV15 Extract Kernel", "kernel");
 
 		m_pQ->submit([&](sycl::handler &cgh) {
 			cgh.parallel_for(sycl::range<2>(height, width),
@@ -315,6 +325,7 @@ cv::Mat DpcppRemappingV15::ExtractFrameImage()
 #ifdef VTUNE_API
 		__itt_task_end(pittTests_domain);
 #endif
+		TraceRecorder::End();
 		break;
 	}
 	}
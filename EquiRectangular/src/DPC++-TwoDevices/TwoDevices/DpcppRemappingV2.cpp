@@ -19,6 +19,7 @@
 #include "DpcppRemappingV2.hpp"
 #include "ConfigurableDeviceSelector.hpp"
 #include "TimingStats.hpp"
+#include "TraceRecorder.hpp"
 #include <opencv2/calib3d.hpp>
 
 #ifdef VTUNE_API
@@ -61,6 +62,7 @@ void DpcppRemappingV2::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV2_calc_kernel);
 #endif
+		TraceRecorder::Begin("DpcppRemappingV2 Calc Kernel", "kernel");
 		BaseAlgorithm::FrameCalculations(bParametersChanged);
 
 		ComputeRotationMatrix((float)m_pParameters->m_yaw * DEGREE_CONVERSION_FACTOR, (float)m_pParameters->m_pitch * DEGREE_CONVERSION_FACTOR, (float)m_pParameters->m_roll * DEGREE_CONVERSION_FACTOR);
@@ -185,6 +187,7 @@ void DpcppRemappingV2::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 		__itt_task_end(pittTests_domain);
 #endif
+		TraceRecorder::End();
 	}
 
 }
@@ -194,6 +197,7 @@ cv::Mat DpcppRemappingV2::ExtractFrameImage()
 #ifdef VTUNE_API
 	__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV2_extract_kernel);
 #endif
+	TraceRecorder::Begin("DpcppRemappingV2 Extract Kernel", "kernel");
 	std::chrono::high_resolution_clock::time_point startTime	= std::chrono::high_resolution_clock::now();
 	cv::Mat retVal;
 
@@ -221,6 +225,7 @@ cv::Mat DpcppRemappingV2::ExtractFrameImage()
 #ifdef VTUNE_API
 	__itt_task_end(pittTests_domain);
 #endif
+	TraceRecorder::End();
 
 	return retVal;
 }
@@ -21,6 +21,7 @@
 #include "DpcppRemappingV3.hpp"
 #include "ConfigurableDeviceSelector.hpp"
 #include "TimingStats.hpp"
+#include "TraceRecorder.hpp"
 #include <opencv2/calib3d.hpp>
 
 #ifdef VTUNE_API
@@ -63,6 +64,7 @@ void DpcppRemappingV3::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV3_calc_kernel);
 #endif
+		TraceRecorder::Begin("DpcppRemappingV3 Calc Kernel", "kernel");
 
 		BaseAlgorithm::FrameCalculations(bParametersChanged);
 
@@ -196,6 +198,7 @@ void DpcppRemappingV3::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 		__itt_task_end(pittTests_domain);
 #endif
+		TraceRecorder::End();
 
 	}
 
@@ -206,6 +209,7 @@ cv::Mat DpcppRemappingV3::ExtractFrameImage()
 #ifdef VTUNE_API
 	__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV3_extract_kernel);
 #endif
+	TraceRecorder::Begin("DpcppRemappingV2 Extract Kernel", "kernel");
 
 	std::chrono::high_resolution_clock::time_point startTime	= std::chrono::high_resolution_clock::now();
 	cv::Mat retVal;
@@ -234,6 +238,7 @@ cv::Mat DpcppRemappingV3::ExtractFrameImage()
 #ifdef VTUNE_API
 	__itt_task_end(pittTests_domain);
 #endif
+	TraceRecorder::End();
 
 	return retVal;
 }
@@ -21,6 +21,7 @@
 #include "DpcppRemappingV4.hpp"
 #include "ConfigurableDeviceSelector.hpp"
 #include "TimingStats.hpp"
+#include "TraceRecorder.hpp"
 #include <opencv2/calib3d.hpp>
 
 #ifdef VTUNE_API
@@ -63,6 +64,7 @@ void DpcppRemappingV4::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV4_calc_kernel);
 #endif
+		TraceRecorder::Begin("DpcppRemappingV4 Calc Kernel", "kernel");
 
 		BaseAlgorithm::FrameCalculations(bParametersChanged);
 
@@ -211,6 +213,7 @@ void DpcppRemappingV4::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 		__itt_task_end(pittTests_domain);
 #endif
+		TraceRecorder::End();
 
 	}
 
@@ -221,6 +224,7 @@ cv::Mat DpcppRemappingV4::ExtractFrameImage()
 #ifdef VTUNE_API
 	__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV4_extract_kernel);
 #endif
+	TraceRecorder::Begin("DpcppRemappingV4 Extract Kernel", "kernel");
 
 	std::chrono::high_resolution_clock::time_point startTime	= std::chrono::high_resolution_clock::now();
 	cv::Mat retVal;
@@ -249,6 +253,7 @@ cv::Mat DpcppRemappingV4::ExtractFrameImage()
 #ifdef VTUNE_API
 	__itt_task_end(pittTests_domain);
 #endif
+	TraceRecorder::End();
 
 	return retVal;
 }
@@ -18,6 +18,7 @@
 #include "DpcppRemappingV5.hpp"
 #include "ConfigurableDeviceSelector.hpp"
 #include "TimingStats.hpp"
+#include "TraceRecorder.hpp"
 #include <opencv2/calib3d.hpp>
 
 #ifdef VTUNE_API
@@ -112,6 +113,7 @@ void DpcppRemappingV5::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 			__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV5_calc_kernel);
 #endif
+			TraceRecorder::Begin("DpcppRemappingV5 Calc Kernel", "kernel");
 			m_pQ->submit([&](sycl::handler& cgh) {
 				cgh.parallel_for(sycl::range<2>(height, width),
 				[=](sycl::id<2> item) {
@@ -143,6 +145,7 @@ void DpcppRemappingV5::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 			__itt_task_end(pittTests_domain);
 #endif
+			TraceRecorder::End();
 
 			break;
 		}
@@ -206,6 +209,7 @@ cv::Mat DpcppRemappingV5::ExtractFrameImage()
 #ifdef VTUNE_API
 			__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV5_copy_image);
 #endif
+			TraceRecorder::Begin("DpcppRemappingV5 Copy Image to USM", "copy");
 			// TODO: This assumes that both images are the exact same size.  Perhaps should put an
 			// ASSERT here to check that assumption
 			memcpy(m_pFullImage, m_pParameters->m_image[m_pParameters->m_imageIndex].data, imageHeight * imageWidth * sizeof(unsigned char) * pixelBytes);
@@ -213,6 +217,7 @@ cv::Mat DpcppRemappingV5::ExtractFrameImage()
 #ifdef VTUNE_API
 			__itt_task_end(pittTests_domain);
 #endif
+			TraceRecorder::End();
 		}
 
 		unsigned char *pFullImage = m_pFullImage;
@@ -220,6 +225,7 @@ cv::Mat DpcppRemappingV5::ExtractFrameImage()
 #ifdef VTUNE_API
 		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV5_extract_kernel);
 #endif
+		TraceRecorder::Begin("DpcppRemappingV5 Extract Kernel", "kernel");
 		m_pQ->submit([&](sycl::handler &cgh) {
 			cgh.parallel_for(sycl::range<2>(height, width),
 			[=](sycl::id<2> item) {
@@ -255,6 +261,7 @@ cv::Mat DpcppRemappingV5::ExtractFrameImage()
 #ifdef VTUNE_API
 		__itt_task_end(pittTests_domain);
 #endif
+		TraceRecorder::End();
 
 		break;
 	}
@@ -273,6 +280,7 @@ cv::Mat DpcppRemappingV5::ExtractFrameImage()
 #ifdef VTUNE_API
 			__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV5_copy_image);
 #endif
+			TraceRecorder::Begin("DpcppRemappingV5 Copy Image to USM", "copy");
 			// TODO: This assumes that both images are the exact same size.  Perhaps should put an
 			// ASSERT here to check that assumption
 			m_pQ->memcpy(m_pDevFullImage, m_pParameters->m_image[m_pParameters->m_imageIndex].data, imageHeight * imageWidth * sizeof(unsigned char) * pixelBytes);
@@ -281,11 +289,13 @@ cv::Mat DpcppRemappingV5::ExtractFrameImage()
 #ifdef VTUNE_API
 			__itt_task_end(pittTests_domain);
 #endif
+			TraceRecorder::End();
 		}
 
 #ifdef VTUNE_API
 		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV5_extract_kernel);
 #endif
+		TraceRecorder::Begin("DpcppRemappingV5 Extract Kernel", "kernel");
 		m_pQ->submit([&](sycl::handler &cgh) {
 			cgh.parallel_for(sycl::range<2>(height, width),
 			[=](sycl::id<2> item) {
@@ -323,6 +333,7 @@ cv::Mat DpcppRemappingV5::ExtractFrameImage()
 #ifdef VTUNE_API
 		__itt_task_end(pittTests_domain);
 #endif
+		TraceRecorder::End();
 		break;
 	}
 	}
@@ -18,6 +18,7 @@
 #include "DpcppRemappingV7.hpp"
 #include "ConfigurableDeviceSelector.hpp"
 #include "TimingStats.hpp"
+#include "TraceRecorder.hpp"
 #include <opencv2/calib3d.hpp>
 
 #ifdef VTUNE_API
@@ -112,6 +113,7 @@ void DpcppRemappingV7::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 			__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV7_calc_kernel);
 #endif
+			TraceRecorder::Begin("DpcppRemappingV7 Calc Kernel", "kernel");
 
 			m_pQ->submit([&](sycl::handler& cgh) {
 				cgh.parallel_for(sycl::range<2>(height, width),
@@ -145,6 +147,7 @@ void DpcppRemappingV7::FrameCalculations(bool bParametersChanged)
 #ifdef VTUNE_API
 			__itt_task_end(pittTests_domain);
 #endif
+			TraceRecorder::End();
 
 			break;
 		}
@@ -216,6 +219,7 @@ cv::Mat DpcppRemappingV7::ExtractFrameImage()
 #ifdef VTUNE_API
 				__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV7_copy_image);
 #endif
+				TraceRecorder::Begin("DpcppRemappingV7 Copy Image to USM", "copy");
 				// TODO: This assumes that both images are the exact same size.  Perhaps should put an
 				// ASSERT here to check that assumption
 				memcpy(m_pFullImage, m_pParameters->m_image[m_pParameters->m_imageIndex].data, imageHeight * imageWidth * sizeof(unsigned char) * pixelBytes);
@@ -223,6 +227,7 @@ cv::Mat DpcppRemappingV7::ExtractFrameImage()
 #ifdef VTUNE_API
 				__itt_task_end(pittTests_domain);
 #endif
+				TraceRecorder::End();
 			}
 
 			pFullImage = m_pFullImage;
@@ -231,6 +236,7 @@ cv::Mat DpcppRemappingV7::ExtractFrameImage()
 #ifdef VTUNE_API
 		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV7_extract_kernel);
 #endif
+		TraceRecorder::Begin("DpcppRemappingV7 Extract Kernel", "kernel");
 		m_pQ->submit([&](sycl::handler &cgh) {
 			//sycl::stream out(65535, 256, cgh);
 
@@ -260,6 +266,7 @@ cv::Mat DpcppRemappingV7::ExtractFrameImage()
 #ifdef VTUNE_API
 		__itt_task_end(pittTests_domain);
 #endif
+		TraceRecorder::End();
 
 		break;
 	}
@@ -285,6 +292,7 @@ cv::Mat DpcppRemappingV7::ExtractFrameImage()
 #ifdef VTUNE_API
 				__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV7_copy_image);
 #endif
+				TraceRecorder::Begin("DpcppRemappingV7 Copy Image to USM", "copy");
 				// TODO: This assumes that both images are the exact same size.  Perhaps should put an
 				// ASSERT here to check that assumption
 				m_pQ->memcpy(m_pDevFullImage, m_pParameters->m_image[m_pParameters->m_imageIndex].data, imageHeight * imageWidth * sizeof(unsigned char) * pixelBytes);
@@ -293,6 +301,7 @@ cv::Mat DpcppRemappingV7::ExtractFrameImage()
 #ifdef VTUNE_API
 				__itt_task_end(pittTests_domain);
 #endif
+				TraceRecorder::End();
 			}
 
 			pDevFullImage = m_pDevFullImage;
@@ -301,6 +310,7 @@ cv::Mat DpcppRemappingV7::ExtractFrameImage()
 #ifdef VTUNE_API
 		__itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_DpcppRemappingV7_extract_kernel);
 #endif
+		TraceRecorder::Begin("DpcppRemappingV7 Extract Kernel", "kernel");
 		m_pQ->submit([&](sycl::handler &cgh) {
 			cgh.parallel_for(sycl::range<2>(height, width),
 			[=](sycl::id<2> item) {
@@ -328,6 +338,7 @@ cv::Mat DpcppRemappingV7::ExtractFrameImage()
 #ifdef VTUNE_API
 		__itt_task_end(pittTests_domain);
 #endif
+		TraceRecorder::End();
 		break;
 	}
 	}
@@ -0,0 +1,184 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "LatencyHistogram.hpp"
+#include <algorithm>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram()
+{
+	Reset();
+}
+
+void LatencyHistogram::Reset()
+{
+	for (int i = 0; i < LATENCY_BUCKET_COUNT; i++)
+	{
+		m_buckets[i] = 0;
+	}
+	m_count = 0;
+	m_min = 0.0;
+	m_max = 0.0;
+	m_mean = 0.0;
+	m_m2 = 0.0;
+}
+
+int LatencyHistogram::GetBucketIndex(uint64_t nanoseconds)
+{
+	if (nanoseconds < (uint64_t)LATENCY_SUB_BUCKETS)
+	{
+		return (int)nanoseconds;
+	}
+	if (nanoseconds >= ((uint64_t)1 << LATENCY_MAX_BITS))
+	{
+		return LATENCY_BUCKET_COUNT - 1;
+	}
+
+	int highestBit = LATENCY_SUB_BUCKET_BITS;
+	while ((nanoseconds >> (highestBit + 1)) != 0)
+	{
+		highestBit++;
+	}
+	// The top LATENCY_SUB_BUCKET_BITS + 1 bits pick the bucket; the leading bit is always set
+	int shift = highestBit - LATENCY_SUB_BUCKET_BITS;
+
+	return (shift + 1) * LATENCY_SUB_BUCKETS + (int)((nanoseconds >> shift) - LATENCY_SUB_BUCKETS);
+}
+
+double LatencyHistogram::GetBucketMiddle(int bucketIndex)
+{
+	if (bucketIndex < LATENCY_SUB_BUCKETS)
+	{
+		return bucketIndex * 1.0e-9;
+	}
+
+	int shift = bucketIndex / LATENCY_SUB_BUCKETS - 1;
+	double low = (double)((uint64_t)(LATENCY_SUB_BUCKETS + bucketIndex % LATENCY_SUB_BUCKETS) << shift);
+	double width = (double)((uint64_t)1 << shift);
+
+	return (low + width / 2.0) * 1.0e-9;
+}
+
+void LatencyHistogram::Record(std::chrono::duration<double> duration)
+{
+	double seconds = duration.count();
+
+	if (seconds < 0.0)
+	{
+		seconds = 0.0;
+	}
+	m_buckets[GetBucketIndex((uint64_t)(seconds * 1.0e9))]++;
+	if (m_count == 0 || seconds < m_min)
+	{
+		m_min = seconds;
+	}
+	if (m_count == 0 || seconds > m_max)
+	{
+		m_max = seconds;
+	}
+	m_count++;
+
+	double delta = seconds - m_mean;
+	m_mean += delta / m_count;
+	m_m2 += delta * (seconds - m_mean);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other)
+{
+	if (other.m_count == 0)
+	{
+		return;
+	}
+	if (m_count == 0)
+	{
+		*this = other;
+		return;
+	}
+
+	for (int i = 0; i < LATENCY_BUCKET_COUNT; i++)
+	{
+		m_buckets[i] += other.m_buckets[i];
+	}
+	m_min = std::min(m_min, other.m_min);
+	m_max = std::max(m_max, other.m_max);
+
+	// Combine the two Welford partial results (Chan et al.)
+	double total = (double)(m_count + other.m_count);
+	double delta = other.m_mean - m_mean;
+	m_mean += delta * other.m_count / total;
+	m_m2 += other.m_m2 + delta * delta * m_count * other.m_count / total;
+	m_count += other.m_count;
+}
+
+uint64_t LatencyHistogram::GetCount() const
+{
+	return m_count;
+}
+
+double LatencyHistogram::GetMin() const
+{
+	return m_min;
+}
+
+double LatencyHistogram::GetMax() const
+{
+	return m_max;
+}
+
+double LatencyHistogram::GetMean() const
+{
+	return m_mean;
+}
+
+double LatencyHistogram::GetStdDev() const
+{
+	if (m_count < 2)
+	{
+		return 0.0;
+	}
+
+	return sqrt(m_m2 / (m_count - 1));
+}
+
+double LatencyHistogram::GetPercentile(double percentile) const
+{
+	if (m_count == 0)
+	{
+		return 0.0;
+	}
+	if (percentile >= 100.0)
+	{
+		return m_max;
+	}
+
+	uint64_t rank = (uint64_t)ceil(percentile / 100.0 * m_count);
+	uint64_t seen = 0;
+
+	if (rank < 1)
+	{
+		rank = 1;
+	}
+	for (int i = 0; i < LATENCY_BUCKET_COUNT; i++)
+	{
+		seen += m_buckets[i];
+		if (seen >= rank)
+		{
+			// The bucket middle can fall outside the exact extremes when only a few samples are in the end buckets
+			return std::min(std::max(GetBucketMiddle(i), m_min), m_max);
+		}
+	}
+
+	return m_max;
+}
@@ -0,0 +1,67 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// LatencyHistogram records durations in logarithmic buckets (in the style of an HDR histogram) so tail latency
+// percentiles can be reported without keeping every sample.  Durations are recorded in nanoseconds.  Values
+// below LATENCY_SUB_BUCKETS nanoseconds get a bucket of their own; above that each power of two range is split
+// into LATENCY_SUB_BUCKETS equal buckets, so a reported percentile is within 1 / LATENCY_SUB_BUCKETS (about 3%)
+// of the recorded value.  The mean and standard deviation are kept exactly with Welford's method in double.
+//
+// LatencyHistogram does no locking; the owner must serialize calls for a given histogram.
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+const int LATENCY_SUB_BUCKET_BITS = 5;
+const int LATENCY_SUB_BUCKETS = 1 << LATENCY_SUB_BUCKET_BITS;
+// Durations of 2^LATENCY_MAX_BITS nanoseconds (about 18 minutes) or more all land in the last bucket
+const int LATENCY_MAX_BITS = 40;
+const int LATENCY_BUCKET_COUNT = (LATENCY_MAX_BITS - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKETS;
+
+class LatencyHistogram {
+private:
+	uint64_t m_buckets[LATENCY_BUCKET_COUNT];
+	uint64_t m_count;
+	// m_min and m_max are the exact extremes in seconds
+	double m_min;
+	double m_max;
+	// m_mean and m_m2 are the running mean and sum of squared differences from the mean (Welford)
+	double m_mean;
+	double m_m2;
+
+private:
+	static int GetBucketIndex(uint64_t nanoseconds);
+	// GetBucketMiddle returns the middle of the bucket in seconds
+	static double GetBucketMiddle(int bucketIndex);
+
+public:
+	LatencyHistogram();
+
+	void Reset();
+	void Record(std::chrono::duration<double> duration);
+	// Merge adds the samples of other into this histogram
+	void Merge(const LatencyHistogram& other);
+
+	uint64_t GetCount() const;
+	double GetMin() const;
+	double GetMax() const;
+	double GetMean() const;
+	double GetStdDev() const;
+	// GetPercentile returns the duration in seconds at or below which percentile (0-100) of the samples fall
+	double GetPercentile(double percentile) const;
+};
@@ -41,7 +41,13 @@
 #include "DpcppRemappingV15.hpp"
 #include "OptimizingEquirectangularConversion.h"
 #include "TimingStats.hpp"
+#include "TraceRecorder.hpp"
 #include "ConfigurableDeviceSelector.hpp"
+#include "DeviceScheduler.hpp"
+#include "SplitFrameBalancer.hpp"
+#include "ReorderBuffer.hpp"
+#include "ResultsWriter.hpp"
+#include "SourceFrame.hpp"
 
 using namespace cl::sycl;
 
@@ -111,6 +117,258 @@ void UpdateParameters(SParameters &parameters)
     }
 }
 
+// CreateAlgorithm returns a new instance of the given algorithm number or NULL if there is no such algorithm
+DpcppBaseAlgorithm* CreateAlgorithm(int algorithm, SParameters& parameters)
+{
+    switch (algorithm)
+    {
+    case 5:
+        return new DpcppRemapping(parameters);
+        break;
+    case 6:
+        return new DpcppRemappingV2(parameters);
+        break;
+    case 7:
+        return new DpcppRemappingV3(parameters);
+        break;
+    case 8:
+        return new DpcppRemappingV4(parameters);
+        break;
+    case 9:
+        return new DpcppRemappingV5(parameters);
+        break;
+    case 10:
+        return new DpcppRemappingV6(parameters);
+        break;
+    case 11:
+        return new DpcppRemappingV7(parameters);
+        break;
+    case 12:
+        return new DpcppRemappingV8(parameters);
+        break;
+    case 13:
+        return new DpcppRemappingV9(parameters);
+        break;
+    case 14:
+        return new DpcppRemappingV10(parameters);
+        break;
+    case 15:
+        return new DpcppRemappingV11(parameters);
+        break;
+    case 16:
+        return new DpcppRemappingV12(parameters);
+        break;
+    case 17:
+        return new DpcppRemappingV13(parameters);
+        break;
+    case 18:
+        return new DpcppRemappingV14(parameters);
+        break;
+    case 19:
+        return new DpcppRemappingV15(parameters);
+        break;
+    }
+
+    return NULL;
+}
+
+// PresentFrames shows the frames the ReorderBuffer releases (frames without an image are only counted)
+void PresentFrames(ReorderBuffer& reorderBuffer, const char* pWindowText, bool bFlush = false)
+{
+    std::vector<SPresentedFrame> frames;
+
+    reorderBuffer.GetReadyFrames(frames, bFlush);
+    for (auto& frame : frames)
+    {
+        if (!frame.m_image.empty())
+        {
+            cv::imshow(pWindowText, frame.m_image);
+            // Waiting for a key for 1 millisecond gives OpenCV a hint that it should show the frame
+            cv::waitKeyEx(1);
+        }
+    }
+}
+
+// AddRunRecord saves the settings and frame statistics of the variant that just finished to the results file (if any)
+void AddRunRecord(ResultsWriter* pResultsWriter, SParameters& parameters, const cv::Mat& source, int algorithm, const std::string& description, const char* pMode, int origYaw, int origPitch, int origRoll)
+{
+    TimingStats* pTimingStats = TimingStats::GetTimingStats();
+
+    if (pResultsWriter == NULL)
+    {
+        return;
+    }
+    pResultsWriter->BeginRecord();
+    pResultsWriter->AddField("algorithm", algorithm);
+    pResultsWriter->AddField("description", description);
+    pResultsWriter->AddField("mode", pMode);
+    pResultsWriter->AddField("devices", parameters.m_devices.empty() ? std::string("CPU;GPU") : parameters.m_devices);
+    pResultsWriter->AddField("reorder", ReorderBuffer::GetPolicyName((EReorderPolicy)parameters.m_reorderPolicy));
+    pResultsWriter->AddField("sourceWidth", source.cols);
+    pResultsWriter->AddField("sourceHeight", source.rows);
+    pResultsWriter->AddField("outputWidth", parameters.m_widthOutput);
+    pResultsWriter->AddField("outputHeight", parameters.m_heightOutput);
+    pResultsWriter->AddField("fov", parameters.m_fov);
+    pResultsWriter->AddField("yaw", origYaw);
+    pResultsWriter->AddField("pitch", origPitch);
+    pResultsWriter->AddField("roll", origRoll);
+    pResultsWriter->AddField("deltaYaw", parameters.m_deltaYaw);
+    pResultsWriter->AddField("deltaPitch", parameters.m_deltaPitch);
+    pResultsWriter->AddField("deltaRoll", parameters.m_deltaRoll);
+    pResultsWriter->AddField("deltaImage", parameters.m_deltaImage ? 1 : 0);
+    pResultsWriter->AddField("iterations", parameters.m_iterations);
+    pResultsWriter->AddSystemFields();
+    // Every mode records the dispatch to completion time of each frame under GENERAL_STATS
+    pResultsWriter->AddFrameFields(pTimingStats->GetHistogram(ETimingType::TIMING_FRAME_LATENCY, GENERAL_STATS),
+        pTimingStats->GetWarmupDuration(ETimingType::TIMING_FRAME_LATENCY, GENERAL_STATS), pTimingStats->GetWarmupIterations(ETimingType::TIMING_FRAME_LATENCY, GENERAL_STATS));
+    // Several frames are in flight at once so the frame rate comes from the whole run rather than the frame times
+    pResultsWriter->AddField("fps", pTimingStats->GetFramesPerSecond());
+    pResultsWriter->EndRecord();
+}
+
+// RunScheduledDevices runs the algorithms from startAlgorithm to endAlgorithm on every device of
+// parameters.m_devices through the DeviceScheduler (instead of the CPU / GPU bitmask protocol) and adds a summary
+// for each variant to summaryStats (and pResultsWriter if it is not NULL)
+void RunScheduledDevices(SParameters& parameters, int startAlgorithm, int endAlgorithm, std::vector<std::string>& summaryStats, ResultsWriter* pResultsWriter)
+{
+    TimingStats* pTimingStats = TimingStats::GetTimingStats();
+    std::vector<sycl::device> devices = DeviceScheduler::GetDevices(parameters.m_devices, parameters);
+    int origYaw = parameters.m_yaw;
+    int origPitch = parameters.m_pitch;
+    int origRoll = parameters.m_roll;
+
+    if (devices.empty())
+    {
+        printf("Error: No devices found for --devices=%s\n", parameters.m_devices.c_str());
+        return;
+    }
+    printf("Scheduling frames across %zu device(s)\n", devices.size());
+    // Every device compiles its kernels on its first frame
+    pTimingStats->SetFrameCounting(ETimingType::TIMING_FRAME_LATENCY, (int)devices.size());
+    ReorderBuffer reorderBuffer((EReorderPolicy)parameters.m_reorderPolicy, parameters.m_reorderLatencyMs);
+
+    for (int algorithm = startAlgorithm; algorithm <= endAlgorithm; algorithm++)
+    {
+        std::chrono::high_resolution_clock::time_point initStartTime = std::chrono::high_resolution_clock::now();
+        std::vector<SParameters*> devParameters;
+        std::vector<DpcppBaseAlgorithm*> devAlgorithms;
+        DeviceScheduler scheduler;
+        bool bVariantValid = true;
+
+        for (size_t i = 0; i < devices.size() && bVariantValid; i++)
+        {
+            SParameters* pDevParameters = new SParameters();
+            DpcppBaseAlgorithm* pAlg;
+
+            *pDevParameters = parameters;
+            pDevParameters->m_image[0] = parameters.m_image[0];
+            pDevParameters->m_image[1] = parameters.m_image[1];
+            // The timing statistics keep one row per device type
+            pDevParameters->m_uiDevIndex = devices[i].is_cpu() ? 0 : 1;
+            devParameters.push_back(pDevParameters);
+            pAlg = CreateAlgorithm(algorithm, *pDevParameters);
+            if (pAlg == NULL)
+            {
+                bVariantValid = false;
+            }
+            else
+            {
+                pAlg->SetDevice(devices[i]);
+                devAlgorithms.push_back(pAlg);
+                scheduler.AddDevice(pAlg, pDevParameters, ConfigurableDeviceSelector::get_device_description(devices[i]));
+            }
+        }
+        scheduler.SetCopyFrames(parameters.m_bShowFrames);
+        if (bVariantValid)
+        {
+            std::chrono::high_resolution_clock::time_point initEndTime = std::chrono::high_resolution_clock::now();
+
+            scheduler.Start();
+            while (bVariantValid)
+            {
+                std::chrono::high_resolution_clock::time_point variantInitStartTime = std::chrono::high_resolution_clock::now();
+                std::string description = "";
+
+                for (auto pAlg : devAlgorithms)
+                {
+                    bVariantValid = (bVariantValid && pAlg->StartVariant());
+                    description += pAlg->GetDescription();
+                    description += " ";
+                }
+                if (bVariantValid)
+                {
+                    int maxInFlight = scheduler.GetDeviceCount() * SCHEDULER_FRAMES_PER_DEVICE;
+                    long long submitted = 0;
+                    long long finished = 0;
+                    char windowText[1024];
+                    std::chrono::high_resolution_clock::time_point totalTimeStart;
+                    std::chrono::high_resolution_clock::time_point variantInitStopTime;
+
+                    parameters.m_yaw = origYaw;
+                    parameters.m_pitch = origPitch;
+                    parameters.m_roll = origRoll;
+                    parameters.m_imageIndex = 0;
+
+                    pTimingStats->Reset();
+                    pTimingStats->ResetLap();
+                    pTimingStats->AddIterationResults(ETimingType::TIMING_INITIALIZATION, GENERAL_STATS, initStartTime, initEndTime);
+                    pTimingStats->AddIterationResults(ETimingType::VARIANT_INITIALIZATION, GENERAL_STATS, variantInitStartTime, std::chrono::high_resolution_clock::now());
+                    scheduler.ResetStats();
+                    reorderBuffer.Reset();
+                    sprintf(windowText, "Algorithm %d Flat View %s", algorithm, description.c_str());
+                    totalTimeStart = std::chrono::high_resolution_clock::now();
+                    while (finished < parameters.m_iterations)
+                    {
+                        SScheduledFrame* pFrame;
+
+                        // Keep enough frames queued that an idle device always has one to take or steal
+                        TraceRecorder::Begin("Dispatch Work", "host");
+                        while (submitted < parameters.m_iterations && scheduler.GetInFlight() < maxInFlight)
+                        {
+                            NormalizeParameters(parameters);
+                            scheduler.Submit(parameters, submitted);
+                            UpdateParameters(parameters);
+                            submitted++;
+                        }
+                        TraceRecorder::End();
+                        pFrame = scheduler.WaitForFrame();
+                        pTimingStats->AddIterationResults(ETimingType::TIMING_FRAME_LATENCY, GENERAL_STATS, pFrame->m_submitTime, pFrame->m_completeTime);
+                        reorderBuffer.AddFrame(pFrame->m_frameNumber, pFrame->m_image, pFrame->m_completeTime);
+                        PresentFrames(reorderBuffer, windowText);
+                        delete pFrame;
+                        finished++;
+                    }
+                    PresentFrames(reorderBuffer, windowText, true);
+                    pTimingStats->AddIterationResults(ETimingType::TIMING_TOTAL, GENERAL_STATS, totalTimeStart, std::chrono::high_resolution_clock::now());
+
+                    printf("Algorithm description: %s\n", description.c_str());
+                    pTimingStats->ReportTimes(true);
+                    printf("%s", scheduler.GetStatsString().c_str());
+                    printf("%s", reorderBuffer.GetStatsString().c_str());
+
+                    variantInitStopTime = std::chrono::high_resolution_clock::now();
+                    for (auto pAlg : devAlgorithms)
+                    {
+                        pAlg->StopVariant();
+                    }
+                    pTimingStats->AddIterationResults(ETimingType::VARIANT_TERMINATION, 0, variantInitStopTime, std::chrono::high_resolution_clock::now());
+                    summaryStats.push_back(description + "\n" + pTimingStats->SummaryStats(true) + scheduler.GetStatsString() + reorderBuffer.GetStatsString());
+                    AddRunRecord(pResultsWriter, parameters, parameters.m_image[0], algorithm, description, "scheduler", origYaw, origPitch, origRoll);
+                }
+            }
+            scheduler.Stop();
+        }
+        for (auto pAlg : devAlgorithms)
+        {
+            delete pAlg;
+        }
+        for (auto pDevParameters : devParameters)
+        {
+            delete pDevParameters;
+        }
+    }
+}
+
 int main(int argc, char** argv) {
     try {
         SParameters parameters;
@@ -142,12 +400,24 @@ int main(int argc, char** argv) {
             PrintUsage(argv[0], errorMessage);
             exit(1);
         }
+        TimingStats::SetWarmupIterations(parameters.m_warmupIterations);
+        if (parameters.m_compareBaseline[0] != '\0')
+        {
+            int regressions = ResultsWriter::Compare(parameters.m_compareBaseline, parameters.m_compareCandidate, parameters.m_regressionThreshold);
+
+            exit((regressions < 0) ? 1 : (regressions > 0) ? 2 : 0);
+        }
 
 #ifdef VTUNE_API
         wchar_t const* pThreadName = _T("Main thread");
 
         __itt_thread_set_name(pThreadName);
 #endif
+        if (parameters.m_tracePath[0] != '\0')
+        {
+            TraceRecorder::Enable();
+            TraceRecorder::SetThreadName("Main thread");
+        }
 
         std::string description;
         std::chrono::high_resolution_clock::time_point initStartTime;
@@ -172,6 +442,20 @@ int main(int argc, char** argv) {
         int origYaw = parameters.m_yaw;
         int origPitch = parameters.m_pitch;
         int origRoll = parameters.m_roll;
+        // dispatchTime holds when each device was handed its current frame (to measure the frame latency)
+        std::chrono::high_resolution_clock::time_point dispatchTime[MAX_DEVICES];
+        // frameNumbers holds the frame each device is working on so the finished frames can be presented in order
+        long long frameNumbers[MAX_DEVICES];
+        ReorderBuffer reorderBuffer((EReorderPolicy)parameters.m_reorderPolicy, parameters.m_reorderLatencyMs);
+        // In split frame mode the devices write their bands of rows into splitImg
+        SplitFrameBalancer splitBalancer;
+        cv::Mat splitImg;
+        ResultsWriter* pResultsWriter = NULL;
+
+        if (parameters.m_resultsPath[0] != '\0')
+        {
+            pResultsWriter = new ResultsWriter(parameters.m_resultsPath, argc, argv);
+        }
 
         pDevAlg[0] = NULL;
         pDevAlg[1] = NULL;
@@ -235,26 +519,34 @@ int main(int argc, char** argv) {
         {
             parameters.m_heightOutput = ((parameters.m_heightOutput / 8) + 1) * 8;
         }
+        // Each source image is decoded once and the devices share the pixels (see SourceFrame)
+        std::shared_ptr<const SourceFrame> pSourceFrame[2];
+        size_t residentBytesBefore = SourceFrame::GetResidentBytes();
+        std::chrono::high_resolution_clock::time_point loadStartTime = std::chrono::high_resolution_clock::now();
+
+        // read src image0
+        printf("Loading Image0\n");
+        pSourceFrame[0] = SourceFrame::Load(parameters.m_imgFilename[0]);
+        if (!pSourceFrame[0])
+        {
+            printf("Error: Could not load image 0 from %s\n", parameters.m_imgFilename[0]);
+            throw std::invalid_argument("Error: Could not load image 0.");
+        }
+        // read src image1
+        printf("Loading Image1\n");
+        pSourceFrame[1] = SourceFrame::Load(parameters.m_imgFilename[1]);
+        if (!pSourceFrame[1])
+        {
+            printf("Error: Could not load image 1 from %s\n", parameters.m_imgFilename[1]);
+            throw std::invalid_argument("Error: Could not load image 1.");
+        }
         for (unsigned int i = 0; i < MAX_DEVICES; i++)
         {
-            // read src image0
-            printf("Loading Image0\n");
-            devParameters[i].m_image[0] = cv::imread(parameters.m_imgFilename[0], cv::IMREAD_COLOR);
-            if (devParameters[i].m_image[0].empty())
-            {
-                printf("Error: Could not load image 0 from %s\n", parameters.m_imgFilename[0]);
-                throw std::invalid_argument("Error: Could not load image 0.");
-            }
-            // read src image1
-            printf("Loading Image1\n");
-            devParameters[i].m_image[1] = cv::imread(parameters.m_imgFilename[1], cv::IMREAD_COLOR);
-            if (devParameters[i].m_image[1].empty())
-            {
-                printf("Error: Could not load image 1 from %s\n", parameters.m_imgFilename[1]);
-                throw std::invalid_argument("Error: Could not load image 1.");
-            }
+            devParameters[i].m_image[0] = pSourceFrame[0]->GetImage();
+            devParameters[i].m_image[1] = pSourceFrame[1]->GetImage();
         }
         printf("Images loaded.\n");
+        printf("%s", SourceFrame::GetStatsString(MAX_DEVICES, std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - loadStartTime).count(), residentBytesBefore).c_str());
         int algorithm = startAlgorithm;
         unsigned int uiDevIndex = 0;
 
@@ -280,104 +572,37 @@ int main(int argc, char** argv) {
         //devParameters[1].m_platformName = "OpenCL";
         // Specifically select the Level-Zero driver for the GPU versus OpenCL
         devParameters[1].m_platformName = "Level-Zero";
+        if (!parameters.m_devices.empty())
+        {
+            // The scheduler runs every algorithm itself, so the two device loop below is skipped
+            parameters.m_image[0] = devParameters[0].m_image[0];
+            parameters.m_image[1] = devParameters[0].m_image[1];
+            RunScheduledDevices(parameters, startAlgorithm, endAlgorithm, summaryStats, pResultsWriter);
+            algorithm = endAlgorithm + 1;
+        }
+        if (parameters.m_bSplitFrame)
+        {
+            // Every frame involves all the devices, so the first frame is the only warmup frame
+            pTimingStats->SetFrameCounting(ETimingType::TIMING_FRAME_LATENCY, 1);
+        }
 
         while (algorithm <= endAlgorithm)
         {
             initStartTime = std::chrono::high_resolution_clock::now();
-            switch (algorithm)
+            for (unsigned int i = 0; i < MAX_DEVICES; i++)
             {
-            case 5:
-                for (unsigned int i = 0; i < MAX_DEVICES; i++)
-                {
-                    pDevAlg[i] = new DpcppRemapping(devParameters[i]);
-                }
-                break;
-            case 6:
-                for (unsigned int i = 0; i < MAX_DEVICES; i++)
-                {
-                    pDevAlg[i] = new DpcppRemappingV2(devParameters[i]);
-                }
-                break;
-            case 7:
-                for (unsigned int i = 0; i < MAX_DEVICES; i++)
-                {
-                    pDevAlg[i] = new DpcppRemappingV3(devParameters[i]);
-                }
-                break;
-            case 8:
-                for (unsigned int i = 0; i < MAX_DEVICES; i++)
-                {
-                    pDevAlg[i] = new DpcppRemappingV4(devParameters[i]);
-                }
-                break;
-            case 9:
-                for (unsigned int i = 0; i < MAX_DEVICES; i++)
-                {
-                    pDevAlg[i] = new DpcppRemappingV5(devParameters[i]);
-                }
-                break;
-            case 10:
-                for (unsigned int i = 0; i < MAX_DEVICES; i++)
-                {
-                    pDevAlg[i] = new DpcppRemappingV6(devParameters[i]);
-                }
-                break;
-            case 11:
-                for (unsigned int i = 0; i < MAX_DEVICES; i++)
-                {
-                    pDevAlg[i] = new DpcppRemappingV7(devParameters[i]);
-                }
-                break;
-            case 12:
-                for (unsigned int i = 0; i < MAX_DEVICES; i++)
-                {
-                    pDevAlg[i] = new DpcppRemappingV8(devParameters[i]);
-                }
-                break;
-            case 13:
-                for (unsigned int i = 0; i < MAX_DEVICES; i++)
-                {
-                    pDevAlg[i] = new DpcppRemappingV9(devParameters[i]);
-                }
-                break;
-            case 14:
-                for (unsigned int i = 0; i < MAX_DEVICES; i++)
-                {
-                    pDevAlg[i] = new DpcppRemappingV10(devParameters[i]);
-                }
-                break;
-            case 15:
-                for (unsigned int i = 0; i < MAX_DEVICES; i++)
-                {
-                    pDevAlg[i] = new DpcppRemappingV11(devParameters[i]);
-                }
-                break;
-            case 16:
-                for (unsigned int i = 0; i < MAX_DEVICES; i++)
-                {
-                    pDevAlg[i] = new DpcppRemappingV12(devParameters[i]);
-                }
-                break;
-            case 17:
-                for (unsigned int i = 0; i < MAX_DEVICES; i++)
-                {
-                    pDevAlg[i] = new DpcppRemappingV13(devParameters[i]);
-                }
-                break;
-            case 18:
-                for (unsigned int i = 0; i < MAX_DEVICES; i++)
-                {
-                    pDevAlg[i] = new DpcppRemappingV14(devParameters[i]);
-                }
-                break;
-            case 19:
+                pDevAlg[i] = CreateAlgorithm(algorithm, devParameters[i]);
+            }
+
+            if (parameters.m_bSplitFrame && pDevAlg[0] != NULL && !pDevAlg[0]->SupportsSplitFrame())
+            {
+                printf("Algorithm %d does not support --splitFrame, skipping it\n", algorithm);
                 for (unsigned int i = 0; i < MAX_DEVICES; i++)
                 {
-                    pDevAlg[i] = new DpcppRemappingV15(devParameters[i]);
+                    delete pDevAlg[i];
+                    pDevAlg[i] = NULL;
                 }
-                break;
             }
-
             if (pDevAlg[0] != NULL && pDevAlg[1] != NULL)
             {
                 for (unsigned int i = 0; i < MAX_DEVICES; i++)
@@ -408,10 +633,20 @@ int main(int argc, char** argv) {
                         parameters.m_imageIndex = 0;
                         iteration = 0;
                         finishedIterations = 0;
+                        reorderBuffer.Reset();
 
                         pTimingStats->Reset();
                         pTimingStats->AddIterationResults(ETimingType::TIMING_INITIALIZATION, GENERAL_STATS, initStartTime, initEndTime);
                         pTimingStats->AddIterationResults(ETimingType::VARIANT_INITIALIZATION, GENERAL_STATS, variantInitStartTime, std::chrono::high_resolution_clock::now());
+                        if (parameters.m_bSplitFrame)
+                        {
+                            splitBalancer.Reset(parameters.m_heightOutput);
+                            splitImg = cv::Mat(parameters.m_heightOutput, parameters.m_widthOutput, CV_8UC3);
+                            for (unsigned int i = 0; i < MAX_DEVICES; i++)
+                            {
+                                devParameters[i].m_pSplitOutput = splitImg.data;
+                            }
+                        }
                         bRunningVariant = true;
                         totalTimeStart = std::chrono::high_resolution_clock::now();
                         while (bRunningVariant)
@@ -427,110 +662,191 @@ int main(int argc, char** argv) {
                             {
                                 if (bDoIterations)
                                 {
-                                    // Normally it is not required to wait for all the devices to warm up before starting the real work, but in this
-                                    // case, we are trying to compare the running speed of different algorithms so we want to make sure we know
-                                    // the actual warm up times to get all devices up and going and then the run time after everything is warmed up.
-                                    bool bStarting = true;
-                                    bool bWarmup = false;
-                                    do
+                                    if (parameters.m_bSplitFrame)
                                     {
-                                        unsigned int newWork = 0;
-                                        unsigned int finishedWork = 0;
-
-                                        if (iteration < parameters.m_iterations)
+                                        // Every device renders its band of rows of every frame, so a frame is done
+                                        // once all the devices report in
+                                        while (iteration < parameters.m_iterations)
                                         {
-                                            if (!bWarmup)
-                                            {
-                                                uiDevIndex = 0;
+                                            std::chrono::high_resolution_clock::time_point frameDispatchTime;
+                                            double deviceSeconds[MAX_DEVICES];
 
 #ifdef VTUNE_API
-                                                __itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_dispatch_work);
+                                            __itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_dispatch_work);
 #endif
-
-                                                for (unsigned int uiMask = 1; (uiMask < ALL_DEVICES_MASK) && (iteration < parameters.m_iterations); uiMask <<= 1)
-                                                {
-                                                    if ((uiMask & availableDevices) == uiMask)
-                                                    {
-                                                        NormalizeParameters(parameters);
-                                                        // Copy the interesting parameters over to the device parameters structure
-                                                        devParameters[uiDevIndex] = parameters;
-                                                        newWork |= uiMask;
-                                                        // Update the parameters for the next time we can give out work
-                                                        UpdateParameters(parameters);
-                                                        // Clear the device from the available devices list while it is working
-                                                        availableDevices &= ~uiMask;
-                                                        iteration++;
-                                                    }
-                                                    uiDevIndex++;
-                                                }
-
-                                                // Create a code block so the requestWorkLock will be automatically released
-                                                {
-                                                    std::lock_guard<std::mutex> requestWorkLock(requestWorkMutex);
-                                                    // We have the lock, select the layers that should do the work (in this case all)
-                                                    requestWork |= newWork;
-                                                }
-                                                // Let all sub-Layers know about the request so they can determine if it applies
-                                                requestWorkCondVar.notify_all();
+                                            TraceRecorder::Begin("Dispatch Work", "host");
+                                            NormalizeParameters(parameters);
+                                            frameDispatchTime = std::chrono::high_resolution_clock::now();
+                                            for (unsigned int i = 0; i < MAX_DEVICES; i++)
+                                            {
+                                                devParameters[i] = parameters;
+                                                devParameters[i].m_firstRow = splitBalancer.GetFirstRow(i);
+                                                devParameters[i].m_rowCount = splitBalancer.GetRowCount(i);
+                                            }
+                                            {
+                                                std::lock_guard<std::mutex> requestWorkLock(requestWorkMutex);
+                                                requestWork |= ALL_DEVICES_MASK;
+                                            }
+                                            requestWorkCondVar.notify_all();
 #ifdef VTUNE_API
-                                                __itt_task_end(pittTests_domain);
+                                            __itt_task_end(pittTests_domain);
+                                            __itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_wait_for_completion);
 #endif
-                                                if (bStarting)
-                                                {
-                                                    bStarting = false;
-                                                    bWarmup = true;
-                                                }
+                                            TraceRecorder::End();
+                                            TraceRecorder::Begin("Wait for Completion", "host");
+                                            {
+                                                std::unique_lock<std::mutex> workCompletedLock(workCompletedMutex);
+                                                workCompletedCondVar.wait(workCompletedLock, [&] {
+                                                    return workCompleted == ALL_DEVICES_MASK;
+                                                    });
+                                                workCompleted = 0;
                                             }
-                                        }
 #ifdef VTUNE_API
-                                        __itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_wait_for_completion);
+                                            __itt_task_end(pittTests_domain);
 #endif
-                                        // Now wait for one or more to be done.  Do it in a code block to make sure
-                                        // the lock is released in all cases.
-                                        {
-                                            std::unique_lock<std::mutex> workCompletedLock(workCompletedMutex);
-                                            workCompletedCondVar.wait(workCompletedLock, [&] {
-                                                return workCompleted != 0;
-                                                });
-                                            finishedWork = workCompleted;
-                                            // Clear the variable for the next time.
-                                            workCompleted = 0;
-                                        }
+                                            TraceRecorder::End();
+                                            pTimingStats->AddIterationResults(ETimingType::TIMING_FRAME_LATENCY, GENERAL_STATS, frameDispatchTime, std::chrono::high_resolution_clock::now());
+                                            for (unsigned int i = 0; i < MAX_DEVICES; i++)
+                                            {
+                                                deviceSeconds[i] = devParameters[i].m_frameSeconds;
+                                            }
+                                            splitBalancer.Update(deviceSeconds);
 
-                                        availableDevices |= finishedWork;
-                                        uiDevIndex = 0;
-#ifdef VTUNE_API
-                                        __itt_task_end(pittTests_domain);
-#endif
+                                            if (parameters.m_bShowFrames)
+                                            {
+                                                char windowText[1024];
+
+                                                sprintf(windowText, "Algorithm %d Flat View %s", algorithm, description.c_str());
 
-                                        for (unsigned int uiMask = 1; uiMask < ALL_DEVICES_MASK; uiMask <<= 1)
+                                                cv::imshow(windowText, splitImg);
+                                                // Waiting for a key for 1 millisecond gives OpenCV a hint that it
+                                                // should show the frame
+                                                key = cv::waitKeyEx(1);
+                                            }
+                                            UpdateParameters(parameters);
+                                            iteration++;
+                                            finishedIterations++;
+                                        }
+                                    }
+                                    else
+                                    {
+                                        // Normally it is not required to wait for all the devices to warm up before starting the real work, but in this
+                                        // case, we are trying to compare the running speed of different algorithms so we want to make sure we know
+                                        // the actual warm up times to get all devices up and going and then the run time after everything is warmed up.
+                                        bool bStarting = true;
+                                        bool bWarmup = false;
+                                        char windowText[1024];
+
+                                        sprintf(windowText, "Algorithm %d Flat View %s", algorithm, description.c_str());
+                                        do
                                         {
-                                            if ((uiMask & finishedWork) == uiMask)
+                                            unsigned int newWork = 0;
+                                            unsigned int finishedWork = 0;
+
+                                            if (iteration < parameters.m_iterations)
                                             {
-                                                if (parameters.m_bShowFrames)
+                                                if (!bWarmup)
                                                 {
-                                                    flatImg = devParameters[uiDevIndex].m_FlatImg;
-                                                    char windowText[1024];
+                                                    uiDevIndex = 0;
+
+    #ifdef VTUNE_API
+                                                    __itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_dispatch_work);
+    #endif
+                                                    TraceRecorder::Begin("Dispatch Work", "host");
 
-                                                    sprintf(windowText, "Algorithm %d Flat View %s", algorithm, description.c_str());
+                                                    for (unsigned int uiMask = 1; (uiMask < ALL_DEVICES_MASK) && (iteration < parameters.m_iterations); uiMask <<= 1)
+                                                    {
+                                                        if ((uiMask & availableDevices) == uiMask)
+                                                        {
+                                                            NormalizeParameters(parameters);
+                                                            // Copy the interesting parameters over to the device parameters structure
+                                                            devParameters[uiDevIndex] = parameters;
+                                                            newWork |= uiMask;
+                                                            dispatchTime[uiDevIndex] = std::chrono::high_resolution_clock::now();
+                                                            frameNumbers[uiDevIndex] = iteration;
+                                                            // Update the parameters for the next time we can give out work
+                                                            UpdateParameters(parameters);
+                                                            // Clear the device from the available devices list while it is working
+                                                            availableDevices &= ~uiMask;
+                                                            iteration++;
+                                                        }
+                                                        uiDevIndex++;
+                                                    }
 
-                                                    cv::imshow(windowText, flatImg);
-                                                    // Waiting for a key for 1 millisecond gives OpenCV a hint that it
-                                                    // should show the frame
-                                                    key = cv::waitKeyEx(1);
+                                                    // Create a code block so the requestWorkLock will be automatically released
+                                                    {
+                                                        std::lock_guard<std::mutex> requestWorkLock(requestWorkMutex);
+                                                        // We have the lock, select the layers that should do the work (in this case all)
+                                                        requestWork |= newWork;
+                                                    }
+                                                    // Let all sub-Layers know about the request so they can determine if it applies
+                                                    requestWorkCondVar.notify_all();
+    #ifdef VTUNE_API
+                                                    __itt_task_end(pittTests_domain);
+    #endif
+                                                    TraceRecorder::End();
+                                                    if (bStarting)
+                                                    {
+                                                        bStarting = false;
+                                                        bWarmup = true;
+                                                    }
                                                 }
+                                            }
+    #ifdef VTUNE_API
+                                            __itt_task_begin(pittTests_domain, __itt_null, __itt_null, handle_wait_for_completion);
+    #endif
+                                            TraceRecorder::Begin("Wait for Completion", "host");
+                                            // Now wait for one or more to be done.  Do it in a code block to make sure
+                                            // the lock is released in all cases.
+                                            {
+                                                std::unique_lock<std::mutex> workCompletedLock(workCompletedMutex);
+                                                workCompletedCondVar.wait(workCompletedLock, [&] {
+                                                    return workCompleted != 0;
+                                                    });
+                                                finishedWork = workCompleted;
+                                                // Clear the variable for the next time.
+                                                workCompleted = 0;
+                                            }
+
+                                            availableDevices |= finishedWork;
+                                            uiDevIndex = 0;
+    #ifdef VTUNE_API
+                                            __itt_task_end(pittTests_domain);
+    #endif
+                                            TraceRecorder::End();
 
-                                                finishedIterations++;
+                                            for (unsigned int uiMask = 1; uiMask < ALL_DEVICES_MASK; uiMask <<= 1)
+                                            {
+                                                if ((uiMask & finishedWork) == uiMask)
+                                                {
+                                                    std::chrono::high_resolution_clock::time_point finishTime = std::chrono::high_resolution_clock::now();
+
+                                                    pTimingStats->AddIterationResults(ETimingType::TIMING_FRAME_LATENCY, GENERAL_STATS, dispatchTime[uiDevIndex], finishTime);
+                                                    if (parameters.m_bShowFrames)
+                                                    {
+                                                        // The device reuses its output for the next frame, so hold a copy until it is presented
+                                                        flatImg = devParameters[uiDevIndex].m_FlatImg.clone();
+                                                    }
+                                                    else
+                                                    {
+                                                        flatImg = cv::Mat();
+                                                    }
+                                                    reorderBuffer.AddFrame(frameNumbers[uiDevIndex], flatImg, finishTime);
+
+                                                    finishedIterations++;
+                                                }
+                                                uiDevIndex++;
                                             }
-                                            uiDevIndex++;
-                                        }
-                                        if (bWarmup && availableDevices == ALL_DEVICES_MASK)
-                                        {
-                                            // We were warming up all the devices and they have all reported the work to be done,
-                                            // so now we can go to normal run mode.
-                                            bWarmup = false;
-                                        }
-                                    } while (finishedIterations < parameters.m_iterations);
+                                            PresentFrames(reorderBuffer, windowText);
+                                            if (bWarmup && availableDevices == ALL_DEVICES_MASK)
+                                            {
+                                                // We were warming up all the devices and they have all reported the work to be done,
+                                                // so now we can go to normal run mode.
+                                                bWarmup = false;
+                                            }
+                                        } while (finishedIterations < parameters.m_iterations);
+                                        PresentFrames(reorderBuffer, windowText, true);
+                                    }
 #ifdef VTUNE_API
                                     __itt_pause();
 #endif
@@ -540,7 +856,10 @@ int main(int argc, char** argv) {
 
                                     printf("Algorithm description: %s\n", description.c_str());
                                     pTimingStats->ReportTimes(true);
-
+                                    if (!parameters.m_bSplitFrame)
+                                    {
+                                        printf("%s", reorderBuffer.GetStatsString().c_str());
+                                    }
                                 }
                             }
                             catch (cl::sycl::exception const& e) {
@@ -573,7 +892,17 @@ int main(int argc, char** argv) {
                             pDevAlg[i]->StopVariant();
                         }
                         pTimingStats->AddIterationResults(ETimingType::VARIANT_TERMINATION, 0, variantInitStopTime, std::chrono::high_resolution_clock::now());
-                        summaryStats.push_back(description + "\n" + pTimingStats->SummaryStats(true));
+                        if (parameters.m_bSplitFrame)
+                        {
+                            printf("%s", splitBalancer.GetStatsString().c_str());
+                            summaryStats.push_back(description + "\n" + pTimingStats->SummaryStats(true) + splitBalancer.GetStatsString());
+                            AddRunRecord(pResultsWriter, parameters, devParameters[0].m_image[0], algorithm, description, "split", origYaw, origPitch, origRoll);
+                        }
+                        else
+                        {
+                            summaryStats.push_back(description + "\n" + pTimingStats->SummaryStats(true) + reorderBuffer.GetStatsString());
+                            AddRunRecord(pResultsWriter, parameters, devParameters[0].m_image[0], algorithm, description, "alternate", origYaw, origPitch, origRoll);
+                        }
                     }
                 }
 
@@ -603,6 +932,17 @@ int main(int argc, char** argv) {
             }
             algorithm++;
         }
+        if (pResultsWriter != NULL)
+        {
+            delete pResultsWriter;
+            pResultsWriter = NULL;
+        }
+        if (TraceRecorder::IsEnabled())
+        {
+            // Every device thread has been joined by now so the buffers are complete
+            TraceRecorder::Write(parameters.m_tracePath);
+            TraceRecorder::Terminate();
+        }
 
         // Make the text be in green (see codeproject.com/Tips/5255355/How-to-Put-Color-on-Windows-Console for colors)
         printf("\033[32m");
@@ -16,6 +16,8 @@
 // Quick and dirty command line argument passing.  Drafted our own so it should be portable to either Linux or Windows
 
 #include "ParseArgs.hpp"
+#include "ReorderBuffer.hpp"
+#include "ResultsWriter.hpp"
 #include <stdio.h>
 #include <string.h>
 //#include <math.h>
@@ -42,6 +44,20 @@ _SParameters::_SParameters()
     // m_iterations = 0 means interactive
     m_iterations = 101;
     m_bShowFrames = false;
+    m_bSplitFrame = false;
+    m_devices = "";
+    m_reorderPolicy = REORDER_OFF;
+    m_reorderLatencyMs = DEFAULT_REORDER_LATENCY_MS;
+    m_warmupIterations = 1;
+    m_resultsPath[0] = '\0';
+    m_compareBaseline[0] = '\0';
+    m_compareCandidate[0] = '\0';
+    m_regressionThreshold = DEFAULT_REGRESSION_THRESHOLD;
+    m_tracePath[0] = '\0';
+    m_firstRow = 0;
+    m_rowCount = 0;
+    m_pSplitOutput = NULL;
+    m_frameSeconds = 0.0;
     for (int i = 0; i < 3; i++)
     {
         m_offsets[i] = 0;
@@ -133,6 +149,10 @@ bool ParseArgs(int argc, char** argv, SParameters *parameters, char *errorMessag
             {
                 parameters->m_bShowFrames = true;
             }
+            else if (_strnicmp("splitFrame", flagStart, flagLength) == 0)
+            {
+                parameters->m_bSplitFrame = true;
+            }
             else
             {
                 if (valueStart == NULL)
@@ -296,6 +316,79 @@ bool ParseArgs(int argc, char** argv, SParameters *parameters, char *errorMessag
                     {
                         parameters->m_driverVersion = valueStart;
                     }
+                    else if (_strnicmp("devices", flagStart, flagLength) == 0)
+                    {
+                        parameters->m_devices = valueStart;
+                    }
+                    else if (_strnicmp("reorder", flagStart, flagLength) == 0)
+                    {
+                        parameters->m_reorderPolicy = REORDER_MAX;
+                        for (int policy = 0; policy < REORDER_MAX; policy++)
+                        {
+                            if (_stricmp(valueStart, ReorderBuffer::GetPolicyName((EReorderPolicy)policy)) == 0)
+                            {
+                                parameters->m_reorderPolicy = policy;
+                            }
+                        }
+                        if (parameters->m_reorderPolicy == REORDER_MAX)
+                        {
+                            sprintf(errorMessage, "Error: Illegal value for reorder (%s).  Must be off, wait, or drop.", valueStart);
+                            bRetVal = false;
+                            break;
+                        }
+                    }
+                    else if (_strnicmp("reorderLatency", flagStart, flagLength) == 0)
+                    {
+                        parameters->m_reorderLatencyMs = atoi(valueStart);
+                        if (parameters->m_reorderLatencyMs < 1)
+                        {
+                            sprintf(errorMessage, "Error: Illegal value for reorderLatency (%s).  Must be a positive number.", valueStart);
+                            bRetVal = false;
+                            break;
+                        }
+                    }
+                    else if (_strnicmp("results", flagStart, flagLength) == 0)
+                    {
+                        strcpy_s(parameters->m_resultsPath, valueStart);
+                    }
+                    else if (_strnicmp("trace", flagStart, flagLength) == 0)
+                    {
+                        strcpy_s(parameters->m_tracePath, valueStart);
+                    }
+                    else if (_strnicmp("compare", flagStart, flagLength) == 0)
+                    {
+                        const char* pSeparator = strchr(valueStart, ';');
+
+                        if (pSeparator == NULL || pSeparator == valueStart || pSeparator[1] == '\0' || pSeparator - valueStart >= MAX_PATH)
+                        {
+                            sprintf(errorMessage, "Error: Illegal value for compare (%s).  Must be baselinePath;candidatePath.", valueStart);
+                            bRetVal = false;
+                            break;
+                        }
+                        strncpy(parameters->m_compareBaseline, valueStart, pSeparator - valueStart);
+                        parameters->m_compareBaseline[pSeparator - valueStart] = '\0';
+                        strcpy_s(parameters->m_compareCandidate, pSeparator + 1);
+                    }
+                    else if (_strnicmp("regressionThreshold", flagStart, flagLength) == 0)
+                    {
+                        parameters->m_regressionThreshold = atof(valueStart);
+                        if (parameters->m_regressionThreshold < 0.0)
+                        {
+                            sprintf(errorMessage, "Error: Illegal value for regressionThreshold (%s).  Must be 0 or more.", valueStart);
+                            bRetVal = false;
+                            break;
+                        }
+                    }
+                    else if (_strnicmp("warmupIterations", flagStart, flagLength) == 0)
+                    {
+                        parameters->m_warmupIterations = atoi(valueStart);
+                        if (parameters->m_warmupIterations < 0)
+                        {
+                            sprintf(errorMessage, "Error: Illegal value for warmupIterations (%s).  Must be 0 or more.", valueStart);
+                            bRetVal = false;
+                            break;
+                        }
+                    }
                     else
                     {
                         sprintf(errorMessage, "Error: Unknown flag = %s", argv[i]);
@@ -326,6 +419,9 @@ void PrintUsage(char* pProgramName, char* pMessage)
     printf("     9 = Algorithm 6 and optimized ExtractFrame using DPC++.\n");
     printf("    10 = Algorithm 9 USM but just taking the truncated pixel point.\n");
     printf("    11 = Algorithm 10 USM but on CPU don't copy memory.\n");
+    printf("--compare=baselinePath;candidatePath compares the frame times of the runs in two --results files instead of the\n");
+    printf("    normal run.  Runs are matched by algorithm, description, and output size and each change is tested with Welch's\n");
+    printf("    t-test.  Exits with 2 if any run is significantly slower by more than --regressionThreshold.\n");
     printf("--deltaImage is a flag to indicate that the image should be changed between each iteration to\n");
     printf("    simulate a video stream.\n");
     printf("--deltaPitch=N where N is the amount of pitch to add each iteration (up or down).  This can run from\n");
@@ -334,6 +430,11 @@ void PrintUsage(char* pProgramName, char* pMessage)
     printf("    Default is 0\n");
     printf("--deltaYaw=N where N is the amount of yaw to add each iteration.  This can run from -360 to 360 integer degrees.\n");
     printf("    Default is 0.\n");
+    printf("--devices=list where list is a semicolon separated list of device types (CPU, GPU, or ACC) to schedule frames\n");
+    printf("    across, each optionally followed by :affinity to split it into sub-devices by affinity domain or :N to split\n");
+    printf("    it into N equal sub-devices, as near as the compute units allow (e.g. CPU;GPU or CPU:4).  Each device gets its\n");
+    printf("    own queue of frames and idle devices steal queued frames from busy ones.  The summary reports each device's\n");
+    printf("    share of the frames and busy / idle time.  Defaults to empty (alternate frames between one CPU and one GPU).\n");
     printf("--deviceName=value where value is a string to match against device names to\n");
     printf("    select the best device to run the code on.  Other options include:\n");
     printf("      all - to run on all devices or\n");
@@ -358,14 +459,33 @@ void PrintUsage(char* pProgramName, char* pMessage)
     printf("    Only used for DPC++ algorithms.  Defaults to empty string (select any)\n");
     printf("--pitch=N where N is the pitch of the viewer's perspective (up or down).  This can run from\n");
     printf("    -90 to 90 integer degrees.  The negative values are down and positive are up.  0 is straight ahead.  Default is 0\n");
+    printf("--reorder=policy where policy decides how frames that devices finish out of order are presented:\n");
+    printf("      off - present each frame as soon as it is done (may step backwards)\n");
+    printf("      wait - hold frames until every earlier frame has been presented\n");
+    printf("      drop - hold frames, but skip missing frames after --reorderLatency and drop them if they arrive later\n");
+    printf("    The presentation interval (mean, jitter, p99, max) and reorder depth are reported either way.  Defaults to off.\n");
+    printf("--reorderLatency=N where N is the number of milliseconds a frame is held waiting for an earlier frame with\n");
+    printf("    --reorder=drop.  Defaults to 50.\n");
+    printf("--regressionThreshold=N where N is the percent a significantly slower frame time must exceed to count as a\n");
+    printf("    regression with --compare.  Default is 5.\n");
+    printf("--results=filePath saves a record of each run (settings, devices, CPU model, git revision, and the frame latency\n");
+    printf("    statistics) to filePath as CSV if it ends in .csv and JSON otherwise.  Defaults to none.\n");
     printf("--roll=N where N defines how level the camera is.  This can run from 0 to 360 degrees.  The rotation is counter\n");
     printf("    clockwise so 90 integer degrees will lift the right side of the 'camera' up to be on top.  180 will flip the\n");
     printf("     'camera' upside down.  270 will place the left side of the camera on top.  Default is 0\n");
     printf("--startAlgorithm=N where N defines the first algorithm number to run and then all algorithms up to and including\n");
     printf("    --endAlgorithm will be run in succession.  Defaults to 0.\n");
     printf("--showFrames indicates each calculated frame should be shown.  Defaults to true for interactive mode, false otherwise.\n");
+    printf("--splitFrame renders each frame on both devices at once, each computing a band of the output rows into one\n");
+    printf("    shared frame.  The split is rebalanced every frame from the time each device took.  Without it whole frames\n");
+    printf("    alternate between the devices.  Only algorithm 17 supports it.  Defaults to false.\n");
+    printf("--trace=filePath records when each thread dispatches work, waits, runs FrameCalculations and ExtractFrameImage,\n");
+    printf("    copies images, and waits on the kernels, and saves it to filePath as a Chrome trace JSON file that can be\n");
+    printf("    opened in Perfetto (ui.perfetto.dev) or chrome://tracing.  Defaults to none.\n");
     printf("--typePreference=type1;type2;... where the types can be CPU, GPU, or \n");
     printf("    ACC (for Accelerator such as FPGA.  type1 is highest preference, then type2, etc.\n");
+    printf("--warmupIterations=N where N is the number of first results per device of each timing type reported as warmup\n");
+    printf("    instead of being included in the averages and the p50/p90/p99/p99.9 latency percentiles.  Default is 1.\n");
     printf("--widthOutput=N where N is the number of pixels width the flattened image will be.  Default is 1080.\n");
     printf("--yaw=N where N defines the yaw of the viewer's perspective (left or right angle).  This can run from\n");
     printf("    -180 to 180 integer degrees.  Negative values are to the left of center and positive to the right.  0 is\n");
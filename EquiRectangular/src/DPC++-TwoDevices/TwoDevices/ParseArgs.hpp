@@ -111,6 +111,40 @@ typedef struct _SParameters {
 	// will be considered depending on how the other parameters are set.
 	std::string m_driverVersion;
 	bool m_bShowFrames;
+	// m_bSplitFrame renders every frame on both devices, each computing a band of the output rows (see
+	// SplitFrameBalancer), instead of handing whole frames to the devices in turn
+	bool m_bSplitFrame;
+	// m_devices lists the devices for the DeviceScheduler (e.g. "CPU;GPU" or "CPU:affinity").  Empty means the two
+	// device (CPU and GPU) protocol.
+	std::string m_devices;
+	// m_reorderPolicy is the EReorderPolicy for presenting frames finished out of order (see ReorderBuffer)
+	int m_reorderPolicy;
+	// m_reorderLatencyMs is how long a frame is held waiting for an earlier one with the drop policy
+	int m_reorderLatencyMs;
+	// m_warmupIterations is the number of first results per device of each timing type that TimingStats reports as
+	// warmup rather than folding into the averages and percentiles
+	int m_warmupIterations;
+	// m_resultsPath is the JSON or CSV file (by extension) that ResultsWriter saves a record of each run to.
+	// Empty (the default) means no results file.
+	char m_resultsPath[MAX_PATH];
+	// m_compareBaseline and m_compareCandidate are the results files to compare (see ResultsWriter::Compare)
+	// instead of the normal run.  Empty (the default) means no comparison.
+	char m_compareBaseline[MAX_PATH];
+	char m_compareCandidate[MAX_PATH];
+	// m_regressionThreshold is how many percent slower a significant frame time change must be to be a regression
+	double m_regressionThreshold;
+	// m_tracePath is the Chrome trace JSON file that TraceRecorder writes the timeline of every thread to.  Empty (the
+	// default) means no tracing.
+	char m_tracePath[MAX_PATH];
+	// m_firstRow and m_rowCount give the band of output rows the device computes for the current frame.  A
+	// m_rowCount of 0 means the whole frame.
+	int m_firstRow;
+	int m_rowCount;
+	// m_pSplitOutput points at the frame shared by the devices in split frame mode (NULL otherwise).  Each device
+	// writes its band of rows straight into it.
+	unsigned char* m_pSplitOutput;
+	// m_frameSeconds is how long the device needed for its latest frame (or band)
+	double m_frameSeconds;
 	unsigned int m_uiMyMask;
 	unsigned int m_uiDevIndex;
 	std::mutex *m_pRequestWorkMutex;
@@ -137,7 +171,9 @@ typedef struct _SParameters {
 			m_roll != a.m_roll || 
 			m_fov != a.m_fov || 
 			m_widthOutput != a.m_widthOutput || 
-			m_heightOutput != a.m_heightOutput
+			m_heightOutput != a.m_heightOutput ||
+			m_firstRow != a.m_firstRow ||
+			m_rowCount != a.m_rowCount
 		);
 	}
 	struct _SParameters& operator=(const struct _SParameters &a)
@@ -150,6 +186,8 @@ typedef struct _SParameters {
 		m_widthOutput = a.m_widthOutput;
 		m_heightOutput = a.m_heightOutput;
 		m_imageIndex = a.m_imageIndex;
+		m_firstRow = a.m_firstRow;
+		m_rowCount = a.m_rowCount;
 
 		return *this;
 	}
@@ -0,0 +1,172 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "ReorderBuffer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+
+ReorderBuffer::ReorderBuffer(EReorderPolicy policy, int maxLatencyMs)
+{
+	m_policy = policy;
+	m_maxLatencySeconds = maxLatencyMs / 1000.0;
+	Reset();
+}
+
+void ReorderBuffer::Reset()
+{
+	m_nextFrame = 0;
+	m_held.clear();
+	m_highestArrived = -1;
+	m_intervals.clear();
+	m_presented = 0;
+	m_outOfOrder = 0;
+	m_dropped = 0;
+	m_skipped = 0;
+	m_maxDepth = 0;
+	m_depthSum = 0.0;
+	m_arrivals = 0;
+}
+
+const char* ReorderBuffer::GetPolicyName(EReorderPolicy policy)
+{
+	switch (policy)
+	{
+	case REORDER_OFF:
+		return "off";
+		break;
+	case REORDER_WAIT:
+		return "wait";
+		break;
+	case REORDER_DROP_LATE:
+		return "drop";
+		break;
+	default:
+		break;
+	}
+
+	return "Unknown";
+}
+
+void ReorderBuffer::AddFrame(long long frameNumber, const cv::Mat& image, std::chrono::high_resolution_clock::time_point arrivalTime)
+{
+	if (frameNumber < m_highestArrived)
+	{
+		m_outOfOrder++;
+	}
+	else
+	{
+		m_highestArrived = frameNumber;
+	}
+	if (m_policy != REORDER_OFF && frameNumber < m_nextFrame)
+	{
+		// Its turn was skipped already, so presenting it now would step the view backwards
+		m_dropped++;
+		return;
+	}
+
+	SHeldFrame& held = m_held[frameNumber];
+
+	held.m_image = image;
+	held.m_arrivalTime = arrivalTime;
+	// The reorder depth is the number of frames already waiting when this one arrives
+	m_arrivals++;
+	m_depthSum += (double)(m_held.size() - 1);
+	if (m_held.size() - 1 > m_maxDepth)
+	{
+		m_maxDepth = m_held.size() - 1;
+	}
+}
+
+void ReorderBuffer::Present(long long frameNumber, cv::Mat& image, std::chrono::high_resolution_clock::time_point now, std::vector<SPresentedFrame>& frames)
+{
+	SPresentedFrame frame;
+
+	if (m_presented > 0)
+	{
+		m_intervals.push_back(std::chrono::duration<double>(now - m_lastPresentTime).count());
+	}
+	m_lastPresentTime = now;
+	m_presented++;
+	frame.m_frameNumber = frameNumber;
+	frame.m_image = image;
+	frames.push_back(frame);
+}
+
+void ReorderBuffer::GetReadyFrames(std::vector<SPresentedFrame>& frames, bool bFlush /* = false */)
+{
+	std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+
+	while (!m_held.empty())
+	{
+		auto oldest = m_held.begin();
+
+		if (m_policy == REORDER_OFF || oldest->first == m_nextFrame || bFlush)
+		{
+			// Whatever is held is presented in frame order
+		}
+		else if (m_policy == REORDER_DROP_LATE && std::chrono::duration<double>(now - oldest->second.m_arrivalTime).count() > m_maxLatencySeconds)
+		{
+			// Waited too long for the missing frame(s), skip ahead to the oldest held frame
+		}
+		else
+		{
+			break;
+		}
+		if (oldest->first >= m_nextFrame)
+		{
+			if (m_policy != REORDER_OFF)
+			{
+				m_skipped += oldest->first - m_nextFrame;
+			}
+			m_nextFrame = oldest->first + 1;
+		}
+		Present(oldest->first, oldest->second.m_image, now, frames);
+		m_held.erase(oldest);
+	}
+}
+
+std::string ReorderBuffer::GetStatsString()
+{
+	char line[1024];
+	double mean = 0.0;
+	double jitter = 0.0;
+	double p99 = 0.0;
+	double maxInterval = 0.0;
+
+	if (!m_intervals.empty())
+	{
+		std::vector<double> sorted = m_intervals;
+
+		for (double interval : m_intervals)
+		{
+			mean += interval;
+		}
+		mean /= m_intervals.size();
+		for (double interval : m_intervals)
+		{
+			jitter += (interval - mean) * (interval - mean);
+		}
+		jitter = sqrt(jitter / m_intervals.size());
+		std::sort(sorted.begin(), sorted.end());
+		p99 = sorted[std::min(sorted.size() - 1, (size_t)ceil(sorted.size() * 0.99) - 1)];
+		maxInterval = sorted.back();
+	}
+	sprintf(line, "All,Presentation,%s,reorder,%5lld,presented,%5lld,out of order,%5lld,dropped,%5lld,skipped,%10.3f,ms mean interval,%10.3f,ms jitter,%10.3f,ms p99 interval,%10.3f,ms max interval,%3zu,max reorder depth,%6.2f,mean reorder depth\n",
+		GetPolicyName(m_policy), m_presented, m_outOfOrder, m_dropped, m_skipped, mean * 1000.0, jitter * 1000.0, p99 * 1000.0, maxInterval * 1000.0,
+		m_maxDepth, (m_arrivals > 0) ? m_depthSum / m_arrivals : 0.0);
+
+	return line;
+}
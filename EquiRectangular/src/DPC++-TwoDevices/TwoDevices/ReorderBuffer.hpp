@@ -0,0 +1,93 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// ReorderBuffer puts the frames finished by several devices back in sequence before they are presented.  With
+// alternate frame dispatch the faster device can finish frame n + 1 before the slower one finishes frame n; showing
+// frames as they finish makes the view jump back and forth (judder).  The policy decides what happens:
+//
+//     REORDER_OFF        frames are presented as they finish (the original behavior, for comparison)
+//     REORDER_WAIT       frames are held until every earlier frame has been presented
+//     REORDER_DROP_LATE  frames are held as with REORDER_WAIT, but once the oldest held frame has waited longer
+//                        than the latency bound the missing frames are skipped; if one arrives later it is dropped
+//
+// Whatever the policy, the buffer measures what a viewer would see: the interval between presented frames (mean,
+// jitter as the standard deviation, p99, and max), how many frames arrived out of order, and the reorder depth (the
+// number of frames already held when a frame arrives).
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include "opencv2/core/core.hpp"
+
+enum EReorderPolicy {
+	REORDER_OFF = 0,
+	REORDER_WAIT,
+	REORDER_DROP_LATE,
+	REORDER_MAX
+};
+
+const int DEFAULT_REORDER_LATENCY_MS = 50;
+
+struct SPresentedFrame {
+	long long	m_frameNumber;
+	cv::Mat		m_image;
+};
+
+class ReorderBuffer {
+private:
+	struct SHeldFrame {
+		cv::Mat		m_image;
+		std::chrono::high_resolution_clock::time_point	m_arrivalTime;
+	};
+
+	EReorderPolicy m_policy;
+	double m_maxLatencySeconds;
+	// m_nextFrame is the frame number to present next
+	long long m_nextFrame;
+	std::map<long long, SHeldFrame> m_held;
+	// m_highestArrived is the largest frame number that has arrived, to count out of order arrivals
+	long long m_highestArrived;
+
+	// Statistics since the last Reset
+	std::chrono::high_resolution_clock::time_point m_lastPresentTime;
+	std::vector<double> m_intervals;
+	long long m_presented;
+	long long m_outOfOrder;
+	long long m_dropped;
+	long long m_skipped;
+	size_t m_maxDepth;
+	double m_depthSum;
+	long long m_arrivals;
+
+private:
+	void Present(long long frameNumber, cv::Mat& image, std::chrono::high_resolution_clock::time_point now, std::vector<SPresentedFrame>& frames);
+
+public:
+	ReorderBuffer(EReorderPolicy policy, int maxLatencyMs);
+
+	// Reset starts a new run with frame number 0 presented first
+	void Reset();
+
+	// AddFrame records a finished frame.  image may be empty if the frames are not being shown.
+	void AddFrame(long long frameNumber, const cv::Mat& image, std::chrono::high_resolution_clock::time_point arrivalTime);
+	// GetReadyFrames appends the frames to present now, in order.  bFlush releases everything held (end of run).
+	void GetReadyFrames(std::vector<SPresentedFrame>& frames, bool bFlush = false);
+
+	static const char* GetPolicyName(EReorderPolicy policy);
+	std::string GetStatsString();
+};
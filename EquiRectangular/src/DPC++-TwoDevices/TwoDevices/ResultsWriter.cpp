@@ -0,0 +1,704 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "ResultsWriter.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#ifdef _WIN32
+#include <windows.h>
+#define popen _popen
+#define pclose _pclose
+#endif
+
+ResultsWriter::ResultsWriter(const char* pPath, int argc, char** argv)
+{
+	m_path = pPath;
+	m_arguments = "";
+	for (int i = 1; i < argc; i++)
+	{
+		if (i > 1)
+		{
+			m_arguments += " ";
+		}
+		m_arguments += argv[i];
+	}
+
+	size_t length = m_path.length();
+	m_bJson = !(length >= 4 && _stricmp(m_path.c_str() + length - 4, ".csv") == 0);
+}
+
+void ResultsWriter::BeginRecord()
+{
+	m_records.push_back(std::vector<SField>());
+}
+
+void ResultsWriter::AddField(const char* pName, const std::string& value)
+{
+	SField field;
+
+	field.m_name = pName;
+	field.m_value = value;
+	field.m_bNumeric = false;
+	m_records.back().push_back(field);
+}
+
+void ResultsWriter::AddField(const char* pName, const char* pValue)
+{
+	AddField(pName, std::string(pValue));
+}
+
+void ResultsWriter::AddField(const char* pName, int value)
+{
+	AddField(pName, std::to_string(value));
+	m_records.back().back().m_bNumeric = true;
+}
+
+void ResultsWriter::AddField(const char* pName, double value)
+{
+	char buffer[64];
+
+	sprintf(buffer, "%.9g", value);
+	AddField(pName, std::string(buffer));
+	m_records.back().back().m_bNumeric = true;
+}
+
+void ResultsWriter::AddSystemFields()
+{
+	char timestamp[64];
+	time_t now = time(NULL);
+
+	strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+	AddField("arguments", m_arguments);
+	AddField("timestamp", timestamp);
+	AddField("gitRevision", GetGitRevision());
+	AddField("cpuModel", GetCpuModel());
+	AddField("hardwareThreads", (int)std::thread::hardware_concurrency());
+}
+
+void ResultsWriter::AddFrameFields(const LatencyHistogram& histogram, std::chrono::duration<double> warmupDuration, int warmupIterations)
+{
+	AddField("warmupFrames", warmupIterations);
+	AddField("warmupMs", warmupDuration.count() * 1000.0);
+	AddField("frames", (int)histogram.GetCount());
+	AddField("frameMeanMs", histogram.GetMean() * 1000.0);
+	AddField("frameStdDevMs", histogram.GetStdDev() * 1000.0);
+	AddField("frameMinMs", histogram.GetMin() * 1000.0);
+	AddField("frameP50Ms", histogram.GetPercentile(50.0) * 1000.0);
+	AddField("frameP90Ms", histogram.GetPercentile(90.0) * 1000.0);
+	AddField("frameP99Ms", histogram.GetPercentile(99.0) * 1000.0);
+	AddField("frameP999Ms", histogram.GetPercentile(99.9) * 1000.0);
+	AddField("frameMaxMs", histogram.GetMax() * 1000.0);
+}
+
+bool ResultsWriter::EndRecord()
+{
+	return Write();
+}
+
+std::string ResultsWriter::EscapeJson(const std::string& value)
+{
+	std::string retVal = "\"";
+
+	for (char c : value)
+	{
+		if (c == '"' || c == '\\')
+		{
+			retVal += '\\';
+			retVal += c;
+		}
+		else if ((unsigned char)c < 0x20)
+		{
+			char buffer[8];
+
+			sprintf(buffer, "\\u%04x", (unsigned char)c);
+			retVal += buffer;
+		}
+		else
+		{
+			retVal += c;
+		}
+	}
+	retVal += "\"";
+
+	return retVal;
+}
+
+std::string ResultsWriter::EscapeCsv(const std::string& value)
+{
+	if (value.find_first_of(",\"\r\n") == std::string::npos)
+	{
+		return value;
+	}
+
+	std::string retVal = "\"";
+
+	for (char c : value)
+	{
+		if (c == '"')
+		{
+			retVal += "\"\"";
+		}
+		else if (c == '\r' || c == '\n')
+		{
+			// Keep each record on one line so ReadCsv can read the file line by line
+			retVal += ' ';
+		}
+		else
+		{
+			retVal += c;
+		}
+	}
+	retVal += "\"";
+
+	return retVal;
+}
+
+bool ResultsWriter::Write()
+{
+	FILE* pFile = fopen(m_path.c_str(), "w");
+
+	if (pFile == NULL)
+	{
+		printf("Unable to write the results file %s\n", m_path.c_str());
+		return false;
+	}
+
+	if (m_bJson)
+	{
+		fprintf(pFile, "[\n");
+		for (size_t i = 0; i < m_records.size(); i++)
+		{
+			std::string line = "{";
+
+			for (size_t j = 0; j < m_records[i].size(); j++)
+			{
+				SField& field = m_records[i][j];
+
+				if (j != 0)
+				{
+					line += ", ";
+				}
+				line += EscapeJson(field.m_name) + ": " + (field.m_bNumeric ? field.m_value : EscapeJson(field.m_value));
+			}
+			line += (i + 1 < m_records.size()) ? "},\n" : "}\n";
+			fputs(line.c_str(), pFile);
+		}
+		fprintf(pFile, "]\n");
+	}
+	else if (!m_records.empty())
+	{
+		// Every record has the same fields so the first one names the columns
+		std::vector<SField>& header = m_records[0];
+
+		for (size_t j = 0; j < header.size(); j++)
+		{
+			fprintf(pFile, "%s%s", (j != 0) ? "," : "", EscapeCsv(header[j].m_name).c_str());
+		}
+		fprintf(pFile, "\n");
+		for (size_t i = 0; i < m_records.size(); i++)
+		{
+			for (size_t j = 0; j < header.size(); j++)
+			{
+				std::string value = "";
+
+				for (SField& field : m_records[i])
+				{
+					if (field.m_name == header[j].m_name)
+					{
+						value = field.m_value;
+						break;
+					}
+				}
+				fprintf(pFile, "%s%s", (j != 0) ? "," : "", EscapeCsv(value).c_str());
+			}
+			fprintf(pFile, "\n");
+		}
+	}
+	fclose(pFile);
+
+	return true;
+}
+
+std::string ResultsWriter::GetCpuModel()
+{
+	std::string retVal = "unknown";
+
+#ifdef _WIN32
+	char name[256];
+	DWORD size = sizeof(name);
+
+	if (RegGetValueA(HKEY_LOCAL_MACHINE, "HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0", "ProcessorNameString", RRF_RT_REG_SZ, NULL, name, &size) == ERROR_SUCCESS)
+	{
+		retVal = name;
+	}
+#else
+	FILE* pFile = fopen("/proc/cpuinfo", "r");
+
+	if (pFile != NULL)
+	{
+		char line[1024];
+
+		while (fgets(line, sizeof(line), pFile) != NULL)
+		{
+			if (strncmp(line, "model name", 10) == 0)
+			{
+				char* pValue = strchr(line, ':');
+
+				if (pValue != NULL)
+				{
+					retVal = pValue + 1;
+				}
+				break;
+			}
+		}
+		fclose(pFile);
+	}
+#endif
+	// Trim the spaces and line ending
+	size_t first = retVal.find_first_not_of(" \t");
+	size_t last = retVal.find_last_not_of(" \t\r\n");
+
+	return (first == std::string::npos) ? "unknown" : retVal.substr(first, last - first + 1);
+}
+
+std::string ResultsWriter::GetGitRevision()
+{
+#ifdef GIT_REVISION
+	return GIT_REVISION;
+#else
+	std::string retVal = "";
+#ifdef _WIN32
+	FILE* pPipe = popen("git rev-parse --short HEAD 2>nul", "r");
+#else
+	FILE* pPipe = popen("git rev-parse --short HEAD 2>/dev/null", "r");
+#endif
+
+	if (pPipe != NULL)
+	{
+		char line[128];
+
+		if (fgets(line, sizeof(line), pPipe) != NULL)
+		{
+			retVal = line;
+		}
+		pclose(pPipe);
+	}
+	while (!retVal.empty() && (retVal.back() == '\n' || retVal.back() == '\r'))
+	{
+		retVal.pop_back();
+	}
+
+	return retVal.empty() ? "unknown" : retVal;
+#endif
+}
+
+bool ResultsWriter::ReadJson(FILE* pFile, std::vector<ResultsRecord>& records)
+{
+	char line[8192];
+
+	// Only the layout Write produces is understood: one flat object per line
+	while (fgets(line, sizeof(line), pFile) != NULL)
+	{
+		const char* pChar = strchr(line, '{');
+
+		if (pChar == NULL)
+		{
+			continue;
+		}
+
+		ResultsRecord record;
+		bool bKey = true;
+		std::string key;
+		std::string value;
+
+		pChar++;
+		while (*pChar != '\0' && *pChar != '}')
+		{
+			if (*pChar == '"')
+			{
+				std::string text = "";
+
+				pChar++;
+				while (*pChar != '\0' && *pChar != '"')
+				{
+					if (*pChar == '\\' && pChar[1] != '\0')
+					{
+						pChar++;
+						if (*pChar == 'u')
+						{
+							unsigned int code = 0;
+
+							sscanf(pChar + 1, "%4x", &code);
+							text += (code < 0x80) ? (char)code : '?';
+							for (int k = 0; k < 4 && pChar[1] != '\0'; k++)
+							{
+								pChar++;
+							}
+						}
+						else
+						{
+							text += (*pChar == 'n') ? '\n' : (*pChar == 't') ? '\t' : *pChar;
+						}
+					}
+					else
+					{
+						text += *pChar;
+					}
+					pChar++;
+				}
+				if (*pChar == '"')
+				{
+					pChar++;
+				}
+				if (bKey)
+				{
+					key = text;
+				}
+				else
+				{
+					value = text;
+				}
+			}
+			else if (*pChar == ':')
+			{
+				bKey = false;
+				value = "";
+				pChar++;
+			}
+			else if (*pChar == ',')
+			{
+				record[key] = value;
+				bKey = true;
+				pChar++;
+			}
+			else if (*pChar == ' ' || *pChar == '\t')
+			{
+				pChar++;
+			}
+			else
+			{
+				// A number (or true, false, null) runs up to the next separator
+				value = "";
+				while (*pChar != '\0' && *pChar != ',' && *pChar != '}' && *pChar != ' ')
+				{
+					value += *pChar++;
+				}
+			}
+		}
+		if (!key.empty())
+		{
+			record[key] = value;
+		}
+		records.push_back(record);
+	}
+
+	return true;
+}
+
+static std::vector<std::string> SplitCsvLine(const char* pLine)
+{
+	std::vector<std::string> fields;
+	std::string field = "";
+	bool bQuoted = false;
+
+	for (const char* pChar = pLine; *pChar != '\0' && (bQuoted || (*pChar != '\r' && *pChar != '\n')); pChar++)
+	{
+		if (bQuoted)
+		{
+			if (*pChar == '"' && pChar[1] == '"')
+			{
+				field += '"';
+				pChar++;
+			}
+			else if (*pChar == '"')
+			{
+				bQuoted = false;
+			}
+			else
+			{
+				field += *pChar;
+			}
+		}
+		else if (*pChar == '"')
+		{
+			bQuoted = true;
+		}
+		else if (*pChar == ',')
+		{
+			fields.push_back(field);
+			field = "";
+		}
+		else
+		{
+			field += *pChar;
+		}
+	}
+	fields.push_back(field);
+
+	return fields;
+}
+
+bool ResultsWriter::ReadCsv(FILE* pFile, std::vector<ResultsRecord>& records)
+{
+	char line[8192];
+	std::vector<std::string> header;
+
+	if (fgets(line, sizeof(line), pFile) == NULL)
+	{
+		return false;
+	}
+	header = SplitCsvLine(line);
+	while (fgets(line, sizeof(line), pFile) != NULL)
+	{
+		std::vector<std::string> fields = SplitCsvLine(line);
+		ResultsRecord record;
+
+		for (size_t j = 0; j < header.size() && j < fields.size(); j++)
+		{
+			record[header[j]] = fields[j];
+		}
+		records.push_back(record);
+	}
+
+	return true;
+}
+
+bool ResultsWriter::Read(const char* pPath, std::vector<ResultsRecord>& records)
+{
+	FILE* pFile = fopen(pPath, "r");
+	bool bRetVal;
+	size_t length = strlen(pPath);
+
+	if (pFile == NULL)
+	{
+		printf("Unable to read the results file %s\n", pPath);
+		return false;
+	}
+	if (length >= 4 && _stricmp(pPath + length - 4, ".csv") == 0)
+	{
+		bRetVal = ReadCsv(pFile, records);
+	}
+	else
+	{
+		bRetVal = ReadJson(pFile, records);
+	}
+	fclose(pFile);
+	if (!bRetVal)
+	{
+		printf("The results file %s is empty\n", pPath);
+	}
+
+	return bRetVal;
+}
+
+std::string ResultsWriter::GetRecordKey(ResultsRecord& record)
+{
+	// mode, devices, and reorder are only written by the TwoDevices build and are empty otherwise
+	return record["algorithm"] + "|" + record["description"] + "|" + record["mode"] + "|" + record["devices"] + "|" + record["reorder"] +
+		"|" + record["outputWidth"] + "x" + record["outputHeight"];
+}
+
+// IncompleteBetaFraction evaluates the continued fraction of the regularized incomplete beta function
+// (modified Lentz's method)
+static double IncompleteBetaFraction(double a, double b, double x)
+{
+	const double tiny = 1.0e-300;
+	double c = 1.0;
+	double d = 1.0 - (a + b) * x / (a + 1.0);
+
+	if (fabs(d) < tiny)
+	{
+		d = tiny;
+	}
+	d = 1.0 / d;
+
+	double retVal = d;
+
+	for (int m = 1; m <= 300; m++)
+	{
+		double m2 = 2.0 * m;
+		double aa = m * (b - m) * x / ((a + m2 - 1.0) * (a + m2));
+
+		d = 1.0 + aa * d;
+		d = (fabs(d) < tiny) ? 1.0 / tiny : 1.0 / d;
+		c = 1.0 + aa / c;
+		c = (fabs(c) < tiny) ? tiny : c;
+		retVal *= d * c;
+		aa = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1.0));
+		d = 1.0 + aa * d;
+		d = (fabs(d) < tiny) ? 1.0 / tiny : 1.0 / d;
+		c = 1.0 + aa / c;
+		c = (fabs(c) < tiny) ? tiny : c;
+
+		double delta = d * c;
+
+		retVal *= delta;
+		if (fabs(delta - 1.0) < 1.0e-12)
+		{
+			break;
+		}
+	}
+
+	return retVal;
+}
+
+static double RegularizedIncompleteBeta(double a, double b, double x)
+{
+	if (x <= 0.0)
+	{
+		return 0.0;
+	}
+	if (x >= 1.0)
+	{
+		return 1.0;
+	}
+
+	double front = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log(1.0 - x));
+
+	// The continued fraction converges quickly only on the low side of the mean, so use the symmetry otherwise
+	if (x < (a + 1.0) / (a + b + 2.0))
+	{
+		return front * IncompleteBetaFraction(a, b, x) / a;
+	}
+
+	return 1.0 - front * IncompleteBetaFraction(b, a, 1.0 - x) / b;
+}
+
+double ResultsWriter::GetTwoSidedPValue(double t, double degreesOfFreedom)
+{
+	return RegularizedIncompleteBeta(degreesOfFreedom / 2.0, 0.5, degreesOfFreedom / (degreesOfFreedom + t * t));
+}
+
+int ResultsWriter::Compare(const char* pBaselinePath, const char* pCandidatePath, double thresholdPercent)
+{
+	std::vector<ResultsRecord> baseline;
+	std::vector<ResultsRecord> candidate;
+	int regressions = 0;
+	int improvements = 0;
+	int unchanged = 0;
+	int unmatched = 0;
+	int duplicates = 0;
+
+	if (!Read(pBaselinePath, baseline) || !Read(pCandidatePath, candidate))
+	{
+		return -1;
+	}
+
+	std::map<std::string, ResultsRecord*> baselineByKey;
+	std::map<std::string, bool> baselineMatched;
+	std::map<std::string, bool> candidateSeen;
+
+	printf("Comparing %s (candidate) to %s (baseline).  Regressions are over %.2f%% slower with p < %.2f.\n", pCandidatePath, pBaselinePath, thresholdPercent, COMPARE_SIGNIFICANCE);
+	for (ResultsRecord& record : baseline)
+	{
+		std::string key = GetRecordKey(record);
+
+		if (baselineByKey.find(key) != baselineByKey.end())
+		{
+			printf("%s %s\n    repeated in baseline, only the first run is compared\n", record["algorithm"].c_str(), record["description"].c_str());
+			duplicates++;
+			continue;
+		}
+		baselineByKey[key] = &record;
+	}
+	for (ResultsRecord& record : candidate)
+	{
+		std::string key = GetRecordKey(record);
+		auto found = baselineByKey.find(key);
+
+		printf("%s %s\n", record["algorithm"].c_str(), record["description"].c_str());
+		if (candidateSeen.find(key) != candidateSeen.end())
+		{
+			printf("    repeated in candidate, only the first run is compared\n");
+			duplicates++;
+			continue;
+		}
+		candidateSeen[key] = true;
+		if (found == baselineByKey.end())
+		{
+			printf("    only in candidate\n");
+			unmatched++;
+			continue;
+		}
+		baselineMatched[key] = true;
+
+		ResultsRecord& base = *found->second;
+		double baseMean = atof(base["frameMeanMs"].c_str());
+		double baseStdDev = atof(base["frameStdDevMs"].c_str());
+		double baseFrames = atof(base["frames"].c_str());
+		double newMean = atof(record["frameMeanMs"].c_str());
+		double newStdDev = atof(record["frameStdDevMs"].c_str());
+		double newFrames = atof(record["frames"].c_str());
+		double changePercent = (baseMean > 0.0) ? (newMean - baseMean) / baseMean * 100.0 : 0.0;
+		double pValue = 1.0;
+
+		// Welch's t-test since the two runs need not have the same variance or frame count
+		if (baseFrames >= 2 && newFrames >= 2)
+		{
+			double baseVariance = baseStdDev * baseStdDev / baseFrames;
+			double newVariance = newStdDev * newStdDev / newFrames;
+			double standardError = sqrt(baseVariance + newVariance);
+
+			if (standardError > 0.0)
+			{
+				double t = (newMean - baseMean) / standardError;
+				double degreesOfFreedom = (baseVariance + newVariance) * (baseVariance + newVariance) /
+					(baseVariance * baseVariance / (baseFrames - 1) + newVariance * newVariance / (newFrames - 1));
+
+				pValue = GetTwoSidedPValue(t, degreesOfFreedom);
+			}
+			else
+			{
+				pValue = (newMean == baseMean) ? 1.0 : 0.0;
+			}
+		}
+
+		const char* pStatus = "no significant change";
+
+		if (pValue < COMPARE_SIGNIFICANCE && changePercent > thresholdPercent)
+		{
+			pStatus = "REGRESSION";
+			regressions++;
+		}
+		else if (pValue < COMPARE_SIGNIFICANCE && changePercent < -thresholdPercent)
+		{
+			pStatus = "improvement";
+			improvements++;
+		}
+		else
+		{
+			unchanged++;
+		}
+		printf("    frame(s),baseline,%12.5f,ms,candidate,%12.5f,ms,change,%+8.2f,%%,p,%8.5f,%s\n", baseMean, newMean, changePercent, pValue, pStatus);
+	}
+	for (ResultsRecord& record : baseline)
+	{
+		std::string key = GetRecordKey(record);
+
+		// Repeated runs were already reported above
+		if (baselineByKey[key] == &record && baselineMatched.find(key) == baselineMatched.end())
+		{
+			printf("%s %s\n    only in baseline\n", record["algorithm"].c_str(), record["description"].c_str());
+			unmatched++;
+		}
+	}
+	printf("%d regression(s), %d improvement(s), %d without a significant change, %d unmatched, %d repeated\n", regressions, improvements, unchanged, unmatched, duplicates);
+
+	return regressions;
+}
@@ -0,0 +1,123 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "SourceFrame.hpp"
+#include <stdio.h>
+#include "opencv2/highgui/highgui.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+std::map<std::string, std::weak_ptr<const SourceFrame>> SourceFrame::c_frames;
+std::mutex SourceFrame::c_framesMutex;
+int SourceFrame::c_decodes = 0;
+int SourceFrame::c_shares = 0;
+size_t SourceFrame::c_decodedBytes = 0;
+double SourceFrame::c_decodeSeconds = 0.0;
+
+SourceFrame::SourceFrame(const char* pPath, const cv::Mat& image)
+{
+	m_path = pPath;
+	m_image = image;
+}
+
+std::shared_ptr<const SourceFrame> SourceFrame::Load(const char* pPath)
+{
+	std::lock_guard<std::mutex> framesLock(c_framesMutex);
+	std::shared_ptr<const SourceFrame> pFrame = c_frames[pPath].lock();
+
+	if (pFrame)
+	{
+		c_shares++;
+	}
+	else
+	{
+		std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+		cv::Mat image = cv::imread(pPath, cv::IMREAD_COLOR);
+
+		if (!image.empty())
+		{
+			pFrame = std::make_shared<const SourceFrame>(pPath, image);
+			c_frames[pPath] = pFrame;
+			c_decodes++;
+			c_decodedBytes += pFrame->GetBytes();
+			c_decodeSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+		}
+	}
+
+	return pFrame;
+}
+
+const cv::Mat& SourceFrame::GetImage() const
+{
+	return m_image;
+}
+
+size_t SourceFrame::GetBytes() const
+{
+	return m_image.total() * m_image.elemSize();
+}
+
+size_t SourceFrame::GetResidentBytes()
+{
+	size_t retVal = 0;
+
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		retVal = counters.WorkingSetSize;
+	}
+#else
+	FILE* pFile = fopen("/proc/self/statm", "r");
+
+	if (pFile != NULL)
+	{
+		unsigned long long totalPages;
+		unsigned long long residentPages;
+
+		if (fscanf(pFile, "%llu %llu", &totalPages, &residentPages) == 2)
+		{
+			retVal = (size_t)residentPages * (size_t)sysconf(_SC_PAGESIZE);
+		}
+		fclose(pFile);
+	}
+#endif
+
+	return retVal;
+}
+
+std::string SourceFrame::GetStatsString(int deviceCount, double loadSeconds, size_t residentBytesBefore)
+{
+	char line[1024];
+	size_t residentBytesAfter = GetResidentBytes();
+	double residentMB = 0.0;
+
+	if (residentBytesAfter > residentBytesBefore)
+	{
+		residentMB = (residentBytesAfter - residentBytesBefore) / (1024.0 * 1024.0);
+	}
+	// Decoding for every device would repeat every decode and keep a copy of every frame per device
+	sprintf(line, "Source frames: %d decoded, %d shared, %.1f ms load (%.1f ms decoding per device), %.1f MB source pixels (%.1f MB per device), resident memory +%.1f MB\n",
+		c_decodes, c_shares, loadSeconds * 1000.0, c_decodeSeconds * deviceCount * 1000.0,
+		c_decodedBytes / (1024.0 * 1024.0), c_decodedBytes * deviceCount / (1024.0 * 1024.0), residentMB);
+
+	return line;
+}
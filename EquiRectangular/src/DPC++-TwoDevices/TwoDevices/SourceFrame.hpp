@@ -0,0 +1,60 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// SourceFrame holds one decoded source panorama.  The frame is decoded once and shared (reference counted) by every
+// device context and worker thread, so the devices no longer each decode and keep their own copy of the same image.
+// The pixels must be treated as read only once loaded; a device that needs its own resident copy (for example in
+// device memory) makes it from GetImage() when its variant starts.
+//
+// Loading the same path again while a frame for it is still alive returns the existing frame.
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "opencv2/core/core.hpp"
+
+class SourceFrame {
+private:
+	std::string m_path;
+	cv::Mat m_image;
+
+	// Every live frame by path so repeated loads share it
+	static std::map<std::string, std::weak_ptr<const SourceFrame>> c_frames;
+	static std::mutex c_framesMutex;
+
+	// Statistics since the program started
+	static int c_decodes;
+	static int c_shares;
+	static size_t c_decodedBytes;
+	static double c_decodeSeconds;
+
+public:
+	SourceFrame(const char* pPath, const cv::Mat& image);
+
+	// Load returns the decoded frame for pPath (decoding it if no live frame has it) or NULL if it cannot be read
+	static std::shared_ptr<const SourceFrame> Load(const char* pPath);
+
+	const cv::Mat& GetImage() const;
+	size_t GetBytes() const;
+
+	// GetResidentBytes returns the resident memory (working set) of the process, or 0 if it is not available
+	static size_t GetResidentBytes();
+	// GetStatsString reports the decode time and memory against decoding every frame once per device
+	static std::string GetStatsString(int deviceCount, double loadSeconds, size_t residentBytesBefore);
+};
@@ -0,0 +1,141 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "SplitFrameBalancer.hpp"
+#include "TimingStats.hpp"
+#include <stdio.h>
+
+SplitFrameBalancer::SplitFrameBalancer()
+{
+	Reset(0);
+}
+
+void SplitFrameBalancer::Reset(int rows)
+{
+	m_rows = rows;
+	m_frames = 0;
+	m_imbalanceSum = 0.0;
+	for (unsigned int i = 0; i < MAX_DEVICES; i++)
+	{
+		m_share[i] = 1.0 / MAX_DEVICES;
+		m_shareSum[i] = 0.0;
+	}
+	ComputeBands();
+}
+
+void SplitFrameBalancer::ComputeBands()
+{
+	int units = m_rows / SPLIT_FRAME_ROW_GRANULARITY;
+	int firstRow = 0;
+
+	for (unsigned int i = 0; i < MAX_DEVICES; i++)
+	{
+		int deviceUnits;
+
+		if (i == MAX_DEVICES - 1)
+		{
+			// The last device takes whatever is left so the bands always cover the frame
+			deviceUnits = units - firstRow / SPLIT_FRAME_ROW_GRANULARITY;
+		}
+		else
+		{
+			int unitsLeftForOthers = MAX_DEVICES - 1 - i;
+
+			deviceUnits = (int)(m_share[i] * units + 0.5);
+			if (deviceUnits < 1)
+			{
+				deviceUnits = 1;
+			}
+			if (firstRow / SPLIT_FRAME_ROW_GRANULARITY + deviceUnits > units - unitsLeftForOthers)
+			{
+				deviceUnits = units - unitsLeftForOthers - firstRow / SPLIT_FRAME_ROW_GRANULARITY;
+			}
+		}
+		m_firstRow[i] = firstRow;
+		m_rowCount[i] = deviceUnits * SPLIT_FRAME_ROW_GRANULARITY;
+		firstRow += m_rowCount[i];
+	}
+}
+
+int SplitFrameBalancer::GetFirstRow(unsigned int uiDevIndex)
+{
+	return m_firstRow[uiDevIndex];
+}
+
+int SplitFrameBalancer::GetRowCount(unsigned int uiDevIndex)
+{
+	return m_rowCount[uiDevIndex];
+}
+
+void SplitFrameBalancer::Update(const double deviceSeconds[MAX_DEVICES])
+{
+	double rowsPerSecond[MAX_DEVICES];
+	double totalRowsPerSecond = 0.0;
+	double slowest = 0.0;
+	double fastest = 0.0;
+
+	m_frames++;
+	if (m_frames == 1)
+	{
+		// Warmup frame (kernel compilation), keep the even split
+		return;
+	}
+	for (unsigned int i = 0; i < MAX_DEVICES; i++)
+	{
+		// Guard against a timer that did not advance
+		double seconds = deviceSeconds[i] > 1e-6 ? deviceSeconds[i] : 1e-6;
+
+		rowsPerSecond[i] = m_rowCount[i] / seconds;
+		totalRowsPerSecond += rowsPerSecond[i];
+		if (i == 0 || seconds > slowest)
+		{
+			slowest = seconds;
+		}
+		if (i == 0 || seconds < fastest)
+		{
+			fastest = seconds;
+		}
+		m_shareSum[i] += (double)m_rowCount[i] / m_rows;
+	}
+	// The fraction of the frame time the faster device sat idle waiting for the slower one
+	m_imbalanceSum += (slowest - fastest) / slowest;
+	for (unsigned int i = 0; i < MAX_DEVICES; i++)
+	{
+		m_share[i] = SPLIT_FRAME_SMOOTHING * (rowsPerSecond[i] / totalRowsPerSecond) + (1.0 - SPLIT_FRAME_SMOOTHING) * m_share[i];
+	}
+	ComputeBands();
+}
+
+std::string SplitFrameBalancer::GetStatsString()
+{
+	char line[1024];
+	long long balancedFrames = m_frames - 1;
+	std::string retVal = "";
+
+	if (balancedFrames < 1)
+	{
+		return retVal;
+	}
+	for (unsigned int i = 0; i < MAX_DEVICES; i++)
+	{
+		sprintf(line, "%3s,Split frame,%5lld,frames,%8.2f,%% of rows on average,%8.2f,%% of rows at the end\n",
+			TimingStats::GetTimingStats()->GetDevString(i).c_str(), balancedFrames, m_shareSum[i] * 100.0 / balancedFrames, m_rowCount[i] * 100.0 / m_rows);
+		retVal += line;
+	}
+	sprintf(line, "All,Split frame,%5lld,frames,%8.2f,%% of the frame time the faster device waited on average\n", balancedFrames, m_imbalanceSum * 100.0 / balancedFrames);
+	retVal += line;
+
+	return retVal;
+}
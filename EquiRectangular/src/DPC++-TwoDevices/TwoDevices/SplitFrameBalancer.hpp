@@ -0,0 +1,61 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// SplitFrameBalancer divides the output rows of each frame into one band per device for --splitFrame.  After each
+// frame the devices' measured times give their rows per second and the bands are resized so both devices should
+// finish at the same time on the next frame.  The new share is blended with the old one (SPLIT_FRAME_SMOOTHING) so
+// one noisy frame does not swing the split.  The first frame of a variant includes the kernel compilation, so it
+// is not used to balance.
+
+#include <string>
+#include "ParseArgs.hpp"
+
+// Bands are whole multiples of this many rows (the output height is already a multiple of 8) and every device
+// keeps at least one multiple so its time can still be measured
+const int SPLIT_FRAME_ROW_GRANULARITY = 8;
+// Weight of the newest measurement when updating the share of rows
+const double SPLIT_FRAME_SMOOTHING = 0.5;
+
+class SplitFrameBalancer {
+private:
+	int m_rows;
+	// m_share holds the fraction of the rows assigned to each device
+	double m_share[MAX_DEVICES];
+	int m_firstRow[MAX_DEVICES];
+	int m_rowCount[MAX_DEVICES];
+	long long m_frames;
+	// Sums over the balanced frames (all but the first) for the statistics
+	double m_shareSum[MAX_DEVICES];
+	double m_imbalanceSum;
+
+private:
+	void ComputeBands();
+
+public:
+	SplitFrameBalancer();
+
+	// Reset starts a new variant with an even split of rows
+	void Reset(int rows);
+
+	int GetFirstRow(unsigned int uiDevIndex);
+	int GetRowCount(unsigned int uiDevIndex);
+
+	// Update takes the time each device needed for its current band and computes the bands for the next frame
+	void Update(const double deviceSeconds[MAX_DEVICES]);
+
+	std::string GetStatsString();
+};
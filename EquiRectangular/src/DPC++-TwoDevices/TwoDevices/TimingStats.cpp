@@ -18,103 +18,175 @@
 #include <iostream>
 
 TimingStats* TimingStats::c_timingStats = new TimingStats();
+int TimingStats::c_warmupIterations = 1;
 
 TimingStats *TimingStats::GetTimingStats()
 {
 	return c_timingStats;
 }
 
+void TimingStats::SetWarmupIterations(int warmupIterations)
+{
+	c_warmupIterations = warmupIterations;
+}
+
 TimingStats::TimingStats()
 {
+	m_frameCountType = TIMING_FRAME;
+	m_warmupFrames = MAX_DEVICES;
 	Reset();
 	ResetLap();
 }
 
-void TimingStats::Reset()
+void TimingStats::LockAll()
+{
+	// Always lock in index order so two callers cannot deadlock
+	for (unsigned int j = 0; j < ALL_STATS; j++)
+	{
+		m_accessMutex[j].lock();
+	}
+}
+
+void TimingStats::UnlockAll()
 {
+	for (unsigned int j = ALL_STATS; j > 0; j--)
 	{
-		std::lock_guard<std::mutex> requestWorkLock(m_accessMutex);
+		m_accessMutex[j - 1].unlock();
+	}
+}
 
-		for (int i = 0; i < ETimingType::TIMING_MAX; i++)
+void TimingStats::Reset()
+{
+	LockAll();
+
+	for (int i = 0; i < ETimingType::TIMING_MAX; i++)
+	{
+		for (int j = 0; j < ALL_STATS; j++)
 		{
-			for (int j = 0; j < ALL_STATS; j++)
-			{
-				m_iterations[i][j] = 0;
-				m_warmupIterations[i][j] = 0;
-				m_durationsSum[i][j] = std::chrono::duration<double>::zero();
-				m_durationWarmup[i][j] = std::chrono::duration<double>::zero();
-			}
+			m_iterations[i][j] = 0;
+			m_warmupIterations[i][j] = 0;
+			m_durationsSum[i][j] = std::chrono::duration<double>::zero();
+			m_durationWarmup[i][j] = std::chrono::duration<double>::zero();
+			m_histograms[i][j].Reset();
 		}
-
-		m_bFirstNonWarmup = true;
-		m_startWarmupTime = std::chrono::high_resolution_clock::now();
 	}
+
+	m_bFirstNonWarmup = true;
+	m_startWarmupTime = std::chrono::high_resolution_clock::now();
+
+	UnlockAll();
+}
+
+void TimingStats::SetFrameCounting(ETimingType frameCountType, int warmupFrames)
+{
+	LockAll();
+
+	m_frameCountType = frameCountType;
+	m_warmupFrames = warmupFrames;
+
+	UnlockAll();
 }
 
 void TimingStats::ResetLap()
 {
-	{
-		std::lock_guard<std::mutex> requestWorkLock(m_accessMutex);
+	LockAll();
 
-		for (int i = 0; i < ETimingType::TIMING_MAX; i++)
+	for (int i = 0; i < ETimingType::TIMING_MAX; i++)
+	{
+		for (int j = 0; j < ALL_STATS; j++)
 		{
-			for (int j = 0; j < ALL_STATS; j++)
-			{
-				m_lapIterations[i][j] = 0;
-				m_lapDurationsSum[i][j] = std::chrono::duration<double>::zero();
-			}
+			m_lapIterations[i][j] = 0;
+			m_lapDurationsSum[i][j] = std::chrono::duration<double>::zero();
 		}
 	}
+
+	UnlockAll();
 }
 
 void TimingStats::AddIterationResults(ETimingType timingType, unsigned int uiDevIndex, std::chrono::high_resolution_clock::time_point startTime, std::chrono::high_resolution_clock::time_point endTime)
 {
 	std::chrono::duration<double> duration = std::chrono::duration<double>(endTime - startTime);
+	ETimingType frameCountType;
+	int warmupFrames;
+	bool bWarmupFrame = false;
+	bool bCountedFrame = false;
+
+	if (timingType == TIMING_TOTAL)
 	{
-		std::lock_guard<std::mutex> requestWorkLock(m_accessMutex);
+		int lapIterations = 0;
 
-		if (timingType == TIMING_TOTAL)
 		{
-			m_lapIterations[timingType][uiDevIndex] = 0;
-			for (int j = 0; j < MAX_DEVICES; j++)
+			std::lock_guard<std::mutex> requestWorkLock(m_accessMutex[GENERAL_STATS]);
+
+			frameCountType = m_frameCountType;
+			if (frameCountType == TIMING_FRAME_LATENCY)
 			{
-				m_lapIterations[timingType][uiDevIndex] += m_lapIterations[TIMING_FRAME][j];
+				lapIterations = m_lapIterations[TIMING_FRAME_LATENCY][GENERAL_STATS];
 			}
-			m_lapDurationsSum[timingType][uiDevIndex] = duration;
 			m_durationsSum[TIMING_TOTAL][GENERAL_STATS] = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - m_startNonWarmupTime);
 		}
-		else
+		if (frameCountType != TIMING_FRAME_LATENCY)
 		{
-			if (m_warmupIterations[timingType][uiDevIndex] < 1)
+			for (unsigned int j = 0; j < MAX_DEVICES; j++)
 			{
-				m_durationWarmup[timingType][uiDevIndex] = duration;
-				m_warmupIterations[timingType][uiDevIndex]++;
+				std::lock_guard<std::mutex> requestWorkLock(m_accessMutex[j]);
 
-				if (timingType == TIMING_FRAME)
-				{
-					m_warmupIterations[TIMING_TOTAL][GENERAL_STATS]++;
-					if (m_warmupIterations[TIMING_TOTAL][GENERAL_STATS] == MAX_DEVICES)
-					{
-						m_durationWarmup[TIMING_TOTAL][GENERAL_STATS] = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - m_startWarmupTime);
-					}
-				}
+				lapIterations += m_lapIterations[TIMING_FRAME][j];
+			}
+		}
+		{
+			std::lock_guard<std::mutex> requestWorkLock(m_accessMutex[uiDevIndex]);
+
+			m_lapIterations[timingType][uiDevIndex] = lapIterations;
+			m_lapDurationsSum[timingType][uiDevIndex] = duration;
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> requestWorkLock(m_accessMutex[uiDevIndex]);
+		// Each device compiles its kernels on its first frame, so the first frames of every device are warmup
+		int warmupIterations = ((timingType == TIMING_FRAME_LATENCY) ? m_warmupFrames : 1) * c_warmupIterations;
+
+		frameCountType = m_frameCountType;
+		warmupFrames = m_warmupFrames * c_warmupIterations;
+		if (m_warmupIterations[timingType][uiDevIndex] < warmupIterations)
+		{
+			m_durationWarmup[timingType][uiDevIndex] += duration;
+			m_warmupIterations[timingType][uiDevIndex]++;
+			bWarmupFrame = (timingType == frameCountType);
+		}
+		else
+		{
+			m_iterations[timingType][uiDevIndex]++;
+			m_durationsSum[timingType][uiDevIndex] += duration;
+			m_histograms[timingType][uiDevIndex].Record(duration);
+			bCountedFrame = (timingType == frameCountType);
+		}
+		m_lapIterations[timingType][uiDevIndex]++;
+		m_lapDurationsSum[timingType][uiDevIndex] += duration;
+	}
+
+	if (bWarmupFrame || bCountedFrame)
+	{
+		std::lock_guard<std::mutex> requestWorkLock(m_accessMutex[GENERAL_STATS]);
+
+		if (bWarmupFrame)
+		{
+			m_warmupIterations[TIMING_TOTAL][GENERAL_STATS]++;
+			if (m_warmupIterations[TIMING_TOTAL][GENERAL_STATS] == warmupFrames)
+			{
+				m_durationWarmup[TIMING_TOTAL][GENERAL_STATS] = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - m_startWarmupTime);
 			}
-			else
+		}
+		else
+		{
+			if (m_bFirstNonWarmup)
 			{
-				m_iterations[timingType][uiDevIndex]++;
-				m_durationsSum[timingType][uiDevIndex] += duration;
-				if (timingType == TIMING_FRAME)
-				{
-					if (m_bFirstNonWarmup)
-					{
-						m_bFirstNonWarmup = false;
-						m_startNonWarmupTime = std::chrono::high_resolution_clock::now();
-					}
-					m_iterations[TIMING_TOTAL][GENERAL_STATS]++;
-				}
+				m_bFirstNonWarmup = false;
+				m_startNonWarmupTime = std::chrono::high_resolution_clock::now();
 			}
-			m_lapIterations[timingType][uiDevIndex]++;
-			m_lapDurationsSum[timingType][uiDevIndex] += duration;
+			m_iterations[TIMING_TOTAL][GENERAL_STATS]++;
 		}
 	}
 }
@@ -155,6 +227,22 @@ std::string TimingStats::GetSummaryLine(std::string strDesc, std::string typeStr
 	return retVal;
 }
 
+std::string TimingStats::GetPercentileLine(std::string strDesc, std::string typeString, std::string devString, const LatencyHistogram& histogram)
+{
+	char line[1024];
+
+#ifdef CSV_OUTPUT
+	char const *pFmt = "%3s,%15s,%5llu,%23s,min,%12.5f,ms,p50,%12.5f,ms,p90,%12.5f,ms,p99,%12.5f,ms,p99.9,%12.5f,ms,max,%12.5f,ms,stddev,%12.5f,ms\n";
+#else
+	char const *pFmt = "%3s %15s %5llu %23s min %12.5fms p50 %12.5fms p90 %12.5fms p99 %12.5fms p99.9 %12.5fms max %12.5fms stddev %12.5fms\n";
+#endif
+	sprintf(line, pFmt, devString.c_str(), strDesc.c_str(), (unsigned long long)histogram.GetCount(), typeString.c_str(), histogram.GetMin() * 1000.0,
+		histogram.GetPercentile(50.0) * 1000.0, histogram.GetPercentile(90.0) * 1000.0, histogram.GetPercentile(99.0) * 1000.0,
+		histogram.GetPercentile(99.9) * 1000.0, histogram.GetMax() * 1000.0, histogram.GetStdDev() * 1000.0);
+
+	return line;
+}
+
 void TimingStats::ReportTime(std::string strDesc, std::string typeString, std::string devString, std::chrono::duration<double> durationSum, int numIterations, ETimingType timingType)
 {
 	printf("%s", GetSummaryLine(strDesc, typeString, devString, durationSum, numIterations, timingType).c_str());
@@ -216,6 +304,9 @@ std::string TimingStats::GetTypeString(ETimingType timingType)
 	case TIMING_FRAME:
 		strDesc = "frame(s)";
 		break;
+	case TIMING_FRAME_LATENCY:
+		strDesc = "Frame latency";
+		break;
 	case VARIANT_TERMINATION:
 		strDesc = "Variant cleanup";
 		break;
@@ -256,6 +347,15 @@ void TimingStats::ReportTimes(bool bIncludeLap)
 				ReportTime(desc, typeString, devString, m_durationsSum[i][j], m_iterations[i][j], (ETimingType)i);
 			}
 		}
+		desc = "percentiles";
+		for (int i = 0; i < ETimingType::TIMING_MAX; i++)
+		{
+			// m_iterations of TIMING_TOTAL counts frames rather than recorded samples, so check the histogram itself
+			if (m_histograms[i][j].GetCount() != 0)
+			{
+				printf("%s", GetPercentileLine(desc, GetTypeString((ETimingType)i), devString, m_histograms[i][j]).c_str());
+			}
+		}
 		if (bIncludeLap)
 		{
 			desc = "lap averaging";
@@ -293,6 +393,12 @@ std::string TimingStats::SummaryStats(bool bIncludeLap /* = true */)
 		if (m_iterations[ETimingType::TIMING_FRAME][j] != 0)
 		{
 			retVal += GetSummaryLine("times averaging", GetTypeString(ETimingType::TIMING_FRAME), devString, m_durationsSum[ETimingType::TIMING_FRAME][j], m_iterations[ETimingType::TIMING_FRAME][j], ETimingType::TIMING_FRAME);
+			retVal += GetPercentileLine("percentiles", GetTypeString(ETimingType::TIMING_FRAME), devString, m_histograms[ETimingType::TIMING_FRAME][j]);
+		}
+		if (m_iterations[ETimingType::TIMING_FRAME_LATENCY][j] != 0)
+		{
+			retVal += GetSummaryLine("times averaging", GetTypeString(ETimingType::TIMING_FRAME_LATENCY), devString, m_durationsSum[ETimingType::TIMING_FRAME_LATENCY][j], m_iterations[ETimingType::TIMING_FRAME_LATENCY][j], ETimingType::TIMING_FRAME_LATENCY);
+			retVal += GetPercentileLine("percentiles", GetTypeString(ETimingType::TIMING_FRAME_LATENCY), devString, m_histograms[ETimingType::TIMING_FRAME_LATENCY][j]);
 		}
 		if (m_durationWarmup[ETimingType::TIMING_TOTAL][j] != std::chrono::duration<double>::zero())
 		{
@@ -315,3 +421,25 @@ std::string TimingStats::SummaryStats(bool bIncludeLap /* = true */)
 	return retVal;
 }
 
+const LatencyHistogram& TimingStats::GetHistogram(ETimingType timingType, unsigned int uiDevIndex)
+{
+	return m_histograms[timingType][uiDevIndex];
+}
+
+std::chrono::duration<double> TimingStats::GetWarmupDuration(ETimingType timingType, unsigned int uiDevIndex)
+{
+	return m_durationWarmup[timingType][uiDevIndex];
+}
+
+int TimingStats::GetWarmupIterations(ETimingType timingType, unsigned int uiDevIndex)
+{
+	return m_warmupIterations[timingType][uiDevIndex];
+}
+
+double TimingStats::GetFramesPerSecond()
+{
+	std::lock_guard<std::mutex> requestWorkLock(m_accessMutex[GENERAL_STATS]);
+	double seconds = m_durationsSum[TIMING_TOTAL][GENERAL_STATS].count();
+
+	return (seconds > 0.0) ? m_iterations[TIMING_TOTAL][GENERAL_STATS] / seconds : 0.0;
+}
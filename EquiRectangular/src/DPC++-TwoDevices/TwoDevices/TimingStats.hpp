@@ -17,7 +17,9 @@
 
 #include <chrono>
 #include <mutex>
+#include <string>
 
+#include "LatencyHistogram.hpp"
 #include "ParseArgs.hpp"
 
 enum ETimingType {
@@ -31,6 +33,8 @@ enum ETimingType {
 	TIMING_REMAP,
 	TIMING_IMAGE_EXTRACTION,
 	TIMING_FRAME,
+	// TIMING_FRAME_LATENCY runs from handing a frame to the device(s) until the whole frame is done
+	TIMING_FRAME_LATENCY,
 	VARIANT_TERMINATION,
 	TIMING_TOTAL,
 	TIMING_MAX
@@ -40,34 +44,56 @@ class TimingStats {
 
 private:
 	static TimingStats* c_timingStats;
+	// c_warmupIterations is the number of first results per device of each timing type that count as warmup
+	// (--warmupIterations)
+	static int c_warmupIterations;
 
-	// m_durationWarmup holds the very first duration for each timing type.  The "warmup" run
-	// is often much longer than the subsequent runs since the kernel may need to be compiled, etc.
-	std::chrono::duration<float> m_durationWarmup[TIMING_MAX][ALL_STATS];
+	// m_durationWarmup holds the sum of the warmup durations for each timing type.  The "warmup" runs
+	// are often much longer than the subsequent runs since the kernel may need to be compiled, etc.
+	std::chrono::duration<double> m_durationWarmup[TIMING_MAX][ALL_STATS];
 	int m_warmupIterations[TIMING_MAX][ALL_STATS];
-	// m_iterations holds the number of times a given timing type has been reported (minus the warmup run)
+	// m_iterations holds the number of times a given timing type has been reported (minus the warmup runs)
 	int m_iterations[TIMING_MAX][ALL_STATS];
-	// m_durationsSum holds the sum of all the post-warmup runs
-	std::chrono::duration<float> m_durationsSum[TIMING_MAX][ALL_STATS];
+	// m_durationsSum holds the sum of all the post-warmup runs.  It is kept in double since a float sum stops
+	// growing once it is about 2^24 times larger than the durations added to it.
+	std::chrono::duration<double> m_durationsSum[TIMING_MAX][ALL_STATS];
+	// m_histograms holds the distribution of the post-warmup runs for the percentiles, min, max, and deviation
+	LatencyHistogram m_histograms[TIMING_MAX][ALL_STATS];
 	// m_lapIterations holds a "lap" counter that helps when looking at instantaneous runs rather than the total
 	// run.  For example if the algorithm takes a lot of time to compute when parameters are changed, but less
 	// time when flipping frames, then the lap time can be used to show the latest frame while the m_iterations
 	// and m_durationsSum will report the overall results including both the runs where parameters were changed
 	// and those where they were not.
 	int m_lapIterations[TIMING_MAX][ALL_STATS];
-	std::chrono::duration<float> m_lapDurationsSum[TIMING_MAX][ALL_STATS];
+	std::chrono::duration<double> m_lapDurationsSum[TIMING_MAX][ALL_STATS];
 	std::chrono::high_resolution_clock::time_point m_startWarmupTime;
 	std::chrono::high_resolution_clock::time_point m_startNonWarmupTime;
 	bool m_bFirstNonWarmup;
-	std::mutex m_accessMutex;
+	// m_frameCountType is the timing type reported once per completed frame: TIMING_FRAME when each device
+	// renders whole frames through the two device protocol, TIMING_FRAME_LATENCY when frames are split across
+	// devices or dispatched by the DeviceScheduler
+	ETimingType m_frameCountType;
+	// m_warmupFrames is the number of frames (one per device that compiles its kernels) counted as warmup
+	int m_warmupFrames;
+	// m_accessMutex has one lock per device (plus GENERAL_STATS) so the devices record their own results without
+	// waiting on each other.  Only the whole run frame counters in the GENERAL_STATS slot are shared.
+	// m_frameCountType and m_warmupFrames are changed with every lock held so any one lock is enough to read them.
+	std::mutex m_accessMutex[ALL_STATS];
+
+private:
+	void LockAll();
+	void UnlockAll();
 
 public:
 	static TimingStats* GetTimingStats();
+	// SetWarmupIterations must be called before any results are added
+	static void SetWarmupIterations(int warmupIterations);
 
 	TimingStats();
 	//~TimingStats();
 
 	void Reset();
+	void SetFrameCounting(ETimingType frameCountType, int warmupFrames);
 	void ResetLap();
 	void AddIterationResults(ETimingType timingType, unsigned int uiDevIndex, std::chrono::high_resolution_clock::time_point startTime, std::chrono::high_resolution_clock::time_point endTime);
 	std::string GetTypeString(ETimingType timingType);
@@ -75,5 +101,14 @@ public:
 	void ReportTime(std::string strDesc, std::string typeString, std::string devString, std::chrono::duration<double> durationSum, int numIterations, ETimingType timingType);
 	void ReportTimes(bool bIncludeLap);
 	std::string GetSummaryLine(std::string strDesc, std::string typeString, std::string devString, std::chrono::duration<double> durationSum, int numIterations, ETimingType timingType);
+	// GetPercentileLine returns the min, p50, p90, p99, p99.9, max, and standard deviation line for histogram
+	std::string GetPercentileLine(std::string strDesc, std::string typeString, std::string devString, const LatencyHistogram& histogram);
 	std::string SummaryStats(bool bIncludeLap = true);
+	// GetHistogram, GetWarmupDuration, and GetWarmupIterations return the statistics of timingType for the device
+	// (e.g., for the results file)
+	const LatencyHistogram& GetHistogram(ETimingType timingType, unsigned int uiDevIndex);
+	std::chrono::duration<double> GetWarmupDuration(ETimingType timingType, unsigned int uiDevIndex);
+	int GetWarmupIterations(ETimingType timingType, unsigned int uiDevIndex);
+	// GetFramesPerSecond returns the whole run frame rate after warmup across all the devices
+	double GetFramesPerSecond();
 };
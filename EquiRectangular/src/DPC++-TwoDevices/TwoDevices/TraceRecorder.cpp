@@ -0,0 +1,255 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#include "TraceRecorder.hpp"
+#include <stdio.h>
+
+std::atomic<bool> TraceRecorder::c_bEnabled(false);
+std::chrono::high_resolution_clock::time_point TraceRecorder::c_startTime;
+std::mutex TraceRecorder::c_buffersMutex;
+std::vector<STraceBuffer*> TraceRecorder::c_buffers;
+thread_local STraceBuffer* TraceRecorder::c_pBuffer = NULL;
+
+STraceChunk* TraceRecorder::NewChunk()
+{
+	STraceChunk* pChunk = new STraceChunk();
+
+	pChunk->m_count.store(0, std::memory_order_relaxed);
+	pChunk->m_pNext.store(NULL, std::memory_order_relaxed);
+
+	return pChunk;
+}
+
+void TraceRecorder::Enable()
+{
+	c_startTime = std::chrono::high_resolution_clock::now();
+	c_bEnabled.store(true);
+}
+
+bool TraceRecorder::IsEnabled()
+{
+	return c_bEnabled.load(std::memory_order_relaxed);
+}
+
+STraceBuffer* TraceRecorder::GetBuffer()
+{
+	if (c_pBuffer == NULL)
+	{
+		STraceBuffer* pBuffer = new STraceBuffer();
+
+		pBuffer->m_pFirst = NewChunk();
+		pBuffer->m_pCurrent = pBuffer->m_pFirst;
+		pBuffer->m_depth = 0;
+		{
+			std::lock_guard<std::mutex> buffersLock(c_buffersMutex);
+
+			pBuffer->m_threadId = (int)c_buffers.size() + 1;
+			c_buffers.push_back(pBuffer);
+		}
+		c_pBuffer = pBuffer;
+	}
+
+	return c_pBuffer;
+}
+
+void TraceRecorder::SetThreadName(const std::string& threadName)
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	STraceBuffer* pBuffer = GetBuffer();
+	std::lock_guard<std::mutex> buffersLock(c_buffersMutex);
+
+	pBuffer->m_threadName = threadName;
+}
+
+void TraceRecorder::Begin(const char* pName, const char* pCategory)
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	STraceBuffer* pBuffer = GetBuffer();
+
+	// Still count the task when it is too deep so the matching End closes the right one
+	if (pBuffer->m_depth < TRACE_MAX_DEPTH)
+	{
+		STraceEvent* pEvent = &pBuffer->m_open[pBuffer->m_depth];
+
+		pEvent->m_pName = pName;
+		pEvent->m_pCategory = pCategory;
+		pEvent->m_beginTime = std::chrono::high_resolution_clock::now();
+	}
+	pBuffer->m_depth++;
+}
+
+void TraceRecorder::End()
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
+	STraceBuffer* pBuffer = c_pBuffer;
+
+	// A Begin from before tracing was enabled has no buffer or depth to close
+	if (pBuffer == NULL || pBuffer->m_depth == 0)
+	{
+		return;
+	}
+	pBuffer->m_depth--;
+	if (pBuffer->m_depth >= TRACE_MAX_DEPTH)
+	{
+		return;
+	}
+
+	STraceChunk* pChunk = pBuffer->m_pCurrent;
+	int count = pChunk->m_count.load(std::memory_order_relaxed);
+
+	if (count == TRACE_CHUNK_EVENTS)
+	{
+		STraceChunk* pNewChunk = NewChunk();
+
+		pChunk->m_pNext.store(pNewChunk, std::memory_order_release);
+		pBuffer->m_pCurrent = pNewChunk;
+		pChunk = pNewChunk;
+		count = 0;
+	}
+	pChunk->m_events[count] = pBuffer->m_open[pBuffer->m_depth];
+	pChunk->m_events[count].m_endTime = endTime;
+	// Publish the event only after it is completely written
+	pChunk->m_count.store(count + 1, std::memory_order_release);
+}
+
+std::string TraceRecorder::EscapeJson(const std::string& value)
+{
+	std::string retVal;
+
+	for (char c : value)
+	{
+		if (c == '"' || c == '\\')
+		{
+			retVal += '\\';
+			retVal += c;
+		}
+		else if ((unsigned char)c < 0x20)
+		{
+			retVal += ' ';
+		}
+		else
+		{
+			retVal += c;
+		}
+	}
+
+	return retVal;
+}
+
+bool TraceRecorder::Write(const char* pPath)
+{
+	FILE* pFile = fopen(pPath, "w");
+	std::vector<STraceBuffer*> buffers;
+	long long events = 0;
+
+	if (pFile == NULL)
+	{
+		printf("Error: Could not open the trace file %s\n", pPath);
+		return false;
+	}
+	{
+		std::lock_guard<std::mutex> buffersLock(c_buffersMutex);
+
+		buffers = c_buffers;
+	}
+
+	fprintf(pFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(pFile, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"TwoDevices\"}}");
+	for (auto pBuffer : buffers)
+	{
+		std::string threadName;
+
+		{
+			std::lock_guard<std::mutex> buffersLock(c_buffersMutex);
+
+			threadName = pBuffer->m_threadName;
+		}
+		if (threadName.empty())
+		{
+			threadName = "Thread " + std::to_string(pBuffer->m_threadId);
+		}
+		fprintf(pFile, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+			pBuffer->m_threadId, EscapeJson(threadName).c_str());
+		for (STraceChunk* pChunk = pBuffer->m_pFirst; pChunk != NULL; pChunk = pChunk->m_pNext.load(std::memory_order_acquire))
+		{
+			int count = pChunk->m_count.load(std::memory_order_acquire);
+
+			for (int i = 0; i < count; i++)
+			{
+				STraceEvent* pEvent = &pChunk->m_events[i];
+				// Complete ("X") events take their start and duration in microseconds
+				double beginUs = std::chrono::duration<double, std::micro>(pEvent->m_beginTime - c_startTime).count();
+				double durationUs = std::chrono::duration<double, std::micro>(pEvent->m_endTime - pEvent->m_beginTime).count();
+
+				fprintf(pFile, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+					EscapeJson(pEvent->m_pName).c_str(), pEvent->m_pCategory, pBuffer->m_threadId, beginUs, durationUs);
+				events++;
+			}
+		}
+	}
+	fprintf(pFile, "\n]}\n");
+
+	bool bRetVal = ferror(pFile) == 0;
+
+	if (fclose(pFile) != 0)
+	{
+		bRetVal = false;
+	}
+	if (bRetVal)
+	{
+		printf("Wrote %lld trace events from %d threads to %s\n", events, (int)buffers.size(), pPath);
+	}
+	else
+	{
+		printf("Error: Could not write the trace file %s\n", pPath);
+	}
+
+	return bRetVal;
+}
+
+void TraceRecorder::Terminate()
+{
+	std::lock_guard<std::mutex> buffersLock(c_buffersMutex);
+
+	c_bEnabled.store(false);
+	for (auto pBuffer : c_buffers)
+	{
+		STraceChunk* pChunk = pBuffer->m_pFirst;
+
+		while (pChunk != NULL)
+		{
+			STraceChunk* pNext = pChunk->m_pNext.load(std::memory_order_acquire);
+
+			delete pChunk;
+			pChunk = pNext;
+		}
+		delete pBuffer;
+	}
+	c_buffers.clear();
+	c_pBuffer = NULL;
+}
@@ -0,0 +1,92 @@
+// Copyright (C) 2023 Intel Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Author: Douglas P. Bogia
+
+#pragma once
+
+// TraceRecorder keeps a timeline of what every thread was doing (dispatching work, waiting on the condition
+// variables, running FrameCalculations and ExtractFrameImage, copying images, and waiting on the SYCL kernels) and
+// writes it as a Chrome trace JSON file (--trace) that can be opened in Perfetto (ui.perfetto.dev) or
+// chrome://tracing.  It covers the same tasks the VTUNE_API builds report to VTune, but works on any platform.
+//
+// Begin and End mirror __itt_task_begin and __itt_task_end: the tasks of a thread nest and End closes the latest
+// Begin.  Each thread writes its events into its own buffer without any locking; a buffer is a list of fixed size
+// chunks, so recording only allocates once every TRACE_CHUNK_EVENTS events.  The kernel and copy tasks are timed
+// on the host from submission until the wait for them returns.
+//
+// While tracing is off Begin and End return right away.  Write should be called once the traced threads are done
+// (e.g., after StopVariant) so the buffers are no longer growing.
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+const int TRACE_CHUNK_EVENTS = 4096;
+// The deepest nesting of tasks on one thread that is recorded (deeper tasks are ignored)
+const int TRACE_MAX_DEPTH = 16;
+
+struct STraceEvent {
+	// m_pName and m_pCategory must be string literals (or otherwise live until Write)
+	const char* m_pName;
+	const char* m_pCategory;
+	std::chrono::high_resolution_clock::time_point m_beginTime;
+	std::chrono::high_resolution_clock::time_point m_endTime;
+};
+
+struct STraceChunk {
+	STraceEvent m_events[TRACE_CHUNK_EVENTS];
+	// m_count is only written by the owning thread; Write reads it to know how many events are complete
+	std::atomic<int> m_count;
+	std::atomic<STraceChunk*> m_pNext;
+};
+
+struct STraceBuffer {
+	int m_threadId;
+	std::string m_threadName;
+	STraceChunk* m_pFirst;
+	STraceChunk* m_pCurrent;
+	// The open tasks of the thread, which only the owning thread touches
+	int m_depth;
+	STraceEvent m_open[TRACE_MAX_DEPTH];
+};
+
+class TraceRecorder {
+private:
+	static std::atomic<bool> c_bEnabled;
+	static std::chrono::high_resolution_clock::time_point c_startTime;
+	// c_buffersMutex only guards adding a thread's buffer to c_buffers (and naming it), not the recording itself
+	static std::mutex c_buffersMutex;
+	static std::vector<STraceBuffer*> c_buffers;
+	static thread_local STraceBuffer* c_pBuffer;
+
+private:
+	static STraceChunk* NewChunk();
+	static STraceBuffer* GetBuffer();
+	static std::string EscapeJson(const std::string& value);
+
+public:
+	// Enable starts the timeline; the times in the trace are relative to this call
+	static void Enable();
+	static bool IsEnabled();
+	// SetThreadName names the calling thread's row in the trace
+	static void SetThreadName(const std::string& threadName);
+	static void Begin(const char* pName, const char* pCategory);
+	static void End();
+	// Write saves every recorded event to pPath.  Returns false (after printing why) if it cannot.
+	static bool Write(const char* pPath);
+	// Terminate turns tracing off and frees all the buffers.  Call it after the other recording threads are done.
+	static void Terminate();
+};